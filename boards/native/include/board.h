@@ -88,6 +88,87 @@ void _native_LED_RED_TOGGLE(void);
 extern mtd_dev_t *mtd0;
 #endif
 
+#if defined(MODULE_NAND_SIM) || DOXYGEN
+#include "nand_sim.h"
+
+/**
+ * @name    NAND driver pins of the simulated NAND
+ *
+ * CE0#, R/B0#, I/O 0 to 7 and the shared pins are the nand driver defaults
+ * already, I/O 8 to 15 are only driven with CONFIG_NAND_SIM_BUS_WIDTH_16.
+ * CE# and R/B# are only wired for the CONFIG_NAND_SIM_LUNS LUNs there are,
+ * the driver probes every wired CE# on init.
+ * @{
+ */
+#if !defined(NAND_PARAM_CE1) && (CONFIG_NAND_SIM_LUNS > 1)
+#define NAND_PARAM_CE1          NAND_SIM_PIN_CE(1)
+#endif
+#if !defined(NAND_PARAM_CE2) && (CONFIG_NAND_SIM_LUNS > 2)
+#define NAND_PARAM_CE2          NAND_SIM_PIN_CE(2)
+#endif
+#if !defined(NAND_PARAM_CE3) && (CONFIG_NAND_SIM_LUNS > 3)
+#define NAND_PARAM_CE3          NAND_SIM_PIN_CE(3)
+#endif
+#if !defined(NAND_PARAM_CE4) && (CONFIG_NAND_SIM_LUNS > 4)
+#define NAND_PARAM_CE4          NAND_SIM_PIN_CE(4)
+#endif
+#if !defined(NAND_PARAM_CE5) && (CONFIG_NAND_SIM_LUNS > 5)
+#define NAND_PARAM_CE5          NAND_SIM_PIN_CE(5)
+#endif
+#if !defined(NAND_PARAM_CE6) && (CONFIG_NAND_SIM_LUNS > 6)
+#define NAND_PARAM_CE6          NAND_SIM_PIN_CE(6)
+#endif
+#if !defined(NAND_PARAM_CE7) && (CONFIG_NAND_SIM_LUNS > 7)
+#define NAND_PARAM_CE7          NAND_SIM_PIN_CE(7)
+#endif
+#if !defined(NAND_PARAM_RB1) && (CONFIG_NAND_SIM_LUNS > 1)
+#define NAND_PARAM_RB1          NAND_SIM_PIN_RB(1)
+#endif
+#if !defined(NAND_PARAM_RB2) && (CONFIG_NAND_SIM_LUNS > 2)
+#define NAND_PARAM_RB2          NAND_SIM_PIN_RB(2)
+#endif
+#if !defined(NAND_PARAM_RB3) && (CONFIG_NAND_SIM_LUNS > 3)
+#define NAND_PARAM_RB3          NAND_SIM_PIN_RB(3)
+#endif
+#if !defined(NAND_PARAM_RB4) && (CONFIG_NAND_SIM_LUNS > 4)
+#define NAND_PARAM_RB4          NAND_SIM_PIN_RB(4)
+#endif
+#if !defined(NAND_PARAM_RB5) && (CONFIG_NAND_SIM_LUNS > 5)
+#define NAND_PARAM_RB5          NAND_SIM_PIN_RB(5)
+#endif
+#if !defined(NAND_PARAM_RB6) && (CONFIG_NAND_SIM_LUNS > 6)
+#define NAND_PARAM_RB6          NAND_SIM_PIN_RB(6)
+#endif
+#if !defined(NAND_PARAM_RB7) && (CONFIG_NAND_SIM_LUNS > 7)
+#define NAND_PARAM_RB7          NAND_SIM_PIN_RB(7)
+#endif
+#ifndef NAND_PARAM_IO8
+#define NAND_PARAM_IO8          NAND_SIM_PIN_IO(8)
+#endif
+#ifndef NAND_PARAM_IO9
+#define NAND_PARAM_IO9          NAND_SIM_PIN_IO(9)
+#endif
+#ifndef NAND_PARAM_IO10
+#define NAND_PARAM_IO10         NAND_SIM_PIN_IO(10)
+#endif
+#ifndef NAND_PARAM_IO11
+#define NAND_PARAM_IO11         NAND_SIM_PIN_IO(11)
+#endif
+#ifndef NAND_PARAM_IO12
+#define NAND_PARAM_IO12         NAND_SIM_PIN_IO(12)
+#endif
+#ifndef NAND_PARAM_IO13
+#define NAND_PARAM_IO13         NAND_SIM_PIN_IO(13)
+#endif
+#ifndef NAND_PARAM_IO14
+#define NAND_PARAM_IO14         NAND_SIM_PIN_IO(14)
+#endif
+#ifndef NAND_PARAM_IO15
+#define NAND_PARAM_IO15         NAND_SIM_PIN_IO(15)
+#endif
+/** @} */
+#endif
+
 #if defined(MODULE_SPIFFS) || DOXYGEN
 /**
  * @name    SPIFFS default configuration
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     cpu_native
+ * @defgroup    cpu_native_nand_sim Simulated ONFI NAND
+ * @brief       ONFI NAND flash model behind the native GPIO mock
+ *
+ * With the `nand_sim` module, `periph_gpio_mock` routes the pins listed
+ * below to a model of an asynchronous (SDR) ONFI NAND, so @ref drivers_nand,
+ * @ref drivers_nand_onfi and the mtd layers above them run on `native`
+ * without hardware.
+ *
+ * Bus cycles are decoded on the edges the driver produces: a command or an
+ * address byte is latched on the rising edge of WE# with CLE or ALE high,
+ * a data byte on the rising edge of WE# with both low, and the next output
+ * byte is put on the bus on the falling edge of RE#. Each LUN has a CE# and
+ * a R/B# pin of its own, R/B# is low for tR, tPROG, tBERS etc. after the
+ * command that started the operation, measured with `ZTIMER_USEC`.
+ *
+ * Supported are
+ *
+ * - RESET (FFh), READ ID (90h) at 00h and 20h, READ PARAMETER PAGE (ECh)
+ *   with three copies and a valid CRC, GET/SET FEATURES (EEh/EFh)
+ * - READ STATUS (70h) and READ STATUS ENHANCED (78h)
+ * - READ (00h-30h), CHANGE READ COLUMN (05h-E0h, 06h-E0h), READ CACHE
+ *   SEQUENTIAL/END (31h/3Fh), COPYBACK (00h-35h, 85h-10h)
+ * - PAGE PROGRAM (80h-10h), CHANGE WRITE COLUMN (85h), PAGE CACHE PROGRAM
+ *   (80h-15h), BLOCK ERASE (60h-D0h)
+ * - multi-plane READ (00h-32h), PROGRAM (80h-11h) and ERASE (60h-D1h)
+ *
+ * Programs only clear bits, like on the real array. Storage is allocated
+ * per programmed page on first use, erased pages read as FFh without taking
+ * memory, so a part of several GiB can be simulated as long as only a part
+ * of it is written. Nothing is kept across runs.
+ *
+ * Geometry and timing are set with the CONFIG_NAND_SIM_* defines below.
+ * The driver is pointed to the pins through the NAND_PARAM_* defines of
+ * the native board.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface of the simulated ONFI NAND
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_SIM_H
+#define NAND_SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "periph/gpio.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    Geometry of the simulated part
+ * @{
+ */
+#ifndef CONFIG_NAND_SIM_DATA_BYTES_PER_PAGE
+#define CONFIG_NAND_SIM_DATA_BYTES_PER_PAGE (2048)
+#endif
+#ifndef CONFIG_NAND_SIM_SPARE_BYTES_PER_PAGE
+#define CONFIG_NAND_SIM_SPARE_BYTES_PER_PAGE (64)
+#endif
+#ifndef CONFIG_NAND_SIM_PAGES_PER_BLOCK
+#define CONFIG_NAND_SIM_PAGES_PER_BLOCK     (64)
+#endif
+#ifndef CONFIG_NAND_SIM_BLOCKS_PER_LUN
+#define CONFIG_NAND_SIM_BLOCKS_PER_LUN      (1024)
+#endif
+#ifndef CONFIG_NAND_SIM_LUNS
+#define CONFIG_NAND_SIM_LUNS                (1)     /**< one CE# and R/B# each, up to 8 */
+#endif
+#ifndef CONFIG_NAND_SIM_PLANES
+#define CONFIG_NAND_SIM_PLANES              (2)     /**< power of two, selected by the lowest block bits */
+#endif
+#ifndef CONFIG_NAND_SIM_PROGRAMS_PER_PAGE
+#define CONFIG_NAND_SIM_PROGRAMS_PER_PAGE   (4)     /**< NOP, further programs of a page fail */
+#endif
+#ifndef CONFIG_NAND_SIM_ECC_BITS
+#define CONFIG_NAND_SIM_ECC_BITS            (4)     /**< host ECC requested per 512 bytes */
+#endif
+/** @} */
+
+/**
+ * @brief   Advertise an on-die ECC the way Micron parts do
+ *
+ * The array operation mode feature (90h) then keeps its ECC enable bit.
+ * Pages are never corrupted, so the ECC has nothing to correct either way.
+ */
+#ifdef DOXYGEN
+#define CONFIG_NAND_SIM_ON_DIE_ECC
+#endif
+
+/**
+ * @brief   16-bit data bus, column addresses count words then
+ */
+#ifdef DOXYGEN
+#define CONFIG_NAND_SIM_BUS_WIDTH_16
+#endif
+
+/**
+ * @name    Array timing of the simulated part in us
+ * @{
+ */
+#ifndef CONFIG_NAND_SIM_T_R_US
+#define CONFIG_NAND_SIM_T_R_US              (25)
+#endif
+#ifndef CONFIG_NAND_SIM_T_PROG_US
+#define CONFIG_NAND_SIM_T_PROG_US           (200)
+#endif
+#ifndef CONFIG_NAND_SIM_T_BERS_US
+#define CONFIG_NAND_SIM_T_BERS_US           (2000)
+#endif
+#ifndef CONFIG_NAND_SIM_T_CBSY_US
+#define CONFIG_NAND_SIM_T_CBSY_US           (3)     /**< cache and multi-plane busy time */
+#endif
+#ifndef CONFIG_NAND_SIM_T_RST_US
+#define CONFIG_NAND_SIM_T_RST_US            (250)
+#endif
+#ifndef CONFIG_NAND_SIM_T_FEAT_US
+#define CONFIG_NAND_SIM_T_FEAT_US           (1)
+#endif
+/** @} */
+
+/**
+ * @name    Pins of the simulated part
+ *
+ * CE0#, R/B0# and the shared pins match the defaults of the nand driver.
+ * @{
+ */
+#define NAND_SIM_PIN_CE(lun)    (((lun) == 0) ? GPIO_PIN(0, 0) : GPIO_PIN(2, (lun)))
+#define NAND_SIM_PIN_RB(lun)    (((lun) == 0) ? GPIO_PIN(0, 1) : GPIO_PIN(3, (lun)))
+#define NAND_SIM_PIN_RE         GPIO_PIN(0, 2)
+#define NAND_SIM_PIN_WE         GPIO_PIN(0, 3)
+#define NAND_SIM_PIN_WP         GPIO_PIN(0, 4)
+#define NAND_SIM_PIN_CLE        GPIO_PIN(0, 5)
+#define NAND_SIM_PIN_ALE        GPIO_PIN(0, 6)
+#define NAND_SIM_PIN_IO(bit)    GPIO_PIN(1, (bit))
+/** @} */
+
+/**
+ * @brief   What the simulated part has been asked to do
+ */
+typedef struct {
+    uint32_t page_reads;            /**< pages moved from the array to a register */
+    uint32_t read_waits;            /**< page reads the host waited the whole tR for, 30h and 35h */
+    uint32_t page_programs;         /**< pages programmed */
+    uint32_t block_erases;          /**< blocks erased */
+    uint32_t failed_ops;            /**< programs and erases reported as failed */
+    uint64_t bytes_in;              /**< data bytes taken from the bus */
+    uint64_t bytes_out;             /**< data bytes put on the bus */
+    uint32_t busy_cycles;           /**< cycles other than status and reset issued while R/B# was low */
+} nand_sim_stats_t;
+
+/**
+ * @brief   Counters since start or the last nand_sim_stats_reset()
+ */
+const nand_sim_stats_t* nand_sim_stats(void);
+
+/**
+ * @brief   Sets all counters to zero
+ */
+void nand_sim_stats_reset(void);
+
+/**
+ * @brief   Erases the whole part and frees its storage, bad blocks stay bad
+ */
+void nand_sim_erase_all(void);
+
+/**
+ * @brief   Marks a block bad the way it ships from the factory
+ *
+ * Its pages read as 00h and programs and erases of it fail.
+ */
+void nand_sim_set_bad_block(const uint8_t lun_no, const uint32_t block_no);
+
+/**
+ * @brief   Wears a block out the way it happens in the field
+ *
+ * Programs and erases of it fail, its pages keep what they hold.
+ */
+void nand_sim_set_worn_block(const uint8_t lun_no, const uint32_t block_no);
+
+/**
+ * @brief   Erases of a block since start, failed ones excluded
+ */
+uint32_t nand_sim_block_erases(const uint8_t lun_no, const uint32_t block_no);
+
+/**
+ * @brief   Level of a pin of the simulated part, for the GPIO mock
+ *
+ * @return  false if @p pin does not belong to the part
+ */
+bool nand_sim_gpio_read(const gpio_t pin, int* const value);
+
+/**
+ * @brief   Drives a pin of the simulated part, for the GPIO mock
+ *
+ * @return  false if @p pin does not belong to the part
+ */
+bool nand_sim_gpio_write(const gpio_t pin, const int value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_SIM_H */
+/** @} */
@@ -61,7 +61,7 @@ extern "C" {
 /**
  * @brief   Define a custom GPIO_PIN macro for native
  */
-#define GPIO_PIN(port, pin) (gpio_t)((port << GPIO_PORT_SHIFT) | pin)
+#define GPIO_PIN(port, pin) ((gpio_t)(((port) << GPIO_PORT_SHIFT) | (pin)))
 
 #define HAVE_GPIO_MODE_T
 #ifndef GPIOHANDLE_REQUEST_PULL_DOWN
@@ -99,6 +99,19 @@ typedef enum {
 
 #endif /* MODULE_PERIPH_GPIO_LINUX | DOXYGEN */
 
+#if defined(MODULE_NAND_SIM) && !defined(MODULE_PERIPH_GPIO_LINUX)
+/**
+ * @name    GPIO pins of the simulated NAND
+ *
+ * The mock keeps the port of a pin too, the simulated NAND tells its control
+ * pins and its I/O bus apart by it.
+ * @{
+ */
+#define GPIO_PORT_SHIFT     (24)
+#define GPIO_PIN(port, pin) ((gpio_t)(((port) << GPIO_PORT_SHIFT) | (pin)))
+/** @} */
+#endif /* MODULE_NAND_SIM */
+
 /**
  * @brief   Prevent shared timer functions from being used
  */
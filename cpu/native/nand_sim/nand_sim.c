@@ -0,0 +1,920 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     cpu_native_nand_sim
+ * @{
+ *
+ * @file
+ * @brief       Simulated ONFI NAND behind the native GPIO mock
+ *
+ * Every LUN has a cache register per plane. Data goes in and out of the
+ * register of the plane addressed last, array operations happen when they
+ * are started, only R/B# and the status register tell the time they take.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "kernel_defines.h"
+#include "nand_sim.h"
+#include "ztimer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAND_SIM_PAGE_SIZE          (CONFIG_NAND_SIM_DATA_BYTES_PER_PAGE + CONFIG_NAND_SIM_SPARE_BYTES_PER_PAGE)
+#define NAND_SIM_COLUMN_CYCLES      (2)
+#define NAND_SIM_ROW_CYCLES         (3)
+#define NAND_SIM_ADDR_CYCLES        (NAND_SIM_COLUMN_CYCLES + NAND_SIM_ROW_CYCLES)
+#define NAND_SIM_PARAM_PAGE_SIZE    (256)
+#define NAND_SIM_FEATURE_SIZE       (4)
+
+#ifdef CONFIG_NAND_SIM_BUS_WIDTH_16
+#define NAND_SIM_BUS_BYTES          (2)
+#else
+#define NAND_SIM_BUS_BYTES          (1)
+#endif
+
+#define NAND_SIM_STATUS_FAIL        (0x01)
+#define NAND_SIM_STATUS_FAILC       (0x02)
+#define NAND_SIM_STATUS_ARDY        (0x20)
+#define NAND_SIM_STATUS_RDY         (0x40)
+#define NAND_SIM_STATUS_WP_N        (0x80)
+
+#define NAND_SIM_FEATURE_ARRAY_OPERATION_MODE       (0x90)
+#define NAND_SIM_ARRAY_OPERATION_MODE_ECC_ENABLE    (0x08)
+
+/** What RE# cycles return */
+typedef enum {
+    NAND_SIM_OUT_NONE,
+    NAND_SIM_OUT_ID,
+    NAND_SIM_OUT_PARAMETER_PAGE,
+    NAND_SIM_OUT_FEATURES,
+    NAND_SIM_OUT_STATUS,
+    NAND_SIM_OUT_DATA
+} nand_sim_out_t;
+
+typedef struct {
+    bool     bad;
+    bool     worn;                                              /**< programs and erases fail, pages stay readable */
+    uint32_t erases;
+    uint8_t  programs[CONFIG_NAND_SIM_PAGES_PER_BLOCK];         /**< since the last erase, for the NOP limit */
+    uint8_t* pages[CONFIG_NAND_SIM_PAGES_PER_BLOCK];            /**< NULL while erased */
+} nand_sim_block_t;
+
+typedef struct {
+    nand_sim_block_t**  blocks;                                 /**< NULL while never programmed nor marked bad */
+
+    uint8_t             regs[CONFIG_NAND_SIM_PLANES][NAND_SIM_PAGE_SIZE];
+    uint32_t            reg_rows[CONFIG_NAND_SIM_PLANES];
+    bool                reg_queued[CONFIG_NAND_SIM_PLANES];     /**< multi-plane operation waiting for the last plane */
+    uint8_t             plane;                                  /**< register data cycles go to */
+    uint32_t            column;                                 /**< in bytes */
+    uint32_t            cache_row;                              /**< page the data register holds for 31h and 3Fh */
+    bool                data_valid;
+
+    uint8_t             cmd;                                    /**< first command of the running sequence */
+    uint8_t             addr[NAND_SIM_ADDR_CYCLES];
+    uint8_t             addr_count;
+
+    nand_sim_out_t      out;
+    uint32_t            out_pos;
+    uint8_t             id_addr;
+
+    uint8_t             feature_addr;
+    uint8_t             feature_count;
+    uint8_t             features[256][NAND_SIM_FEATURE_SIZE];
+
+    uint8_t             status_fail;                            /**< FAIL and FAILC */
+    uint32_t            rdy_at;                                 /**< R/B# and RDY come back */
+    uint32_t            ardy_at;                                /**< the array is done, ARDY */
+} nand_sim_lun_t;
+
+static nand_sim_lun_t   _luns[CONFIG_NAND_SIM_LUNS];
+static nand_sim_stats_t _stats;
+static uint8_t          _parameter_page[NAND_SIM_PARAM_PAGE_SIZE];
+static bool             _init_done;
+
+static uint16_t         _io;                                    /**< levels the host drives */
+static uint16_t         _io_out;                                /**< levels the part drives while RE# is low */
+static bool             _re = true;
+static bool             _we = true;
+static bool             _wp;
+static bool             _cle;
+static bool             _ale;
+static bool             _ce[CONFIG_NAND_SIM_LUNS];
+
+#ifdef CONFIG_NAND_SIM_ON_DIE_ECC
+static const uint8_t    _id[] = { 0x2C, 0xDA, 0x90, 0x95, 0x06 };  /**< Micron, internal ECC bits set in byte 4 */
+#else
+static const uint8_t    _id[] = { 0x2C, 0xDA, 0x90, 0x95, 0x04 };
+#endif
+
+static inline uint32_t _now(void) {
+    return ztimer_now(ZTIMER_USEC);
+}
+
+static inline bool _passed(const uint32_t time) {
+    return (int32_t)(_now() - time) >= 0;
+}
+
+/** Time an array operation can start, after the one still running */
+static inline uint32_t _array_start(const nand_sim_lun_t* const lun) {
+    return _passed(lun->ardy_at) ? _now() : lun->ardy_at;
+}
+
+static inline void _put16(uint8_t* const bytes, const uint16_t value) {
+    bytes[0] = value & 0xFF;
+    bytes[1] = value >> 8;
+}
+
+static inline void _put32(uint8_t* const bytes, const uint32_t value) {
+    _put16(bytes, value & 0xFFFF);
+    _put16(&(bytes[2]), value >> 16);
+}
+
+static inline uint32_t _get_le(const uint8_t* const bytes, const uint8_t size) {
+    uint32_t value = 0;
+
+    for(uint8_t pos = 0; pos < size; ++pos) {
+        value |= (uint32_t)bytes[pos] << (pos * 8);
+    }
+
+    return value;
+}
+
+/** ONFI CRC-16, polynomial 8005h from 4F4Eh */
+static uint16_t _crc16_onfi(const uint8_t* const bytes, const size_t size) {
+    uint16_t crc = 0x4F4E;
+
+    for(size_t pos = 0; pos < size; ++pos) {
+        crc ^= (uint16_t)bytes[pos] << 8;
+        for(uint8_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x8005 : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static void _build_parameter_page(void) {
+    uint8_t* const pp = _parameter_page;
+    uint16_t       features = 0;
+    uint8_t        plane_bits = 0;
+
+    while((1U << plane_bits) < CONFIG_NAND_SIM_PLANES) {
+        ++plane_bits;
+    }
+
+    if(IS_ACTIVE(CONFIG_NAND_SIM_BUS_WIDTH_16)) {
+        features |= 0x0001;
+    }
+    if(CONFIG_NAND_SIM_LUNS > 1) {
+        features |= 0x0002;                         /**< multiple LUN operations */
+    }
+    if(CONFIG_NAND_SIM_PLANES > 1) {
+        features |= 0x0008 | 0x0040;                /**< multi-plane program and erase, multi-plane read */
+    }
+
+    memset(pp, 0x00, NAND_SIM_PARAM_PAGE_SIZE);
+
+    memcpy(&(pp[0]), "ONFI", 4);
+    _put16(&(pp[4]), 0x003E);                       /**< ONFI 1.0 to 2.3 */
+    _put16(&(pp[6]), features);
+    _put16(&(pp[8]), 0x001F);                       /**< cache program, cache read, features, 78h, copyback */
+    pp[14] = 3;                                     /**< parameter page copies */
+
+    memcpy(&(pp[32]), "RIOT        ", 12);
+    memcpy(&(pp[44]), "NATIVE NAND SIM     ", 20);
+
+    _put32(&(pp[80]), CONFIG_NAND_SIM_DATA_BYTES_PER_PAGE);
+    _put16(&(pp[84]), CONFIG_NAND_SIM_SPARE_BYTES_PER_PAGE);
+    _put32(&(pp[92]), CONFIG_NAND_SIM_PAGES_PER_BLOCK);
+    _put32(&(pp[96]), CONFIG_NAND_SIM_BLOCKS_PER_LUN);
+    pp[100] = CONFIG_NAND_SIM_LUNS;
+    pp[101] = (NAND_SIM_COLUMN_CYCLES << 4) | NAND_SIM_ROW_CYCLES;
+    pp[102] = 1;                                    /**< SLC */
+    _put16(&(pp[103]), CONFIG_NAND_SIM_BLOCKS_PER_LUN / 50);
+    pp[105] = 1;                                    /**< 1 x 10^5 cycles */
+    pp[106] = 5;
+    pp[107] = 1;
+    pp[110] = CONFIG_NAND_SIM_PROGRAMS_PER_PAGE;
+    pp[112] = CONFIG_NAND_SIM_ECC_BITS;
+    pp[113] = plane_bits;
+
+    _put16(&(pp[129]), 0x0001);                     /**< SDR timing mode 0 */
+    _put16(&(pp[133]), CONFIG_NAND_SIM_T_PROG_US);
+    _put16(&(pp[135]), CONFIG_NAND_SIM_T_BERS_US);
+    _put16(&(pp[137]), CONFIG_NAND_SIM_T_R_US);
+    _put16(&(pp[139]), 500);                        /**< tCCS in ns */
+
+    _put16(&(pp[254]), _crc16_onfi(pp, 254));
+}
+
+static void _init(void) {
+    _build_parameter_page();
+
+    for(uint8_t lun_no = 0; lun_no < CONFIG_NAND_SIM_LUNS; ++lun_no) {
+        nand_sim_lun_t* const lun = &(_luns[lun_no]);
+
+        lun->blocks = (nand_sim_block_t**)calloc(CONFIG_NAND_SIM_BLOCKS_PER_LUN, sizeof(nand_sim_block_t*));
+        /** Ready now, a zero time is in the future half of the time the clock is running */
+        lun->rdy_at = _now();
+        lun->ardy_at = lun->rdy_at;
+        _ce[lun_no] = true;
+    }
+
+    _init_done = true;
+}
+
+static inline uint32_t _row_block(const uint32_t row) {
+    return (row / CONFIG_NAND_SIM_PAGES_PER_BLOCK) % CONFIG_NAND_SIM_BLOCKS_PER_LUN;
+}
+
+static inline uint32_t _row_page(const uint32_t row) {
+    return row % CONFIG_NAND_SIM_PAGES_PER_BLOCK;
+}
+
+static inline uint8_t _row_plane(const uint32_t row) {
+    return _row_block(row) % CONFIG_NAND_SIM_PLANES;
+}
+
+static nand_sim_block_t* _block(nand_sim_lun_t* const lun, const uint32_t block_no, const bool create) {
+    if(lun->blocks == NULL) {
+        return NULL;
+    }
+
+    if(lun->blocks[block_no] == NULL && create) {
+        lun->blocks[block_no] = (nand_sim_block_t*)calloc(1, sizeof(nand_sim_block_t));
+    }
+
+    return lun->blocks[block_no];
+}
+
+static void _free_pages(nand_sim_block_t* const block) {
+    for(uint32_t page_no = 0; page_no < CONFIG_NAND_SIM_PAGES_PER_BLOCK; ++page_no) {
+        free(block->pages[page_no]);
+        block->pages[page_no]       = NULL;
+        block->programs[page_no]    = 0;
+    }
+}
+
+/** Array to the register of the row's plane */
+static void _page_load(nand_sim_lun_t* const lun, const uint32_t row) {
+    const uint8_t                 plane = _row_plane(row);
+    const nand_sim_block_t* const block = _block(lun, _row_block(row), false);
+    uint8_t*                const reg   = lun->regs[plane];
+
+    if(block != NULL && block->bad) {
+        memset(reg, 0x00, NAND_SIM_PAGE_SIZE);
+    } else if(block != NULL && block->pages[_row_page(row)] != NULL) {
+        memcpy(reg, block->pages[_row_page(row)], NAND_SIM_PAGE_SIZE);
+    } else {
+        memset(reg, 0xFF, NAND_SIM_PAGE_SIZE);
+    }
+
+    lun->reg_rows[plane]    = row;
+    lun->data_valid         = true;
+}
+
+/** Register of @p plane to the array, bits can only be cleared */
+static bool _page_program(nand_sim_lun_t* const lun, const uint8_t plane) {
+    const uint32_t          row     = lun->reg_rows[plane];
+    nand_sim_block_t* const block   = _block(lun, _row_block(row), true);
+    const uint32_t          page_no = _row_page(row);
+
+    if(! _wp || block == NULL || block->bad || block->worn || block->programs[page_no] >= CONFIG_NAND_SIM_PROGRAMS_PER_PAGE) {
+        return false;
+    }
+
+    if(block->pages[page_no] == NULL) {
+        block->pages[page_no] = (uint8_t*)malloc(NAND_SIM_PAGE_SIZE);
+        if(block->pages[page_no] == NULL) {
+            return false;
+        }
+        memset(block->pages[page_no], 0xFF, NAND_SIM_PAGE_SIZE);
+    }
+
+    for(size_t pos = 0; pos < NAND_SIM_PAGE_SIZE; ++pos) {
+        block->pages[page_no][pos] &= lun->regs[plane][pos];
+    }
+
+    ++(block->programs[page_no]);
+    ++(_stats.page_programs);
+
+    return true;
+}
+
+static bool _block_erase(nand_sim_lun_t* const lun, const uint32_t row) {
+    /** Created for a block never programmed as well, every erase wears it */
+    nand_sim_block_t* const block   = _block(lun, _row_block(row), true);
+
+    if(! _wp || (block != NULL && (block->bad || block->worn))) {
+        return false;
+    }
+
+    if(block != NULL) {
+        _free_pages(block);
+        ++(block->erases);
+    }
+
+    ++(_stats.block_erases);
+
+    return true;
+}
+
+static void _set_result(nand_sim_lun_t* const lun, const bool ok) {
+    lun->status_fail = ((lun->status_fail & NAND_SIM_STATUS_FAIL) ? NAND_SIM_STATUS_FAILC : 0) | (ok ? 0 : NAND_SIM_STATUS_FAIL);
+
+    if(! ok) {
+        ++(_stats.failed_ops);
+    }
+}
+
+static uint8_t _status(const nand_sim_lun_t* const lun) {
+    return (_passed(lun->rdy_at) ? NAND_SIM_STATUS_RDY : 0) | (_passed(lun->ardy_at) ? NAND_SIM_STATUS_ARDY : 0) | (_wp ? NAND_SIM_STATUS_WP_N : 0) | lun->status_fail;
+}
+
+static void _reset(nand_sim_lun_t* const lun) {
+    lun->cmd            = 0xFF;
+    lun->addr_count     = 0;
+    lun->out            = NAND_SIM_OUT_NONE;
+    lun->data_valid     = false;
+    lun->status_fail    = 0;
+    memset(lun->reg_queued, 0, sizeof(lun->reg_queued));
+
+    lun->rdy_at         = _now() + CONFIG_NAND_SIM_T_RST_US;
+    lun->ardy_at        = lun->rdy_at;
+}
+
+/** Column and row of a full address, register contents stay */
+static void _take_addr(nand_sim_lun_t* const lun) {
+    const uint32_t row  = _get_le(&(lun->addr[NAND_SIM_COLUMN_CYCLES]), NAND_SIM_ROW_CYCLES);
+
+    lun->column         = _get_le(lun->addr, NAND_SIM_COLUMN_CYCLES) * NAND_SIM_BUS_BYTES;
+    lun->plane          = _row_plane(row);
+    lun->reg_rows[lun->plane] = row;
+}
+
+static void _on_addr(nand_sim_lun_t* const lun, const uint8_t byte) {
+    if(lun->addr_count < NAND_SIM_ADDR_CYCLES) {
+        lun->addr[lun->addr_count] = byte;
+    }
+    ++(lun->addr_count);
+
+    switch(lun->cmd) {
+    case 0x90:
+        if(lun->addr_count == 1) {
+            lun->id_addr    = byte;
+            lun->out        = NAND_SIM_OUT_ID;
+            lun->out_pos    = 0;
+        }
+        break;
+    case 0xEC:
+        if(lun->addr_count == 1) {
+            lun->out        = NAND_SIM_OUT_PARAMETER_PAGE;
+            lun->out_pos    = 0;
+            lun->rdy_at     = _now() + CONFIG_NAND_SIM_T_R_US;
+        }
+        break;
+    case 0xEE:
+        if(lun->addr_count == 1) {
+            lun->feature_addr   = byte;
+            lun->out            = NAND_SIM_OUT_FEATURES;
+            lun->out_pos        = 0;
+            lun->rdy_at         = _now() + CONFIG_NAND_SIM_T_FEAT_US;
+        }
+        break;
+    case 0xEF:
+        if(lun->addr_count == 1) {
+            lun->feature_addr   = byte;
+            lun->feature_count  = 0;
+        }
+        break;
+    case 0x78:
+        if(lun->addr_count == NAND_SIM_ROW_CYCLES) {
+            lun->out        = NAND_SIM_OUT_STATUS;
+        }
+        break;
+    case 0x80:
+        if(lun->addr_count == NAND_SIM_ADDR_CYCLES) {
+            _take_addr(lun);
+            memset(lun->regs[lun->plane], 0xFF, NAND_SIM_PAGE_SIZE);
+        }
+        break;
+    case 0x85:
+        /** Two cycles change the column only, five move the register to another page for copyback */
+        if(lun->addr_count == NAND_SIM_COLUMN_CYCLES) {
+            lun->column     = _get_le(lun->addr, NAND_SIM_COLUMN_CYCLES) * NAND_SIM_BUS_BYTES;
+        } else if(lun->addr_count == NAND_SIM_ADDR_CYCLES) {
+            _take_addr(lun);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/** Loads the page addressed for 30h, 32h or 35h */
+static bool _read_addressed(nand_sim_lun_t* const lun) {
+    if(lun->cmd != 0x00 || lun->addr_count < NAND_SIM_ADDR_CYCLES) {
+        return false;
+    }
+
+    _take_addr(lun);
+    _page_load(lun, lun->reg_rows[lun->plane]);
+    ++(_stats.page_reads);
+
+    return true;
+}
+
+static void _program(nand_sim_lun_t* const lun, const uint8_t confirm) {
+    if((lun->cmd != 0x80 || lun->addr_count < NAND_SIM_ADDR_CYCLES) && lun->cmd != 0x85) {
+        return;
+    }
+
+    if(confirm == 0x11) {
+        lun->reg_queued[lun->plane] = true;
+        lun->rdy_at = _now() + CONFIG_NAND_SIM_T_CBSY_US;
+        return;
+    }
+
+    const uint32_t start = _array_start(lun);
+    bool           ok    = true;
+
+    lun->reg_queued[lun->plane] = true;
+    for(uint8_t plane = 0; plane < CONFIG_NAND_SIM_PLANES; ++plane) {
+        if(lun->reg_queued[plane]) {
+            ok = _page_program(lun, plane) && ok;
+            lun->reg_queued[plane] = false;
+        }
+    }
+    _set_result(lun, ok);
+
+    if(confirm == 0x15) {
+        /** The cache register is free again after tCBSY, the array keeps programming */
+        lun->rdy_at     = start + CONFIG_NAND_SIM_T_CBSY_US;
+        lun->ardy_at    = lun->rdy_at + CONFIG_NAND_SIM_T_PROG_US;
+    } else {
+        lun->rdy_at     = start + CONFIG_NAND_SIM_T_PROG_US;
+        lun->ardy_at    = lun->rdy_at;
+    }
+
+    lun->data_valid = false;
+}
+
+static void _erase(nand_sim_lun_t* const lun, const uint8_t confirm) {
+    if(lun->cmd != 0x60 || lun->addr_count < NAND_SIM_ROW_CYCLES) {
+        return;
+    }
+
+    const uint32_t row   = _get_le(lun->addr, NAND_SIM_ROW_CYCLES);
+    const uint8_t  plane = _row_plane(row);
+
+    lun->reg_rows[plane]    = row;
+    lun->reg_queued[plane]  = true;
+
+    if(confirm == 0xD1) {
+        lun->rdy_at = _now() + CONFIG_NAND_SIM_T_CBSY_US;
+        return;
+    }
+
+    const uint32_t start = _array_start(lun);
+    bool           ok    = true;
+
+    for(uint8_t pos = 0; pos < CONFIG_NAND_SIM_PLANES; ++pos) {
+        if(lun->reg_queued[pos]) {
+            ok = _block_erase(lun, lun->reg_rows[pos]) && ok;
+            lun->reg_queued[pos] = false;
+        }
+    }
+    _set_result(lun, ok);
+
+    lun->rdy_at     = start + CONFIG_NAND_SIM_T_BERS_US;
+    lun->ardy_at    = lun->rdy_at;
+    lun->data_valid = false;
+}
+
+static void _on_cmd(nand_sim_lun_t* const lun, const uint8_t byte) {
+    switch(byte) {
+    case 0xFF:
+        _reset(lun);
+        return;
+
+    case 0x70:
+        lun->out = NAND_SIM_OUT_STATUS;
+        return;
+
+    case 0x00:
+        /** Also returns to the data after a status read */
+        lun->out = lun->data_valid ? NAND_SIM_OUT_DATA : NAND_SIM_OUT_NONE;
+        lun->cmd = byte;
+        lun->addr_count = 0;
+        return;
+
+    case 0x05:
+    case 0x06:
+    case 0x60:
+    case 0x78:
+    case 0x80:
+    case 0x85:
+    case 0x90:
+    case 0xEC:
+    case 0xEE:
+    case 0xEF:
+        if(byte == 0x80 || byte == 0x90 || byte == 0xEC || byte == 0xEE) {
+            lun->out = NAND_SIM_OUT_NONE;
+        }
+        lun->cmd = byte;
+        lun->addr_count = 0;
+        return;
+
+    case 0x30:
+    case 0x35:
+        if(_read_addressed(lun)) {
+            /** Planes queued by 32h were loaded already, all of them take tR together */
+            memset(lun->reg_queued, 0, sizeof(lun->reg_queued));
+            lun->cache_row  = lun->reg_rows[lun->plane];
+            lun->rdy_at     = _array_start(lun) + CONFIG_NAND_SIM_T_R_US;
+            lun->ardy_at    = lun->rdy_at;
+            lun->out        = NAND_SIM_OUT_DATA;
+            ++(_stats.read_waits);
+        }
+        break;
+
+    case 0x32:
+        if(_read_addressed(lun)) {
+            lun->reg_queued[lun->plane] = true;
+            lun->rdy_at     = _now() + CONFIG_NAND_SIM_T_CBSY_US;
+        }
+        break;
+
+    case 0x31:
+    case 0x3F:
+        {
+            /** The page in the data register goes out, 31h has the array load the next one meanwhile */
+            const uint32_t start    = _array_start(lun);
+            const uint32_t row      = lun->cache_row;
+
+            if(byte == 0x31 && lun->cmd == 0x00 && lun->addr_count >= NAND_SIM_ADDR_CYCLES) {
+                lun->cache_row = _get_le(&(lun->addr[NAND_SIM_COLUMN_CYCLES]), NAND_SIM_ROW_CYCLES);
+            } else {
+                lun->cache_row = row + 1;
+            }
+
+            _page_load(lun, row);
+            lun->plane      = _row_plane(row);
+            lun->column     = 0;
+            lun->rdy_at     = start + CONFIG_NAND_SIM_T_CBSY_US;
+            lun->ardy_at    = lun->rdy_at + ((byte == 0x31) ? CONFIG_NAND_SIM_T_R_US : 0);
+            lun->out        = NAND_SIM_OUT_DATA;
+            if(byte == 0x31) {
+                ++(_stats.page_reads);
+            }
+        }
+        break;
+
+    case 0x10:
+    case 0x11:
+    case 0x15:
+        _program(lun, byte);
+        break;
+
+    case 0xD0:
+    case 0xD1:
+        _erase(lun, byte);
+        break;
+
+    case 0xE0:
+        if(lun->cmd == 0x06 && lun->addr_count >= NAND_SIM_ADDR_CYCLES) {
+            _take_addr(lun);
+        } else if(lun->cmd == 0x05 && lun->addr_count >= NAND_SIM_COLUMN_CYCLES) {
+            lun->column = _get_le(lun->addr, NAND_SIM_COLUMN_CYCLES) * NAND_SIM_BUS_BYTES;
+        }
+        lun->out = lun->data_valid ? NAND_SIM_OUT_DATA : NAND_SIM_OUT_NONE;
+        break;
+
+    default:
+        DEBUG("nand_sim: unknown command %02x\n", byte);
+        break;
+    }
+
+    lun->cmd = byte;
+    lun->addr_count = 0;
+}
+
+static void _on_data_in(nand_sim_lun_t* const lun, const uint16_t word) {
+    switch(lun->cmd) {
+    case 0x80:
+    case 0x85:
+        for(uint8_t pos = 0; pos < NAND_SIM_BUS_BYTES; ++pos) {
+            if(lun->column < NAND_SIM_PAGE_SIZE) {
+                lun->regs[lun->plane][lun->column] = (word >> (pos * 8)) & 0xFF;
+            }
+            ++(lun->column);
+        }
+        _stats.bytes_in += NAND_SIM_BUS_BYTES;
+        break;
+
+    case 0xEF:
+        if(lun->feature_count < NAND_SIM_FEATURE_SIZE) {
+            lun->features[lun->feature_addr][lun->feature_count] = word & 0xFF;
+            ++(lun->feature_count);
+        }
+
+        if(lun->feature_count == NAND_SIM_FEATURE_SIZE) {
+            if(lun->feature_addr == NAND_SIM_FEATURE_ARRAY_OPERATION_MODE && ! IS_ACTIVE(CONFIG_NAND_SIM_ON_DIE_ECC)) {
+                /** Without an internal ECC the enable bit does not stick */
+                lun->features[lun->feature_addr][0] &= ~NAND_SIM_ARRAY_OPERATION_MODE_ECC_ENABLE;
+            }
+            lun->rdy_at = _now() + CONFIG_NAND_SIM_T_FEAT_US;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static uint16_t _on_data_out(nand_sim_lun_t* const lun) {
+    const uint32_t pos = lun->out_pos++;
+
+    switch(lun->out) {
+    case NAND_SIM_OUT_STATUS:
+        return _status(lun);
+
+    case NAND_SIM_OUT_ID:
+        /** The ID repeats, which is how the driver finds its length */
+        if(lun->id_addr == 0x20) {
+            return "ONFI"[pos % 4];
+        }
+        return (lun->id_addr == 0x00) ? _id[pos % sizeof(_id)] : 0x00;
+
+    case NAND_SIM_OUT_PARAMETER_PAGE:
+        return _parameter_page[pos % NAND_SIM_PARAM_PAGE_SIZE];
+
+    case NAND_SIM_OUT_FEATURES:
+        return lun->features[lun->feature_addr][pos % NAND_SIM_FEATURE_SIZE];
+
+    case NAND_SIM_OUT_DATA:
+        {
+            uint16_t word = 0;
+
+            for(uint8_t byte = 0; byte < NAND_SIM_BUS_BYTES; ++byte) {
+                const uint8_t value = (lun->column < NAND_SIM_PAGE_SIZE) ? lun->regs[lun->plane][lun->column] : 0xFF;
+                word |= (uint16_t)value << (byte * 8);
+                ++(lun->column);
+            }
+            _stats.bytes_out += NAND_SIM_BUS_BYTES;
+
+            return word;
+        }
+
+    default:
+        return 0x00;
+    }
+}
+
+/** Cycles a busy LUN takes: reset, status, and the row address of 78h */
+static bool _allowed_while_busy(const nand_sim_lun_t* const lun) {
+    const uint8_t byte = _io & 0xFF;
+
+    if(_cle) {
+        return byte == 0xFF || byte == 0x70 || byte == 0x78;
+    }
+
+    return _ale && lun->cmd == 0x78;
+}
+
+/** Rising WE# edge, a cycle goes to every LUN with CE# low */
+static void _on_write_cycle(void) {
+    for(uint8_t lun_no = 0; lun_no < CONFIG_NAND_SIM_LUNS; ++lun_no) {
+        nand_sim_lun_t* const lun = &(_luns[lun_no]);
+
+        if(_ce[lun_no]) {
+            continue;
+        }
+
+        if(! _passed(lun->rdy_at) && ! _allowed_while_busy(lun)) {
+            ++(_stats.busy_cycles);
+        }
+
+        if(_cle && ! _ale) {
+            _on_cmd(lun, _io & 0xFF);
+        } else if(_ale && ! _cle) {
+            _on_addr(lun, _io & 0xFF);
+        } else if(! _cle && ! _ale) {
+            _on_data_in(lun, _io);
+        }
+    }
+}
+
+/** Falling RE# edge, the selected LUN puts its next output on the bus */
+static void _on_read_cycle(void) {
+    for(uint8_t lun_no = 0; lun_no < CONFIG_NAND_SIM_LUNS; ++lun_no) {
+        nand_sim_lun_t* const lun = &(_luns[lun_no]);
+
+        if(_ce[lun_no]) {
+            continue;
+        }
+
+        if(! _passed(lun->rdy_at) && lun->out != NAND_SIM_OUT_STATUS) {
+            ++(_stats.busy_cycles);
+        }
+
+        _io_out = _on_data_out(lun);
+        return;
+    }
+}
+
+/** LUN whose CE# or R/B# @p pin is, -1 if none */
+static int _lun_of(const gpio_t pin, const bool rb) {
+    for(uint8_t lun_no = 0; lun_no < CONFIG_NAND_SIM_LUNS; ++lun_no) {
+        if(pin == (rb ? NAND_SIM_PIN_RB(lun_no) : NAND_SIM_PIN_CE(lun_no))) {
+            return lun_no;
+        }
+    }
+
+    return -1;
+}
+
+bool nand_sim_gpio_read(const gpio_t pin, int* const value) {
+    if(! _init_done) {
+        _init();
+    }
+
+    if(pin >= NAND_SIM_PIN_IO(0) && pin < NAND_SIM_PIN_IO(NAND_SIM_BUS_BYTES * 8)) {
+        const uint16_t levels = _re ? _io : _io_out;
+        *value = (levels >> (pin - NAND_SIM_PIN_IO(0))) & 1;
+        return true;
+    }
+
+    const int rb_lun_no = _lun_of(pin, true);
+    if(rb_lun_no >= 0) {
+        *value = _passed(_luns[rb_lun_no].rdy_at);
+        return true;
+    }
+
+    const int ce_lun_no = _lun_of(pin, false);
+    if(ce_lun_no >= 0) {
+        *value = _ce[ce_lun_no];
+        return true;
+    }
+
+    switch(pin) {
+    case NAND_SIM_PIN_RE:
+        *value = _re;
+        return true;
+    case NAND_SIM_PIN_WE:
+        *value = _we;
+        return true;
+    case NAND_SIM_PIN_WP:
+        *value = _wp;
+        return true;
+    case NAND_SIM_PIN_CLE:
+        *value = _cle;
+        return true;
+    case NAND_SIM_PIN_ALE:
+        *value = _ale;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool nand_sim_gpio_write(const gpio_t pin, const int value) {
+    const bool level = value != 0;
+
+    if(! _init_done) {
+        _init();
+    }
+
+    if(pin >= NAND_SIM_PIN_IO(0) && pin < NAND_SIM_PIN_IO(16)) {
+        const uint16_t mask = 1U << (pin - NAND_SIM_PIN_IO(0));
+        _io = level ? (_io | mask) : (_io & ~mask);
+        return true;
+    }
+
+    if(_lun_of(pin, true) >= 0) {
+        return true;                                /**< driven by the part */
+    }
+
+    const int ce_lun_no = _lun_of(pin, false);
+    if(ce_lun_no >= 0) {
+        _ce[ce_lun_no] = level;
+        return true;
+    }
+
+    switch(pin) {
+    case NAND_SIM_PIN_RE:
+        if(_re && ! level) {
+            _re = level;
+            _on_read_cycle();
+        }
+        _re = level;
+        return true;
+    case NAND_SIM_PIN_WE:
+        if(! _we && level) {
+            _on_write_cycle();
+        }
+        _we = level;
+        return true;
+    case NAND_SIM_PIN_WP:
+        _wp = level;
+        return true;
+    case NAND_SIM_PIN_CLE:
+        _cle = level;
+        return true;
+    case NAND_SIM_PIN_ALE:
+        _ale = level;
+        return true;
+    default:
+        return false;
+    }
+}
+
+const nand_sim_stats_t* nand_sim_stats(void) {
+    return &_stats;
+}
+
+void nand_sim_stats_reset(void) {
+    memset(&_stats, 0, sizeof(_stats));
+}
+
+void nand_sim_erase_all(void) {
+    if(! _init_done) {
+        _init();
+    }
+
+    for(uint8_t lun_no = 0; lun_no < CONFIG_NAND_SIM_LUNS; ++lun_no) {
+        nand_sim_lun_t* const lun = &(_luns[lun_no]);
+
+        for(uint32_t block_no = 0; block_no < CONFIG_NAND_SIM_BLOCKS_PER_LUN; ++block_no) {
+            nand_sim_block_t* const block = lun->blocks[block_no];
+
+            if(block == NULL) {
+                continue;
+            }
+
+            _free_pages(block);
+            if(! block->bad && ! block->worn) {
+                free(block);
+                lun->blocks[block_no] = NULL;
+            }
+        }
+    }
+}
+
+void nand_sim_set_bad_block(const uint8_t lun_no, const uint32_t block_no) {
+    if(! _init_done) {
+        _init();
+    }
+
+    if(lun_no >= CONFIG_NAND_SIM_LUNS || block_no >= CONFIG_NAND_SIM_BLOCKS_PER_LUN) {
+        return;
+    }
+
+    nand_sim_block_t* const block = _block(&(_luns[lun_no]), block_no, true);
+    if(block != NULL) {
+        _free_pages(block);
+        block->bad = true;
+    }
+}
+
+uint32_t nand_sim_block_erases(const uint8_t lun_no, const uint32_t block_no) {
+    if(lun_no >= CONFIG_NAND_SIM_LUNS || block_no >= CONFIG_NAND_SIM_BLOCKS_PER_LUN) {
+        return 0;
+    }
+
+    const nand_sim_block_t* const block = _block(&(_luns[lun_no]), block_no, false);
+
+    return (block != NULL) ? block->erases : 0;
+}
+
+void nand_sim_set_worn_block(const uint8_t lun_no, const uint32_t block_no) {
+    if(! _init_done) {
+        _init();
+    }
+
+    if(lun_no >= CONFIG_NAND_SIM_LUNS || block_no >= CONFIG_NAND_SIM_BLOCKS_PER_LUN) {
+        return;
+    }
+
+    nand_sim_block_t* const block = _block(&(_luns[lun_no]), block_no, true);
+    if(block != NULL) {
+        block->worn = true;
+    }
+}
@@ -19,10 +19,20 @@
 
 #include "periph/gpio.h"
 
+#ifdef MODULE_NAND_SIM
+#include "nand_sim.h"
+#endif
+
 int gpio_init(gpio_t pin, gpio_mode_t mode) {
   (void) pin;
   (void) mode;
 
+#ifdef MODULE_NAND_SIM
+  int value;
+  if (nand_sim_gpio_read(pin, &value))
+    return 0;
+#endif
+
   if (mode >= GPIO_OUT)
     return 0;
   else
@@ -54,24 +64,34 @@ void gpio_irq_disable(gpio_t pin)
 int gpio_read(gpio_t pin) {
   (void) pin;
 
+#ifdef MODULE_NAND_SIM
+  int value;
+  if (nand_sim_gpio_read(pin, &value))
+    return value;
+#endif
+
   return 0;
 }
 
 void gpio_set(gpio_t pin) {
-  (void) pin;
+  gpio_write(pin, 1);
 }
 
 void gpio_clear(gpio_t pin) {
-  (void) pin;
+  gpio_write(pin, 0);
 }
 
 void gpio_toggle(gpio_t pin) {
-  (void) pin;
+  gpio_write(pin, !gpio_read(pin));
 }
 
 void gpio_write(gpio_t pin, int value) {
   (void) pin;
   (void) value;
+
+#ifdef MODULE_NAND_SIM
+  nand_sim_gpio_write(pin, value);
+#endif
 }
 
 /** @} */
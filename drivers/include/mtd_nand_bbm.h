@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_nand_bbm mtd bad block remapping for NANDs
+ * @ingroup     drivers_storage
+ * @brief       Contiguous good block view of a @ref drivers_mtd_nand_onfi device
+ *
+ * Upper layers such as littlefs or @ref drivers_mtd_mapper expect every
+ * sector of a device to work. This wrapper hides bad blocks behind a reserve
+ * pool at the end of the NAND, sized by the number of bad blocks the part may
+ * develop over its life (bb_per_lun of the parameter page).
+ *
+ * Every logical block is looked up in a flat array, so the hot path costs an
+ * index. Blocks going bad on program or erase are replaced by a pool block on
+ * the spot; pages already programmed are moved along, by copyback if the
+ * page does not have to pass the host ECC. Replacements are persisted in the
+ * @ref drivers_nand_bbt.
+ *
+ * ## Usage
+ *
+ * ```
+ * mtd_nand_bbm_t bbm = {
+ *     .base = {
+ *         .driver = &mtd_nand_bbm_driver,
+ *     },
+ *     .parent = &mtd_nand,
+ * };
+ * mtd_dev_t *dev = &bbm.base;
+ * ```
+ *
+ * Geometry is taken from the parent on init.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for mtd_nand_bbm driver
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef MTD_NAND_BBM_H
+#define MTD_NAND_BBM_H
+
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mtd_nand_onfi.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief   Device descriptor for mtd_nand_bbm device
+ *
+ * This is an extension of the @c mtd_dev_t struct
+ */
+typedef struct {
+    mtd_dev_t base;                 /**< inherit from mtd_dev_t object */
+    mtd_nand_onfi_t* parent;        /**< NAND holding the blocks */
+    uint32_t* map;                  /**< physical block of every logical block */
+    uint32_t pool_start;            /**< first block of the reserve pool */
+    uint8_t* page_buffer;           /**< one data page, for moves through the host */
+} mtd_nand_bbm_t;
+
+/**
+ * @brief   nand bad block remapping operations table for mtd
+ */
+extern const mtd_desc_t mtd_nand_bbm_driver;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_NAND_BBM_H */
+/** @} */
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_nand_ftl mtd page mapped flash translation layer for NANDs
+ * @ingroup     drivers_storage
+ * @brief       512 byte sectors on top of a @ref drivers_mtd_nand_onfi device
+ *
+ * File systems like @ref pkg_fatfs rewrite small sectors in place. On a raw
+ * NAND every such rewrite would cost a block erase. This layer writes pages
+ * out of place instead:
+ *
+ * - pages are appended to an open block, in program order
+ * - a logical to physical map in RAM points to the newest copy of every
+ *   logical NAND page
+ * - the logical page number and a sequence number are kept in the free spare
+ *   bytes of each page, so the map can be rebuilt by reading the spare bytes
+ *   only
+ * - blocks holding mostly stale pages are reclaimed by a garbage collector,
+ *   picking the block with the fewest valid pages (greedy) or the best ratio
+ *   of reclaimed space to copy cost, weighted by age (cost-benefit)
+ *
+ * Sectors sharing a NAND page are read, merged and written as one page. A
+ * write covering whole NAND pages is programmed as it is.
+ *
+ * Erasing a sector range unmaps the NAND pages it covers completely, those
+ * read as erased then. Pages only partially covered keep their content, as
+ * the sectors are rewritten right after erasing by @ref pkg_fatfs anyway.
+ * The unmapped range is logged in a trim page, so it survives a reboot
+ * before the next checkpoint. A block holding a trim page is only collected
+ * after a checkpoint covers the trim. Without intact checkpoints, the trim
+ * is moved along with the valid pages, narrowed to the pages still unmapped.
+ *
+ * ## Checkpoints
+ *
+ * Rebuilding the map from every page takes time growing with the device. So
+ * the map, the state of all blocks and a pool of erased blocks are written
+ * as a checkpoint to the first blocks of the range, each one starting on a
+ * fresh block and carrying a number and a CRC. Until the next checkpoint,
+ * pages are only written to the blocks of that pool, in pool order.
+ *
+ * Init loads the newest intact checkpoint and replays the records of the
+ * pool blocks written since, so it reads the checkpoint plus the spare
+ * bytes of at most @ref CONFIG_MTD_NAND_FTL_CHECKPOINT_POOL_PERCENT of the
+ * blocks. The garbage collector keeps that many blocks erased on top of its
+ * reserve, so each pool comes out full. A new
+ * checkpoint is written once the pool is used up, on power down and by
+ * mtd_nand_ftl_checkpoint(). Without an intact checkpoint all blocks are
+ * scanned, and a checkpoint is written right after.
+ *
+ * ## Wear leveling
+ *
+ * Every block has an erase count in RAM. It is written next to the record of
+ * the first page programmed after an erase, if the free spare bytes have room
+ * for it, and with every checkpoint. Free blocks are handed out least worn
+ * first. Every @ref CONFIG_MTD_NAND_FTL_WL_INTERVAL erases, the used block
+ * with the lowest count is collected if its count is more than
+ * @ref CONFIG_MTD_NAND_FTL_WL_THRESHOLD below the highest one, so cold data
+ * does not pin the least worn blocks. Its pages go to the most worn free
+ * block, which then sees few erases. mtd_nand_ftl_wear_level() runs the same
+ * check, e.g. while the device is idle.
+ *
+ * Erases since the last checkpoint are lost on a power loss, at most one per
+ * block. Blocks without a count after scanning all blocks, erased ones or
+ * all of them if the spare bytes have no room, start at the mean of the
+ * others. The blocks of the checkpoint area are neither counted nor leveled.
+ *
+ * ## Erasing ahead
+ *
+ * Collected blocks are not erased right away but when they are opened, unless
+ * the parent knows them to be erased already. mtd_nand_ftl_erase_ahead()
+ * erases free blocks in the order they are going to be opened, until
+ * @ref CONFIG_MTD_NAND_FTL_ERASE_AHEAD of them are. Run from the thread
+ * started by mtd_nand_ftl_eraser_start(), at a priority below the writers,
+ * this takes the block erase out of the write path while the device is idle
+ * in between.
+ *
+ * ## Usage
+ *
+ * ```
+ * mtd_nand_ftl_t ftl = {
+ *     .base = {
+ *         .driver = &mtd_nand_ftl_driver,
+ *     },
+ *     .parent = &mtd_nand,
+ * };
+ * mtd_dev_t *dev = &ftl.base;
+ * ```
+ *
+ * The map takes 4 bytes of RAM per NAND page. To limit it, or to leave room
+ * for other users, @c first_block and @c block_count select the blocks of
+ * the parent handled by this layer. @c block_count 0 takes all of them.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for mtd_nand_ftl driver
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef MTD_NAND_FTL_H
+#define MTD_NAND_FTL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mtd.h"
+#include "mtd_nand_onfi.h"
+#include "mutex.h"
+#include "sched.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifndef CONFIG_MTD_NAND_FTL_OP_PERCENT
+#define CONFIG_MTD_NAND_FTL_OP_PERCENT      (7)     /**< blocks kept out of the logical size, in percent */
+#endif
+
+#ifndef CONFIG_MTD_NAND_FTL_GC_RESERVE
+#define CONFIG_MTD_NAND_FTL_GC_RESERVE      (2)     /**< free blocks left for the garbage collector */
+#endif
+
+#ifndef CONFIG_MTD_NAND_FTL_CHECKPOINT_POOL_PERCENT
+#define CONFIG_MTD_NAND_FTL_CHECKPOINT_POOL_PERCENT (4) /**< blocks handed out per checkpoint, bounds the replay */
+#endif
+
+#ifndef CONFIG_MTD_NAND_FTL_ERASE_AHEAD
+#define CONFIG_MTD_NAND_FTL_ERASE_AHEAD     (4)     /**< free blocks kept erased ahead of use */
+#endif
+
+#ifndef CONFIG_MTD_NAND_FTL_WL_THRESHOLD
+#define CONFIG_MTD_NAND_FTL_WL_THRESHOLD    (100)   /**< erase count spread that moves cold data, 0 to disable */
+#endif
+
+#ifndef CONFIG_MTD_NAND_FTL_WL_INTERVAL
+#define CONFIG_MTD_NAND_FTL_WL_INTERVAL     (32)    /**< erases between two static wear leveling checks */
+#endif
+
+#if DOXYGEN
+/**
+ * @brief   Pick garbage collection victims by cost-benefit instead of the
+ *          fewest valid pages
+ */
+#define CONFIG_MTD_NAND_FTL_GC_COST_BENEFIT
+#endif
+
+#define MTD_NAND_FTL_SECTOR_SIZE            (512)           /**< sector size towards the upper layer */
+#define MTD_NAND_FTL_UNMAPPED               (UINT32_MAX)    /**< map entry of a page never written */
+#define MTD_NAND_FTL_CHECKPOINT_PAGE        (0x80000000UL)  /**< record of a checkpoint page, or'ed with its index */
+#define MTD_NAND_FTL_TRIM_PAGE              (0x40000000UL)  /**< record of a page holding a @ref mtd_nand_ftl_trim_t */
+
+#define MTD_NAND_FTL_CHECKPOINT_MAGIC       "NFTL"
+#define MTD_NAND_FTL_CHECKPOINT_MAGIC_SIZE  (4)
+
+typedef enum {
+    MTD_NAND_FTL_BLOCK_FREE     = 0,    /**< nothing valid in it, erased before it is opened */
+    MTD_NAND_FTL_BLOCK_OPEN     = 1,    /**< being appended to */
+    MTD_NAND_FTL_BLOCK_USED     = 2,    /**< programmed, may hold valid pages */
+    MTD_NAND_FTL_BLOCK_RETIRED  = 3,    /**< failed a program, valid pages still to be moved */
+    MTD_NAND_FTL_BLOCK_BAD      = 4,    /**< not used at all */
+    MTD_NAND_FTL_BLOCK_CHECKPOINT = 5   /**< part of the checkpoint area */
+} mtd_nand_ftl_block_state_t;
+
+/**
+ * @brief   Mapping record in the free spare bytes of every programmed page
+ *
+ * The CRC (CCITT) covers the fields in front of it, the spare bytes are not
+ * protected by the host ECC.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t logical;               /**< logical NAND page held */
+    uint32_t seq;                   /**< newer copies have a higher one */
+    uint16_t crc;
+} mtd_nand_ftl_meta_t;
+
+/**
+ * @brief   Logical pages unmapped by an erase, at the start of a trim page
+ *
+ * Trim pages are appended like data pages, with MTD_NAND_FTL_TRIM_PAGE as
+ * logical page in their record. They never hold valid data.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t first_logical;         /**< first logical NAND page unmapped */
+    uint32_t end_logical;           /**< logical NAND page behind the last one */
+} mtd_nand_ftl_trim_t;
+
+/**
+ * @brief   Erase count behind the mapping record of the first page of a block
+ *
+ * Only written if the free spare bytes have room for both. The CRC (CCITT)
+ * covers the count.
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t erase_count;           /**< erases of the block, including the one before this page */
+    uint16_t crc;
+} mtd_nand_ftl_wear_t;
+
+/**
+ * @brief   Header in front of a checkpoint
+ *
+ * Followed by the map, the sequence numbers, erase counts and states of all
+ * blocks, and the pool. The CRC (CCITT) covers the header up to the CRC itself and all
+ * of those. Pages of a checkpoint carry MTD_NAND_FTL_CHECKPOINT_PAGE with
+ * their index as logical page and the checkpoint number as sequence number.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t magic[MTD_NAND_FTL_CHECKPOINT_MAGIC_SIZE];
+    uint32_t no;                    /**< higher for newer checkpoints */
+    uint32_t seq;                   /**< last sequence number of a page before it */
+    uint32_t logical_pages;
+    uint32_t block_count;
+    uint32_t pages;                 /**< NAND pages taken */
+    uint16_t pool_count;
+    uint16_t crc;
+} mtd_nand_ftl_checkpoint_t;
+
+/**
+ * @brief   Device descriptor for mtd_nand_ftl device
+ *
+ * This is an extension of the @c mtd_dev_t struct
+ */
+typedef struct {
+    mtd_dev_t base;                 /**< inherit from mtd_dev_t object */
+    mtd_nand_onfi_t* parent;        /**< NAND holding the pages */
+    uint32_t first_block;           /**< first block of the parent used */
+    uint32_t block_count;           /**< blocks used, 0 for all after first_block */
+    uint32_t logical_pages;         /**< NAND pages visible to the upper layer */
+    uint32_t* l2p;                  /**< physical page of every logical page */
+    uint16_t* valid;                /**< valid pages per block */
+    uint8_t* block_state;           /**< see @ref mtd_nand_ftl_block_state_t */
+    uint32_t* block_seq;            /**< newest sequence number per block, its age for the GC */
+    uint32_t* erase_count;          /**< erases per block */
+    uint8_t* trimmed;               /**< 1 bit per block holding a trim page not in a checkpoint yet */
+    uint32_t wl_erases;             /**< erases since the last static wear leveling check */
+    uint32_t free_blocks;           /**< blocks in MTD_NAND_FTL_BLOCK_FREE */
+    uint32_t open_block;            /**< block being appended to, UINT32_MAX if none */
+    uint32_t open_page;             /**< next page of the open block */
+    uint32_t alloc_cursor;          /**< where the search for a free block starts */
+    uint32_t seq;                   /**< last sequence number written */
+    uint8_t* page_buffer;           /**< one data page, for merging sectors */
+    uint8_t* gc_buffer;             /**< one data page, for moving valid pages */
+    uint8_t* checkpoint_buffer;     /**< one data page, for checkpoints */
+    uint32_t checkpoint_blocks;     /**< blocks at the start of the range holding checkpoints */
+    uint32_t checkpoint_no;         /**< highest checkpoint number seen */
+    uint32_t checkpoint_block;      /**< first block of the newest checkpoint */
+    uint32_t checkpoint_pages;      /**< NAND pages of the newest checkpoint */
+    bool checkpointed;              /**< pages are allocated from the pool of an intact checkpoint */
+    uint32_t* pool;                 /**< erased blocks handed out until the next checkpoint */
+    uint16_t pool_max;              /**< erased blocks handed out per checkpoint */
+    uint16_t pool_count;            /**< blocks in the pool */
+    uint16_t pool_pos;              /**< next pool block to open */
+    mutex_t lock;                   /**< serializes the eraser thread with the mtd operations */
+    kernel_pid_t eraser;            /**< thread erasing ahead, KERNEL_PID_UNDEF if none */
+} mtd_nand_ftl_t;
+
+/**
+ * @brief   nand flash translation layer operations table for mtd
+ */
+extern const mtd_desc_t mtd_nand_ftl_driver;
+
+/**
+ * @brief   Writes a checkpoint and hands out a new pool
+ *
+ * Calling it before a planned reboot makes the next init read the
+ * checkpoint only.
+ *
+ * @return  0 on success, the next init scans all blocks otherwise
+ * @return  -ENODEV if the FTL was not initialized
+ */
+int mtd_nand_ftl_checkpoint(mtd_nand_ftl_t* const ftl);
+
+/**
+ * @brief   Collects the coldest used block if the erase counts spread too far
+ *
+ * See @ref CONFIG_MTD_NAND_FTL_WL_THRESHOLD.
+ *
+ * @return  1 if a block was collected, 0 if the spread is fine, < 0 on error
+ * @return  -ENODEV if the FTL was not initialized
+ */
+int mtd_nand_ftl_wear_level(mtd_nand_ftl_t* const ftl);
+
+/**
+ * @brief   Erases the next free block to be opened, unless enough of them are
+ *
+ * See @ref CONFIG_MTD_NAND_FTL_ERASE_AHEAD.
+ *
+ * @return  1 if a block was erased or retired, 0 if nothing is left to do
+ * @return  -ENODEV if the FTL was not initialized
+ */
+int mtd_nand_ftl_erase_ahead(mtd_nand_ftl_t* const ftl);
+
+/**
+ * @brief   Starts a thread calling mtd_nand_ftl_erase_ahead() whenever
+ *          blocks got freed or opened
+ *
+ * @p priority should be below the one of all writers, the erases then only
+ * run while those wait for something else. Each erase holds the device lock,
+ * so a writer waits for one erase at most.
+ *
+ * @return  pid of the thread, < 0 on error
+ */
+kernel_pid_t mtd_nand_ftl_eraser_start(mtd_nand_ftl_t* const ftl, char* const stack, const int stack_size, const uint8_t priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_NAND_FTL_H */
+/** @} */
@@ -12,6 +12,43 @@
  * @ingroup     drivers_storage
  * @brief       Driver for ONFI NANDs using mtd interface
  *
+ * ## Page cache
+ *
+ * With the `mtd_nand_onfi_cache` module, the data of the last
+ * @ref CONFIG_MTD_NAND_ONFI_CACHE_PAGES pages read through the mtd interface
+ * is kept in RAM. File systems re-reading their superblock and directory
+ * pages then skip tR and the bus transfer, reads of a part of a cached page
+ * are served from it as well. Pages are looked up by a hash of their row and
+ * replaced least recently used first. Programming or erasing a block drops
+ * its pages from the cache.
+ *
+ * A miss reads the whole data area of the page, also for a partial read.
+ * The spare area functions below do not use the cache.
+ *
+ * ## Read-ahead
+ *
+ * The `mtd_nand_onfi_readahead` module adds to the page cache. A miss on
+ * the page following the last one read from the NAND is taken as a
+ * sequential stream, and the pages up to the window size are read into the
+ * cache in one cache read (31h/3Fh): the part loads the next page while the
+ * current one is transferred, so tR is paid once per window instead of once
+ * per page. Reads stay within a block.
+ *
+ * The window starts at one page and doubles each time a stream misses right
+ * after the pages read ahead, up to @ref CONFIG_MTD_NAND_ONFI_READAHEAD_MAX
+ * but never more than the cache holds. It is halved if a page read ahead
+ * is missed, i.e. replaced before the reader got to it, and falls back to
+ * one page on a read elsewhere. Parts without the cache read commands read
+ * page by page.
+ *
+ * ## Locking
+ *
+ * The mtd functions and the spare area functions below hold nand_t::lock of
+ * the NAND while they run, so threads sharing the device and the `nand tune`
+ * shell command do not interleave their commands. Layers on top, such as
+ * @ref drivers_mtd_nand_bbm, go through those functions or take the lock
+ * themselves when they touch the NAND or the bad block table directly.
+ *
  * @{
  *
  * @file
@@ -23,16 +60,79 @@
 #ifndef MTD_NAND_ONFI_H
 #define MTD_NAND_ONFI_H
 
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
 #include "nand.h"
 #include "nand_cmd.h"
 #include "nand/onfi.h"
+#include "nand/ecc.h"
+#include "nand/bbt.h"
 #include "mtd.h"
+#include "kernel_defines.h"
+
+#if IS_USED(MODULE_MTD_NAND_ONFI_CACHE) || defined(DOXYGEN)
+#include "memarray.h"
+#endif
 
 #ifdef __cplusplus
 extern "C"
 {
 #endif
 
+#define MTD_NAND_ONFI_OOB_OFFSET        (NAND_ECC_SPARE_RESERVED_SIZE)  /**< first spare byte after the bad block marker */
+#define MTD_NAND_ONFI_OOB_ERASED_FLIPS  (1)     /**< zero bits tolerated in spare bytes read as erased */
+
+#ifndef CONFIG_MTD_NAND_ONFI_CACHE_PAGES
+#define CONFIG_MTD_NAND_ONFI_CACHE_PAGES    (4)     /**< pages held by the page cache */
+#endif
+
+#ifndef CONFIG_MTD_NAND_ONFI_CACHE_BUCKETS
+#define CONFIG_MTD_NAND_ONFI_CACHE_BUCKETS  (8)     /**< hash buckets of the page cache */
+#endif
+
+#ifndef CONFIG_MTD_NAND_ONFI_READAHEAD_MAX
+#define CONFIG_MTD_NAND_ONFI_READAHEAD_MAX  (4)     /**< most pages read ahead at once */
+#endif
+
+#if IS_USED(MODULE_MTD_NAND_ONFI_CACHE) || defined(DOXYGEN)
+/**
+ * @brief   Data area of a page held by the page cache
+ */
+typedef struct mtd_nand_onfi_cache_entry {
+    struct mtd_nand_onfi_cache_entry* next;     /**< next entry of the same hash bucket */
+    struct mtd_nand_onfi_cache_entry* newer;    /**< more recently used entry */
+    struct mtd_nand_onfi_cache_entry* older;    /**< less recently used entry */
+    uint32_t page_no;                           /**< NAND page held */
+    uint8_t data[];                             /**< data area of the page */
+} mtd_nand_onfi_cache_entry_t;
+
+/**
+ * @brief   Page cache of a mtd_nand_onfi device
+ */
+typedef struct {
+    memarray_t pool;                                    /**< unused entries */
+    void* entries;                                      /**< memory of all entries */
+    mtd_nand_onfi_cache_entry_t* buckets[CONFIG_MTD_NAND_ONFI_CACHE_BUCKETS];  /**< entries by page_no */
+    mtd_nand_onfi_cache_entry_t* newest;                /**< most recently used entry */
+    mtd_nand_onfi_cache_entry_t* oldest;                /**< least recently used entry, replaced first */
+    uint32_t hits;                                      /**< reads served from the cache */
+    uint32_t misses;                                    /**< reads going to the NAND */
+} mtd_nand_onfi_cache_t;
+#endif
+
+#if IS_USED(MODULE_MTD_NAND_ONFI_READAHEAD) || defined(DOXYGEN)
+/**
+ * @brief   Sequential stream seen by the read-ahead
+ */
+typedef struct {
+    uint32_t start;                 /**< first page of the last read from the NAND */
+    uint32_t end;                   /**< page after it, a sequential reader misses there next */
+    uint16_t window;                /**< pages read on the next sequential miss */
+} mtd_nand_onfi_readahead_t;
+#endif
+
 /**
  * @brief   Device descriptor for mtd_nand_onfi device
  *
@@ -42,6 +142,16 @@ typedef struct {
     mtd_dev_t base;                 /**< inherit from mtd_dev_t object */
     nand_onfi_t* nand_onfi;         /**< nand_onfi dev descriptor */
     const nand_params_t* params;    /**< params for nand_onfi init */
+    nand_ecc_t ecc;                 /**< ECC engine, configured from the parameter page on init */
+    uint8_t* page_buffer;           /**< data + spare of one page */
+    nand_bbt_t bbt;                 /**< bad block table, its blocks are not exposed */
+    uint8_t* erased;                /**< 1 bit per block, set from an erase until the next program */
+#if IS_USED(MODULE_MTD_NAND_ONFI_CACHE) || defined(DOXYGEN)
+    mtd_nand_onfi_cache_t cache;    /**< recently read pages, with `mtd_nand_onfi_cache` only */
+#endif
+#if IS_USED(MODULE_MTD_NAND_ONFI_READAHEAD) || defined(DOXYGEN)
+    mtd_nand_onfi_readahead_t readahead;    /**< stream state, with `mtd_nand_onfi_readahead` only */
+#endif
 } mtd_nand_onfi_t;
 
 /**
@@ -49,6 +159,93 @@ typedef struct {
  */
 extern const mtd_desc_t mtd_nand_driver;
 
+/**
+ * @brief   Whether @p block_no is known to be erased
+ *
+ * Only erases and programs through this driver since init are tracked,
+ * blocks erased before read as not erased. Erasing a block known to be
+ * erased returns right away.
+ */
+bool mtd_nand_onfi_block_erased(const mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no);
+
+/**
+ * @brief   Drops the cached pages of @p block_no
+ *
+ * Programs and erases through this driver do so on their own. Users
+ * programming the NAND past the driver, e.g. by copyback, have to call it.
+ * Does nothing without the `mtd_nand_onfi_cache` module.
+ */
+#if IS_USED(MODULE_MTD_NAND_ONFI_CACHE) || defined(DOXYGEN)
+void mtd_nand_onfi_cache_invalidate(mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no);
+#else
+static inline void mtd_nand_onfi_cache_invalidate(mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no)
+{
+    (void)mtd_nand;
+    (void)block_no;
+}
+#endif
+
+/**
+ * @brief   Spare bytes free for upper layer metadata
+ *
+ * Those lie between the bad block marker and the ECC parity. They are not
+ * covered by the host ECC, users should protect them by a checksum.
+ */
+size_t mtd_nand_onfi_oob_size(const mtd_nand_onfi_t* const mtd_nand);
+
+/**
+ * @brief   Reads a whole data page together with the free spare bytes
+ *
+ * @p page_no is a NAND page, @p data holds @c page_size bytes and may be
+ * NULL. Returns 0, or -EBADMSG on an uncorrectable page.
+ */
+int mtd_nand_onfi_read_page_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const data, void* const oob, const size_t oob_size);
+
+/**
+ * @brief   Programs a whole data page together with the free spare bytes
+ *
+ * Returns 0, or -EIO if the page could not be programmed, the block is
+ * retired then.
+ */
+int mtd_nand_onfi_write_page_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, const void* const data, const void* const oob, const size_t oob_size);
+
+/**
+ * @brief   Reads the free spare bytes of a page only
+ *
+ * The column is set to the spare area, so @p oob_size bytes are moved over
+ * the bus instead of the whole page. The bytes are not checked by the host
+ * ECC, which is fine for metadata with its own checksum.
+ */
+int mtd_nand_onfi_read_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const oob, const size_t oob_size);
+
+/**
+ * @brief   Whether spare bytes read by mtd_nand_onfi_read_oob() are erased,
+ *          allowing for @ref MTD_NAND_ONFI_OOB_ERASED_FLIPS bit flips
+ */
+bool mtd_nand_onfi_oob_erased(const void* const oob, const size_t oob_size);
+
+/**
+ * @brief   Finds the first erased page of a block programmed in page order
+ *
+ * Only valid for users writing the first @p oob_size free spare bytes of
+ * every page they program, with at least two bits cleared, such as
+ * mtd_nand_onfi_write_page_oob() with a checksummed record. The pages are
+ * binary searched by their spare bytes, @p oob is scratch space.
+ *
+ * Returns the number of programmed pages, 0 for an erased block.
+ */
+int mtd_nand_onfi_find_frontier(mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no, void* const oob, const size_t oob_size);
+
+/**
+ * @brief   Moves a page inside the NAND by copyback, see nand_onfi_copyback()
+ *
+ * The destination block is no longer taken for erased and its cached pages
+ * are dropped. Returns 0, -ENOTSUP for pages on different planes, or -EIO if
+ * the page could not be moved, the destination block is retired if it failed
+ * to program.
+ */
+int mtd_nand_onfi_copyback(mtd_nand_onfi_t* const mtd_nand, const uint32_t src_page_no, const uint32_t dst_page_no);
+
 #ifdef __cplusplus
 }
 #endif
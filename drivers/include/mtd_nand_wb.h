@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_mtd_nand_wb mtd write-back page buffer for NANDs
+ * @ingroup     drivers_storage
+ * @brief       Coalesces small writes to a @ref drivers_mtd_nand_onfi or
+ *              @ref drivers_mtd_nand_bbm device into whole page programs
+ *
+ * A NAND programs whole pages, and allows only a few partial programs per
+ * page (NOP). With the host doing the ECC, a page can even be programmed
+ * once only. Loggers appending records of a few dozen bytes through
+ * mtd_write() or @ref sys_vfs would program the same page over and over.
+ *
+ * This wrapper keeps @ref CONFIG_MTD_NAND_WB_SLOTS page sized slots in RAM.
+ * Writes are copied into the slot of their page, the range written since the
+ * last program is tracked per slot. A slot is programmed
+ *
+ * - as soon as the whole page got written
+ * - when it is needed for another page, least recently written first
+ * - when its first unprogrammed write is older than
+ *   @ref CONFIG_MTD_NAND_WB_TIMEOUT_MS, checked on every access
+ * - by mtd_nand_wb_sync() and on MTD_POWER_DOWN
+ *
+ * Writes of a whole page without a slot go to the parent right away. Reads
+ * see the buffered data. Erasing a sector drops the slots of its pages.
+ *
+ * Data in the slots is lost on a power loss, call mtd_nand_wb_sync() where
+ * the upper layer would expect it on the NAND.
+ *
+ * ## Usage
+ *
+ * ```
+ * mtd_nand_wb_t wb = {
+ *     .base = {
+ *         .driver = &mtd_nand_wb_driver,
+ *     },
+ *     .parent = &mtd_nand.base,
+ * };
+ * mtd_dev_t *dev = &wb.base;
+ * ```
+ *
+ * Geometry is taken from the parent on init.
+ *
+ * @{
+ *
+ * @file
+ * @brief       Interface definition for mtd_nand_wb driver
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef MTD_NAND_WB_H
+#define MTD_NAND_WB_H
+
+#include <stdint.h>
+
+#include "mtd.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifndef CONFIG_MTD_NAND_WB_SLOTS
+#define CONFIG_MTD_NAND_WB_SLOTS            (2)     /**< pages buffered at once */
+#endif
+
+#ifndef CONFIG_MTD_NAND_WB_TIMEOUT_MS
+#define CONFIG_MTD_NAND_WB_TIMEOUT_MS       (1000)  /**< age of a write that gets its slot programmed, 0 for none */
+#endif
+
+#define MTD_NAND_WB_NO_PAGE                 (UINT32_MAX)    /**< page of a free slot */
+
+/**
+ * @brief   One page buffered in RAM
+ */
+typedef struct {
+    uint32_t page_no;               /**< page of the parent, MTD_NAND_WB_NO_PAGE if free */
+    uint32_t dirty_start;           /**< first byte written since the last program */
+    uint32_t dirty_end;             /**< end of the bytes written since the last program */
+    uint32_t since;                 /**< ms of the first write since the last program */
+    uint32_t used;                  /**< order of the last write, for eviction */
+} mtd_nand_wb_slot_t;
+
+/**
+ * @brief   Device descriptor for mtd_nand_wb device
+ *
+ * This is an extension of the @c mtd_dev_t struct
+ */
+typedef struct {
+    mtd_dev_t base;                 /**< inherit from mtd_dev_t object */
+    mtd_dev_t* parent;              /**< NAND mtd device written to */
+    mtd_nand_wb_slot_t slots[CONFIG_MTD_NAND_WB_SLOTS]; /**< metadata of the slots */
+    uint8_t* buffer;                /**< data of all slots, one page each */
+    uint32_t used;                  /**< writes so far, for the eviction order */
+    uint32_t writes;                /**< write calls taken */
+    uint32_t programs;              /**< page programs issued to the parent */
+} mtd_nand_wb_t;
+
+/**
+ * @brief   nand write-back page buffer operations table for mtd
+ */
+extern const mtd_desc_t mtd_nand_wb_driver;
+
+/**
+ * @brief   Programs all slots holding unwritten data
+ *
+ * @return  0 on success, the first error of the parent otherwise
+ */
+int mtd_nand_wb_sync(mtd_nand_wb_t* const wb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_NAND_WB_H */
+/** @} */
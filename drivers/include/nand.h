@@ -27,14 +27,22 @@ _* This file is subject to the terms and conditions of the GNU Lesser
 extern "C" {
 #endif
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "kernel_defines.h"
+#include "mutex.h"
+#include "nand/trace.h"
 #include "periph/gpio.h"
 #include "ztimer.h"
 
+#if IS_USED(MODULE_PERIPH_GPIO_LL)
+#include "periph/gpio_ll.h"
+#endif
+
 #define NAND_MSB0                           (1)
 #define NAND_MSB1                           (2)
 #define NAND_MSB2                           (4)
@@ -57,10 +65,24 @@ extern "C" {
 #define NAND_MAX_COMMAND_SIZE               (2)
 #define NAND_MAX_COMMAND_CYCLE_SIZE         (10)
 #define NAND_MIN_ID_SIZE                    (4)
-#define NAND_MAX_ID_SIZE                    (20)
+#define NAND_MAX_ID_SIZE                    (20)    /**< bytes read to find the repeating ID */
+#define NAND_ID_KEEP_SIZE                   (8)     /**< ID bytes kept in nand_t, enough to tell parts apart */
 #define NAND_MAX_SIG_SIZE                   (20)
 
 #define NAND_MAX_IO_BITS                    (16)
+#define NAND_IO_LANE_BITS                   (8)     /**< I/O pins of one byte of the data bus */
+
+/**
+ * @brief   The board wires only I/O 0 to 7, leave out the 16-bit transfer loop
+ *
+ * Boards with a 16-bit bus still need the 8-bit loop, the ID and the
+ * parameter page are read on I/O 0 to 7 before the width is known.
+ */
+#ifdef DOXYGEN
+#define CONFIG_NAND_DATA_BUS_8BIT
+#endif
+
+#define NAND_TIMING_SCALE_NOMINAL           (256)   /**< of nand_t::timing_scale_cycle and timing_scale_latch, the delays as the commands give them */
 
 #define NAND_ADDR_INDEX_COLUMN              (0)
 #define NAND_ADDR_INDEX_ROW                 (1)
@@ -75,6 +97,9 @@ extern "C" {
 #define NAND_INIT_PARTIAL                   (1)     /**< returned on partial init */
 #define NAND_INIT_ID_TOO_SHORT              (2)    /**< returned on failed init */
 #define NAND_INIT_PARAMETER_PAGE_TOO_SHORT  (3)    /**< returned on failed init */
+#define NAND_INIT_PARAMETER_PAGE_CRC_MISMATCH (4)  /**< returned on failed init, no copy of the parameter page passed its CRC */
+#define NAND_INIT_RESET_TIMEOUT             (5)    /**< returned on failed init, the target on CE0# stayed busy after RESET */
+#define NAND_INIT_ECC_UNKNOWN               (6)    /**< returned on failed init, the ECC requirement could not be read */
 
 typedef enum {
     NAND_RW_OK = 0,             /**< no error */
@@ -83,7 +108,9 @@ typedef enum {
     NAND_RW_ECC_MISMATCH,       /**< CRC-mismatch of received data */
     NAND_RW_NOT_SUPPORTED,      /**< operation not supported on used card */
     NAND_RW_CMD_INVALID,
-    NAND_RW_CMD_CHAIN_TOO_LONG
+    NAND_RW_CMD_CHAIN_TOO_LONG,
+    NAND_RW_NOT_FOUND,          /**< the data looked for is not on the NAND */
+    NAND_RW_UNRELIABLE          /**< the same data read back differently, the bus timing does not hold */
 } nand_rw_response_t;
 
 typedef enum {
@@ -94,51 +121,62 @@ typedef enum {
 
 /**
  * @brief   nand device params
+ *
+ * The CE# and R/B# pins are indexed by the LUN, the I/O pins by the bit.
+ * Entries a board does not wire are GPIO_UNDEF.
  */
 typedef struct {
-    gpio_t ce0;             /**< pin that controls chip 0 enable */
-    gpio_t ce1;             /**< pin that controls chip 1 enable */
-    gpio_t ce2;             /**< pin that controls chip 2 enable */
-    gpio_t ce3;             /**< pin that controls chip 3 enable */
-    gpio_t ce4;             /**< pin that controls chip 4 enable */
-    gpio_t ce5;             /**< pin that controls chip 5 enable */
-    gpio_t ce6;             /**< pin that controls chip 6 enable */
-    gpio_t ce7;             /**< pin that controls chip 7 enable */
-    gpio_t rb0;             /**< pin connected to the chip 0 beady/busy */
-    gpio_t rb1;             /**< pin connected to the chip 1 ready/busy */
-    gpio_t rb2;             /**< pin connected to the chip 2 ready/busy */
-    gpio_t rb3;             /**< pin connected to the chip 3 ready/busy */
-    gpio_t re;              /**< pin that controls read enable */
-    gpio_t we;              /**< pin that controls write enable*/
-    gpio_t wp;              /**< pin that controls write protection */
-    gpio_t cle;             /**< pin that controls command latch */
-    gpio_t ale;             /**< pin that controls address latch */
-    gpio_t io0;             /**< pin connected to the I/O 0 */
-    gpio_t io1;             /**< pin connected to the I/O 1 */
-    gpio_t io2;             /**< pin connected to the I/O 2 */
-    gpio_t io3;             /**< pin connected to the I/O 3 */
-    gpio_t io4;             /**< pin connected to the I/O 4 */
-    gpio_t io5;             /**< pin connected to the I/O 5 */
-    gpio_t io6;             /**< pin connected to the I/O 6 */
-    gpio_t io7;             /**< pin connected to the I/O 7 */
-    gpio_t io8;             /**< pin connected to the I/O 8 (only for 16-bit data access) */
-    gpio_t io9;             /**< pin connected to the I/O 9 (only for 16-bit data access) */
-    gpio_t io10;            /**< pin connected to the I/O 10 (only for 16-bit data access) */
-    gpio_t io11;            /**< pin connected to the I/O 11 (only for 16-bit data access) */
-    gpio_t io12;            /**< pin connected to the I/O 12 (only for 16-bit data access) */
-    gpio_t io13;            /**< pin connected to the I/O 13 (only for 16-bit data access) */
-    gpio_t io14;            /**< pin connected to the I/O 14 (only for 16-bit data access) */
-    gpio_t io15;            /**< pin connected to the I/O 15 (only for 16-bit data access) */
+    gpio_t ce[NAND_MAX_CHIPS];          /**< pins that control the chip enable of each LUN */
+    gpio_t rb[NAND_MAX_CHIPS];          /**< pins connected to the ready/busy of each LUN */
+    gpio_t re;                          /**< pin that controls read enable */
+    gpio_t we;                          /**< pin that controls write enable*/
+    gpio_t wp;                          /**< pin that controls write protection */
+    gpio_t cle;                         /**< pin that controls command latch */
+    gpio_t ale;                         /**< pin that controls address latch */
+    gpio_t io[NAND_MAX_IO_BITS];        /**< pins connected to the I/O 0 to 15, 8 to 15 only for 16-bit access */
 } nand_params_t;
 
+#if IS_USED(MODULE_PERIPH_GPIO_LL) || DOXYGEN
+/**
+ * @brief   One byte of the data bus as port access, set up by nand_init()
+ *
+ * When the 8 I/O pins of a byte lane are consecutive pins of one port, I/O 0
+ * on the lowest, a cycle drives or samples them with one access to that port
+ * and a shift instead of 8 gpio_write() or gpio_read() calls. Lanes wired
+ * otherwise are driven pin by pin.
+ */
 typedef struct {
-    bool                init_done;                 /**< set to true once the init procedure completed successfully */
+    gpio_port_t         port;                      /**< GPIO_PORT_UNDEF if the pins are not in order on one port, gpio_t access then */
+    uword_t             mask;                      /**< all 8 pins of the lane */
+    uint8_t             shift;                     /**< pin number of the lowest I/O of the lane */
+} nand_io_lane_t;
+#endif
 
-    uint8_t             nand_id[NAND_MAX_ID_SIZE];
-    uint8_t             nand_id_size;
 
-    uint8_t             sig[NAND_MAX_SIG_SIZE];
-    uint8_t             sig_size;
+typedef struct nand {
+    const nand_params_t* params;                   /**< pins, stays in flash */
+#if IS_USED(MODULE_PERIPH_GPIO_LL) || DOXYGEN
+    nand_io_lane_t      io_lane[NAND_MAX_IO_BITS / NAND_IO_LANE_BITS]; /**< port masks of the data bus */
+#endif
+    mutex_t             lock;                      /**< held by whoever runs a sequence of commands that must not interleave */
+#if IS_USED(MODULE_NAND_TRACE) || DOXYGEN
+    nand_trace_ctx_t    trace;                     /**< command running, its traced steps are recorded with it */
+#endif
+
+    uint32_t            data_bytes_per_page;
+    uint32_t            pages_per_block;
+    uint32_t            blocks_per_lun;
+
+    nand_std_t          standard_type;
+
+    uint16_t            spare_bytes_per_page;
+    uint16_t            bb_per_lun;
+    uint16_t            ecc_codeword_size;         /**< data bytes covered by one ECC codeword */
+    uint16_t            timing_scale_cycle;        /**< read and write cycle delays in 1/256 of the nominal ones */
+    uint16_t            timing_scale_latch;        /**< CLE and ALE delays in 1/256 of the nominal ones */
+
+    uint8_t             nand_id[NAND_ID_KEEP_SIZE];
+    uint8_t             nand_id_size;
 
     uint8_t             maker_code;
     uint8_t             device_code;
@@ -146,12 +184,7 @@ typedef struct {
     uint8_t             data_bus_width;
     uint8_t             addr_bus_width;
 
-    uint32_t            data_bytes_per_page;
-    uint16_t            spare_bytes_per_page;
-    uint32_t            pages_per_block;
-    uint32_t            blocks_per_lun;
     uint8_t             lun_count;
-    uint16_t            bb_per_lun;
     uint8_t             bits_per_cell;
 
     uint8_t             column_addr_cycles;
@@ -159,11 +192,13 @@ typedef struct {
 
     uint8_t             programs_per_page;
 
-    nand_std_t          standard_type;
-    nand_params_t       params;
+    uint8_t             ecc_bits;                  /**< bits the host ECC must correct per codeword, 0 if none required */
+
+    bool                ecc_on_die : 1;            /**< set to true while the NAND corrects pages internally */
+    bool                init_done  : 1;            /**< set to true once the init procedure completed successfully */
 } nand_t;
 
-int nand_init(nand_t* const nand, nand_params_t* const params);
+int nand_init(nand_t* const nand, const nand_params_t* const params);
 
 size_t nand_write_addr_column(const nand_t* const nand, const uint64_t* const addr_column, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns);
 size_t nand_write_addr_row(const nand_t* const nand, const uint64_t* const addr_row, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns);
@@ -180,8 +215,25 @@ void nand_set_io_pin_read(const nand_t* const nand);
 
 void nand_wait(const uint32_t delay_ns);
 bool nand_wait_until_ready(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t ready_this_lun_timeout_ns, const uint32_t ready_other_luns_timeout_ns);
+/**
+ * Polls R/B# of the LUN, @p timeout_ns 0 waits without a limit. A LUN the
+ * board wires no R/B# for (GPIO_UNDEF) is polled with READ STATUS (70h)
+ * until RDY is set instead, with its CE# low, and READ MODE (00h) follows,
+ * so data output of a page read goes on afterwards. The latches are left
+ * released.
+ */
 bool nand_wait_until_lun_ready(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t timeout_ns);
 
+/**
+ * Waits for all LUNs in @p lun_mask, bit n for LUN n, against one common
+ * deadline, so LUNs busy at the same time cost the longest of their busy
+ * times. Returns the mask of those still busy at the deadline, 0 when all
+ * came ready. Unlike nand_wait_until_lun_ready(), @p timeout_ns 0 does not
+ * wait at all. LUNs without R/B# keep the wait going until the deadline and
+ * count as ready then. Counted by nand_stats and nand_trace as one R/B# wait.
+ */
+uint8_t nand_wait_until_luns_ready(const nand_t* const nand, const uint8_t lun_mask, const uint32_t timeout_ns);
+
 bool nand_check_DDR(const uint8_t * const bytes, const size_t bytes_size);
 size_t nand_fold_DDR_repeat_bytes(uint8_t * const bytes, const size_t bytes_size, const uint8_t filling_empty_byte);
 
@@ -210,132 +262,57 @@ static inline void nand_set_pin_default(const nand_t* const nand) {
 }
 
 static inline void nand_set_latch_command(const nand_t* const nand) {
-    gpio_write(nand->params.ale, 0);
-    gpio_write(nand->params.cle, 1);
+    gpio_write(nand->params->ale, 0);
+    gpio_write(nand->params->cle, 1);
 }
 
 static inline void nand_set_latch_address(const nand_t* const nand) {
-    gpio_write(nand->params.cle, 0);
-    gpio_write(nand->params.ale, 1);
+    gpio_write(nand->params->cle, 0);
+    gpio_write(nand->params->ale, 1);
 }
 
 static inline void nand_set_latch_raw(const nand_t* const nand) {
-    gpio_write(nand->params.cle, 0);
-    gpio_write(nand->params.ale, 0);
+    gpio_write(nand->params->cle, 0);
+    gpio_write(nand->params->ale, 0);
 }
 
 static inline void nand_set_read_enable(const nand_t* const nand) {
-    gpio_write(nand->params.re, 0);
+    gpio_write(nand->params->re, 0);
 }
 
 static inline void nand_set_read_disable(const nand_t* const nand) {
-    gpio_write(nand->params.re, 1);
+    gpio_write(nand->params->re, 1);
 }
 
 static inline void nand_set_write_enable(const nand_t* const nand) {
-    gpio_write(nand->params.we, 0);
+    gpio_write(nand->params->we, 0);
 }
 
 static inline void nand_set_write_disable(const nand_t* const nand) {
-    gpio_write(nand->params.we, 1);
+    gpio_write(nand->params->we, 1);
 }
 
 static inline void nand_set_write_protect_enable(const nand_t* const nand) {
-    gpio_write(nand->params.wp, 0);
+    gpio_write(nand->params->wp, 0);
 }
 
 static inline void nand_set_write_protect_disable(const nand_t* const nand) {
-    gpio_write(nand->params.wp, 1);
+    gpio_write(nand->params->wp, 1);
 }
 
 static inline void nand_set_chip_enable(const nand_t* const nand, const uint8_t lun_no) {
-    switch(lun_no) {
-    case 0:
-        {
-            gpio_write(nand->params.ce0, 0);
-        }
-        break;
-    case 1:
-        {
-            gpio_write(nand->params.ce1, 0);
-        }
-        break;
-    case 2:
-        {
-            gpio_write(nand->params.ce2, 0);
-        }
-        break;
-    case 3:
-        {
-            gpio_write(nand->params.ce3, 0);
-        }
-        break;
-    case 4:
-        {
-            gpio_write(nand->params.ce4, 0);
-        }
-        break;
-    case 5:
-        {
-            gpio_write(nand->params.ce5, 0);
-        }
-        break;
-    case 6:
-        {
-            gpio_write(nand->params.ce6, 0);
-        }
-        break;
-    case 7:
-        {
-            gpio_write(nand->params.ce7, 0);
-        }
-        break;
-    }
+    assert(lun_no < NAND_MAX_CHIPS);
+    gpio_write(nand->params->ce[lun_no], 0);
 }
 
 static inline void nand_set_chip_disable(const nand_t* const nand, const uint8_t lun_no) {
-    switch(lun_no) {
-    case 0:
-        {
-            gpio_write(nand->params.ce0, 1);
-        }
-        break;
-    case 1:
-        {
-            gpio_write(nand->params.ce1, 1);
-        }
-        break;
-    case 2:
-        {
-            gpio_write(nand->params.ce2, 1);
-        }
-        break;
-    case 3:
-        {
-            gpio_write(nand->params.ce3, 1);
-        }
-        break;
-    case 4:
-        {
-            gpio_write(nand->params.ce4, 1);
-        }
-        break;
-    case 5:
-        {
-            gpio_write(nand->params.ce5, 1);
-        }
-        break;
-    case 6:
-        {
-            gpio_write(nand->params.ce6, 1);
-        }
-        break;
-    case 7:
-        {
-            gpio_write(nand->params.ce7, 1);
-        }
-        break;
-    }
+    assert(lun_no < NAND_MAX_CHIPS);
+    gpio_write(nand->params->ce[lun_no], 1);
+}
+
+/** Width of the data bus, a constant with CONFIG_NAND_DATA_BUS_8BIT */
+static inline uint8_t nand_data_bus_width(const nand_t* const nand) {
+    return IS_ACTIVE(CONFIG_NAND_DATA_BUS_8BIT) ? 8 : nand->data_bus_width;
 }
 
 static inline size_t nand_one_lun_pages_count(const nand_t* const nand) {
@@ -346,6 +323,10 @@ static inline size_t nand_all_pages_count(const nand_t* const nand) {
     return nand_one_lun_pages_count(nand) * nand->lun_count;
 }
 
+static inline size_t nand_all_blocks_count(const nand_t* const nand) {
+    return nand->blocks_per_lun * nand->lun_count;
+}
+
 static inline size_t nand_one_page_size(const nand_t* const nand) {
     return nand->data_bytes_per_page + nand->spare_bytes_per_page;
 }
@@ -382,10 +363,19 @@ static inline uint64_t nand_addr_flat_to_addr_row(const nand_t* const nand, cons
     return addr_flat / nand_one_page_size(nand);
 }
 
+static inline uint8_t nand_addr_row_to_lun_no(const nand_t* const nand, const uint64_t addr_row) {
+    return addr_row / nand_one_lun_pages_count(nand);
+}
+
 static inline uint64_t nand_addr_to_addr_flat(const nand_t* const nand, const uint64_t addr_row, const uint64_t addr_column) {
     return addr_row * nand_one_page_size(nand) + addr_column;
 }
 
+/** Delay of a command chain after the board specific scale found by calibration */
+static inline uint32_t nand_timing_scaled(const uint32_t delay_ns, const uint16_t scale) {
+    return (uint32_t)(((uint64_t)delay_ns * scale) / NAND_TIMING_SCALE_NOMINAL);
+}
+
 static inline uint32_t nand_deadline_from_interval(const uint32_t interval_ns) {
     return ztimer_now(ZTIMER_USEC) + (interval_ns / 1000);
 }
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_nand_bbt NAND bad block table
+ * @ingroup     drivers_storage
+ * @brief       Bad block bookkeeping for ONFI NANDs.
+ * @anchor      drivers_nand_bbt
+ * @{
+ *
+ * The state of every block is kept in RAM with 2 bits per block, so a lookup
+ * is a shift and a mask. The factory markers are scanned only once, the
+ * table is then stored in the last @ref CONFIG_NAND_BBT_BLOCKS blocks of the
+ * device and loaded from there with a few page reads on the next init.
+ *
+ * Each update is written with a higher version to @ref NAND_BBT_COPIES
+ * reserved blocks not holding the current table, so an interrupted update
+ * leaves the previous one readable.
+ *
+ * The table also records which block replaces a retired one, for remapping
+ * layers such as @ref drivers_mtd_nand_bbm. It holds as many entries as the
+ * parameter page allows bad blocks (bb_per_lun).
+ *
+ * @file
+ * @brief       Public interface for the nand_bbt driver.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_BBT_H
+#define NAND_BBT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nand.h"
+#include "nand/onfi.h"
+
+#ifndef CONFIG_NAND_BBT_BLOCKS
+#define CONFIG_NAND_BBT_BLOCKS              (4)     /**< blocks reserved at the end of the device */
+#endif
+
+#ifndef CONFIG_NAND_BBT_REMAPS
+#define CONFIG_NAND_BBT_REMAPS              (20)    /**< replacements recorded if the NAND gives no bb_per_lun */
+#endif
+
+#define NAND_BBT_COPIES                     (2)     /**< copies written per update */
+
+/** Changes with every layout change, tables of an older layout are not loaded */
+#define NAND_BBT_MAGIC                      "NBB2"
+#define NAND_BBT_MAGIC_SIZE                 (4)
+
+#define NAND_BBT_BITS_PER_BLOCK             (2)
+#define NAND_BBT_BLOCKS_PER_BYTE            (8 / NAND_BBT_BITS_PER_BLOCK)
+#define NAND_BBT_STATE_MASK                 ((1 << NAND_BBT_BITS_PER_BLOCK) - 1)
+
+#define NAND_BBT_MARKER_GOOD                (0xFF)  /**< factory marker of a good block */
+
+typedef enum {
+    NAND_BBT_GOOD           = 0,    /**< usable */
+    NAND_BBT_WORN           = 1,    /**< failed a program or erase */
+    NAND_BBT_RESERVED       = 2,    /**< holds the table */
+    NAND_BBT_FACTORY_BAD    = 3     /**< marked bad by the manufacturer */
+} nand_bbt_state_t;
+
+/**
+ * @brief   Header in front of the bitmap and the replacements on flash
+ *
+ * The CRC (CCITT) covers the header up to the CRC itself, the bitmap and
+ * all replacement slots.
+ */
+typedef struct __attribute__((packed)) {
+    uint8_t             magic[NAND_BBT_MAGIC_SIZE];
+    uint32_t            version;
+    uint32_t            blocks;
+    uint16_t            remaps_max;
+    uint16_t            remaps_count;
+    uint16_t            crc;
+} nand_bbt_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t            block;              /**< block as seen by the upper layer */
+    uint32_t            replacement;        /**< block holding its data */
+} nand_bbt_remap_t;
+
+typedef struct {
+    nand_onfi_t*        nand_onfi;
+    uint8_t*            bitmap;             /**< 2 bits per block, see @ref nand_bbt_state_t */
+    uint32_t            blocks;             /**< blocks of the device */
+    uint32_t            first_reserved;     /**< first block of the table area */
+    uint32_t            version;            /**< version of the table in RAM */
+    uint8_t             current_copies;     /**< bit n set if reserved block n holds the current version */
+    nand_bbt_remap_t*   remaps;
+    uint16_t            remaps_count;
+    uint16_t            remaps_max;
+} nand_bbt_t;
+
+/**
+ * Loads the table from the reserved blocks, or scans the factory markers and
+ * stores a new table if none is found. Returns NAND_INIT_PARTIAL if the
+ * scanned table could not be stored, it is still usable then.
+ */
+int nand_bbt_init(nand_bbt_t* const bbt, nand_onfi_t* const nand_onfi);
+void nand_bbt_deinit(nand_bbt_t* const bbt);
+
+/**
+ * Reads the factory marker of the first and the last page of every block.
+ * Only the RAM table is updated, use nand_bbt_store() to persist it.
+ */
+nand_rw_response_t nand_bbt_scan(nand_bbt_t* const bbt);
+
+/** Loads the newest valid copy of the table, NAND_RW_NOT_FOUND if there is none */
+nand_rw_response_t nand_bbt_load(nand_bbt_t* const bbt);
+nand_rw_response_t nand_bbt_store(nand_bbt_t* const bbt);
+
+/** Retires a block that failed a program or erase, and stores the table */
+nand_rw_response_t nand_bbt_mark_bad(nand_bbt_t* const bbt, const uint32_t block_no);
+
+/**
+ * Records that @p replacement now holds the data of @p block_no, updating an
+ * earlier entry of @p block_no, and retires the block it was stored in
+ * before. The table is stored once. Returns NAND_RW_NOT_SUPPORTED if all
+ * entries are in use.
+ */
+nand_rw_response_t nand_bbt_remap(nand_bbt_t* const bbt, const uint32_t block_no, const uint32_t replacement);
+
+/** Block holding the data of @p block_no, @p block_no itself if it was never remapped */
+uint32_t nand_bbt_replacement(const nand_bbt_t* const bbt, const uint32_t block_no);
+
+/** Whether @p block_no currently replaces another block */
+bool nand_bbt_is_replacement(const nand_bbt_t* const bbt, const uint32_t block_no);
+
+static inline nand_bbt_state_t nand_bbt_get(const nand_bbt_t* const bbt, const uint32_t block_no) {
+    return (nand_bbt_state_t)((bbt->bitmap[block_no / NAND_BBT_BLOCKS_PER_BYTE] >> ((block_no % NAND_BBT_BLOCKS_PER_BYTE) * NAND_BBT_BITS_PER_BLOCK)) & NAND_BBT_STATE_MASK);
+}
+
+static inline void nand_bbt_set(nand_bbt_t* const bbt, const uint32_t block_no, const nand_bbt_state_t state) {
+    const uint8_t shift = (block_no % NAND_BBT_BLOCKS_PER_BYTE) * NAND_BBT_BITS_PER_BLOCK;
+    uint8_t* const byte = &(bbt->bitmap[block_no / NAND_BBT_BLOCKS_PER_BYTE]);
+
+    *byte = (*byte & ~(NAND_BBT_STATE_MASK << shift)) | (state << shift);
+}
+
+static inline bool nand_bbt_is_bad(const nand_bbt_t* const bbt, const uint32_t block_no) {
+    return block_no >= bbt->blocks || nand_bbt_get(bbt, block_no) != NAND_BBT_GOOD;
+}
+
+/** Blocks available to users, the table area is at the end */
+static inline uint32_t nand_bbt_user_blocks(const nand_bbt_t* const bbt) {
+    return bbt->first_reserved;
+}
+
+static inline size_t nand_bbt_bitmap_size(const uint32_t blocks) {
+    return (blocks + NAND_BBT_BLOCKS_PER_BYTE - 1) / NAND_BBT_BLOCKS_PER_BYTE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_BBT_H */
+/** @} */
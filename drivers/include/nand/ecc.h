@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_nand_ecc NAND ECC engine
+ * @ingroup     drivers_storage
+ * @brief       Host side error correction for NAND pages.
+ * @anchor      drivers_nand_ecc
+ * @{
+ *
+ * The engine splits a page into codewords of @ref nand_t::ecc_codeword_size
+ * data bytes and keeps the parity of all codewords back to back at the end
+ * of the spare area. The first spare bytes stay untouched for the factory
+ * bad block marker and upper layer metadata.
+ *
+ * @file
+ * @brief       Public interface for the nand_ecc driver.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_ECC_H
+#define NAND_ECC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel_defines.h"
+#include "nand.h"
+#include "nand_cmd.h"
+#include "nand/ecc/bch.h"
+
+/**
+ * @brief   Use BCH also for parts requiring 1-bit correction
+ *
+ * By default those get a Hamming code, it is cheaper to compute and leaves
+ * more of the spare area free.
+ */
+#ifdef DOXYGEN
+#define CONFIG_NAND_ECC_NO_HAMMING
+#endif
+
+#define NAND_ECC_SPARE_RESERVED_SIZE        (2)     /**< factory bad block marker */
+
+#define NAND_ECC_HAMMING_STEP_SIZE          (256)   /**< data bytes per Hamming code */
+#define NAND_ECC_HAMMING_BYTES              (3)     /**< bytes per Hamming code */
+
+typedef enum {
+    NAND_ECC_MODE_NONE,         /**< pages are transferred as is */
+    NAND_ECC_MODE_BCH,          /**< software BCH, parity in the spare area */
+    NAND_ECC_MODE_HAMMING,      /**< 1-bit Hamming per 256 bytes, for SLC */
+    NAND_ECC_MODE_ON_DIE        /**< corrected inside the NAND, nothing stored by the host */
+} nand_ecc_mode_t;
+
+typedef struct {
+    nand_ecc_mode_t     mode;
+    uint16_t            step_size;          /**< data bytes per codeword */
+    uint16_t            steps;              /**< codewords per page */
+    uint8_t             strength;           /**< correctable bits per codeword */
+    uint8_t             bytes_per_step;     /**< parity bytes per codeword */
+    uint16_t            spare_offset;       /**< first spare byte holding parity */
+    uint32_t            corrected_bits;     /**< bitflips corrected since init */
+    uint32_t            failed_steps;       /**< uncorrectable codewords seen since init */
+    uint8_t*            calculated;         /**< codes computed while a page was read, see nand_ecc_stream_read_cb() */
+    nand_ecc_bch_t      bch;
+} nand_ecc_t;
+
+/**
+ * Sets @p ecc up for @p nand. @p ecc has to be zeroed before its first init,
+ * a later init releases what the previous one allocated.
+ */
+int nand_ecc_init(nand_ecc_t* const ecc, const nand_t* const nand, const nand_ecc_mode_t mode);
+void nand_ecc_deinit(nand_ecc_t* const ecc);
+
+void nand_ecc_calculate_step(const nand_ecc_t* const ecc, const uint8_t* const data, uint8_t* const code);
+void nand_ecc_calculate(const nand_ecc_t* const ecc, const uint8_t* const data, uint8_t* const spare);
+nand_rw_response_t nand_ecc_correct(nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const spare, size_t* const corrected_bits);
+nand_rw_response_t nand_ecc_correct_calculated(nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const spare, const uint8_t* const calculated, size_t* const corrected_bits);
+
+/**
+ * Erased codewords read back as all 0xFF including their parity, which does
+ * not decode. Counts the zero bits of one codeword, @p data and its @p code,
+ * and if there are no more than @ref nand_ecc_t::strength, fills @p data with
+ * 0xFF and returns true. Stops counting as soon as the limit is exceeded.
+ *
+ * nand_ecc_correct() and nand_ecc_correct_calculated() call this before the
+ * decoder for every codeword whose parity is within that limit of all 0xFF,
+ * and count the zero bits as corrected.
+ */
+bool nand_ecc_check_erased(const nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const code, size_t* const flipped_bits);
+
+/**
+ * Hooks for nand_run_cmd_chains(), to compute the codes while the page is on
+ * the bus instead of in a second pass afterwards. The page has to be
+ * transferred with its spare area from column 0, in chunks of
+ * @ref nand_ecc_t::step_size with the buffer advancing, and the
+ * @ref nand_ecc_t passed as hook_arg.
+ *
+ * The program hook is a pre hook and fills the parity in the spare area of
+ * the buffer before that is sent. The read hook is a post hook and fills
+ * @ref nand_ecc_t::calculated, which is then handed to
+ * nand_ecc_correct_calculated().
+ */
+void nand_ecc_stream_program_cb(nand_t* const nand, const nand_cmd_t* const cmd, nand_cmd_params_t* const cmd_params, const size_t current_chain_seq, nand_cmd_chain_t* current_chain);
+void nand_ecc_stream_read_cb(nand_t* const nand, const nand_cmd_t* const cmd, nand_cmd_params_t* const cmd_params, const size_t current_chain_seq, nand_cmd_chain_t* current_chain);
+
+static inline bool nand_ecc_enabled(const nand_ecc_t* const ecc) {
+    return ecc->mode != NAND_ECC_MODE_NONE;
+}
+
+static inline bool nand_ecc_on_host(const nand_ecc_t* const ecc) {
+    return ecc->mode != NAND_ECC_MODE_NONE && ecc->mode != NAND_ECC_MODE_ON_DIE;
+}
+
+static inline nand_ecc_mode_t nand_ecc_mode_for(const nand_t* const nand) {
+    if(nand->ecc_on_die) {
+        return NAND_ECC_MODE_ON_DIE;
+    }
+
+    if(nand->ecc_bits == 0 || nand->ecc_codeword_size == 0) {
+        return NAND_ECC_MODE_NONE;
+    }
+
+    if(! IS_ACTIVE(CONFIG_NAND_ECC_NO_HAMMING) && nand->ecc_bits == 1) {
+        return NAND_ECC_MODE_HAMMING;
+    }
+
+    return NAND_ECC_MODE_BCH;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_ECC_H */
+/** @} */
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_ecc
+ * @{
+ *
+ * @file
+ * @brief       Binary BCH codec for NAND spare area parity.
+ *
+ * Encoding and the error-free decode path are a byte-wise table-driven LFSR
+ * over the generator polynomial, so a clean codeword costs one table lookup
+ * per data byte. Syndromes, Berlekamp-Massey and the Chien search are only
+ * entered when the recomputed parity differs from the stored one. They use
+ * log/antilog tables of GF(2^m) allocated by nand_ecc_bch_init(), 4 * 2^m
+ * bytes: 32 KiB for 512-byte codewords, 64 KiB for 1 KiB ones.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_ECC_BCH_H
+#define NAND_ECC_BCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef CONFIG_NAND_ECC_BCH_MAX_STRENGTH
+#define CONFIG_NAND_ECC_BCH_MAX_STRENGTH    (24)    /**< largest t accepted from the parameter page */
+#endif
+
+#define NAND_ECC_BCH_MIN_M                  (5)
+#define NAND_ECC_BCH_MAX_M                  (15)
+
+typedef struct {
+    uint8_t     m;              /**< Galois field order, GF(2^m) */
+    uint8_t     t;              /**< correctable bits per codeword */
+    uint16_t    n;              /**< 2^m - 1 */
+    uint32_t    poly;           /**< primitive polynomial of GF(2^m), including x^m */
+    uint16_t    data_size;      /**< data bytes per codeword */
+    uint16_t    ecc_bits;       /**< degree of the generator polynomial */
+    uint8_t     ecc_bytes;      /**< parity bytes per codeword */
+    uint8_t     ecc_words;      /**< 32-bit words holding the LFSR */
+    uint32_t*   remainder_table;/**< 256 * ecc_words, remainder of each leading byte */
+    uint16_t*   gf_exp;         /**< a^i for i = 0 .. n - 1 */
+    uint16_t*   gf_log;         /**< log_a(x) for x = 1 .. n */
+} nand_ecc_bch_t;
+
+int nand_ecc_bch_init(nand_ecc_bch_t* const bch, const uint16_t data_size, const uint8_t strength);
+void nand_ecc_bch_deinit(nand_ecc_bch_t* const bch);
+
+void nand_ecc_bch_encode(const nand_ecc_bch_t* const bch, const uint8_t* const data, uint8_t* const ecc);
+int nand_ecc_bch_decode(const nand_ecc_bch_t* const bch, uint8_t* const data, const uint8_t* const ecc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_ECC_BCH_H */
+/** @} */
@@ -38,6 +38,57 @@ extern "C" {
 
 #define NAND_ONFI_MAX_UNIQUE_ID_SIZE             (512)
 #define NAND_ONFI_PARAMETER_PAGE_SIZE            (768)          /**< ONFI states standard as 0-767 */
+#define NAND_ONFI_PARAMETER_PAGE_COPY_SIZE       (256)          /**< one copy out of the redundant parameter pages */
+#define NAND_ONFI_PARAMETER_PAGE_CRC_POS         (254)          /**< CRC-16 of bytes 0-253, little endian */
+#define NAND_ONFI_PARAMETER_PAGE_CRC_POLY        (0x8005)
+#define NAND_ONFI_PARAMETER_PAGE_CRC_SEED        (0x4F4E)
+
+#define NAND_ONFI_FEATURE_16BIT_DATA_BUS         (0x0001)
+#define NAND_ONFI_FEATURE_EXT_PARAMETER_PAGE     (0x0080)       /**< since ONFI 2.1 */
+
+#define NAND_ONFI_OPT_CMD_READ_CACHE             (0x0002)       /**< of nand_onfi_chip_t::opt_cmd, 31h and 3Fh supported */
+#define NAND_ONFI_OPT_CMD_READ_STATUS_ENHANCED   (0x0008)       /**< of nand_onfi_chip_t::opt_cmd, 78h supported */
+
+#define NAND_ONFI_ECC_BITS_SEE_EXT_PARAMETER_PAGE   (0xFF)
+#define NAND_ONFI_ECC_CODEWORD_SIZE_DEFAULT         (512)
+
+#define NAND_ONFI_FEATURE_PARAMETERS_SIZE        (4)            /**< P1-P4 of GET/SET FEATURES */
+#define NAND_ONFI_FEATURE_ADDR_TIMING_MODE       (0x01)
+#define NAND_ONFI_FEATURE_ADDR_ARRAY_OPERATION_MODE (0x90)      /**< vendor specific, Micron */
+
+#define NAND_ONFI_ARRAY_OPERATION_MODE_ECC_ENABLE   (0x08)      /**< P1 bit of the Micron array operation mode */
+
+#define NAND_ONFI_STATUS_FAIL                    (0x01)         /**< last operation failed, uncorrectable page with on-die ECC */
+#define NAND_ONFI_STATUS_FAILC                   (0x02)
+#define NAND_ONFI_STATUS_REWRITE_RECOMMENDED     (0x08)         /**< vendor specific, on-die ECC corrected bitflips near its limit */
+#define NAND_ONFI_STATUS_ARDY                    (0x20)
+#define NAND_ONFI_STATUS_RDY                     (0x40)
+#define NAND_ONFI_STATUS_WP_N                    (0x80)
+
+#define NAND_ONFI_PLANE_ADDR_BITS_MASK           (0x0F)         /**< of nand_onfi_chip_t::interleaved_bits */
+
+#define NAND_ONFI_TARGET_READY                   (0x01)         /**< of nand_onfi_t::targets, came ready from the reset within tRST */
+#define NAND_ONFI_TARGET_PRESENT                 (0x02)         /**< answered READ ID with a maker code */
+#define NAND_ONFI_TARGET_ONFI                    (0x04)         /**< answered READ ID 20h with the ONFI signature */
+#define NAND_ONFI_TARGET_SAME_ID                 (0x08)         /**< same NAND ID as the target on CE0#, so the same geometry */
+
+#define NAND_ONFI_MAKER_MICRON                   (0x2C)
+#define NAND_ONFI_MICRON_ID_INTERNAL_ECC_POS     (4)            /**< ID byte advertising the internal ECC */
+#define NAND_ONFI_MICRON_ID_INTERNAL_ECC_MASK    (0x03)         /**< Internal ECC level, bits 1:0, zero without */
+
+/**
+ * @brief   Keep the on-die ECC of the NAND disabled, even if it is advertised
+ *
+ * Host ECC is used instead, as requested by the parameter page.
+ */
+#ifdef DOXYGEN
+#define CONFIG_NAND_ONFI_NO_ON_DIE_ECC
+#endif
+
+#define NAND_ONFI_EXT_PARAMETER_PAGE_HEADER_SIZE    (32)        /**< CRC, signature, reserved, section types */
+#define NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_COUNT  (8)
+#define NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_UNIT   (16)        /**< section lengths are given in 16-byte units */
+#define NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_ECC    (2)
 
 /**
  * @brief   version type of ONFI
@@ -129,19 +180,102 @@ typedef struct __attribute__ ((packed)) {
     uint8_t  vendor[88];
 
     uint16_t crc;
-
-    /* redundant */
-    uint8_t  redundant1[256];
-    uint8_t  redundant2[256];
 } nand_onfi_chip_t;
 
+/**
+ * The parameter page is only parsed on init, what is needed afterwards is
+ * kept here. The capabilities are the bits of opt_cmd, fields go by size.
+ */
 typedef struct {
     nand_t              nand;
-    nand_onfi_chip_t    onfi_chip;
+    uint32_t            ecc_on_die_corrected_bits;  /**< bitflips reported by the on-die ECC since init */
+    uint32_t            ecc_on_die_failed_reads;    /**< reads the on-die ECC could not correct since init */
+    uint16_t            opt_cmd;                    /**< optional commands supported, as in nand_onfi_chip_t */
+    uint8_t             plane_addr_bits;            /**< row address bits selecting the plane */
+    uint8_t             targets[NAND_MAX_CHIPS];    /**< NAND_ONFI_TARGET_* of each CE#, probed on init */
 } nand_onfi_t;
 
-int nand_onfi_init(nand_onfi_t* const nand_onfi, nand_params_t* const params);
+int nand_onfi_init(nand_onfi_t* const nand_onfi, const nand_params_t* const params);
+
+/**
+ * Issues RESET to every target the board wires CE# for, one after the other,
+ * and then waits for all of them against a single tRST: on R/B# where it is
+ * wired, by polling READ STATUS for RDY where it is not. Returns the mask of
+ * the targets that came ready, bit n for CE n#.
+ */
+uint8_t nand_onfi_reset(nand_onfi_t* const nand_onfi);
+
+/**
+ * Reads the first copy of the parameter page into @p chip. If its CRC does
+ * not hold, the redundant copies are read and the first good one is taken.
+ * Returns the size of the copy, 0 if none passed the CRC.
+ */
 size_t nand_onfi_read_chip(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, nand_onfi_chip_t* const chip);
+bool nand_onfi_read_ext_ecc(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const nand_onfi_chip_t* const chip, uint8_t* const ecc_bits, uint16_t* const ecc_codeword_size);
+
+/**
+ * Checks the CRC-16 at the end of one NAND_ONFI_PARAMETER_PAGE_COPY_SIZE copy
+ * of the parameter page.
+ */
+bool nand_onfi_check_parameter_page(const uint8_t* const copy);
+
+nand_rw_response_t nand_onfi_read_status(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, uint8_t* const status);
+/** READ STATUS ENHANCED (78h) of the LUN holding @p addr_row, falls back to 70h on parts without it */
+nand_rw_response_t nand_onfi_read_status_enhanced(nand_onfi_t* const nand_onfi, const uint64_t addr_row, uint8_t* const status);
+nand_rw_response_t nand_onfi_get_features(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const uint8_t feature_addr, uint8_t* const parameters);
+nand_rw_response_t nand_onfi_set_features(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const uint8_t feature_addr, const uint8_t* const parameters);
+
+/**
+ * @brief   Whether the part carries an internal ECC engine
+ *
+ * ONFI has no standard field for this. Only Micron's ID byte 4 is decoded,
+ * parts of other makers are reported without on-die ECC even if they have
+ * one. Those still work with the host ECC of @ref drivers_nand_ecc.
+ */
+bool nand_onfi_has_on_die_ecc(const nand_onfi_t* const nand_onfi);
+bool nand_onfi_set_on_die_ecc(nand_onfi_t* const nand_onfi, const bool enable);
+
+nand_rw_response_t nand_onfi_read_page(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, uint8_t* const buffer, const size_t buffer_size);
+/**
+ * Program and erase check the status register afterwards and return
+ * NAND_RW_WRITE_ERROR if the part reports a failure, the block should be
+ * retired then.
+ */
+nand_rw_response_t nand_onfi_program_page(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, const uint8_t* const buffer, const size_t buffer_size);
+
+/**
+ * Reads consecutive pages of a block through the cache register. The part
+ * loads the next page while the current one is transferred, so tR is spent
+ * only once for the whole run.
+ *
+ * nand_onfi_read_cache_start() loads the first page. Each call of
+ * nand_onfi_read_cache_next() then returns the following page in turn from
+ * column 0, the run ends with @p last set. No other command may go to the
+ * LUN in between. Check nand_onfi_has_read_cache() first.
+ *
+ * A run given up early, e.g. on an error, is ended by
+ * nand_onfi_read_cache_end() instead.
+ */
+bool nand_onfi_has_read_cache(const nand_onfi_t* const nand_onfi);
+nand_rw_response_t nand_onfi_read_cache_start(nand_onfi_t* const nand_onfi, const uint64_t addr_row);
+nand_rw_response_t nand_onfi_read_cache_next(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, uint8_t* const buffer, const size_t buffer_size, const bool last);
+nand_rw_response_t nand_onfi_read_cache_end(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no);
+
+/**
+ * Same as nand_onfi_read_page() and nand_onfi_program_page(), but the data is
+ * moved in chunks of chunk_size with the hooks run around each chunk. Reads
+ * skip the on-die ECC status check.
+ */
+nand_rw_response_t nand_onfi_read_page_hooked(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg);
+nand_rw_response_t nand_onfi_program_page_hooked(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, const uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg);
+nand_rw_response_t nand_onfi_erase_block(nand_onfi_t* const nand_onfi, const uint64_t addr_row);
+
+/**
+ * Moves a page to another page of the same plane and LUN inside the NAND,
+ * without transferring it over the bus. Returns NAND_RW_NOT_SUPPORTED for
+ * pages on different planes. Host side ECC is not checked on the way.
+ */
+nand_rw_response_t nand_onfi_copyback(nand_onfi_t* const nand_onfi, const uint64_t src_addr_row, const uint64_t dst_addr_row);
 
 #ifdef __cplusplus
 }
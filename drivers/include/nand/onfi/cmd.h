@@ -41,7 +41,7 @@ static const nand_cmd_t NAND_ONFI_CMD_READ = {
         },
         {
             .cycles_defined             = false,
-            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_READY_THIS_LUN,
             .cycles_type                = NAND_CMD_TYPE_RAW_READ
         }
     }
@@ -112,7 +112,7 @@ static const nand_cmd_t NAND_ONFI_CMD_READ_PARAMETER_PAGE = {
             },
             {
                 .cycles_defined         = false,
-                .timings                = NAND_ONFI_CMD_TIMING_RAW_READ,
+                .timings                = NAND_ONFI_CMD_TIMING_RAW_READ_READY_THIS_LUN,
                 .cycles_type            = NAND_CMD_TYPE_RAW_READ
             }
         }
@@ -170,25 +170,366 @@ static const nand_cmd_t NAND_ONFI_CMD_BLOCK_ERASE = {
 };
 
 
+static const nand_cmd_t NAND_ONFI_CMD_READ_STATUS = {
+    .chains_length = 2,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x70 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_STATUS,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+/** READ STATUS of the LUN the row address points at, for targets with more than one LUN */
+static const nand_cmd_t NAND_ONFI_CMD_READ_STATUS_ENHANCED = {
+    .chains_length = 3,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x78 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_ROW_WRITE,
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_STATUS,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+/**
+ * READ followed by READ STATUS once the page is in the page register, then
+ * READ MODE (00h) to return to data output. Parts with on-die ECC report the
+ * ECC result of the page read in the status byte.
+ */
+static const nand_cmd_t NAND_ONFI_CMD_READ_WITH_STATUS = {
+    .chains_length = 7,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x00 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_WRITE,
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x30 }
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x70 }
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_STATUS,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x00 }
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+static const nand_cmd_t NAND_ONFI_CMD_GET_FEATURES = {
+    .chains_length = 3,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0xEE },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_SINGLE_WRITE,
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+static const nand_cmd_t NAND_ONFI_CMD_SET_FEATURES = {
+    .chains_length = 3,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0xEF },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_SINGLE_WRITE,
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_RAW_WRITE
+        }
+    }
+};
+
+/**
+ * COPYBACK READ loads a page into the page register without transferring
+ * it, COPYBACK PROGRAM then writes the page register to another page of the
+ * same plane.
+ */
+static const nand_cmd_t NAND_ONFI_CMD_COPYBACK_READ = {
+    .chains_length = 3,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x00 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_WRITE,
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x35 }
+        }
+    }
+};
+
+static const nand_cmd_t NAND_ONFI_CMD_COPYBACK_PROGRAM = {
+    .chains_length = 3,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x85 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_WRITE,
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x10 }
+        }
+    }
+};
+
+/**
+ * Cache reads: READ CACHE START is a READ without data output, it loads the
+ * first page into the page register. READ CACHE SEQUENTIAL (31h) moves the
+ * page register to the cache register and starts loading the next page
+ * while the cache register is clocked out. READ CACHE END (3Fh) moves the
+ * last page without loading another one.
+ */
+static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_START = {
+    .chains_length = 3,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x00 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_ADDR_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_ADDR_WRITE,
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x30 }
+        }
+    }
+};
+
+static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_SEQUENTIAL = {
+    .chains_length = 2,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x31 },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_END = {
+    .chains_length = 2,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x3F },
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+/** Ends a cache read run early, the page moved to the data register is left there */
+static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_ABORT = {
+    .chains_length = 1,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x3F },
+        }
+    }
+};
+
+/**
+ * Same as above with READ STATUS and READ MODE (00h) in between, for the
+ * on-die ECC result of the page moved to the cache register.
+ */
+static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_SEQUENTIAL_WITH_STATUS = {
+    .chains_length = 5,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x31 },
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x70 }
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_STATUS,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x00 }
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_END_WITH_STATUS = {
+    .chains_length = 5,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x3F },
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_READY_THIS_LUN,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x70 }
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ_STATUS,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        },
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0x00 }
+        },
+        {
+            .cycles_defined             = false,
+            .timings                    = NAND_ONFI_CMD_TIMING_RAW_READ,
+            .cycles_type                = NAND_CMD_TYPE_RAW_READ
+        }
+    }
+};
+
+/** R/B# is left to the caller, so that resets of several targets overlap */
+static const nand_cmd_t NAND_ONFI_CMD_RESET = {
+    .chains_length = 1,
+    .chains = {
+        {
+            .cycles_defined             = true,
+            .timings                    = NAND_ONFI_CMD_TIMING_CMD_WRITE_POST_DELAY,
+            .cycles_type                = NAND_CMD_TYPE_CMD_WRITE,
+            .cycles                     = { .cmd = 0xFF }
+        }
+    }
+};
+
 #if 0
 static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_RANDOM              = { .cmd_data = { 0x00, 0x31 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_READ_MULTI_PLANE               = { .cmd_data = { 0x00, 0x32 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
-static const nand_cmd_t NAND_ONFI_CMD_COPYBACK_READ                  = { .cmd_data = { 0x00, 0x35 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_CHANGE_READ_COLUMN             = { .cmd_data = { 0x05, 0xe0 }, .params = NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN }; /**< Copyback read with data output */
 static const nand_cmd_t NAND_ONFI_CMD_CHANGE_READ_COLUMN_ENHANCED    = { .cmd_data = { 0x06, 0xe0 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_ODT_DISABLE                    = { .cmd_data = { 0x1b       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_ALL_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_ODT_ENABLE                     = { .cmd_data = { 0x1c       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_ALL_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_SEQUENTIAL_CONTINUE = { .cmd_data = { 0x31       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN }; /**< Non-standard but ONFI-compliant */
-static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_SEQUENTIAL          = { .cmd_data = { 0x31       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
-static const nand_cmd_t NAND_ONFI_CMD_READ_CACHE_END                 = { .cmd_data = { 0x3f       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_BLOCK_ERASE                    = { .cmd_data = { 0x60, 0xd0 }, .params = NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_BLOCK_ERASE_MULTI_PLANE        = { .cmd_data = { 0x60, 0xd1 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
-static const nand_cmd_t NAND_ONFI_CMD_READ_STATUS                    = { .cmd_data = { 0x70       }, .params = NAND_ONFI_CMD_PARAM_ALLOW_ALL_BUSY_LUN };
-static const nand_cmd_t NAND_ONFI_CMD_READ_STATUS_ENHANCED           = { .cmd_data = { 0x78       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_ALL_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_PAGE_PROGRAM                   = { .cmd_data = { 0x80, 0x10 }, .params = NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_PAGE_PROGRAM_MULTI_PLANE       = { .cmd_data = { 0x80, 0x11 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_PAGE_CACHE_PROGRAM             = { .cmd_data = { 0x80, 0x15 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
-static const nand_cmd_t NAND_ONFI_CMD_COPYBACK_PROGRAM               = { .cmd_data = { 0x85, 0x10 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_COPYBACK_PROGRAM_DATA_MODIFY   = { .cmd_data = { 0x85, 0x10 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN }; /**< Non-standard but ONFI-compliant */
 static const nand_cmd_t NAND_ONFI_CMD_COPYBACK_PROGRAM_MULTI_PLANE   = { .cmd_data = { 0x85, 0x11 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
 static const nand_cmd_t NAND_ONFI_CMD_SMALL_DATA_MOVE                = { .cmd_data = { 0x85, 0x15 }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL | NAND_ONFI_CMD_PARAM_ALLOW_OTHER_BUSY_LUN };
@@ -199,8 +540,6 @@ static const nand_cmd_t NAND_ONFI_CMD_VOLUME_SELECT                  = { .cmd_da
 static const nand_cmd_t NAND_ONFI_CMD_ODT_CONFIGURE                  = { .cmd_data = { 0xe2       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL };
 static const nand_cmd_t NAND_ONFI_CMD_READ_PARAMETER_PAGE            = { .cmd_data = { 0xec       } };
 static const nand_cmd_t NAND_ONFI_CMD_READ_UNIQUE_ID                 = { .cmd_data = { 0xed       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL };
-static const nand_cmd_t NAND_ONFI_CMD_GET_FEATURES                   = { .cmd_data = { 0xee       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL };
-static const nand_cmd_t NAND_ONFI_CMD_SET_FEATURES                   = { .cmd_data = { 0xef       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL };
 static const nand_cmd_t NAND_ONFI_CMD_COMMAND_BASED_DCC_TRAINING     = { .cmd_data = { 0x18       }, .params = NAND_ONFI_CMD_PARAM_OPTIONAL };
 static const nand_cmd_t NAND_ONFI_CMD_READ_DQ_TRAINING               = { .cmd_data = { 0x62       } };
 static const nand_cmd_t NAND_ONFI_CMD_WRITE_TX_DQ_TRAINING_PATTERN   = { .cmd_data = { 0x63       } };
@@ -212,6 +212,34 @@ extern "C" {
     .post_delay_ns                      = NAND_ONFI_TIMING_IGNORE     \
 }
 
+#define NAND_ONFI_CMD_TIMING_RAW_READ_READY_THIS_LUN {                \
+    .pre_delay_ns                       = NAND_ONFI_TIMING_IGNORE   , \
+    .latch_enable_pre_delay_ns          = NAND_ONFI_TIMING_IGNORE   , \
+    .latch_enable_post_delay_ns         = NAND_ONFI_TIMING_IGNORE   , \
+    .ready_this_lun_timeout_ns          = NAND_ONFI_TIMING_INFINITY , \
+    .ready_other_luns_timeout_ns        = NAND_ONFI_TIMING_IGNORE   , \
+    .ready_post_delay_ns                = NAND_ONFI_TIMING_RR       , \
+    .cycle_rw_enable_post_delay_ns      = NAND_ONFI_TIMING_REA      , \
+    .cycle_rw_disable_post_delay_ns     = NAND_ONFI_TIMING_REH      , \
+    .latch_disable_pre_delay_ns         = NAND_ONFI_TIMING_IGNORE   , \
+    .latch_disable_post_delay_ns        = NAND_ONFI_TIMING_IGNORE   , \
+    .post_delay_ns                      = NAND_ONFI_TIMING_IGNORE     \
+}
+
+#define NAND_ONFI_CMD_TIMING_RAW_READ_STATUS {                        \
+    .pre_delay_ns                       = NAND_ONFI_TIMING_WHR      , \
+    .latch_enable_pre_delay_ns          = NAND_ONFI_TIMING_IGNORE   , \
+    .latch_enable_post_delay_ns         = NAND_ONFI_TIMING_IGNORE   , \
+    .ready_this_lun_timeout_ns          = NAND_ONFI_TIMING_IGNORE   , \
+    .ready_other_luns_timeout_ns        = NAND_ONFI_TIMING_IGNORE   , \
+    .ready_post_delay_ns                = NAND_ONFI_TIMING_IGNORE   , \
+    .cycle_rw_enable_post_delay_ns      = NAND_ONFI_TIMING_REA      , \
+    .cycle_rw_disable_post_delay_ns     = NAND_ONFI_TIMING_REH      , \
+    .latch_disable_pre_delay_ns         = NAND_ONFI_TIMING_IGNORE   , \
+    .latch_disable_post_delay_ns        = NAND_ONFI_TIMING_IGNORE   , \
+    .post_delay_ns                      = NAND_ONFI_TIMING_IGNORE     \
+}
+
 #ifdef __cplusplus
 }
 #endif
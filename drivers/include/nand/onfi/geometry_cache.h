@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Parameter page of the last ONFI NAND, kept across boots
+ *
+ * With the `nand_onfi_geometry_cache` module, nand_onfi_init() stores the
+ * first copy of the parameter page and the ECC requirement found for it with
+ * eepreg, along with the NAND ID. When a later boot reads the same ID, both
+ * come from the EEPROM and the parameter page, and the extended one where the
+ * ECC requirement is there, are not read at all. The cached copy still has to
+ * pass its CRC.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_ONFI_GEOMETRY_CACHE_H
+#define NAND_ONFI_GEOMETRY_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include "nand/onfi.h"
+
+/**
+ * Fills @p chip, nand_t::ecc_bits and ecc_codeword_size from the cache,
+ * false if it holds nothing for this NAND ID.
+ */
+bool nand_onfi_geometry_cache_load(nand_onfi_t* const nand_onfi, nand_onfi_chip_t* const chip);
+
+/**
+ * Stores the parameter page @p chip and the ECC requirement found for it.
+ */
+void nand_onfi_geometry_cache_store(const nand_onfi_t* const nand_onfi, const nand_onfi_chip_t* const chip);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_ONFI_GEOMETRY_CACHE_H */
+/** @} */
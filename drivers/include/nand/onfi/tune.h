@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Calibration of the bus timing of ONFI NANDs
+ *
+ * The delays of the command chains are the ONFI minimums plus what the
+ * bit-banged bus needs on top, which depends on the board traces and the MCU
+ * clock. With the `nand_onfi_tune` module, nand_onfi_init() searches for the
+ * shortest cycle delays and then the shortest latch delays, in steps of
+ * @ref CONFIG_NAND_ONFI_TUNE_STEP 256ths of the nominal ones. A setting passes
+ * when the first copy of the parameter page reads back
+ * @ref CONFIG_NAND_ONFI_TUNE_READS times with a valid CRC and the same bytes
+ * as at nominal timing. @ref CONFIG_NAND_ONFI_TUNE_MARGIN percent of the
+ * nominal delays are added to what passed, the result goes to
+ * nand_t::timing_scale_cycle and nand_t::timing_scale_latch.
+ *
+ * With the `eepreg` module the result is stored in the EEPROM with the NAND
+ * ID, and later boots with the same part load it instead of searching.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_ONFI_TUNE_H
+#define NAND_ONFI_TUNE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "nand.h"
+#include "nand/onfi.h"
+
+#ifndef CONFIG_NAND_ONFI_TUNE_READS
+#define CONFIG_NAND_ONFI_TUNE_READS         (8)
+#endif
+
+#ifndef CONFIG_NAND_ONFI_TUNE_STEP
+#define CONFIG_NAND_ONFI_TUNE_STEP          (8)     /**< of NAND_TIMING_SCALE_NOMINAL */
+#endif
+
+#ifndef CONFIG_NAND_ONFI_TUNE_MARGIN
+#define CONFIG_NAND_ONFI_TUNE_MARGIN        (25)    /**< percent of the nominal delays */
+#endif
+
+/**
+ * Searches the timing, applies it and stores it with eepreg. On failure the
+ * nominal timing stays and NAND_RW_UNRELIABLE is returned, either the
+ * parameter page does not even pass at nominal timing or the tuned cycle and
+ * latch delays do not pass together.
+ *
+ * The caller holds nand_t::lock, no other command may run in between.
+ */
+nand_rw_response_t nand_onfi_tune(nand_onfi_t* const nand_onfi);
+
+/**
+ * Called by nand_onfi_init(), loads the stored timing of this NAND or
+ * searches it if there is none. A loaded timing is checked with a single read
+ * of the parameter page and searched anew if that fails.
+ */
+nand_rw_response_t nand_onfi_tune_init(nand_onfi_t* const nand_onfi);
+
+/**
+ * Last NAND nand_onfi_tune_init() ran on, for the shell
+ */
+nand_onfi_t* nand_onfi_tune_dev(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_ONFI_TUNE_H */
+/** @} */
@@ -56,7 +56,7 @@ typedef struct {
     nand_samsung_chip_t     samsung_chip;
 } nand_samsung_t;
 
-int nand_samsung_init(nand_samsung_t* const nand_samsung, nand_params_t* const params);
+int nand_samsung_init(nand_samsung_t* const nand_samsung, const nand_params_t* const params);
 void nand_samsung_read_chip(nand_samsung_t* const nand_samsung, nand_samsung_chip_t* const chip);
 
 #ifdef __cplusplus
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_nand_stats NAND statistics
+ * @ingroup     drivers_storage
+ * @brief       Counters and latency histograms of the NAND stack.
+ * @anchor      drivers_nand_stats
+ * @{
+ *
+ * With the `nand_stats` module, every run of nand_run_cmd_chains() and every
+ * read, write and erase through @ref drivers_mtd_nand_onfi is counted by its
+ * type, with the bytes it moved and its latency in log2 buckets of us:
+ * bucket n holds the operations that took [2^n, 2^(n+1)) us, bucket 0 those
+ * under 2 us and the last bucket all longer ones.
+ *
+ * The time of the commands is split into the time spent in nand_wait(), the
+ * time spent waiting for R/B#, and the rest, the time of the bus cycles
+ * themselves. Each command and each mtd operation costs two ztimer_now()
+ * calls, each R/B# wait two more.
+ *
+ * The numbers are shown by the `nand` shell command. Without the module the
+ * hooks are empty inlines and nothing is counted.
+ *
+ * @file
+ * @brief       Public interface for the nand_stats module.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_STATS_H
+#define NAND_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel_defines.h"
+#include "nand.h"
+
+#if IS_USED(MODULE_NAND_STATS)
+#include "ztimer.h"
+#endif
+
+#ifndef CONFIG_NAND_STATS_BUCKETS
+#define CONFIG_NAND_STATS_BUCKETS           (20)    /**< up to 2^19 us, about half a second */
+#endif
+
+typedef enum {
+    NAND_STATS_OP_READ      = 0,    /**< page reads, cache reads and copybacks */
+    NAND_STATS_OP_PROGRAM   = 1,    /**< page programs */
+    NAND_STATS_OP_ERASE     = 2,    /**< block erases */
+    NAND_STATS_OP_OTHER     = 3,    /**< status, ID, features, reset etc., commands only */
+    NAND_STATS_OP_NUMOF
+} nand_stats_op_t;
+
+typedef struct {
+    uint32_t            count;                              /**< operations done */
+    uint32_t            failed;                             /**< operations returning an error */
+    uint64_t            bytes;                              /**< data bytes moved, no command or address cycles */
+    uint64_t            usec;                               /**< time spent in total */
+    uint32_t            usec_max;                           /**< longest operation */
+    uint32_t            buckets[CONFIG_NAND_STATS_BUCKETS]; /**< latency histogram */
+} nand_stats_ops_t;
+
+typedef struct {
+    nand_stats_ops_t    cmd[NAND_STATS_OP_NUMOF];           /**< runs of nand_run_cmd_chains() */
+    nand_stats_ops_t    mtd[NAND_STATS_OP_NUMOF];           /**< mtd reads, writes and erases, OTHER is unused */
+    uint64_t            wait_ns;                            /**< asked of nand_wait(), in ns as most delays are below 1 us */
+    uint64_t            ready_usec;                         /**< spent waiting for R/B# */
+    uint32_t            timeouts;                           /**< R/B# waits that ran out */
+    uint32_t            ecc_corrected_bits;                 /**< bitflips corrected by the host or the on-die ECC */
+    uint32_t            ecc_failed;                         /**< mtd reads of pages the ECC could not correct */
+    const nand_t*       nand;                               /**< last NAND initialized, for `nand info` */
+} nand_stats_t;
+
+#if IS_USED(MODULE_NAND_STATS) || DOXYGEN
+extern nand_stats_t nand_stats;
+
+/**
+ * @brief   Sets all counters to zero, the NAND stays registered
+ */
+void nand_stats_reset(void);
+
+/**
+ * @brief   Counts a finished operation
+ *
+ * @param[in]   ops     nand_stats.cmd or nand_stats.mtd entry of the operation
+ * @param[in]   start   nand_stats_now() when it began
+ * @param[in]   bytes   data bytes moved
+ * @param[in]   ok      false if it failed
+ */
+void nand_stats_op(nand_stats_ops_t* const ops, const uint32_t start, const size_t bytes, const bool ok);
+
+/**
+ * @brief   Type of a command, by the first command cycle of its chains
+ */
+nand_stats_op_t nand_stats_cmd_op(const uint8_t first_cmd);
+
+static inline uint32_t nand_stats_now(void) {
+    return ztimer_now(ZTIMER_USEC);
+}
+
+static inline void nand_stats_register(const nand_t* const nand) {
+    nand_stats.nand = nand;
+}
+
+static inline void nand_stats_cmd(const uint8_t first_cmd, const uint32_t start, const size_t bytes, const bool ok) {
+    nand_stats_op(&(nand_stats.cmd[nand_stats_cmd_op(first_cmd)]), start, bytes, ok);
+}
+
+static inline void nand_stats_mtd(const nand_stats_op_t op, const uint32_t start, const int res) {
+    nand_stats_op(&(nand_stats.mtd[op]), start, (res > 0) ? (size_t)res : 0, res >= 0);
+
+    if(res == -EBADMSG) {
+        ++(nand_stats.ecc_failed);
+    }
+}
+
+static inline void nand_stats_wait(const uint32_t delay_ns) {
+    nand_stats.wait_ns += delay_ns;
+}
+
+static inline void nand_stats_ready(const uint32_t start, const bool ready) {
+    nand_stats.ready_usec += nand_stats_now() - start;
+
+    if(! ready) {
+        ++(nand_stats.timeouts);
+    }
+}
+
+static inline void nand_stats_ecc(const size_t corrected_bits) {
+    nand_stats.ecc_corrected_bits += corrected_bits;
+}
+#else
+static inline uint32_t nand_stats_now(void) {
+    return 0;
+}
+
+static inline void nand_stats_register(const nand_t* const nand) {
+    (void)nand;
+}
+
+static inline void nand_stats_cmd(const uint8_t first_cmd, const uint32_t start, const size_t bytes, const bool ok) {
+    (void)first_cmd;
+    (void)start;
+    (void)bytes;
+    (void)ok;
+}
+
+static inline void nand_stats_mtd(const nand_stats_op_t op, const uint32_t start, const int res) {
+    (void)op;
+    (void)start;
+    (void)res;
+}
+
+static inline void nand_stats_wait(const uint32_t delay_ns) {
+    (void)delay_ns;
+}
+
+static inline void nand_stats_ready(const uint32_t start, const bool ready) {
+    (void)start;
+    (void)ready;
+}
+
+static inline void nand_stats_ecc(const size_t corrected_bits) {
+    (void)corrected_bits;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_STATS_H */
+/** @} */
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @defgroup    drivers_nand_trace NAND command trace
+ * @ingroup     drivers_storage
+ * @brief       Ring buffer of the steps of the last NAND commands.
+ * @anchor      drivers_nand_trace
+ * @{
+ *
+ * With the `nand_trace` module, nand_run_cmd_chains() records an event for
+ * every chain it runs, one for every wait on R/B# and one for the whole
+ * command when it ends or times out. Each event carries the first command
+ * cycle of the command, the LUN, the row of its last address chain, the
+ * phase, the start time from `ZTIMER_USEC` and the duration, so a slow page
+ * read can be told apart into R/B#, bus and retries afterwards.
+ *
+ * Events go to a ring buffer of @ref CONFIG_NAND_TRACE_EVENTS entries, the
+ * oldest are overwritten. A slot is taken by an atomic increment, so
+ * recording never blocks. A dump running at the same time as a command may
+ * show a half written event. With the `trace` module each event is also
+ * passed to trace(), packed as phase, command, cycle and LUN in one word.
+ *
+ * The command the steps belong to is kept in the @ref nand_t it runs on, so
+ * commands on different NANDs do not mix up their events.
+ *
+ * Recording costs a ztimer_now() and a few stores per chain. Without the
+ * module the hooks are empty inlines.
+ *
+ * @file
+ * @brief       Public interface for the nand_trace module.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_TRACE_H
+#define NAND_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kernel_defines.h"
+
+#if IS_USED(MODULE_NAND_TRACE)
+#include "ztimer.h"
+#endif
+
+#ifndef CONFIG_NAND_TRACE_EVENTS
+#define CONFIG_NAND_TRACE_EVENTS            (64)    /**< events kept, a power of two */
+#endif
+
+typedef enum {
+    NAND_TRACE_CMD          = 0,    /**< command cycle, @c cycle is the opcode */
+    NAND_TRACE_ADDR         = 1,    /**< address cycles */
+    NAND_TRACE_DATA_IN      = 2,    /**< data cycles to the NAND */
+    NAND_TRACE_DATA_OUT     = 3,    /**< data cycles from the NAND */
+    NAND_TRACE_READY        = 4,    /**< wait on R/B#, @c cycle is 1 if it went ready */
+    NAND_TRACE_TIMEOUT      = 5,    /**< command given up, the duration is that of the whole command */
+    NAND_TRACE_END          = 6,    /**< command done, the duration is that of the whole command */
+    NAND_TRACE_PHASE_NUMOF
+} nand_trace_phase_t;
+
+typedef struct {
+    uint32_t            time;       /**< start, ZTIMER_USEC */
+    uint32_t            duration;   /**< us */
+    uint32_t            row;        /**< row of the last address chain of the command */
+    uint8_t             cmd;        /**< first command cycle of the command */
+    uint8_t             cycle;      /**< depends on the phase */
+    uint8_t             lun;        /**< LUN the command runs on */
+    uint8_t             phase;      /**< nand_trace_phase_t */
+} nand_trace_event_t;
+
+struct nand;
+
+#if IS_USED(MODULE_NAND_TRACE) || DOXYGEN
+/**
+ * @brief   The command the following steps belong to, one per NAND
+ */
+typedef struct {
+    uint32_t            start;      /**< start of the command */
+    uint32_t            row;        /**< row of its last address chain */
+    uint8_t             cmd;        /**< first command cycle */
+    uint8_t             lun;        /**< LUN */
+} nand_trace_ctx_t;
+
+/**
+ * @brief   Prints the events from the oldest to the newest
+ */
+void nand_trace_dump(void);
+
+/**
+ * @brief   Drops all events
+ */
+void nand_trace_reset(void);
+
+/**
+ * @brief   Starts a command on @p nand, its steps are recorded with its context
+ *
+ * @return  start of the command, the start of the first step
+ */
+uint32_t nand_trace_begin(struct nand* const nand, const uint8_t cmd, const uint8_t lun_no);
+
+/**
+ * @brief   Sets the row of the command running on @p nand
+ */
+void nand_trace_row(struct nand* const nand, const uint64_t row);
+
+/**
+ * @brief   Stores an event of the command running on @p nand in the ring buffer
+ *
+ * @return  end of the event, the start of the next step
+ */
+uint32_t nand_trace_step(const struct nand* const nand, const nand_trace_phase_t phase, const uint8_t cycle, const uint32_t start);
+
+/**
+ * @brief   Stores the end of the command running on @p nand, its duration is that of the whole command
+ */
+void nand_trace_end(const struct nand* const nand, const bool ok);
+
+static inline uint32_t nand_trace_now(void) {
+    return ztimer_now(ZTIMER_USEC);
+}
+#else
+static inline uint32_t nand_trace_now(void) {
+    return 0;
+}
+
+static inline uint32_t nand_trace_begin(struct nand* const nand, const uint8_t cmd, const uint8_t lun_no) {
+    (void)nand;
+    (void)cmd;
+    (void)lun_no;
+
+    return 0;
+}
+
+static inline void nand_trace_row(struct nand* const nand, const uint64_t row) {
+    (void)nand;
+    (void)row;
+}
+
+static inline uint32_t nand_trace_step(const struct nand* const nand, const nand_trace_phase_t phase, const uint8_t cycle, const uint32_t start) {
+    (void)nand;
+    (void)phase;
+    (void)cycle;
+    (void)start;
+
+    return 0;
+}
+
+static inline void nand_trace_end(const struct nand* const nand, const bool ok) {
+    (void)nand;
+    (void)ok;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_TRACE_H */
+/** @} */
@@ -27,6 +27,7 @@ _* This file is subject to the terms and conditions of the GNU Lesser
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -73,6 +74,7 @@ struct _nand_raw_t {
     size_t                      buffer_size;                        // Zero-able
     size_t                      current_buffer_seq;
     size_t                      current_raw_offset;
+    bool                        buffer_advance;                     // Move buffer past each transferred chunk
 };
 
 union _nand_cmd_cycles_t {
@@ -101,12 +103,28 @@ struct _nand_cmd_t {
 struct _nand_cmd_params_t {
     uint8_t                     lun_no;
     nand_cmd_t*                 cmd_override;                       // Nullable
+    void*                       hook_arg;                           // Nullable, passed through to the hooks
 };
 
 size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand_cmd_params_t* const cmd_params, nand_rw_response_t* const err);
 
 size_t nand_cmd_base_cmdw_addrsgw_rawsgr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, uint8_t* const buffer, const size_t buffer_size);
+size_t nand_cmd_base_cmdw_addrw_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrw_cmdw_rawr_hooked(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrw_raww_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, const uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrw_raww_cmdw_hooked(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, const uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrrw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_row, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrsgw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint16_t addr_single, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrsgw_raww(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint16_t addr_single, const uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_addrw_cmdw_cmdw_rawr_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, uint8_t* const status, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+size_t nand_cmd_base_cmdw_cmdw_rawr_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, uint8_t* const status, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err);
+void nand_cmd_base_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, nand_rw_response_t* const err);
+void nand_cmd_base_cmdw_addrrw_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_row, nand_rw_response_t* const err);
+void nand_cmd_base_cmdw_addrw_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, nand_rw_response_t* const err);
 size_t nand_cmd_read_id(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const id_cmd, uint8_t* const bytes_id, const size_t bytes_id_max_size);
+/** Reads the ID into nand_t::nand_id, keeping NAND_ID_KEEP_SIZE bytes of it, returns its full size */
+size_t nand_cmd_read_nand_id(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const id_cmd);
 size_t nand_cmd_read_parameter_page(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const pp_cmd, uint8_t* const bytes_pp, const size_t bytes_pp_max_size);
 
 size_t nand_extract_id(uint8_t* const bytes_id, const size_t bytes_id_size);
@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_bbm
+ * @{
+ *
+ * @file
+ * @brief       mtd bad block remapping for ONFI NANDs
+ *
+ * Logical blocks [0, pool_start) map to themselves unless the bad block
+ * table records a replacement, the pool is [pool_start, user blocks).
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "mtd_nand_bbm.h"
+#include "mtd_nand_onfi.h"
+#include "nand.h"
+#include "nand/onfi.h"
+#include "nand/ecc.h"
+#include "nand/bbt.h"
+#include "mtd.h"
+#include "mutex.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define MTD_NAND_BBM_NO_SPARE               (UINT32_MAX)
+
+static inline uint32_t _physical_page(const mtd_nand_bbm_t* const bbm, const uint32_t page_no) {
+    const uint32_t pages_per_block = bbm->base.pages_per_sector;
+
+    return bbm->map[page_no / pages_per_block] * pages_per_block + page_no % pages_per_block;
+}
+
+static uint32_t _find_spare(const mtd_nand_bbm_t* const bbm) {
+    const nand_bbt_t* const bbt     = &(bbm->parent->bbt);
+          uint32_t          spare   = MTD_NAND_BBM_NO_SPARE;
+
+    mutex_lock(&(bbm->parent->nand_onfi->nand.lock));
+    for(uint32_t block_no = bbm->pool_start; block_no < nand_bbt_user_blocks(bbt); ++block_no) {
+        if(! nand_bbt_is_bad(bbt, block_no) && ! nand_bbt_is_replacement(bbt, block_no)) {
+            spare = block_no;
+            break;
+        }
+    }
+    mutex_unlock(&(bbm->parent->nand_onfi->nand.lock));
+
+    return spare;
+}
+
+/** The table is stored on the NAND, under the lock of the parent like its own retirements */
+static void _mark_bad(mtd_nand_onfi_t* const parent, const uint32_t block_no) {
+    mutex_lock(&(parent->nand_onfi->nand.lock));
+    nand_bbt_mark_bad(&(parent->bbt), block_no);
+    mutex_unlock(&(parent->nand_onfi->nand.lock));
+}
+
+static bool _is_erased(const uint8_t* const buffer, const size_t size) {
+    for(size_t pos = 0; pos < size; ++pos) {
+        if(buffer[pos] != 0xFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Returns < 0 if the page could not be moved. @p spare_failed tells whether
+ * the destination failed, a source that cannot be read is reported as is.
+ */
+static int _move_page(mtd_nand_bbm_t* const bbm, const uint32_t src_page_no, const uint32_t dst_page_no, bool* const spare_failed) {
+          mtd_nand_onfi_t*    const parent    = bbm->parent;
+    const uint32_t                  page_size = parent->base.page_size;
+
+    /** Copyback bypasses the host ECC, so flips would be copied along */
+    if(! nand_ecc_on_host(&(parent->ecc))) {
+        switch(mtd_nand_onfi_copyback(parent, src_page_no, dst_page_no)) {
+        case 0:
+            return 0;
+
+        case -ENOTSUP:                  /**< other plane, through the host */
+            break;
+
+        default:
+            *spare_failed = true;
+            return -EIO;
+        }
+    }
+
+    const int                       res       = parent->base.driver->read_page(&(parent->base), bbm->page_buffer, src_page_no, 0, page_size);
+    if(res < 0) {
+        DEBUG("mtd_nand_bbm: page %" PRIu32 " unreadable, block not moved\n", src_page_no);
+        return res;
+    }
+
+    /** Programming an erased page would make it unwritable */
+    if(_is_erased(bbm->page_buffer, page_size)) {
+        return 0;
+    }
+
+    if(parent->base.driver->write_page(&(parent->base), bbm->page_buffer, dst_page_no, 0, page_size) < 0) {
+        *spare_failed = true;
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/** Moves the first @p pages_in_use pages of a logical block to an erased pool block */
+static int _remap(mtd_nand_bbm_t* const bbm, const uint32_t logical_block_no, const uint32_t pages_in_use) {
+    mtd_nand_onfi_t*    const parent            = bbm->parent;
+    const uint32_t            pages_per_block   = bbm->base.pages_per_sector;
+
+    for(;;) {
+        const uint32_t spare = _find_spare(bbm);
+
+        if(spare == MTD_NAND_BBM_NO_SPARE) {
+            DEBUG("mtd_nand_bbm: reserve pool exhausted\n");
+            return -ENOSPC;
+        }
+
+        /** Pool blocks are user blocks of the parent, which serializes the access to the NAND */
+        if(parent->base.driver->erase_sector(&(parent->base), spare, 1) < 0) {
+            _mark_bad(parent, spare);
+            continue;
+        }
+
+        bool spare_failed = false;
+        int  res          = 0;
+        for(uint32_t page = 0; page < pages_in_use && res == 0; ++page) {
+            res = _move_page(bbm, bbm->map[logical_block_no] * pages_per_block + page, spare * pages_per_block + page, &spare_failed);
+        }
+
+        if(spare_failed) {
+            _mark_bad(parent, spare);
+            continue;
+        }
+
+        /** The mapping stays, the spare is erased again when it is handed out next */
+        if(res < 0) {
+            return res;
+        }
+
+        mutex_lock(&(parent->nand_onfi->nand.lock));
+        const nand_rw_response_t err = nand_bbt_remap(&(parent->bbt), logical_block_no, spare);
+        mutex_unlock(&(parent->nand_onfi->nand.lock));
+
+        switch(err) {
+        case NAND_RW_OK:
+            break;
+
+        case NAND_RW_NOT_SUPPORTED:
+            return -ENOSPC;
+
+        default:
+            return -EIO;
+        }
+
+        DEBUG("mtd_nand_bbm: block %" PRIu32 " moved from %" PRIu32 " to %" PRIu32 "\n", logical_block_no, bbm->map[logical_block_no], spare);
+        bbm->map[logical_block_no] = spare;
+
+        return 0;
+    }
+}
+
+static int mtd_nand_bbm_init(mtd_dev_t* const dev)
+{
+    if(dev == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_nand_bbm_t*     const bbm       = (mtd_nand_bbm_t*)dev;
+    if(bbm->parent == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_nand_onfi_t*    const parent    = bbm->parent;
+    if(parent->base.sector_count == 0) {
+        const int res = mtd_init(&(parent->base));
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    nand_bbt_t*         const bbt       = &(parent->bbt);
+    if(bbt->remaps_max >= nand_bbt_user_blocks(bbt)) {
+        return -ENOSPC;
+    }
+
+    bbm->pool_start             = nand_bbt_user_blocks(bbt) - bbt->remaps_max;
+    dev->sector_count           = bbm->pool_start;
+    dev->pages_per_sector       = parent->base.pages_per_sector;
+    dev->page_size              = parent->base.page_size;
+
+    free(bbm->map);
+    free(bbm->page_buffer);
+    bbm->map                    = (uint32_t*)malloc(sizeof(uint32_t) * dev->sector_count);
+    bbm->page_buffer            = (uint8_t*)malloc(sizeof(uint8_t) * dev->page_size);
+    if(bbm->map == NULL || bbm->page_buffer == NULL) {
+        return -ENOMEM;
+    }
+
+    for(uint32_t block_no = 0; block_no < dev->sector_count; ++block_no) {
+        bbm->map[block_no] = block_no;
+    }
+
+    for(uint16_t pos = 0; pos < bbt->remaps_count; ++pos) {
+        if(bbt->remaps[pos].block < dev->sector_count) {
+            bbm->map[bbt->remaps[pos].block] = bbt->remaps[pos].replacement;
+        }
+    }
+
+    /** Factory bad blocks, and blocks retired without a replacement */
+    for(uint32_t block_no = 0; block_no < dev->sector_count; ++block_no) {
+        if(nand_bbt_is_bad(bbt, bbm->map[block_no])) {
+            const int res = _remap(bbm, block_no, 0);
+            if(res < 0) {
+                return res;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int mtd_nand_bbm_read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_bbm_t*     const bbm       = (mtd_nand_bbm_t*)dev;
+    mtd_dev_t*          const parent    = &(bbm->parent->base);
+
+    if(page_no >= dev->sector_count * dev->pages_per_sector) {
+        return -EOVERFLOW;
+    }
+
+    return parent->driver->read_page(parent, read_buffer, _physical_page(bbm, page_no), offset, size);
+}
+
+static int mtd_nand_bbm_write_page(mtd_dev_t* const dev, const void* const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_bbm_t*     const bbm       = (mtd_nand_bbm_t*)dev;
+    mtd_dev_t*          const parent    = &(bbm->parent->base);
+    const uint32_t            block_no  = page_no / dev->pages_per_sector;
+
+    if(page_no >= dev->sector_count * dev->pages_per_sector) {
+        return -EOVERFLOW;
+    }
+
+    for(;;) {
+        const int res = parent->driver->write_page(parent, write_buffer, _physical_page(bbm, page_no), offset, size);
+
+        if(res != -EIO || ! nand_bbt_is_bad(&(bbm->parent->bbt), bbm->map[block_no])) {
+            return res;
+        }
+
+        /** The block was retired by the failed program, pages before this one move along */
+        const int remap_res = _remap(bbm, block_no, page_no % dev->pages_per_sector);
+        if(remap_res < 0) {
+            return remap_res;
+        }
+    }
+}
+
+static int mtd_nand_bbm_erase_block(mtd_dev_t* const dev, const uint32_t block_no, const uint32_t count)
+{
+    mtd_nand_bbm_t*     const bbm       = (mtd_nand_bbm_t*)dev;
+    mtd_dev_t*          const parent    = &(bbm->parent->base);
+
+    if(block_no + count > dev->sector_count) {
+        return -EOVERFLOW;
+    }
+
+    for(uint32_t erasure_pos = block_no; erasure_pos < block_no + count; ++erasure_pos) {
+        int res = parent->driver->erase_sector(parent, bbm->map[erasure_pos], 1);
+
+        /** A replacement is erased before it is handed out */
+        if(res == -EIO && nand_bbt_is_bad(&(bbm->parent->bbt), bbm->map[erasure_pos])) {
+            res = _remap(bbm, erasure_pos, 0);
+        }
+
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    return 0;
+}
+
+static int mtd_nand_bbm_power(mtd_dev_t *dev, enum mtd_power_state power)
+{
+    mtd_nand_bbm_t*     const bbm       = (mtd_nand_bbm_t*)dev;
+
+    return mtd_power(&(bbm->parent->base), power);
+}
+
+const mtd_desc_t mtd_nand_bbm_driver = {
+    .init           = mtd_nand_bbm_init,
+    .read_page      = mtd_nand_bbm_read_page,
+    .write_page     = mtd_nand_bbm_write_page,
+    .erase_sector   = mtd_nand_bbm_erase_block,
+    .power          = mtd_nand_bbm_power,
+};
@@ -0,0 +1,1151 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_ftl
+ * @{
+ *
+ * @file
+ * @brief       mtd page mapped flash translation layer for ONFI NANDs
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "mtd_nand_ftl.h"
+#include "mtd_nand_ftl_internal.h"
+#include "mtd_nand_onfi.h"
+#include "nand.h"
+#include "nand/bbt.h"
+#include "checksum/crc16_ccitt.h"
+#include "bitfield.h"
+#include "mutex.h"
+#include "thread.h"
+#include "thread_flags.h"
+#include "mtd.h"
+#include "kernel_defines.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define MTD_NAND_FTL_ERASER_FLAG            (1u << 0)
+
+/** Spare bytes of the first page of a block, if they have room for the erase count */
+typedef struct __attribute__((packed)) {
+    mtd_nand_ftl_meta_t meta;
+    mtd_nand_ftl_wear_t wear;
+} _first_record_t;
+
+static inline bool _wear_fits(const mtd_nand_ftl_t* const ftl) {
+    return mtd_nand_onfi_oob_size(ftl->parent) >= sizeof(_first_record_t);
+}
+
+static inline uint16_t _wear_crc(const mtd_nand_ftl_wear_t* const wear) {
+    return crc16_ccitt_calc((const uint8_t*)wear, offsetof(mtd_nand_ftl_wear_t, crc));
+}
+
+static void _wake_eraser(const mtd_nand_ftl_t* const ftl) {
+    if(ftl->eraser != KERNEL_PID_UNDEF) {
+        thread_flags_set(thread_get(ftl->eraser), MTD_NAND_FTL_ERASER_FLAG);
+    }
+}
+
+static void _unmap(mtd_nand_ftl_t* const ftl, const uint32_t logical) {
+    if(ftl->l2p[logical] != MTD_NAND_FTL_UNMAPPED) {
+        ftl->valid[_block_of(ftl, ftl->l2p[logical])]--;
+        ftl->l2p[logical] = MTD_NAND_FTL_UNMAPPED;
+    }
+}
+
+/** Forgets the pages of a block that could not be moved, their data is lost */
+static void _drop_block(mtd_nand_ftl_t* const ftl, const uint32_t block) {
+    for(uint32_t logical = 0; logical < ftl->logical_pages && ftl->valid[block] > 0; ++logical) {
+        if(ftl->l2p[logical] != MTD_NAND_FTL_UNMAPPED && _block_of(ftl, ftl->l2p[logical]) == block) {
+            DEBUG("mtd_nand_ftl: logical page %" PRIu32 " lost\n", logical);
+            _unmap(ftl, logical);
+        }
+    }
+}
+
+/** Whether the tables are allocated, an init succeeded */
+static inline bool _initialized(const mtd_nand_ftl_t* const ftl) {
+    return ftl->l2p != NULL && ftl->pool != NULL;
+}
+
+static uint32_t _find_free_block(mtd_nand_ftl_t* const ftl) {
+    /** Only blocks the init after a reboot is going to replay */
+    if(ftl->checkpointed) {
+        while(ftl->pool_pos < ftl->pool_count) {
+            const uint32_t block = ftl->pool[ftl->pool_pos++];
+
+            if(ftl->block_state[block] == MTD_NAND_FTL_BLOCK_FREE) {
+                return block;
+            }
+        }
+
+        return MTD_NAND_FTL_NO_BLOCK;
+    }
+
+    /** Least worn first, ties are taken in turns */
+    uint32_t found = MTD_NAND_FTL_NO_BLOCK;
+    for(uint32_t pos = 0; pos < ftl->block_count; ++pos) {
+        const uint32_t block = (ftl->alloc_cursor + pos) % ftl->block_count;
+
+        if(ftl->block_state[block] == MTD_NAND_FTL_BLOCK_FREE && (found == MTD_NAND_FTL_NO_BLOCK || ftl->erase_count[block] < ftl->erase_count[found])) {
+            found = block;
+        }
+    }
+
+    if(found != MTD_NAND_FTL_NO_BLOCK) {
+        ftl->alloc_cursor = (found + 1) % ftl->block_count;
+    }
+
+    return found;
+}
+
+/** Most worn free block, cold data parked there keeps it from wearing further */
+static uint32_t _find_worn_free_block(const mtd_nand_ftl_t* const ftl) {
+    uint32_t found = MTD_NAND_FTL_NO_BLOCK;
+    for(uint32_t block = ftl->checkpoint_blocks; block < ftl->block_count; ++block) {
+        if(ftl->block_state[block] == MTD_NAND_FTL_BLOCK_FREE && (found == MTD_NAND_FTL_NO_BLOCK || ftl->erase_count[block] > ftl->erase_count[found])) {
+            found = block;
+        }
+    }
+
+    return found;
+}
+
+/** Whether @p a is worth collecting before @p b, (1 - u) * age / 2u compared without division */
+static bool _cost_benefit_better(const mtd_nand_ftl_t* const ftl, const uint32_t a, const uint32_t b) {
+    const uint32_t pages_per_block  = _pages_per_block(ftl);
+    const uint64_t benefit_a        = (uint64_t)(pages_per_block - ftl->valid[a]) * (ftl->seq - ftl->block_seq[a]);
+    const uint64_t benefit_b        = (uint64_t)(pages_per_block - ftl->valid[b]) * (ftl->seq - ftl->block_seq[b]);
+
+    return benefit_a * ftl->valid[b] > benefit_b * ftl->valid[a];
+}
+
+static uint32_t _pick_victim(const mtd_nand_ftl_t* const ftl) {
+    const uint32_t  pages_per_block = _pages_per_block(ftl);
+          uint32_t  victim          = MTD_NAND_FTL_NO_BLOCK;
+
+    for(uint32_t block = 0; block < ftl->block_count; ++block) {
+        /** Retired blocks go first, their pages are at risk */
+        if(ftl->block_state[block] == MTD_NAND_FTL_BLOCK_RETIRED) {
+            return block;
+        }
+
+        if(ftl->block_state[block] != MTD_NAND_FTL_BLOCK_USED || ftl->valid[block] == pages_per_block) {
+            continue;
+        }
+
+        /** Ties go to the less worn block, so a fixed scan order does not wear out the first blocks */
+        if(victim == MTD_NAND_FTL_NO_BLOCK) {
+            victim = block;
+        } else if(IS_ACTIVE(CONFIG_MTD_NAND_FTL_GC_COST_BENEFIT)) {
+            if(_cost_benefit_better(ftl, block, victim) ||
+               (! _cost_benefit_better(ftl, victim, block) && ftl->erase_count[block] < ftl->erase_count[victim])) {
+                victim = block;
+            }
+        } else if(ftl->valid[block] < ftl->valid[victim] ||
+                  (ftl->valid[block] == ftl->valid[victim] && ftl->erase_count[block] < ftl->erase_count[victim])) {
+            victim = block;
+        }
+    }
+
+    return victim;
+}
+
+static int _erase_block(mtd_nand_ftl_t* const ftl, const uint32_t block) {
+    mtd_nand_onfi_t*    const parent            = ftl->parent;
+
+    const int res = parent->base.driver->erase_sector(&(parent->base), ftl->first_block + block, 1);
+    if(res < 0) {
+        return res;
+    }
+
+    ftl->erase_count[block]    += 1;
+    ftl->wl_erases             += 1;
+
+    return 0;
+}
+
+/** Opens the free @p block, it is marked bad if it does not erase */
+static int _take_block(mtd_nand_ftl_t* const ftl, const uint32_t block) {
+    ftl->free_blocks -= 1;
+
+    /** Not erased ahead, the program waits for it */
+    if(! mtd_nand_onfi_block_erased(ftl->parent, ftl->first_block + block) && _erase_block(ftl, block) < 0) {
+        ftl->block_state[block] = MTD_NAND_FTL_BLOCK_BAD;
+        return -EIO;
+    }
+
+    ftl->block_state[block]     = MTD_NAND_FTL_BLOCK_OPEN;
+    ftl->open_block             = block;
+    ftl->open_page              = 0;
+    _wake_eraser(ftl);
+
+    return 0;
+}
+
+static int _collect(mtd_nand_ftl_t* const ftl);
+static int _wear_level(mtd_nand_ftl_t* const ftl);
+
+static int _open_block(mtd_nand_ftl_t* const ftl, const bool gc) {
+    if(! gc) {
+        /** Blocks freed now are handed out by the next checkpoint, keep enough of them for a full pool */
+        while(ftl->free_blocks <= (uint32_t)CONFIG_MTD_NAND_FTL_GC_RESERVE + ftl->pool_max) {
+            const int res = _collect(ftl);
+            if(res < 0) {
+                return res;
+            }
+        }
+
+        if(ftl->wl_erases >= CONFIG_MTD_NAND_FTL_WL_INTERVAL) {
+            const int res = _wear_level(ftl);
+            if(res < 0) {
+                return res;
+            }
+        }
+
+        /** Moving valid pages may have opened a block already */
+        if(ftl->open_block != MTD_NAND_FTL_NO_BLOCK) {
+            return 0;
+        }
+    }
+
+    for(;;) {
+        uint32_t block = _find_free_block(ftl);
+
+        /** The pool is used up, the next checkpoint hands out a new one */
+        if(block == MTD_NAND_FTL_NO_BLOCK && ftl->checkpointed) {
+            const int res = mtd_nand_ftl_checkpoint_write(ftl);
+            if(res < 0) {
+                return res;
+            }
+            block = _find_free_block(ftl);
+        }
+
+        if(block == MTD_NAND_FTL_NO_BLOCK) {
+            DEBUG("mtd_nand_ftl: no free block left\n");
+            return -ENOSPC;
+        }
+
+        if(_take_block(ftl, block) == 0) {
+            return 0;
+        }
+    }
+}
+
+/**
+ * Programs @p data to the next page of the open block, with @p record_logical
+ * and the next sequence number in its record. The garbage collector may only
+ * run if @p gc is false. The caller takes the sequence number on success.
+ */
+static int _program_record(mtd_nand_ftl_t* const ftl, const uint32_t record_logical, const void* const data, const bool gc, uint32_t* const physical_page) {
+    const uint32_t pages_per_block = _pages_per_block(ftl);
+
+    for(;;) {
+        if(ftl->open_block != MTD_NAND_FTL_NO_BLOCK && ftl->open_page == pages_per_block) {
+            ftl->block_state[ftl->open_block] = MTD_NAND_FTL_BLOCK_USED;
+            ftl->open_block = MTD_NAND_FTL_NO_BLOCK;
+        }
+
+        if(ftl->open_block == MTD_NAND_FTL_NO_BLOCK) {
+            const int res = _open_block(ftl, gc);
+            if(res < 0) {
+                return res;
+            }
+            continue;
+        }
+
+        const uint32_t      block           = ftl->open_block;
+        const uint32_t      page            = ftl->open_page++;
+        _first_record_t     record          = {
+            .meta = {
+                .logical    = record_logical,
+                .seq        = ftl->seq + 1,
+            },
+            .wear = {
+                .erase_count = ftl->erase_count[block],
+            },
+        };
+        record.meta.crc = _meta_crc(&(record.meta));
+        record.wear.crc = _wear_crc(&(record.wear));
+
+        *physical_page = _physical_page(ftl, block, page);
+
+        const size_t        record_size     = (page == 0 && _wear_fits(ftl)) ? sizeof(record) : sizeof(record.meta);
+        const int           res             = mtd_nand_onfi_write_page_oob(ftl->parent, *physical_page, data, &record, record_size);
+
+        /** The parent retired the block, pages already in there are moved by the next collection */
+        if(res == -EIO) {
+            DEBUG("mtd_nand_ftl: program of page %" PRIu32 " failed\n", *physical_page);
+            ftl->block_state[block] = (ftl->valid[block] > 0) ? MTD_NAND_FTL_BLOCK_RETIRED : MTD_NAND_FTL_BLOCK_BAD;
+            ftl->open_block = MTD_NAND_FTL_NO_BLOCK;
+            continue;
+        }
+
+        if(res < 0) {
+            return res;
+        }
+
+        ftl->seq               += 1;
+        ftl->block_seq[block]   = ftl->seq;
+
+        return 0;
+    }
+}
+
+/** Programs @p data as the newest copy of @p logical, the garbage collector may only run if @p gc is false */
+static int _append(mtd_nand_ftl_t* const ftl, const uint32_t logical, const void* const data, const bool gc) {
+    uint32_t            physical_page;
+
+    const int           res             = _program_record(ftl, logical, data, gc, &physical_page);
+    if(res < 0) {
+        return res;
+    }
+
+    _unmap(ftl, logical);
+    ftl->l2p[logical]                           = physical_page;
+    ftl->valid[_block_of(ftl, physical_page)]  += 1;
+
+    return 0;
+}
+
+/**
+ * Logs the pages of @p trim which are still unmapped again, one trim page
+ * per run of them. Pages written after the trim are mapped and left out, so
+ * the higher sequence number does not unmap them on a scan.
+ */
+static int _move_trim(mtd_nand_ftl_t* const ftl, const mtd_nand_ftl_trim_t* const trim) {
+    uint32_t logical = trim->first_logical;
+
+    while(logical < trim->end_logical) {
+        if(ftl->l2p[logical] != MTD_NAND_FTL_UNMAPPED) {
+            ++logical;
+            continue;
+        }
+
+        mtd_nand_ftl_trim_t run = {
+            .first_logical  = logical,
+        };
+        while(logical < trim->end_logical && ftl->l2p[logical] == MTD_NAND_FTL_UNMAPPED) {
+            ++logical;
+        }
+        run.end_logical = logical;
+
+        uint32_t physical_page;
+        memset(ftl->gc_buffer, 0xFF, _data_page_size(ftl));
+        memcpy(ftl->gc_buffer, &run, sizeof(run));
+
+        const int res = _program_record(ftl, MTD_NAND_FTL_TRIM_PAGE, ftl->gc_buffer, true, &physical_page);
+        if(res < 0) {
+            return res;
+        }
+        bf_set(ftl->trimmed, _block_of(ftl, physical_page));
+    }
+
+    return 0;
+}
+
+/**
+ * Keeps the trims of @p victim from being erased with it. A checkpoint
+ * holds them in its map, without one they are moved.
+ */
+static int _save_trims(mtd_nand_ftl_t* const ftl, const uint32_t victim) {
+    mtd_nand_onfi_t*    const parent            = ftl->parent;
+    const uint32_t            pages_per_block   = _pages_per_block(ftl);
+
+    if(ftl->checkpointed && mtd_nand_ftl_checkpoint_write(ftl) == 0) {
+        return 0;
+    }
+
+    for(uint32_t page = 0; page < pages_per_block; ++page) {
+        const uint32_t      physical_page   = _physical_page(ftl, victim, page);
+        mtd_nand_ftl_meta_t meta;
+        mtd_nand_ftl_trim_t trim;
+
+        if(mtd_nand_onfi_read_oob(parent, physical_page, &meta, sizeof(meta)) < 0 || ! _meta_trim(&meta) ||
+           mtd_nand_ftl_read_trim(ftl, physical_page, ftl->gc_buffer, &trim) < 0) {
+            continue;
+        }
+
+        const int res = _move_trim(ftl, &trim);
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    bf_unset(ftl->trimmed, victim);
+
+    return 0;
+}
+
+/** Moves the valid pages out of @p victim, it is erased when opened again */
+static int _collect_block(mtd_nand_ftl_t* const ftl, const uint32_t victim) {
+    mtd_nand_onfi_t*    const parent            = ftl->parent;
+    const uint32_t            pages_per_block   = _pages_per_block(ftl);
+
+    DEBUG("mtd_nand_ftl: collecting block %" PRIu32 " with %u valid pages\n", victim, ftl->valid[victim]);
+
+    /** Trim pages count as stale, but older copies of their pages may still be out there */
+    if(bf_isset(ftl->trimmed, victim)) {
+        const int res = _save_trims(ftl, victim);
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    for(uint32_t page = 0; page < pages_per_block && ftl->valid[victim] > 0; ++page) {
+        const uint32_t      physical_page   = _physical_page(ftl, victim, page);
+        mtd_nand_ftl_meta_t meta;
+
+        /** Stale pages are told apart by their record, without moving their data */
+        if(mtd_nand_onfi_read_oob(parent, physical_page, &meta, sizeof(meta)) < 0 || ! _meta_valid(ftl, &meta) || ftl->l2p[meta.logical] != physical_page) {
+            continue;
+        }
+
+        if(parent->base.driver->read_page(&(parent->base), ftl->gc_buffer, physical_page, 0, _data_page_size(ftl)) < 0) {
+            continue;
+        }
+
+        const int res = _append(ftl, meta.logical, ftl->gc_buffer, true);
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    /** Unreadable pages, or pages whose spare bytes got corrupted */
+    if(ftl->valid[victim] > 0) {
+        _drop_block(ftl, victim);
+    }
+
+    if(ftl->block_state[victim] == MTD_NAND_FTL_BLOCK_RETIRED) {
+        ftl->block_state[victim] = MTD_NAND_FTL_BLOCK_BAD;
+        return 0;
+    }
+
+    ftl->block_state[victim]    = MTD_NAND_FTL_BLOCK_FREE;
+    ftl->free_blocks           += 1;
+    _wake_eraser(ftl);
+
+    return 0;
+}
+
+static int _collect(mtd_nand_ftl_t* const ftl) {
+    const uint32_t victim = _pick_victim(ftl);
+
+    if(victim == MTD_NAND_FTL_NO_BLOCK) {
+        DEBUG("mtd_nand_ftl: nothing to collect\n");
+        return -ENOSPC;
+    }
+
+    return _collect_block(ftl, victim);
+}
+
+static int _wear_level(mtd_nand_ftl_t* const ftl) {
+    uint32_t coldest    = MTD_NAND_FTL_NO_BLOCK;
+    uint32_t most_worn  = 0;
+
+    ftl->wl_erases = 0;
+
+    if(CONFIG_MTD_NAND_FTL_WL_THRESHOLD == 0) {
+        return 0;
+    }
+
+    for(uint32_t block = ftl->checkpoint_blocks; block < ftl->block_count; ++block) {
+        switch(ftl->block_state[block]) {
+        case MTD_NAND_FTL_BLOCK_USED:
+            if(coldest == MTD_NAND_FTL_NO_BLOCK || ftl->erase_count[block] < ftl->erase_count[coldest]) {
+                coldest = block;
+            }
+            /* fall through */
+        case MTD_NAND_FTL_BLOCK_FREE:
+        case MTD_NAND_FTL_BLOCK_OPEN:
+            if(ftl->erase_count[block] > most_worn) {
+                most_worn = ftl->erase_count[block];
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    /** Collecting a block takes a free one for its valid pages */
+    if(coldest == MTD_NAND_FTL_NO_BLOCK || most_worn - ftl->erase_count[coldest] <= CONFIG_MTD_NAND_FTL_WL_THRESHOLD || ftl->free_blocks == 0) {
+        return 0;
+    }
+
+    DEBUG("mtd_nand_ftl: moving cold block %" PRIu32 ", %" PRIu32 " erases below %" PRIu32 "\n", coldest, most_worn - ftl->erase_count[coldest], most_worn);
+
+    /** The valid pages of one block fit into the fresh one, hot writes go on behind them */
+    const uint32_t worn = _find_worn_free_block(ftl);
+    if(worn != MTD_NAND_FTL_NO_BLOCK) {
+        /** Closed early, an untouched one stays erased for later */
+        if(ftl->open_block != MTD_NAND_FTL_NO_BLOCK) {
+            if(ftl->open_page == 0) {
+                ftl->block_state[ftl->open_block]   = MTD_NAND_FTL_BLOCK_FREE;
+                ftl->free_blocks                   += 1;
+            } else {
+                ftl->block_state[ftl->open_block]   = MTD_NAND_FTL_BLOCK_USED;
+            }
+            ftl->open_block = MTD_NAND_FTL_NO_BLOCK;
+        }
+
+        if(_take_block(ftl, worn) == 0 && ftl->checkpointed) {
+            /** Only the pool is replayed, the checkpoint puts the open block first in it */
+            const int res = mtd_nand_ftl_checkpoint_write(ftl);
+            if(res < 0) {
+                return res;
+            }
+        }
+    }
+
+    const int res = _collect_block(ftl, coldest);
+
+    return (res < 0) ? res : 1;
+}
+
+/**
+ * Erases the first block of the next checkpoint, then the next free block to
+ * be opened while fewer than CONFIG_MTD_NAND_FTL_ERASE_AHEAD of them are
+ */
+static int _erase_ahead(mtd_nand_ftl_t* const ftl) {
+    mtd_nand_onfi_t*    const parent    = ftl->parent;
+          uint32_t          ready       = 0;
+          uint32_t          next        = MTD_NAND_FTL_NO_BLOCK;
+
+    if(ftl->block_state == NULL) {
+        return 0;
+    }
+
+    /** It holds an older checkpoint only, the next checkpoint erases it anyway */
+    const uint32_t            area      = mtd_nand_ftl_checkpoint_next(ftl);
+    if(area != MTD_NAND_FTL_NO_BLOCK && ! mtd_nand_onfi_block_erased(parent, ftl->first_block + area)) {
+        /** Retired, so the next checkpoint steps over it and this is not retried forever */
+        if(parent->base.driver->erase_sector(&(parent->base), ftl->first_block + area, 1) < 0) {
+            DEBUG("mtd_nand_ftl: erase of checkpoint block %" PRIu32 " failed\n", area);
+            nand_bbt_mark_bad(&(parent->bbt), ftl->first_block + area);
+        }
+        return 1;
+    }
+
+    /** The rest of the pool is opened in pool order */
+    for(uint16_t pos = ftl->pool_pos; ftl->checkpointed && pos < ftl->pool_count; ++pos) {
+        const uint32_t block = ftl->pool[pos];
+
+        if(ftl->block_state[block] != MTD_NAND_FTL_BLOCK_FREE) {
+            continue;
+        }
+        if(! mtd_nand_onfi_block_erased(parent, ftl->first_block + block)) {
+            next = block;
+            break;
+        }
+        ready += 1;
+    }
+
+    /** Then the least worn blocks, the next pool takes the erased ones first */
+    if(next == MTD_NAND_FTL_NO_BLOCK) {
+        ready = 0;
+
+        for(uint32_t block = ftl->checkpoint_blocks; block < ftl->block_count; ++block) {
+            if(ftl->block_state[block] != MTD_NAND_FTL_BLOCK_FREE) {
+                continue;
+            }
+            if(mtd_nand_onfi_block_erased(parent, ftl->first_block + block)) {
+                ready += 1;
+            } else if(next == MTD_NAND_FTL_NO_BLOCK || ftl->erase_count[block] < ftl->erase_count[next]) {
+                next = block;
+            }
+        }
+    }
+
+    if(next == MTD_NAND_FTL_NO_BLOCK || ready >= CONFIG_MTD_NAND_FTL_ERASE_AHEAD) {
+        return 0;
+    }
+
+    if(_erase_block(ftl, next) < 0) {
+        ftl->block_state[next]  = MTD_NAND_FTL_BLOCK_BAD;
+        ftl->free_blocks       -= 1;
+    }
+
+    return 1;
+}
+
+int mtd_nand_ftl_read_trim(mtd_nand_ftl_t* const ftl, const uint32_t physical_page, uint8_t* const buffer, mtd_nand_ftl_trim_t* const trim) {
+    mtd_nand_onfi_t*    const parent    = ftl->parent;
+
+    const int                 res       = parent->base.driver->read_page(&(parent->base), buffer, physical_page, 0, _data_page_size(ftl));
+    if(res < 0) {
+        return res;
+    }
+
+    memcpy(trim, buffer, sizeof(*trim));
+    if(trim->end_logical > ftl->logical_pages) {
+        trim->end_logical = ftl->logical_pages;
+    }
+
+    return 0;
+}
+
+/** Erase count kept with the first page of a programmed block */
+static int _stored_erase_count(const mtd_nand_ftl_t* const ftl, const uint32_t block, uint32_t* const erase_count) {
+    _first_record_t record;
+
+    if(! _wear_fits(ftl)) {
+        return -ENOTSUP;
+    }
+
+    const int res = mtd_nand_onfi_read_oob(ftl->parent, _physical_page(ftl, block, 0), &record, sizeof(record));
+    if(res < 0) {
+        return res;
+    }
+
+    if(record.meta.crc != _meta_crc(&(record.meta)) || record.wear.crc != _wear_crc(&(record.wear))) {
+        return -EBADMSG;
+    }
+
+    *erase_count = record.wear.erase_count;
+
+    return 0;
+}
+
+/** Gives blocks without a stored erase count the mean of the others */
+static void _estimate_erase_counts(mtd_nand_ftl_t* const ftl, const uint8_t* const known) {
+    uint64_t sum    = 0;
+    uint32_t count  = 0;
+
+    for(uint32_t block = ftl->checkpoint_blocks; block < ftl->block_count; ++block) {
+        if(known[block]) {
+            sum    += ftl->erase_count[block];
+            count  += 1;
+        }
+    }
+
+    for(uint32_t block = ftl->checkpoint_blocks; block < ftl->block_count; ++block) {
+        if(! known[block]) {
+            ftl->erase_count[block] = count ? sum / count : 0;
+        }
+    }
+}
+
+/**
+ * Rebuilds the map from the spare bytes of every programmed page, the newest
+ * copy of a logical page wins. Erased blocks and the erased tail of a block
+ * are skipped after a binary search for the first erased page.
+ */
+static int _mount(mtd_nand_ftl_t* const ftl) {
+    mtd_nand_onfi_t*    const parent            = ftl->parent;
+    uint32_t*           const seqs              = (uint32_t*)calloc(ftl->logical_pages, sizeof(uint32_t));
+    uint8_t*            const known             = (uint8_t*)calloc(ftl->block_count, sizeof(uint8_t));
+
+    if(seqs == NULL || known == NULL) {
+        free(seqs);
+        free(known);
+        return -ENOMEM;
+    }
+
+    for(uint32_t block = ftl->checkpoint_blocks; block < ftl->block_count; ++block) {
+        if(nand_bbt_is_bad(&(parent->bbt), ftl->first_block + block)) {
+            ftl->block_state[block] = MTD_NAND_FTL_BLOCK_BAD;
+            continue;
+        }
+
+        mtd_nand_ftl_meta_t     meta;
+        const int               frontier    = mtd_nand_onfi_find_frontier(parent, ftl->first_block + block, &meta, sizeof(meta));
+        if(frontier < 0) {
+            free(seqs);
+            free(known);
+            return frontier;
+        }
+
+        ftl->block_state[block] = (frontier == 0) ? MTD_NAND_FTL_BLOCK_FREE : MTD_NAND_FTL_BLOCK_USED;
+        known[block]            = (frontier > 0 && _stored_erase_count(ftl, block, &(ftl->erase_count[block])) == 0);
+
+        /** Only the records are read, not the data in front of them */
+        for(uint32_t page = 0; page < (uint32_t)frontier; ++page) {
+            const uint32_t      physical_page   = _physical_page(ftl, block, page);
+
+            if(mtd_nand_onfi_read_oob(parent, physical_page, &meta, sizeof(meta)) < 0 || ! (_meta_valid(ftl, &meta) || _meta_trim(&meta))) {
+                continue;
+            }
+
+            if(meta.seq > ftl->seq) {
+                ftl->seq = meta.seq;
+            }
+            if(meta.seq > ftl->block_seq[block]) {
+                ftl->block_seq[block] = meta.seq;
+            }
+
+            /** Blocks are not scanned in write order, a trim only unmaps copies older than itself */
+            if(_meta_trim(&meta)) {
+                mtd_nand_ftl_trim_t trim;
+
+                if(mtd_nand_ftl_read_trim(ftl, physical_page, ftl->page_buffer, &trim) < 0) {
+                    continue;
+                }
+                bf_set(ftl->trimmed, block);
+
+                for(uint32_t logical = trim.first_logical; logical < trim.end_logical; ++logical) {
+                    if(meta.seq > seqs[logical]) {
+                        ftl->l2p[logical]   = MTD_NAND_FTL_UNMAPPED;
+                        seqs[logical]       = meta.seq;
+                    }
+                }
+                continue;
+            }
+
+            if(meta.seq > seqs[meta.logical]) {
+                ftl->l2p[meta.logical]  = physical_page;
+                seqs[meta.logical]      = meta.seq;
+            }
+        }
+    }
+
+    _estimate_erase_counts(ftl, known);
+
+    free(seqs);
+    free(known);
+
+    return 0;
+}
+
+static void _free_tables(mtd_nand_ftl_t* const ftl) {
+    free(ftl->l2p);
+    free(ftl->valid);
+    free(ftl->block_state);
+    free(ftl->block_seq);
+    free(ftl->erase_count);
+    free(ftl->trimmed);
+    free(ftl->page_buffer);
+    free(ftl->gc_buffer);
+    free(ftl->checkpoint_buffer);
+    free(ftl->pool);
+    ftl->l2p            = NULL;
+    ftl->valid          = NULL;
+    ftl->block_state    = NULL;
+    ftl->block_seq      = NULL;
+    ftl->erase_count    = NULL;
+    ftl->trimmed        = NULL;
+    ftl->page_buffer    = NULL;
+    ftl->gc_buffer      = NULL;
+    ftl->checkpoint_buffer = NULL;
+    ftl->pool           = NULL;
+}
+
+static void _reset_tables(mtd_nand_ftl_t* const ftl) {
+    for(uint32_t logical = 0; logical < ftl->logical_pages; ++logical) {
+        ftl->l2p[logical] = MTD_NAND_FTL_UNMAPPED;
+    }
+
+    for(uint32_t block = 0; block < ftl->block_count; ++block) {
+        ftl->block_state[block] = (block < ftl->checkpoint_blocks) ? MTD_NAND_FTL_BLOCK_CHECKPOINT : MTD_NAND_FTL_BLOCK_FREE;
+        ftl->block_seq[block]   = 0;
+        ftl->erase_count[block] = 0;
+    }
+
+    memset(ftl->trimmed, 0, (ftl->block_count + 7) / 8);
+
+    ftl->checkpointed   = false;
+    ftl->pool_count     = 0;
+    ftl->pool_pos       = 0;
+    ftl->seq            = 0;
+}
+
+/** Derives the valid pages per block and the free blocks from the map and the block states */
+static void _count(mtd_nand_ftl_t* const ftl) {
+    ftl->free_blocks = 0;
+
+    for(uint32_t block = 0; block < ftl->block_count; ++block) {
+        ftl->valid[block] = 0;
+
+        /** The open block of a checkpoint, if it was full then */
+        if(ftl->block_state[block] == MTD_NAND_FTL_BLOCK_OPEN) {
+            ftl->block_state[block] = MTD_NAND_FTL_BLOCK_USED;
+        }
+
+        if(ftl->block_state[block] == MTD_NAND_FTL_BLOCK_FREE) {
+            ftl->free_blocks += 1;
+        }
+    }
+
+    for(uint32_t logical = 0; logical < ftl->logical_pages; ++logical) {
+        if(ftl->l2p[logical] != MTD_NAND_FTL_UNMAPPED) {
+            ftl->valid[_block_of(ftl, ftl->l2p[logical])] += 1;
+        }
+    }
+}
+
+static int _init(mtd_dev_t* const dev)
+{
+    if(dev == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+    if(ftl->parent == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_nand_onfi_t*    const parent    = ftl->parent;
+    if(parent->base.sector_count == 0) {
+        const int res = mtd_init(&(parent->base));
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    if(_data_page_size(ftl) % MTD_NAND_FTL_SECTOR_SIZE != 0) {
+        return -ENOTSUP;
+    }
+
+    if(mtd_nand_onfi_oob_size(parent) < sizeof(mtd_nand_ftl_meta_t)) {
+        DEBUG("mtd_nand_ftl_init: %u free spare bytes are too few\n", (unsigned)mtd_nand_onfi_oob_size(parent));
+        return -ENOTSUP;
+    }
+
+    const uint32_t            user_blocks   = nand_bbt_user_blocks(&(parent->bbt));
+    if(ftl->first_block >= user_blocks) {
+        return -EOVERFLOW;
+    }
+    if(ftl->block_count == 0) {
+        ftl->block_count = user_blocks - ftl->first_block;
+    }
+    if(ftl->first_block + ftl->block_count > user_blocks) {
+        return -EOVERFLOW;
+    }
+
+    ftl->pool_max               = (ftl->block_count * CONFIG_MTD_NAND_FTL_CHECKPOINT_POOL_PERCENT + 99) / 100;
+    ftl->checkpoint_blocks      = mtd_nand_ftl_checkpoint_area(ftl);
+    if(ftl->block_count <= ftl->checkpoint_blocks) {
+        return -ENOSPC;
+    }
+
+    /** Independent of the blocks bad right now, so the logical size stays the same while blocks wear out */
+    const uint32_t            data_blocks   = ftl->block_count - ftl->checkpoint_blocks;
+    const uint32_t            spare_blocks  = CONFIG_MTD_NAND_FTL_GC_RESERVE + ftl->pool_max + (data_blocks * CONFIG_MTD_NAND_FTL_OP_PERCENT + 99) / 100;
+    if(data_blocks <= spare_blocks) {
+        return -ENOSPC;
+    }
+
+    ftl->logical_pages          = (data_blocks - spare_blocks) * _pages_per_block(ftl);
+
+    _free_tables(ftl);
+    ftl->l2p                    = (uint32_t*)malloc(sizeof(uint32_t) * ftl->logical_pages);
+    ftl->valid                  = (uint16_t*)calloc(ftl->block_count, sizeof(uint16_t));
+    ftl->block_state            = (uint8_t*)calloc(ftl->block_count, sizeof(uint8_t));
+    ftl->block_seq              = (uint32_t*)calloc(ftl->block_count, sizeof(uint32_t));
+    ftl->erase_count            = (uint32_t*)calloc(ftl->block_count, sizeof(uint32_t));
+    ftl->trimmed                = (uint8_t*)calloc((ftl->block_count + 7) / 8, sizeof(uint8_t));
+    ftl->page_buffer            = (uint8_t*)malloc(sizeof(uint8_t) * _data_page_size(ftl));
+    ftl->gc_buffer              = (uint8_t*)malloc(sizeof(uint8_t) * _data_page_size(ftl));
+    ftl->checkpoint_buffer      = (uint8_t*)malloc(sizeof(uint8_t) * _data_page_size(ftl));
+    ftl->pool                   = (uint32_t*)malloc(sizeof(uint32_t) * (ftl->pool_max + 1));
+    if(ftl->l2p == NULL || ftl->valid == NULL || ftl->block_state == NULL || ftl->block_seq == NULL || ftl->erase_count == NULL || ftl->trimmed == NULL || ftl->page_buffer == NULL || ftl->gc_buffer == NULL || ftl->checkpoint_buffer == NULL || ftl->pool == NULL) {
+        _free_tables(ftl);
+        return -ENOMEM;
+    }
+
+    ftl->open_block             = MTD_NAND_FTL_NO_BLOCK;
+    ftl->open_page              = 0;
+    ftl->alloc_cursor           = ftl->checkpoint_blocks;
+    ftl->checkpoint_no          = 0;
+    ftl->wl_erases              = 0;
+
+    _reset_tables(ftl);
+    int res = mtd_nand_ftl_checkpoint_load(ftl);
+
+    if(res < 0) {
+        DEBUG("mtd_nand_ftl_init: no checkpoint (%d), scanning all blocks\n", res);
+        _reset_tables(ftl);
+
+        res = _mount(ftl);
+        if(res < 0) {
+            _free_tables(ftl);
+            return res;
+        }
+
+        _count(ftl);
+        mtd_nand_ftl_checkpoint_write(ftl);
+    } else {
+        _count(ftl);
+    }
+
+    DEBUG("mtd_nand_ftl_init: %" PRIu32 " logical pages, %" PRIu32 " free blocks\n", ftl->logical_pages, ftl->free_blocks);
+
+    dev->page_size              = MTD_NAND_FTL_SECTOR_SIZE;
+    dev->pages_per_sector       = 1;
+    dev->sector_count           = ftl->logical_pages * (_data_page_size(ftl) / MTD_NAND_FTL_SECTOR_SIZE);
+
+    return 0;
+}
+
+static int _read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+    mtd_dev_t*          const parent    = &(ftl->parent->base);
+
+    if(page_no >= dev->sector_count || offset >= MTD_NAND_FTL_SECTOR_SIZE) {
+        return -EOVERFLOW;
+    }
+
+    /** Sectors up to the end of the NAND page are served at once */
+    const uint64_t            address   = (uint64_t)page_no * MTD_NAND_FTL_SECTOR_SIZE + offset;
+    const uint32_t            logical   = address / _data_page_size(ftl);
+    const uint32_t            column    = address % _data_page_size(ftl);
+    const uint32_t            raw_size  = (size < _data_page_size(ftl) - column) ? size : _data_page_size(ftl) - column;
+
+    if(ftl->l2p[logical] == MTD_NAND_FTL_UNMAPPED) {
+        memset(read_buffer, 0xFF, raw_size);
+        return raw_size;
+    }
+
+    return parent->driver->read_page(parent, read_buffer, ftl->l2p[logical], column, raw_size);
+}
+
+static int _write_page(mtd_dev_t* const dev, const void* const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+    mtd_dev_t*          const parent    = &(ftl->parent->base);
+
+    if(page_no >= dev->sector_count || offset >= MTD_NAND_FTL_SECTOR_SIZE) {
+        return -EOVERFLOW;
+    }
+
+    const uint64_t            address   = (uint64_t)page_no * MTD_NAND_FTL_SECTOR_SIZE + offset;
+    const uint32_t            logical   = address / _data_page_size(ftl);
+    const uint32_t            column    = address % _data_page_size(ftl);
+    const uint32_t            raw_size  = (size < _data_page_size(ftl) - column) ? size : _data_page_size(ftl) - column;
+    const void*               data      = write_buffer;
+
+    /** Sectors of the NAND page not written keep their content */
+    if(raw_size < _data_page_size(ftl)) {
+        if(ftl->l2p[logical] == MTD_NAND_FTL_UNMAPPED) {
+            memset(ftl->page_buffer, 0xFF, _data_page_size(ftl));
+        } else {
+            const int res = parent->driver->read_page(parent, ftl->page_buffer, ftl->l2p[logical], 0, _data_page_size(ftl));
+            if(res < 0) {
+                return res;
+            }
+        }
+
+        memcpy(&(ftl->page_buffer[column]), write_buffer, raw_size);
+        data = ftl->page_buffer;
+    }
+
+    const int                 res       = _append(ftl, logical, data, false);
+    if(res < 0) {
+        return res;
+    }
+
+    return raw_size;
+}
+
+static int _erase_sector(mtd_dev_t* const dev, const uint32_t sector, const uint32_t count)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    if(sector + count > dev->sector_count) {
+        return -EOVERFLOW;
+    }
+
+    /** Only NAND pages covered completely */
+    const uint32_t            sectors_per_page  = _data_page_size(ftl) / MTD_NAND_FTL_SECTOR_SIZE;
+    const uint32_t            first_logical     = (sector + sectors_per_page - 1) / sectors_per_page;
+    const uint32_t            end_logical       = (sector + count) / sectors_per_page;
+
+    bool                      unmapped          = false;
+    for(uint32_t logical = first_logical; logical < end_logical; ++logical) {
+        unmapped |= (ftl->l2p[logical] != MTD_NAND_FTL_UNMAPPED);
+        _unmap(ftl, logical);
+    }
+
+    if(! unmapped) {
+        return 0;
+    }
+
+    /** Logged like a page write, so replay and scan unmap the range again after a reboot */
+    const mtd_nand_ftl_trim_t trim              = {
+        .first_logical  = first_logical,
+        .end_logical    = end_logical,
+    };
+    uint32_t                  physical_page;
+
+    memset(ftl->page_buffer, 0xFF, _data_page_size(ftl));
+    memcpy(ftl->page_buffer, &trim, sizeof(trim));
+
+    const int                 res               = _program_record(ftl, MTD_NAND_FTL_TRIM_PAGE, ftl->page_buffer, false, &physical_page);
+    if(res < 0) {
+        return res;
+    }
+
+    bf_set(ftl->trimmed, _block_of(ftl, physical_page));
+
+    return 0;
+}
+
+static int _power(mtd_dev_t *dev, enum mtd_power_state power)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    /** Nothing to save before the first init */
+    if(! _initialized(ftl)) {
+        return (power == MTD_POWER_DOWN) ? 0 : -ENODEV;
+    }
+
+    /** Next init reads the checkpoint only */
+    if(power == MTD_POWER_DOWN) {
+        mtd_nand_ftl_checkpoint_write(ftl);
+    }
+
+    return mtd_power(&(ftl->parent->base), power);
+}
+
+static int mtd_nand_ftl_init(mtd_dev_t* const dev)
+{
+    if(dev == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    /** Nobody else takes the lock before the eraser thread is started */
+    if(ftl->eraser == KERNEL_PID_UNDEF) {
+        mutex_init(&(ftl->lock));
+    }
+
+    mutex_lock(&(ftl->lock));
+    const int                 res       = _init(dev);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+static int mtd_nand_ftl_read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    mutex_lock(&(ftl->lock));
+    const int                 res       = _read_page(dev, read_buffer, page_no, offset, size);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+static int mtd_nand_ftl_write_page(mtd_dev_t* const dev, const void* const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    mutex_lock(&(ftl->lock));
+    const int                 res       = _write_page(dev, write_buffer, page_no, offset, size);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+static int mtd_nand_ftl_erase_sector(mtd_dev_t* const dev, const uint32_t sector, const uint32_t count)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    mutex_lock(&(ftl->lock));
+    const int                 res       = _erase_sector(dev, sector, count);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+static int mtd_nand_ftl_power(mtd_dev_t *dev, enum mtd_power_state power)
+{
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)dev;
+
+    mutex_lock(&(ftl->lock));
+    const int                 res       = _power(dev, power);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+int mtd_nand_ftl_checkpoint(mtd_nand_ftl_t* const ftl) {
+    if(! _initialized(ftl)) {
+        return -ENODEV;
+    }
+
+    mutex_lock(&(ftl->lock));
+    const int res = mtd_nand_ftl_checkpoint_write(ftl);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+int mtd_nand_ftl_wear_level(mtd_nand_ftl_t* const ftl) {
+    if(! _initialized(ftl)) {
+        return -ENODEV;
+    }
+
+    mutex_lock(&(ftl->lock));
+    const int res = _wear_level(ftl);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+int mtd_nand_ftl_erase_ahead(mtd_nand_ftl_t* const ftl) {
+    if(! _initialized(ftl)) {
+        return -ENODEV;
+    }
+
+    mutex_lock(&(ftl->lock));
+    const int res = _erase_ahead(ftl);
+    mutex_unlock(&(ftl->lock));
+
+    return res;
+}
+
+static void* _eraser(void* arg) {
+    mtd_nand_ftl_t*     const ftl       = (mtd_nand_ftl_t*)arg;
+
+    for(;;) {
+        thread_flags_wait_any(MTD_NAND_FTL_ERASER_FLAG);
+
+        /** One block per lock, so writers coming in wait for one erase at most */
+        while(mtd_nand_ftl_erase_ahead(ftl) > 0) {}
+    }
+
+    return NULL;
+}
+
+kernel_pid_t mtd_nand_ftl_eraser_start(mtd_nand_ftl_t* const ftl, char* const stack, const int stack_size, const uint8_t priority) {
+    const kernel_pid_t pid = thread_create(stack, stack_size, priority, THREAD_CREATE_STACKTEST, _eraser, ftl, "nand_ftl_erase");
+
+    if(pid > 0) {
+        mutex_lock(&(ftl->lock));
+        ftl->eraser = pid;
+        _wake_eraser(ftl);
+        mutex_unlock(&(ftl->lock));
+    }
+
+    return pid;
+}
+
+const mtd_desc_t mtd_nand_ftl_driver = {
+    .init           = mtd_nand_ftl_init,
+    .read_page      = mtd_nand_ftl_read_page,
+    .write_page     = mtd_nand_ftl_write_page,
+    .erase_sector   = mtd_nand_ftl_erase_sector,
+    .power          = mtd_nand_ftl_power,
+};
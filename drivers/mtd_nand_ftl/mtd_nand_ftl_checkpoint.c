@@ -0,0 +1,515 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_ftl
+ * @{
+ *
+ * @file
+ * @brief       Checkpoints of the mtd_nand_ftl state
+ *
+ * A checkpoint is a byte stream cut into NAND pages. It starts on page 0 of
+ * an area block and continues through the next good area blocks, wrapping at
+ * the end of the area. Blocks holding the newest intact checkpoint are never
+ * erased, so an interrupted checkpoint leaves the previous one readable.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "mtd_nand_ftl.h"
+#include "mtd_nand_ftl_internal.h"
+#include "mtd_nand_onfi.h"
+#include "nand.h"
+#include "nand/bbt.h"
+#include "checksum/crc16_ccitt.h"
+#include "bitfield.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+typedef struct {
+    uint32_t            no;             /**< number of the checkpoint */
+    uint32_t            block;          /**< area block of the current page */
+    uint32_t            page;           /**< page within that block */
+    uint32_t            index;          /**< page within the checkpoint */
+    size_t              fill;           /**< bytes of the buffer used */
+    uint16_t            crc;            /**< over everything behind the header so far */
+} _cursor_t;
+
+static size_t _stream_size(const mtd_nand_ftl_t* const ftl, const uint32_t logical_pages, const uint16_t pool_count) {
+    return sizeof(mtd_nand_ftl_checkpoint_t)
+         + logical_pages * sizeof(uint32_t)
+         + ftl->block_count * (2 * sizeof(uint32_t) + sizeof(uint8_t))
+         + pool_count * sizeof(uint32_t);
+}
+
+uint32_t mtd_nand_ftl_checkpoint_area(const mtd_nand_ftl_t* const ftl) {
+    /** Sized for one map entry per page of the range, so the area does not depend on the logical size */
+    const size_t    bytes   = _stream_size(ftl, ftl->block_count * _pages_per_block(ftl), ftl->pool_max + 1);
+    const uint32_t  pages   = (bytes + _data_page_size(ftl) - 1) / _data_page_size(ftl);
+    const uint32_t  span    = (pages + _pages_per_block(ftl) - 1) / _pages_per_block(ftl);
+
+    return 2 * span + 1;
+}
+
+static uint32_t _next_area_block(const mtd_nand_ftl_t* const ftl, const uint32_t block) {
+    for(uint32_t pos = 1; pos <= ftl->checkpoint_blocks; ++pos) {
+        const uint32_t next = (block + pos) % ftl->checkpoint_blocks;
+
+        if(! nand_bbt_is_bad(&(ftl->parent->bbt), ftl->first_block + next)) {
+            return next;
+        }
+    }
+
+    return MTD_NAND_FTL_NO_BLOCK;
+}
+
+static uint32_t _span(const mtd_nand_ftl_t* const ftl, const uint32_t pages) {
+    return (pages + _pages_per_block(ftl) - 1) / _pages_per_block(ftl);
+}
+
+/** Whether @p block holds a page of the newest intact checkpoint */
+static bool _holds_newest(const mtd_nand_ftl_t* const ftl, const uint32_t block) {
+    if(! ftl->checkpointed) {
+        return false;
+    }
+
+    uint32_t current = ftl->checkpoint_block;
+    for(uint32_t pos = 0; pos < _span(ftl, ftl->checkpoint_pages) && current != MTD_NAND_FTL_NO_BLOCK; ++pos) {
+        if(current == block) {
+            return true;
+        }
+        current = _next_area_block(ftl, current);
+    }
+
+    return false;
+}
+
+static void _advance(const mtd_nand_ftl_t* const ftl, _cursor_t* const cursor) {
+    cursor->index  += 1;
+    cursor->fill    = 0;
+
+    if(++cursor->page == _pages_per_block(ftl)) {
+        cursor->block   = _next_area_block(ftl, cursor->block);
+        cursor->page    = 0;
+    }
+}
+
+static int _put_page(mtd_nand_ftl_t* const ftl, _cursor_t* const cursor) {
+    mtd_nand_onfi_t*    const parent = ftl->parent;
+
+    /** Entering a block, it may still hold an older checkpoint */
+    while(cursor->page == 0) {
+        if(cursor->block == MTD_NAND_FTL_NO_BLOCK || _holds_newest(ftl, cursor->block)) {
+            DEBUG("mtd_nand_ftl: checkpoint area full\n");
+            return -ENOSPC;
+        }
+
+        if(parent->base.driver->erase_sector(&(parent->base), ftl->first_block + cursor->block, 1) == 0) {
+            break;
+        }
+
+        cursor->block = _next_area_block(ftl, cursor->block);
+    }
+
+    mtd_nand_ftl_meta_t meta = {
+        .logical    = MTD_NAND_FTL_CHECKPOINT_PAGE | cursor->index,
+        .seq        = cursor->no,
+    };
+    meta.crc = _meta_crc(&meta);
+
+    const int res = mtd_nand_onfi_write_page_oob(parent, _physical_page(ftl, cursor->block, cursor->page), ftl->checkpoint_buffer, &meta, sizeof(meta));
+    if(res < 0) {
+        return res;
+    }
+
+    _advance(ftl, cursor);
+
+    return 0;
+}
+
+static int _put(mtd_nand_ftl_t* const ftl, _cursor_t* const cursor, const void* const src, size_t size) {
+    const uint8_t*  bytes       = (const uint8_t*)src;
+    const size_t    page_size   = _data_page_size(ftl);
+
+    while(size > 0) {
+        const size_t chunk = (size < page_size - cursor->fill) ? size : page_size - cursor->fill;
+
+        memcpy(&(ftl->checkpoint_buffer[cursor->fill]), bytes, chunk);
+        cursor->fill   += chunk;
+        bytes          += chunk;
+        size           -= chunk;
+
+        if(cursor->fill == page_size) {
+            const int res = _put_page(ftl, cursor);
+            if(res < 0) {
+                return res;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int _write(mtd_nand_ftl_t* const ftl, _cursor_t* const cursor, const mtd_nand_ftl_checkpoint_t* const header) {
+    int res;
+
+    if((res = _put(ftl, cursor, header, sizeof(*header))) < 0 ||
+       (res = _put(ftl, cursor, ftl->l2p, ftl->logical_pages * sizeof(uint32_t))) < 0 ||
+       (res = _put(ftl, cursor, ftl->block_seq, ftl->block_count * sizeof(uint32_t))) < 0 ||
+       (res = _put(ftl, cursor, ftl->erase_count, ftl->block_count * sizeof(uint32_t))) < 0 ||
+       (res = _put(ftl, cursor, ftl->block_state, ftl->block_count * sizeof(uint8_t))) < 0 ||
+       (res = _put(ftl, cursor, ftl->pool, ftl->pool_count * sizeof(uint32_t))) < 0) {
+        return res;
+    }
+
+    if(cursor->fill > 0) {
+        memset(&(ftl->checkpoint_buffer[cursor->fill]), 0xFF, _data_page_size(ftl) - cursor->fill);
+        return _put_page(ftl, cursor);
+    }
+
+    return 0;
+}
+
+/** Makes init scan all blocks, the pool of the newest checkpoint can not be kept to any more */
+static void _invalidate(mtd_nand_ftl_t* const ftl) {
+    mtd_nand_onfi_t*    const parent = ftl->parent;
+
+    ftl->checkpointed = false;
+
+    for(uint32_t block = 0; block < ftl->checkpoint_blocks; ++block) {
+        if(! nand_bbt_is_bad(&(parent->bbt), ftl->first_block + block)) {
+            parent->base.driver->erase_sector(&(parent->base), ftl->first_block + block, 1);
+        }
+    }
+}
+
+/** Erased ones first, least worn first among those and among the others */
+static bool _pool_before(const mtd_nand_ftl_t* const ftl, const uint32_t a, const uint32_t b) {
+    const bool erased_a = mtd_nand_onfi_block_erased(ftl->parent, ftl->first_block + a);
+    const bool erased_b = mtd_nand_onfi_block_erased(ftl->parent, ftl->first_block + b);
+
+    if(erased_a != erased_b) {
+        return erased_a;
+    }
+
+    return ftl->erase_count[a] < ftl->erase_count[b];
+}
+
+/** Hands out the open block first, then free blocks erased ahead and the least worn ones */
+static void _fill_pool(mtd_nand_ftl_t* const ftl) {
+    ftl->pool_count = 0;
+    ftl->pool_pos   = 0;
+
+    if(ftl->open_block != MTD_NAND_FTL_NO_BLOCK && ftl->open_page < _pages_per_block(ftl)) {
+        ftl->pool[ftl->pool_count++] = ftl->open_block;
+        ftl->pool_pos = 1;
+    }
+
+    /** Kept sorted behind the open block, the last one drops out when full */
+    const uint16_t first = ftl->pool_count;
+    for(uint32_t pos = 0; pos < ftl->block_count; ++pos) {
+        const uint32_t block = (ftl->alloc_cursor + pos) % ftl->block_count;
+
+        if(ftl->block_state[block] != MTD_NAND_FTL_BLOCK_FREE) {
+            continue;
+        }
+
+        uint16_t slot = ftl->pool_count;
+        if(ftl->pool_count == ftl->pool_max + 1) {
+            if(! _pool_before(ftl, block, ftl->pool[slot - 1])) {
+                continue;
+            }
+            slot -= 1;
+        } else {
+            ftl->pool_count += 1;
+        }
+
+        while(slot > first && _pool_before(ftl, block, ftl->pool[slot - 1])) {
+            ftl->pool[slot] = ftl->pool[slot - 1];
+            slot -= 1;
+        }
+        ftl->pool[slot] = block;
+    }
+}
+
+uint32_t mtd_nand_ftl_checkpoint_next(const mtd_nand_ftl_t* const ftl) {
+    /** Each checkpoint starts on a fresh block behind the newest one */
+    uint32_t block = ftl->checkpointed ? ftl->checkpoint_block : ftl->checkpoint_blocks - 1;
+    for(uint32_t pos = 0; pos < (ftl->checkpointed ? _span(ftl, ftl->checkpoint_pages) : 1) && block != MTD_NAND_FTL_NO_BLOCK; ++pos) {
+        block = _next_area_block(ftl, block);
+    }
+
+    return _holds_newest(ftl, block) ? MTD_NAND_FTL_NO_BLOCK : block;
+}
+
+int mtd_nand_ftl_checkpoint_write(mtd_nand_ftl_t* const ftl) {
+    _fill_pool(ftl);
+
+    mtd_nand_ftl_checkpoint_t header = {
+        .magic          = MTD_NAND_FTL_CHECKPOINT_MAGIC,
+        .no             = ftl->checkpoint_no + 1,
+        .seq            = ftl->seq,
+        .logical_pages  = ftl->logical_pages,
+        .block_count    = ftl->block_count,
+        .pages          = (_stream_size(ftl, ftl->logical_pages, ftl->pool_count) + _data_page_size(ftl) - 1) / _data_page_size(ftl),
+        .pool_count     = ftl->pool_count,
+    };
+    header.crc = crc16_ccitt_calc((const uint8_t*)&header, offsetof(mtd_nand_ftl_checkpoint_t, crc));
+    header.crc = crc16_ccitt_update(header.crc, (const uint8_t*)ftl->l2p, ftl->logical_pages * sizeof(uint32_t));
+    header.crc = crc16_ccitt_update(header.crc, (const uint8_t*)ftl->block_seq, ftl->block_count * sizeof(uint32_t));
+    header.crc = crc16_ccitt_update(header.crc, (const uint8_t*)ftl->erase_count, ftl->block_count * sizeof(uint32_t));
+    header.crc = crc16_ccitt_update(header.crc, ftl->block_state, ftl->block_count * sizeof(uint8_t));
+    header.crc = crc16_ccitt_update(header.crc, (const uint8_t*)ftl->pool, ftl->pool_count * sizeof(uint32_t));
+
+    uint32_t    block   = mtd_nand_ftl_checkpoint_next(ftl);
+    int         res     = -ENOSPC;
+    for(uint32_t attempt = 0; attempt < ftl->checkpoint_blocks && block != MTD_NAND_FTL_NO_BLOCK; ++attempt) {
+        _cursor_t cursor = {
+            .no     = header.no,
+            .block  = block,
+        };
+
+        res = _write(ftl, &cursor, &header);
+        if(res == 0) {
+            DEBUG("mtd_nand_ftl: checkpoint %" PRIu32 " in block %" PRIu32 ", %u pool blocks\n", header.no, block, ftl->pool_count);
+            ftl->checkpointed       = true;
+            ftl->checkpoint_no      = header.no;
+            ftl->checkpoint_block   = block;
+            ftl->checkpoint_pages   = header.pages;
+            /** The map holds every trim up to here */
+            memset(ftl->trimmed, 0, (ftl->block_count + 7) / 8);
+            return 0;
+        }
+
+        if(res != -EIO) {
+            break;
+        }
+
+        /** The block went bad under the checkpoint, start over behind it */
+        block = _next_area_block(ftl, cursor.block);
+    }
+
+    DEBUG("mtd_nand_ftl: checkpoint failed (%d)\n", res);
+    _invalidate(ftl);
+
+    return res;
+}
+
+static int _get_page(mtd_nand_ftl_t* const ftl, _cursor_t* const cursor) {
+    mtd_nand_onfi_t*    const parent        = ftl->parent;
+    mtd_nand_ftl_meta_t       meta;
+
+    if(cursor->block == MTD_NAND_FTL_NO_BLOCK) {
+        return -EBADMSG;
+    }
+
+    const uint32_t            physical_page = _physical_page(ftl, cursor->block, cursor->page);
+
+    if(mtd_nand_onfi_read_oob(parent, physical_page, &meta, sizeof(meta)) < 0 || meta.crc != _meta_crc(&meta) ||
+       meta.logical != (MTD_NAND_FTL_CHECKPOINT_PAGE | cursor->index) || meta.seq != cursor->no) {
+        return -EBADMSG;
+    }
+
+    const int                 res           = parent->base.driver->read_page(&(parent->base), ftl->checkpoint_buffer, physical_page, 0, _data_page_size(ftl));
+    if(res < 0) {
+        return res;
+    }
+
+    return 0;
+}
+
+static int _get(mtd_nand_ftl_t* const ftl, _cursor_t* const cursor, void* const dst, size_t size) {
+          uint8_t*  bytes       = (uint8_t*)dst;
+    const size_t    page_size   = _data_page_size(ftl);
+
+    while(size > 0) {
+        if(cursor->fill == page_size) {
+            _advance(ftl, cursor);
+        }
+
+        if(cursor->fill == 0) {
+            const int res = _get_page(ftl, cursor);
+            if(res < 0) {
+                return res;
+            }
+        }
+
+        const size_t chunk = (size < page_size - cursor->fill) ? size : page_size - cursor->fill;
+
+        memcpy(bytes, &(ftl->checkpoint_buffer[cursor->fill]), chunk);
+        cursor->crc     = crc16_ccitt_update(cursor->crc, bytes, chunk);
+        cursor->fill   += chunk;
+        bytes          += chunk;
+        size           -= chunk;
+    }
+
+    return 0;
+}
+
+static int _read(mtd_nand_ftl_t* const ftl, const uint32_t block, const uint32_t no, mtd_nand_ftl_checkpoint_t* const header) {
+    _cursor_t cursor = {
+        .no     = no,
+        .block  = block,
+    };
+
+    int res = _get(ftl, &cursor, header, sizeof(*header));
+    if(res < 0) {
+        return res;
+    }
+
+    if(memcmp(header->magic, MTD_NAND_FTL_CHECKPOINT_MAGIC, MTD_NAND_FTL_CHECKPOINT_MAGIC_SIZE) != 0 ||
+       header->logical_pages != ftl->logical_pages || header->block_count != ftl->block_count ||
+       header->pool_count > ftl->pool_max + 1) {
+        return -EBADMSG;
+    }
+
+    cursor.crc = crc16_ccitt_calc((const uint8_t*)header, offsetof(mtd_nand_ftl_checkpoint_t, crc));
+    ftl->pool_count = header->pool_count;
+
+    if((res = _get(ftl, &cursor, ftl->l2p, ftl->logical_pages * sizeof(uint32_t))) < 0 ||
+       (res = _get(ftl, &cursor, ftl->block_seq, ftl->block_count * sizeof(uint32_t))) < 0 ||
+       (res = _get(ftl, &cursor, ftl->erase_count, ftl->block_count * sizeof(uint32_t))) < 0 ||
+       (res = _get(ftl, &cursor, ftl->block_state, ftl->block_count * sizeof(uint8_t))) < 0 ||
+       (res = _get(ftl, &cursor, ftl->pool, ftl->pool_count * sizeof(uint32_t))) < 0) {
+        return res;
+    }
+
+    if(cursor.crc != header->crc || cursor.index + 1 != header->pages) {
+        return -EBADMSG;
+    }
+
+    return 0;
+}
+
+/**
+ * Applies the records of the pool blocks written since the checkpoint, in
+ * the order they were opened. Erased pool blocks are skipped, they were
+ * either not opened yet or collected after being written.
+ */
+static int _replay(mtd_nand_ftl_t* const ftl, const uint32_t checkpoint_seq) {
+    mtd_nand_onfi_t*    const parent            = ftl->parent;
+    const uint32_t            pages_per_block   = _pages_per_block(ftl);
+
+    ftl->pool_pos = 0;
+
+    for(uint16_t pos = 0; pos < ftl->pool_count; ++pos) {
+        const uint32_t          block       = ftl->pool[pos];
+        mtd_nand_ftl_meta_t     meta;
+
+        if(block >= ftl->block_count) {
+            return -EBADMSG;
+        }
+
+        const int               frontier    = mtd_nand_onfi_find_frontier(parent, ftl->first_block + block, &meta, sizeof(meta));
+        if(frontier < 0) {
+            return frontier;
+        }
+
+        if(frontier == 0) {
+            continue;
+        }
+
+        for(uint32_t page = 0; page < (uint32_t)frontier && page < pages_per_block; ++page) {
+            const uint32_t      physical_page   = _physical_page(ftl, block, page);
+
+            /** Pages of the open block from before the checkpoint are in the map already */
+            if(mtd_nand_onfi_read_oob(parent, physical_page, &meta, sizeof(meta)) < 0 || ! (_meta_valid(ftl, &meta) || _meta_trim(&meta)) || meta.seq <= checkpoint_seq) {
+                continue;
+            }
+
+            /** Pages are replayed in write order, a trim unmaps whatever is mapped at that point */
+            if(_meta_trim(&meta)) {
+                mtd_nand_ftl_trim_t trim;
+
+                if(mtd_nand_ftl_read_trim(ftl, physical_page, ftl->page_buffer, &trim) == 0) {
+                    for(uint32_t logical = trim.first_logical; logical < trim.end_logical; ++logical) {
+                        ftl->l2p[logical] = MTD_NAND_FTL_UNMAPPED;
+                    }
+                }
+
+                bf_set(ftl->trimmed, block);
+                ftl->block_seq[block]   = meta.seq;
+                if(meta.seq > ftl->seq) {
+                    ftl->seq = meta.seq;
+                }
+                continue;
+            }
+
+            ftl->l2p[meta.logical]  = physical_page;
+            ftl->block_seq[block]   = meta.seq;
+            if(meta.seq > ftl->seq) {
+                ftl->seq = meta.seq;
+            }
+        }
+
+        /** A partly written block is not appended to after a reboot */
+        ftl->block_state[block] = nand_bbt_is_bad(&(parent->bbt), ftl->first_block + block) ? MTD_NAND_FTL_BLOCK_RETIRED : MTD_NAND_FTL_BLOCK_USED;
+        ftl->pool_pos           = pos + 1;
+    }
+
+    return 0;
+}
+
+int mtd_nand_ftl_checkpoint_load(mtd_nand_ftl_t* const ftl) {
+    mtd_nand_onfi_t*    const parent    = ftl->parent;
+          uint32_t          below       = UINT32_MAX;
+
+    /** Newest first, an interrupted checkpoint falls back to the one before */
+    for(;;) {
+        uint32_t            best_block  = MTD_NAND_FTL_NO_BLOCK;
+        uint32_t            best_no     = 0;
+
+        for(uint32_t block = 0; block < ftl->checkpoint_blocks; ++block) {
+            mtd_nand_ftl_meta_t meta;
+
+            if(nand_bbt_is_bad(&(parent->bbt), ftl->first_block + block) ||
+               mtd_nand_onfi_read_oob(parent, _physical_page(ftl, block, 0), &meta, sizeof(meta)) < 0 ||
+               meta.crc != _meta_crc(&meta) || (meta.logical & MTD_NAND_FTL_CHECKPOINT_PAGE) == 0) {
+                continue;
+            }
+
+            /** The next checkpoint has to be numbered above any one seen, intact or not */
+            if(meta.seq > ftl->checkpoint_no) {
+                ftl->checkpoint_no = meta.seq;
+            }
+
+            if(meta.logical == MTD_NAND_FTL_CHECKPOINT_PAGE && meta.seq < below && meta.seq > best_no) {
+                best_block  = block;
+                best_no     = meta.seq;
+            }
+        }
+
+        if(best_block == MTD_NAND_FTL_NO_BLOCK) {
+            return -ENOENT;
+        }
+
+        mtd_nand_ftl_checkpoint_t header;
+        if(_read(ftl, best_block, best_no, &header) == 0) {
+            DEBUG("mtd_nand_ftl: checkpoint %" PRIu32 " found in block %" PRIu32 "\n", best_no, best_block);
+            ftl->checkpointed       = true;
+            ftl->checkpoint_block   = best_block;
+            ftl->checkpoint_pages   = header.pages;
+            ftl->seq                = header.seq;
+
+            return _replay(ftl, header.seq);
+        }
+
+        below = best_no;
+    }
+}
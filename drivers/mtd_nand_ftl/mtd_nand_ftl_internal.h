@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_ftl
+ * @{
+ *
+ * @file
+ * @brief       Helpers shared by the mtd_nand_ftl sources
+ *
+ * Block numbers are relative to first_block, page numbers in the map are
+ * absolute NAND pages of the parent.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef MTD_NAND_FTL_INTERNAL_H
+#define MTD_NAND_FTL_INTERNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mtd_nand_ftl.h"
+#include "nand.h"
+#include "checksum/crc16_ccitt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MTD_NAND_FTL_NO_BLOCK               (UINT32_MAX)
+
+static inline uint32_t _pages_per_block(const mtd_nand_ftl_t* const ftl) {
+    return ((nand_t*)ftl->parent->nand_onfi)->pages_per_block;
+}
+
+static inline uint32_t _data_page_size(const mtd_nand_ftl_t* const ftl) {
+    return ((nand_t*)ftl->parent->nand_onfi)->data_bytes_per_page;
+}
+
+static inline uint32_t _physical_page(const mtd_nand_ftl_t* const ftl, const uint32_t block, const uint32_t page) {
+    return (ftl->first_block + block) * _pages_per_block(ftl) + page;
+}
+
+static inline uint32_t _block_of(const mtd_nand_ftl_t* const ftl, const uint32_t physical_page) {
+    return physical_page / _pages_per_block(ftl) - ftl->first_block;
+}
+
+static inline uint16_t _meta_crc(const mtd_nand_ftl_meta_t* const meta) {
+    return crc16_ccitt_calc((const uint8_t*)meta, offsetof(mtd_nand_ftl_meta_t, crc));
+}
+
+/** Whether @p meta is the intact record of a data page */
+static inline bool _meta_valid(const mtd_nand_ftl_t* const ftl, const mtd_nand_ftl_meta_t* const meta) {
+    return meta->crc == _meta_crc(meta) && meta->logical < ftl->logical_pages;
+}
+
+/** Whether @p meta is the intact record of a trim page */
+static inline bool _meta_trim(const mtd_nand_ftl_meta_t* const meta) {
+    return meta->crc == _meta_crc(meta) && meta->logical == MTD_NAND_FTL_TRIM_PAGE;
+}
+
+/** Reads the range a trim page unmaps, clipped to the logical pages, @p buffer takes one data page */
+int mtd_nand_ftl_read_trim(mtd_nand_ftl_t* const ftl, const uint32_t physical_page, uint8_t* const buffer, mtd_nand_ftl_trim_t* const trim);
+
+/** Blocks at the start of the range needed to hold two checkpoints, plus one to step over a bad one, pool_max has to be set */
+uint32_t mtd_nand_ftl_checkpoint_area(const mtd_nand_ftl_t* const ftl);
+
+/** Area block the next checkpoint starts on, MTD_NAND_FTL_NO_BLOCK if none is left */
+uint32_t mtd_nand_ftl_checkpoint_next(const mtd_nand_ftl_t* const ftl);
+
+/** mtd_nand_ftl_checkpoint() with the lock held */
+int mtd_nand_ftl_checkpoint_write(mtd_nand_ftl_t* const ftl);
+
+/**
+ * Loads the newest intact checkpoint and replays the pages written to its
+ * pool since. Returns -ENOENT if there is none, the tables are left in an
+ * undefined state on any error.
+ */
+int mtd_nand_ftl_checkpoint_load(mtd_nand_ftl_t* const ftl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_NAND_FTL_INTERNAL_H */
+/** @} */
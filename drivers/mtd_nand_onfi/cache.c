@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Page cache of the mtd_nand_onfi driver
+ *
+ * Entries are chained twice: by hash bucket for the lookup, and in a list
+ * from newest to oldest use for the replacement. Unused entries are kept
+ * in a memarray pool.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "mtd_nand_onfi.h"
+#include "mtd_nand_onfi_internal.h"
+#include "memarray.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static inline mtd_nand_onfi_cache_entry_t** _bucket(mtd_nand_onfi_cache_t* const cache, const uint32_t page_no) {
+    return &(cache->buckets[page_no % CONFIG_MTD_NAND_ONFI_CACHE_BUCKETS]);
+}
+
+static void _unlink_lru(mtd_nand_onfi_cache_t* const cache, mtd_nand_onfi_cache_entry_t* const entry) {
+    if(entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    } else {
+        cache->newest = entry->older;
+    }
+
+    if(entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    } else {
+        cache->oldest = entry->newer;
+    }
+}
+
+static void _link_newest(mtd_nand_onfi_cache_t* const cache, mtd_nand_onfi_cache_entry_t* const entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+
+    if(cache->newest != NULL) {
+        cache->newest->newer = entry;
+    } else {
+        cache->oldest = entry;
+    }
+    cache->newest = entry;
+}
+
+/** Unlinks @p entry from its bucket and the use list and returns it to the pool */
+static void _remove(mtd_nand_onfi_cache_t* const cache, mtd_nand_onfi_cache_entry_t* const entry) {
+    for(mtd_nand_onfi_cache_entry_t** link = _bucket(cache, entry->page_no); *link != NULL; link = &((*link)->next)) {
+        if(*link == entry) {
+            *link = entry->next;
+            break;
+        }
+    }
+
+    _unlink_lru(cache, entry);
+    memarray_free(&(cache->pool), entry);
+}
+
+static mtd_nand_onfi_cache_entry_t* _find(mtd_nand_onfi_cache_t* const cache, const uint32_t page_no) {
+    for(mtd_nand_onfi_cache_entry_t* entry = *_bucket(cache, page_no); entry != NULL; entry = entry->next) {
+        if(entry->page_no == page_no) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+int mtd_nand_onfi_cache_init(mtd_nand_onfi_t* const mtd_nand)
+{
+    mtd_nand_onfi_cache_t*    const cache               = &(mtd_nand->cache);
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+
+    /** A re-init may find a part with another page size, the entries are sized anew */
+    if(cache->entries != NULL) {
+        while(cache->oldest != NULL) {
+            _remove(cache, cache->oldest);
+        }
+
+        free(cache->entries);
+        cache->entries = NULL;
+    }
+
+    /** Entries are kept pointer aligned for the pool's free list */
+    const size_t                    entry_size          = (sizeof(mtd_nand_onfi_cache_entry_t) + nand->data_bytes_per_page + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    cache->entries = malloc(entry_size * CONFIG_MTD_NAND_ONFI_CACHE_PAGES);
+    if(cache->entries == NULL) {
+        return -ENOMEM;
+    }
+
+    memarray_init(&(cache->pool), cache->entries, entry_size, CONFIG_MTD_NAND_ONFI_CACHE_PAGES);
+
+    cache->hits     = 0;
+    cache->misses   = 0;
+
+    return 0;
+}
+
+const uint8_t* mtd_nand_onfi_cache_lookup(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+    mtd_nand_onfi_cache_t*    const cache               = &(mtd_nand->cache);
+    mtd_nand_onfi_cache_entry_t* const entry            = _find(cache, page_no);
+
+    if(entry == NULL) {
+        cache->misses += 1;
+        return NULL;
+    }
+
+    cache->hits += 1;
+    if(entry != cache->newest) {
+        _unlink_lru(cache, entry);
+        _link_newest(cache, entry);
+    }
+
+    return entry->data;
+}
+
+uint8_t* mtd_nand_onfi_cache_fill(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+    mtd_nand_onfi_cache_t*    const cache               = &(mtd_nand->cache);
+
+    if(cache->entries == NULL) {
+        return NULL;
+    }
+
+    mtd_nand_onfi_cache_entry_t* entry                  = _find(cache, page_no);
+    if(entry != NULL) {
+        _remove(cache, entry);
+    }
+
+    entry = memarray_alloc(&(cache->pool));
+    if(entry == NULL) {
+        DEBUG("mtd_nand_onfi_cache: replacing page %" PRIu32 "\n", cache->oldest->page_no);
+        _remove(cache, cache->oldest);
+        entry = memarray_alloc(&(cache->pool));
+    }
+
+    entry->page_no  = page_no;
+    entry->next     = *_bucket(cache, page_no);
+    *_bucket(cache, page_no) = entry;
+    _link_newest(cache, entry);
+
+    return entry->data;
+}
+
+void mtd_nand_onfi_cache_drop(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+    mtd_nand_onfi_cache_entry_t* const entry            = _find(&(mtd_nand->cache), page_no);
+
+    if(entry != NULL) {
+        _remove(&(mtd_nand->cache), entry);
+    }
+}
+
+void mtd_nand_onfi_cache_invalidate(mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no)
+{
+    mtd_nand_onfi_cache_t*    const cache               = &(mtd_nand->cache);
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+    mtd_nand_onfi_cache_entry_t*    entry               = cache->newest;
+
+    /** The cache is small, walking it beats looking up every page of the block */
+    while(entry != NULL) {
+        mtd_nand_onfi_cache_entry_t* const older        = entry->older;
+
+        if(entry->page_no / nand->pages_per_block == block_no) {
+            _remove(cache, entry);
+        }
+        entry = older;
+    }
+}
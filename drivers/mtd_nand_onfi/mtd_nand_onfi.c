@@ -1,13 +1,56 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       mtd wrapper for ONFI NANDs
+ *
+ * MTD pages are the data area of NAND pages, MTD sectors are NAND blocks.
+ * While ECC is enabled every page is transferred as a whole together with
+ * its spare area, so the parity can be checked and corrected.
+ *
+ * Blocks known to be bad are refused for program and erase, and blocks
+ * failing either are retired in the bad block table. Blocks erased since
+ * init are remembered until their next program, erasing them again is
+ * skipped.
+ *
+ * The page cache is consulted by mtd reads only, and dropped for a block on
+ * every program or erase of it, successful or not.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
 #define ENABLE_DEBUG 0
 #include "debug.h"
 
 #include "mtd_nand_onfi.h"
+#include "mtd_nand_onfi_internal.h"
 #include "nand.h"
 #include "nand_cmd.h"
 #include "nand/onfi.h"
+#include "nand/ecc.h"
+#include "nand/bbt.h"
+#include "nand/stats.h"
 #include "mtd.h"
+#include "mutex.h"
+#include "bitarithm.h"
+#include "bitfield.h"
 
+#include <inttypes.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 static int mtd_nand_onfi_init(mtd_dev_t* const dev)
@@ -21,7 +64,7 @@ static int mtd_nand_onfi_init(mtd_dev_t* const dev)
         return -ENODEV;
     }
 
-    nand_t*             const nand      = (nand_t*)&(mtd_nand->nand_onfi);
+    nand_t*             const nand      = (nand_t*)mtd_nand->nand_onfi;
     if(mtd_nand->params != NULL && ! nand->init_done && nand_onfi_init(mtd_nand->nand_onfi, mtd_nand->params) != NAND_INIT_OK) {
         return -EIO;
     }
@@ -30,237 +73,523 @@ static int mtd_nand_onfi_init(mtd_dev_t* const dev)
         return -EIO;
     }
 
-    dev->sector_count       = nand_onfi_all_block_count(nand);
-    dev->page_size          = nand_onfi_one_page_size(mtd_nand->nand_onfi);
+    if(nand_ecc_init(&(mtd_nand->ecc), nand, nand_ecc_mode_for(nand)) != NAND_INIT_OK) {
+        DEBUG("mtd_nand_onfi_init: ECC (%u bits / %u bytes) not available\n", nand->ecc_bits, nand->ecc_codeword_size);
+        nand_ecc_init(&(mtd_nand->ecc), nand, NAND_ECC_MODE_NONE);
+    }
+
+    if(mtd_nand->page_buffer == NULL) {
+        mtd_nand->page_buffer = (uint8_t*)malloc(sizeof(uint8_t) * nand_one_page_size(nand));
+        if(mtd_nand->page_buffer == NULL) {
+            nand_ecc_deinit(&(mtd_nand->ecc));
+            return -ENOMEM;
+        }
+    }
+
+    if(mtd_nand->bbt.bitmap == NULL && nand_bbt_init(&(mtd_nand->bbt), mtd_nand->nand_onfi) == NAND_INIT_ERROR) {
+        DEBUG("mtd_nand_onfi_init: bad block table not available\n");
+        return -EIO;
+    }
+
+    if(mtd_nand->erased == NULL) {
+        mtd_nand->erased = (uint8_t*)calloc((nand_bbt_user_blocks(&(mtd_nand->bbt)) + 7) / 8, sizeof(uint8_t));
+        if(mtd_nand->erased == NULL) {
+            return -ENOMEM;
+        }
+    }
+
+    const int cache_res = mtd_nand_onfi_cache_init(mtd_nand);
+    if(cache_res < 0) {
+        return cache_res;
+    }
+
+    mtd_nand_onfi_readahead_init(mtd_nand);
+
+    dev->sector_count       = nand_bbt_user_blocks(&(mtd_nand->bbt));
+    dev->page_size          = nand->data_bytes_per_page;
     dev->pages_per_sector   = nand->pages_per_block;    /**< NAND is intended to use one block per one access */
 
     return 0;
 }
 
-static int mtd_nand_onfi_read(mtd_dev_t* const dev, void* const read_buffer, const uint32_t addr_flat, const uint32_t size)
+/** Reads data and spare area of a page into the page buffer, corrected if the host does the ECC */
+static int _read_full_page(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
 {
-          mtd_nand_onfi_t *   const mtd_nand            = (mtd_nand_onfi_t*)dev;
-          nand_t*             const nand                = (nand_t*)&(mtd_nand->nand_onfi);
-    const uint64_t                  addr_column         = nand_addr_flat_to_addr_column(nand, addr_flat);
-    const uint64_t                  addr_row            = nand_addr_flat_to_addr_row(nand, addr_flat);
-    const uint8_t                   lun_no              = addr_flat / nand_one_lun_pages_size(nand); // TODO: lun_no looks invalid
-
-          nand_rw_response_t* const err                 = (nand_rw_response_t *)malloc(sizeof(nand_rw_response_t));
-
-          nand_raw_t*         const raw_store           = (nand_raw_t*)malloc(sizeof(nand_raw_t));
-                raw_store->raw_size                     = size;
-                raw_store->buffer                       = read_buffer;
-                raw_store->buffer_size                  = size; // TODO: Should throw error if size is too large
-                raw_store->current_buffer_seq           = 0;
-                raw_store->current_raw_offset           = 0;
-
-          nand_cmd_t*         const cmd_mutable         = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
-                memcpy(cmd_mutable, &NAND_ONFI_CMD_READ, sizeof(nand_cmd_t));
-                cmd_mutable->chains[1].cycles_defined   = true;
-                cmd_mutable->chains[1].cycles.addr[0]   = addr_column;
-                cmd_mutable->chains[1].cycles.addr[1]   = addr_row;
-                cmd_mutable->chains[3].cycles_defined   = true;
-                cmd_mutable->chains[3].cycles.raw       = raw_store;
-
-          nand_cmd_params_t*  const cmd_params          = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
-                cmd_params->lun_no                      = lun_no;
-                cmd_params->cmd_override                = cmd_mutable;
-
-    nand_run_cmd_chains(nand, &NAND_ONFI_CMD_READ, cmd_params, err);
-
-    free(cmd_params);
-    free(cmd_mutable);
-    free(raw_store);
-
-    if(*err != NAND_RW_OK) {
-        free(err);
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+          nand_t*             const nand                = (nand_t*)nand_onfi;
+    const uint64_t                  addr_row            = nand_page_no_to_addr_row(page_no);
+          uint8_t*            const page_buffer         = mtd_nand->page_buffer;
+          uint8_t*            const spare_buffer        = &(page_buffer[nand->data_bytes_per_page]);
+
+    if(! nand_ecc_on_host(&(mtd_nand->ecc))) {
+        switch(nand_onfi_read_page(nand_onfi, addr_row, nand_offset_to_addr_column(0), page_buffer, nand_one_page_size(nand))) {
+        case NAND_RW_OK:
+            return 0;
+
+        case NAND_RW_ECC_MISMATCH:  /**< on-die ECC */
+            DEBUG("mtd_nand_onfi: uncorrectable page %" PRIu32 "\n", page_no);
+            return -EBADMSG;
+
+        default:
+            return -EIO;
+        }
+    }
+
+    /** Codes are computed per codeword as it arrives, only mismatching codewords get decoded afterwards */
+    if(nand_onfi_read_page_hooked(nand_onfi, addr_row, nand_offset_to_addr_column(0), page_buffer, nand_one_page_size(nand), mtd_nand->ecc.step_size, NULL, nand_ecc_stream_read_cb, &(mtd_nand->ecc)) != NAND_RW_OK) {
         return -EIO;
     }
 
-    free(err);
-    return size;
+    size_t                          corrected_bits      = 0;
+    if(nand_ecc_correct_calculated(&(mtd_nand->ecc), page_buffer, spare_buffer, mtd_nand->ecc.calculated, &corrected_bits) != NAND_RW_OK) {
+        DEBUG("mtd_nand_onfi: uncorrectable page %" PRIu32 "\n", page_no);
+        return -EBADMSG;
+    }
+
+    nand_stats_ecc(corrected_bits);
+
+    return 0;
 }
 
-static int mtd_nand_onfi_read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+/** Programs data and spare area from the page buffer, the parity is filled in on the way */
+static int _program_full_page(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
 {
-          mtd_nand_onfi_t *   const mtd_nand            = (mtd_nand_onfi_t*)dev;
-          nand_t*             const nand                = (nand_t*)&(mtd_nand->nand_onfi);
-    const uint64_t                  addr_column         = nand_offset_to_addr_column(offset);
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+          nand_t*             const nand                = (nand_t*)nand_onfi;
     const uint64_t                  addr_row            = nand_page_no_to_addr_row(page_no);
-    const uint8_t                   lun_no              = page_no / nand_one_lun_pages_count(nand); // TODO: lun_no looks invalid
-    const size_t                    page_size           = nand_one_page_size(nand);
-    const size_t                    raw_size            = (size < page_size) ? size : page_size; // TODO: Should throw error if size > page_size
-
-          nand_rw_response_t* const err                 = (nand_rw_response_t *)malloc(sizeof(nand_rw_response_t));
-
-          nand_raw_t*         const raw_store           = (nand_raw_t*)malloc(sizeof(nand_raw_t));
-                raw_store->raw_size                     = raw_size;
-                raw_store->buffer                       = read_buffer;
-                raw_store->buffer_size                  = size;
-                raw_store->current_buffer_seq           = 0;
-                raw_store->current_raw_offset           = 0;
-
-          nand_cmd_t*         const cmd_mutable         = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
-                memcpy(cmd_mutable, &NAND_ONFI_CMD_READ, sizeof(nand_cmd_t));
-                cmd_mutable->chains[1].cycles_defined   = true;
-                cmd_mutable->chains[1].cycles.addr[0]   = addr_column;
-                cmd_mutable->chains[1].cycles.addr[1]   = addr_row;
-                cmd_mutable->chains[3].cycles_defined   = true;
-                cmd_mutable->chains[3].cycles.raw       = raw_store;
-
-          nand_cmd_params_t*  const cmd_params          = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
-                cmd_params->lun_no                      = lun_no;
-                cmd_params->cmd_override                = cmd_mutable;
-
-    nand_run_cmd_chains(nand, &NAND_ONFI_CMD_READ, cmd_params, err);
-
-    free(cmd_params);
-    free(cmd_mutable);
-    free(raw_store);
-
-    if(*err != NAND_RW_OK) {
-        free(err);
+    const uint32_t                  block_no            = page_no / nand->pages_per_block;
+          nand_rw_response_t        err;
+
+    if(nand_bbt_is_bad(&(mtd_nand->bbt), block_no)) {
         return -EIO;
     }
 
-    free(err);
-    return raw_size;
+    bf_unset(mtd_nand->erased, block_no);
+    mtd_nand_onfi_cache_invalidate(mtd_nand, block_no);
+
+    if(! nand_ecc_on_host(&(mtd_nand->ecc))) {
+        err = nand_onfi_program_page(nand_onfi, addr_row, nand_offset_to_addr_column(0), mtd_nand->page_buffer, nand_one_page_size(nand));
+    } else {
+        /** Parity of each codeword is computed right before it goes out, the spare area is sent last */
+        err = nand_onfi_program_page_hooked(nand_onfi, addr_row, nand_offset_to_addr_column(0), mtd_nand->page_buffer, nand_one_page_size(nand), mtd_nand->ecc.step_size, nand_ecc_stream_program_cb, NULL, &(mtd_nand->ecc));
+    }
+
+    if(err == NAND_RW_WRITE_ERROR) {
+        DEBUG("mtd_nand_onfi: program failed, retiring block %" PRIu32 "\n", block_no);
+        nand_bbt_mark_bad(&(mtd_nand->bbt), block_no);
+    }
+
+    return (err == NAND_RW_OK) ? 0 : -EIO;
 }
 
-static int mtd_nand_onfi_write(mtd_dev_t* const dev, const void* const write_buffer, const uint32_t addr_flat, const uint32_t size)
+static int _read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
 {
           mtd_nand_onfi_t *   const mtd_nand            = (mtd_nand_onfi_t*)dev;
-          nand_t*             const nand                = (nand_t*)&(mtd_nand->nand_onfi);
-    const uint64_t                  addr_column         = nand_addr_flat_to_addr_column(nand, addr_flat);
-    const uint64_t                  addr_row            = nand_addr_flat_to_addr_row(nand, addr_flat);
-    const uint8_t                   lun_no              = addr_flat / nand_one_lun_pages_size(nand); // TODO: lun_no looks invalid
-
-          nand_rw_response_t* const err                 = (nand_rw_response_t *)malloc(sizeof(nand_rw_response_t));
-
-          nand_raw_t*         const raw_store           = (nand_raw_t*)malloc(sizeof(nand_raw_t));
-                raw_store->raw_size                     = size;
-                raw_store->buffer                       = write_buffer;
-                raw_store->buffer_size                  = size;
-                raw_store->current_buffer_seq           = 0;
-                raw_store->current_raw_offset           = 0;
-
-          nand_cmd_t*         const cmd_mutable         = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
-                memcpy(cmd_mutable, &NAND_ONFI_CMD_PAGE_PROGRAM, sizeof(nand_cmd_t));
-                cmd_mutable->chains[1].cycles_defined   = true;
-                cmd_mutable->chains[1].cycles.addr[0]   = addr_column;
-                cmd_mutable->chains[1].cycles.addr[1]   = addr_row;
-                cmd_mutable->chains[2].cycles_defined   = true;
-                cmd_mutable->chains[2].cycles.raw       = raw_store;
-
-          nand_cmd_params_t*  const cmd_params          = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
-                cmd_params->lun_no                      = lun_no;
-                cmd_params->cmd_override                = cmd_mutable;
-
-    nand_run_cmd_chains(nand, &NAND_ONFI_CMD_PAGE_PROGRAM, cmd_params, err);
-
-    free(cmd_params);
-    free(cmd_mutable);
-    free(raw_store);
-
-    if(*err != NAND_RW_OK) {
-        free(err);
-        return -EIO;
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+          nand_t*             const nand                = (nand_t*)nand_onfi;
+    const uint64_t                  addr_row            = nand_page_no_to_addr_row(page_no);
+    const size_t                    page_size           = nand->data_bytes_per_page;
+
+    if(offset >= page_size) {
+        return -EOVERFLOW;
     }
 
-    free(err);
-    return size;
+    const size_t                    raw_size            = (size < page_size - offset) ? size : page_size - offset;
+
+    const uint8_t*            const cached              = mtd_nand_onfi_cache_lookup(mtd_nand, page_no);
+    if(cached != NULL) {
+        memcpy(read_buffer, &(cached[offset]), raw_size);
+        return raw_size;
+    }
+
+    const int                       ahead               = mtd_nand_onfi_readahead(mtd_nand, page_no, read_buffer, offset, raw_size);
+    if(ahead != 0) {
+        return ahead;
+    }
+
+    /** A page going to the cache is read as a whole, later reads of other parts of it hit */
+    uint8_t*                  const fill                = mtd_nand_onfi_cache_fill(mtd_nand, page_no);
+
+    if(! nand_ecc_on_host(&(mtd_nand->ecc))) {
+        uint8_t*              const target              = (fill != NULL) ? fill : read_buffer;
+        const uint32_t              target_offset       = (fill != NULL) ? 0 : offset;
+        const size_t                target_size         = (fill != NULL) ? page_size : raw_size;
+        const nand_rw_response_t    err                 = nand_onfi_read_page(nand_onfi, addr_row, nand_offset_to_addr_column(target_offset), target, target_size);
 
+        if(err != NAND_RW_OK) {
+            mtd_nand_onfi_cache_drop(mtd_nand, page_no);
+        }
+
+        switch(err) {
+        case NAND_RW_OK:
+            if(fill != NULL) {
+                memcpy(read_buffer, &(fill[offset]), raw_size);
+            }
+            return raw_size;
+
+        case NAND_RW_ECC_MISMATCH:  /**< on-die ECC */
+            DEBUG("mtd_nand_onfi_read_page: uncorrectable page %" PRIu32 "\n", page_no);
+            return -EBADMSG;
+
+        default:
+            return -EIO;
+        }
+    }
+
+    /** Codewords can only be checked as a whole, fetch data and spare in one go */
+    const int                       res                 = _read_full_page(mtd_nand, page_no);
+    if(res < 0) {
+        mtd_nand_onfi_cache_drop(mtd_nand, page_no);
+        return res;
+    }
+
+    if(fill != NULL) {
+        memcpy(fill, mtd_nand->page_buffer, page_size);
+    }
+    memcpy(read_buffer, &(mtd_nand->page_buffer[offset]), raw_size);
+
+    return raw_size;
 }
 
-static int mtd_nand_onfi_write_page(mtd_dev_t * const dev, const void * const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+/** Whether the parity area of a page is still erased, up to as many bitflips as one codeword corrects */
+static bool _parity_erased(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+          nand_t*             const nand                = (nand_t*)nand_onfi;
+    const size_t                    parity_offset       = nand->data_bytes_per_page + mtd_nand->ecc.spare_offset;
+    const size_t                    parity_size         = nand->spare_bytes_per_page - mtd_nand->ecc.spare_offset;
+          uint8_t*            const parity              = &(mtd_nand->page_buffer[parity_offset]);
+          size_t                    zeros               = 0;
+
+    if(nand_onfi_read_page(nand_onfi, nand_page_no_to_addr_row(page_no), nand_offset_to_addr_column(parity_offset), parity, parity_size) != NAND_RW_OK) {
+        return false;
+    }
+
+    for(size_t pos = 0; pos < parity_size && zeros <= mtd_nand->ecc.strength; ++pos) {
+        zeros += bitarithm_bits_set((uint8_t)~parity[pos]);
+    }
+
+    return zeros <= mtd_nand->ecc.strength;
+}
+
+static int _write_page(mtd_dev_t * const dev, const void * const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
 {
           mtd_nand_onfi_t *   const mtd_nand            = (mtd_nand_onfi_t*)dev;
-          nand_t*             const nand                = (nand_t*)&(mtd_nand->nand_onfi);
-    const uint64_t                  addr_column         = nand_offset_to_addr_column(offset);
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+          nand_t*             const nand                = (nand_t*)nand_onfi;
     const uint64_t                  addr_row            = nand_page_no_to_addr_row(page_no);
-    const uint8_t                   lun_no              = page_no / nand_one_lun_pages_count(nand); // TODO: lun_no looks invalid
-    const size_t                    page_size           = nand_one_page_size(nand);
-    const size_t                    raw_size            = (size < page_size) ? size : page_size; // TODO: Should throw error if size > page_size
-
-          nand_rw_response_t* const err                 = (nand_rw_response_t *)malloc(sizeof(nand_rw_response_t));
-
-          nand_raw_t*         const raw_store           = (nand_raw_t*)malloc(sizeof(nand_raw_t));
-                raw_store->raw_size                     = raw_size;
-                raw_store->buffer                       = write_buffer;
-                raw_store->buffer_size                  = raw_size;
-                raw_store->current_buffer_seq           = 0;
-                raw_store->current_raw_offset           = 0;
-
-          nand_cmd_t*         const cmd_mutable         = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
-                memcpy(cmd_mutable, &NAND_ONFI_CMD_PAGE_PROGRAM, sizeof(nand_cmd_t));
-                cmd_mutable->chains[1].cycles_defined   = true;
-                cmd_mutable->chains[1].cycles.addr[0]   = addr_column;
-                cmd_mutable->chains[1].cycles.addr[1]   = addr_row;
-                cmd_mutable->chains[2].cycles_defined   = true;
-                cmd_mutable->chains[2].cycles.raw       = raw_store;
-
-          nand_cmd_params_t*  const cmd_params          = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
-                cmd_params->lun_no                      = lun_no;
-                cmd_params->cmd_override                = cmd_mutable;
-
-    nand_run_cmd_chains(nand, &NAND_ONFI_CMD_PAGE_PROGRAM, cmd_params, err);
-
-    free(cmd_params);
-    free(cmd_mutable);
-    free(raw_store);
-
-    if(*err != NAND_RW_OK) {
-        free(err);
-        return -EIO;
+    const size_t                    page_size           = nand->data_bytes_per_page;
+
+    if(offset >= page_size) {
+        return -EOVERFLOW;
+    }
+
+    const size_t                    raw_size            = (size < page_size - offset) ? size : page_size - offset;
+    const uint32_t                  block_no            = page_no / nand->pages_per_block;
+
+    if(! nand_ecc_on_host(&(mtd_nand->ecc))) {
+        if(nand_bbt_is_bad(&(mtd_nand->bbt), block_no)) {
+            return -EIO;
+        }
+
+        bf_unset(mtd_nand->erased, block_no);
+        mtd_nand_onfi_cache_invalidate(mtd_nand, block_no);
+
+        const nand_rw_response_t    err                 = nand_onfi_program_page(nand_onfi, addr_row, nand_offset_to_addr_column(offset), write_buffer, raw_size);
+        if(err == NAND_RW_WRITE_ERROR) {
+            DEBUG("mtd_nand_onfi_write_page: program failed, retiring block %" PRIu32 "\n", block_no);
+            nand_bbt_mark_bad(&(mtd_nand->bbt), block_no);
+        }
+
+        return (err == NAND_RW_OK) ? (int)raw_size : -EIO;
+    }
+
+    /**
+     * The parity covers the whole page, so a page is programmed once with all
+     * bytes outside of [offset, offset + size) left erased. A second partial
+     * program would program over the parity of the first one.
+     */
+    if(raw_size < page_size && ! _parity_erased(mtd_nand, page_no)) {
+        DEBUG("mtd_nand_onfi_write_page: page %" PRIu32 " already programmed, partial program refused\n", page_no);
+        return -EINVAL;
+    }
+
+    memset(mtd_nand->page_buffer, 0xFF, nand_one_page_size(nand));
+    memcpy(&(mtd_nand->page_buffer[offset]), write_buffer, raw_size);
+
+    const int                       res                 = _program_full_page(mtd_nand, page_no);
+    if(res < 0) {
+        return res;
     }
 
-    free(err);
     return raw_size;
 }
 
-static int mtd_nand_onfi_erase(mtd_dev_t* const dev, const uint32_t addr_flat, const uint32_t count) {
-    return -ENOTSUP;
+static int mtd_nand_onfi_read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_onfi_t *         const mtd_nand            = (mtd_nand_onfi_t*)dev;
+
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const uint32_t                  start               = nand_stats_now();
+    const int                       res                 = _read_page(dev, read_buffer, page_no, offset, size);
+
+    nand_stats_mtd(NAND_STATS_OP_READ, start, res);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
 }
 
-static int mtd_nand_onfi_erase_block(mtd_dev_t* const dev, const uint32_t block_no, const uint32_t count)
+static int mtd_nand_onfi_write_page(mtd_dev_t * const dev, const void * const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_onfi_t *         const mtd_nand            = (mtd_nand_onfi_t*)dev;
+
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const uint32_t                  start               = nand_stats_now();
+    const int                       res                 = _write_page(dev, write_buffer, page_no, offset, size);
+
+    nand_stats_mtd(NAND_STATS_OP_PROGRAM, start, res);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
+}
+
+bool mtd_nand_onfi_block_erased(const mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no)
+{
+    return mtd_nand->erased != NULL && block_no < mtd_nand->base.sector_count && bf_isset(mtd_nand->erased, block_no);
+}
+
+size_t mtd_nand_onfi_oob_size(const mtd_nand_onfi_t* const mtd_nand)
+{
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+    const size_t                    spare_end           = nand_ecc_on_host(&(mtd_nand->ecc)) ? mtd_nand->ecc.spare_offset : nand->spare_bytes_per_page;
+
+    return (spare_end > MTD_NAND_ONFI_OOB_OFFSET) ? spare_end - MTD_NAND_ONFI_OOB_OFFSET : 0;
+}
+
+static int _read_page_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const data, void* const oob, const size_t oob_size)
+{
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+
+    if(oob_size > mtd_nand_onfi_oob_size(mtd_nand)) {
+        return -EOVERFLOW;
+    }
+
+    const int                       res                 = _read_full_page(mtd_nand, page_no);
+    if(res < 0) {
+        return res;
+    }
+
+    if(data != NULL) {
+        memcpy(data, mtd_nand->page_buffer, nand->data_bytes_per_page);
+    }
+    memcpy(oob, &(mtd_nand->page_buffer[nand->data_bytes_per_page + MTD_NAND_ONFI_OOB_OFFSET]), oob_size);
+
+    return 0;
+}
+
+static int _write_page_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, const void* const data, const void* const oob, const size_t oob_size)
+{
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+
+    if(oob_size > mtd_nand_onfi_oob_size(mtd_nand)) {
+        return -EOVERFLOW;
+    }
+
+    memset(mtd_nand->page_buffer, 0xFF, nand_one_page_size(nand));
+    memcpy(mtd_nand->page_buffer, data, nand->data_bytes_per_page);
+    memcpy(&(mtd_nand->page_buffer[nand->data_bytes_per_page + MTD_NAND_ONFI_OOB_OFFSET]), oob, oob_size);
+
+    return _program_full_page(mtd_nand, page_no);
+}
+
+static int _read_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const oob, const size_t oob_size)
+{
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+
+    if(oob_size > mtd_nand_onfi_oob_size(mtd_nand)) {
+        return -EOVERFLOW;
+    }
+
+    /** The data register is loaded as a whole, only the spare bytes are clocked out */
+    switch(nand_onfi_read_page(mtd_nand->nand_onfi, nand_page_no_to_addr_row(page_no), nand_offset_to_addr_column(nand->data_bytes_per_page + MTD_NAND_ONFI_OOB_OFFSET), oob, oob_size)) {
+    case NAND_RW_OK:
+        return 0;
+
+    case NAND_RW_ECC_MISMATCH:  /**< on-die ECC */
+        return -EBADMSG;
+
+    default:
+        return -EIO;
+    }
+}
+
+bool mtd_nand_onfi_oob_erased(const void* const oob, const size_t oob_size)
+{
+    const uint8_t*            const bytes               = (const uint8_t*)oob;
+          unsigned                  zero_bits           = 0;
+
+    for(size_t pos = 0; pos < oob_size; ++pos) {
+        zero_bits += bitarithm_bits_set((uint8_t)~bytes[pos]);
+        if(zero_bits > MTD_NAND_ONFI_OOB_ERASED_FLIPS) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int _find_frontier(mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no, void* const oob, const size_t oob_size)
+{
+    const nand_t*             const nand                = (nand_t*)mtd_nand->nand_onfi;
+    const uint32_t                  first_page          = block_no * nand->pages_per_block;
+          uint32_t                  programmed          = 0;                        /**< pages below are programmed */
+          uint32_t                  erased              = nand->pages_per_block;    /**< pages from here on are erased */
+
+    /** Unreadable pages are programmed, an erased page would pass the on-die ECC */
+    while(programmed < erased) {
+        const uint32_t              page                = programmed + (erased - programmed) / 2;
+        const int                   res                 = _read_oob(mtd_nand, first_page + page, oob, oob_size);
+
+        if(res == -EIO || res == -EOVERFLOW) {
+            return res;
+        }
+
+        if(res == 0 && mtd_nand_onfi_oob_erased(oob, oob_size)) {
+            erased = page;
+        } else {
+            programmed = page + 1;
+        }
+    }
+
+    return erased;
+}
+
+int mtd_nand_onfi_read_page_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const data, void* const oob, const size_t oob_size)
+{
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const int                       res                 = _read_page_oob(mtd_nand, page_no, data, oob, oob_size);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
+}
+
+int mtd_nand_onfi_write_page_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, const void* const data, const void* const oob, const size_t oob_size)
+{
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const int                       res                 = _write_page_oob(mtd_nand, page_no, data, oob, oob_size);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
+}
+
+int mtd_nand_onfi_read_oob(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const oob, const size_t oob_size)
+{
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const int                       res                 = _read_oob(mtd_nand, page_no, oob, oob_size);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
+}
+
+int mtd_nand_onfi_find_frontier(mtd_nand_onfi_t* const mtd_nand, const uint32_t block_no, void* const oob, const size_t oob_size)
+{
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const int                       res                 = _find_frontier(mtd_nand, block_no, oob, oob_size);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
+}
+
+int mtd_nand_onfi_copyback(mtd_nand_onfi_t* const mtd_nand, const uint32_t src_page_no, const uint32_t dst_page_no)
+{
+    const nand_t*             const nand                = (const nand_t*)mtd_nand->nand_onfi;
+    const uint32_t                  block_no            = dst_page_no / nand->pages_per_block;
+          int                       res                 = -EIO;
+
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    if(! nand_bbt_is_bad(&(mtd_nand->bbt), block_no)) {
+        bf_unset(mtd_nand->erased, block_no);
+        mtd_nand_onfi_cache_invalidate(mtd_nand, block_no);
+
+        switch(nand_onfi_copyback(mtd_nand->nand_onfi, nand_page_no_to_addr_row(src_page_no), nand_page_no_to_addr_row(dst_page_no))) {
+        case NAND_RW_OK:
+            res = 0;
+            break;
+
+        case NAND_RW_NOT_SUPPORTED:
+            res = -ENOTSUP;
+            break;
+
+        case NAND_RW_WRITE_ERROR:
+            DEBUG("mtd_nand_onfi_copyback: program failed, retiring block %" PRIu32 "\n", block_no);
+            nand_bbt_mark_bad(&(mtd_nand->bbt), block_no);
+            break;
+
+        default:
+            break;
+        }
+    }
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
+}
+
+static int _erase_block(mtd_dev_t* const dev, const uint32_t block_no, const uint32_t count)
 {
     mtd_nand_onfi_t *   const mtd_nand  = (mtd_nand_onfi_t*)dev;
-    nand_t*             const nand      = (nand_t*)&(mtd_nand->nand_onfi);
-    nand_rw_response_t* const err       = (nand_rw_response_t *)malloc(sizeof(nand_rw_response_t));
+    nand_onfi_t*        const nand_onfi = mtd_nand->nand_onfi;
+    nand_t*             const nand      = (nand_t*)nand_onfi;
 
     for(uint32_t erasure_pos = block_no; erasure_pos < block_no + count; ++erasure_pos) {
-        const uint64_t                  addr_row            = nand_page_no_to_addr_row(erasure_pos);
-        const uint8_t                   lun_no              = erasure_pos / nand->blocks_per_lun; // TODO: lun_no looks invalid
+        const uint64_t addr_row = nand_page_no_to_addr_row((uint64_t)erasure_pos * nand->pages_per_block);
 
-              nand_cmd_t*         const cmd_mutable         = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
-                    memcpy(cmd_mutable, &NAND_ONFI_CMD_BLOCK_ERASE, sizeof(nand_cmd_t));
-                    cmd_mutable->chains[1].cycles_defined   = true;
-                    cmd_mutable->chains[1].cycles.addr_row  = addr_row;
+        if(nand_bbt_is_bad(&(mtd_nand->bbt), erasure_pos)) {
+            return -EIO;
+        }
 
-              nand_cmd_params_t*  const cmd_params          = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
-                    cmd_params->lun_no                      = lun_no;
-                    cmd_params->cmd_override                = cmd_mutable;
+        /** Nothing programmed since the last erase */
+        if(bf_isset(mtd_nand->erased, erasure_pos)) {
+            continue;
+        }
 
-        nand_run_cmd_chains(nand, &NAND_ONFI_CMD_BLOCK_ERASE, cmd_params, err);
+        mtd_nand_onfi_cache_invalidate(mtd_nand, erasure_pos);
 
-        free(cmd_params);
-        free(cmd_mutable);
+        const nand_rw_response_t err = nand_onfi_erase_block(nand_onfi, addr_row);
+        if(err == NAND_RW_WRITE_ERROR) {
+            DEBUG("mtd_nand_onfi_erase_block: erase failed, retiring block %" PRIu32 "\n", erasure_pos);
+            nand_bbt_mark_bad(&(mtd_nand->bbt), erasure_pos);
+        }
 
-        if(*err != NAND_RW_OK) {
-            free(err);
+        if(err != NAND_RW_OK) {
             return -EIO;
         }
+
+        bf_set(mtd_nand->erased, erasure_pos);
     }
 
-    free(err);
-    return count;
+    return 0;
+}
+
+static int mtd_nand_onfi_erase_block(mtd_dev_t* const dev, const uint32_t block_no, const uint32_t count)
+{
+    mtd_nand_onfi_t *   const mtd_nand  = (mtd_nand_onfi_t*)dev;
+
+    mutex_lock(&(mtd_nand->nand_onfi->nand.lock));
+    const uint32_t      start       = nand_stats_now();
+    const int           res         = _erase_block(dev, block_no, count);
+
+    nand_stats_mtd(NAND_STATS_OP_ERASE, start, res);
+    mutex_unlock(&(mtd_nand->nand_onfi->nand.lock));
+
+    return res;
 }
 
 static int mtd_nand_onfi_power(mtd_dev_t *dev, enum mtd_power_state power)
 {
     mtd_nand_onfi_t *   const mtd_nand  = (mtd_nand_onfi_t*)dev;
-    nand_t*             const nand      = (nand_t*)&(mtd_nand->nand_onfi);
+    nand_t*             const nand      = (nand_t*)mtd_nand->nand_onfi;
 
+    mutex_lock(&(nand->lock));
     switch(power) {
     case MTD_POWER_UP:
         for(uint8_t this_lun_no = 0; this_lun_no < nand->lun_count; ++this_lun_no) {
@@ -270,21 +599,19 @@ static int mtd_nand_onfi_power(mtd_dev_t *dev, enum mtd_power_state power)
 
     case MTD_POWER_DOWN:
         for(uint8_t this_lun_no = 0; this_lun_no < nand->lun_count; ++this_lun_no) {
-            nand_onfi_set_chip_disable(nand, this_lun_no);
+            nand_set_chip_disable(nand, this_lun_no);
         }
         break;
     }
+    mutex_unlock(&(nand->lock));
 
     return 0;
 }
 
 const mtd_desc_t mtd_nand_driver = {
     .init           = mtd_nand_onfi_init,
-    .read           = mtd_nand_onfi_read,
     .read_page      = mtd_nand_onfi_read_page,
-    .write          = mtd_nand_onfi_write,
     .write_page     = mtd_nand_onfi_write_page,
-    .erase          = mtd_nand_onfi_erase,
     .erase_sector   = mtd_nand_onfi_erase_block,
     .power          = mtd_nand_onfi_power,
-};
\ No newline at end of file
+};
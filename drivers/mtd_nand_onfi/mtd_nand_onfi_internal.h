@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Page cache and read-ahead hooks of the mtd_nand_onfi driver
+ *
+ * Without the `mtd_nand_onfi_cache` and `mtd_nand_onfi_readahead` modules
+ * they compile to nothing.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef MTD_NAND_ONFI_INTERNAL_H
+#define MTD_NAND_ONFI_INTERNAL_H
+
+#include <stdint.h>
+
+#include "mtd_nand_onfi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if IS_USED(MODULE_MTD_NAND_ONFI_CACHE)
+/** Allocates the entries for the page size of the NAND, or empties the cache if they are */
+int mtd_nand_onfi_cache_init(mtd_nand_onfi_t* const mtd_nand);
+
+/** Data area of @p page_no if cached, counting a hit or a miss */
+const uint8_t* mtd_nand_onfi_cache_lookup(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no);
+
+/** Entry data for @p page_no to be read into, replacing the least recently used page */
+uint8_t* mtd_nand_onfi_cache_fill(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no);
+
+/** Drops @p page_no, after a failed read into its entry */
+void mtd_nand_onfi_cache_drop(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no);
+#else
+static inline int mtd_nand_onfi_cache_init(mtd_nand_onfi_t* const mtd_nand)
+{
+    (void)mtd_nand;
+    return 0;
+}
+
+static inline const uint8_t* mtd_nand_onfi_cache_lookup(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+    (void)mtd_nand;
+    (void)page_no;
+    return NULL;
+}
+
+static inline uint8_t* mtd_nand_onfi_cache_fill(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+    (void)mtd_nand;
+    (void)page_no;
+    return NULL;
+}
+
+static inline void mtd_nand_onfi_cache_drop(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no)
+{
+    (void)mtd_nand;
+    (void)page_no;
+}
+#endif
+
+#if IS_USED(MODULE_MTD_NAND_ONFI_READAHEAD)
+/** Starts without a stream */
+void mtd_nand_onfi_readahead_init(mtd_nand_onfi_t* const mtd_nand);
+
+/**
+ * Reads @p page_no on a cache miss together with the pages following it if
+ * a stream continues there, and copies the requested range out. Returns the
+ * bytes copied, or 0 if the caller is to read the page alone.
+ */
+int mtd_nand_onfi_readahead(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const read_buffer, const uint32_t offset, const uint32_t size);
+#else
+static inline void mtd_nand_onfi_readahead_init(mtd_nand_onfi_t* const mtd_nand)
+{
+    (void)mtd_nand;
+}
+
+static inline int mtd_nand_onfi_readahead(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const read_buffer, const uint32_t offset, const uint32_t size)
+{
+    (void)mtd_nand;
+    (void)page_no;
+    (void)read_buffer;
+    (void)offset;
+    (void)size;
+    return 0;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MTD_NAND_ONFI_INTERNAL_H */
+/** @} */
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Sequential read-ahead of the mtd_nand_onfi driver
+ *
+ * Pages read ahead go to the page cache like any other page read, the
+ * stream is only told apart by where the next miss falls.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "mtd_nand_onfi.h"
+#include "mtd_nand_onfi_internal.h"
+#include "nand.h"
+#include "nand/onfi.h"
+#include "nand/ecc.h"
+#include "nand/stats.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+/** More than the cache holds would replace the first pages of the window by the last ones */
+#define MTD_NAND_ONFI_READAHEAD_WINDOW_MAX  ((CONFIG_MTD_NAND_ONFI_READAHEAD_MAX < CONFIG_MTD_NAND_ONFI_CACHE_PAGES) ? CONFIG_MTD_NAND_ONFI_READAHEAD_MAX : CONFIG_MTD_NAND_ONFI_CACHE_PAGES)
+
+void mtd_nand_onfi_readahead_init(mtd_nand_onfi_t* const mtd_nand)
+{
+    mtd_nand_onfi_readahead_t* const ra                 = &(mtd_nand->readahead);
+
+    ra->start   = UINT32_MAX;
+    ra->end     = UINT32_MAX;
+    ra->window  = 1;
+}
+
+/** Window for a miss on @p page_no, by how the last window was used */
+static uint16_t _adapt(mtd_nand_onfi_readahead_t* const ra, const uint32_t page_no)
+{
+    if(page_no == ra->end) {
+        /** All pages read ahead were taken */
+        return (ra->window * 2 < MTD_NAND_ONFI_READAHEAD_WINDOW_MAX) ? ra->window * 2 : MTD_NAND_ONFI_READAHEAD_WINDOW_MAX;
+    }
+
+    if(page_no >= ra->start && page_no < ra->end) {
+        /** Replaced before the reader got to it */
+        return (ra->window > 1) ? ra->window / 2 : 1;
+    }
+
+    return 1;
+}
+
+/** Moves the next page of a cache read into @p fill, corrected if the host does the ECC */
+static nand_rw_response_t _read_next(mtd_nand_onfi_t* const mtd_nand, const uint8_t lun_no, uint8_t* const fill, const bool last)
+{
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+    const nand_t*             const nand                = (nand_t*)nand_onfi;
+          uint8_t*            const page_buffer         = mtd_nand->page_buffer;
+
+    if(! nand_ecc_on_host(&(mtd_nand->ecc))) {
+        return nand_onfi_read_cache_next(nand_onfi, lun_no, fill, nand->data_bytes_per_page, last);
+    }
+
+    const nand_rw_response_t        err                 = nand_onfi_read_cache_next(nand_onfi, lun_no, page_buffer, nand_one_page_size(nand), last);
+    if(err != NAND_RW_OK) {
+        return err;
+    }
+
+    size_t                          corrected_bits      = 0;
+    if(nand_ecc_correct(&(mtd_nand->ecc), page_buffer, &(page_buffer[nand->data_bytes_per_page]), &corrected_bits) != NAND_RW_OK) {
+        return NAND_RW_ECC_MISMATCH;
+    }
+
+    nand_stats_ecc(corrected_bits);
+
+    memcpy(fill, page_buffer, nand->data_bytes_per_page);
+
+    return NAND_RW_OK;
+}
+
+int mtd_nand_onfi_readahead(mtd_nand_onfi_t* const mtd_nand, const uint32_t page_no, void* const read_buffer, const uint32_t offset, const uint32_t size)
+{
+          mtd_nand_onfi_readahead_t* const ra           = &(mtd_nand->readahead);
+          nand_onfi_t*        const nand_onfi           = mtd_nand->nand_onfi;
+    const nand_t*             const nand                = (nand_t*)nand_onfi;
+    const uint32_t                  block_end           = (page_no / nand->pages_per_block + 1) * nand->pages_per_block;
+
+    ra->window = _adapt(ra, page_no);
+
+    const uint32_t                  count               = (ra->window < block_end - page_no) ? ra->window : block_end - page_no;
+
+    ra->start   = page_no;
+    ra->end     = page_no + 1;
+
+    if(count < 2 || ! nand_onfi_has_read_cache(nand_onfi)) {
+        return 0;
+    }
+
+    const uint8_t                   lun_no              = nand_addr_row_to_lun_no(nand, nand_page_no_to_addr_row(page_no));
+          int                       res                 = -EIO;
+
+    DEBUG("mtd_nand_onfi_readahead: pages %" PRIu32 " to %" PRIu32 "\n", page_no, page_no + count - 1);
+
+    if(nand_onfi_read_cache_start(nand_onfi, nand_page_no_to_addr_row(page_no)) != NAND_RW_OK) {
+        return -EIO;
+    }
+
+    for(uint32_t pos = 0; pos < count; ++pos) {
+        const bool                    last              = (pos + 1 == count);
+        uint8_t*                const fill              = mtd_nand_onfi_cache_fill(mtd_nand, page_no + pos);
+        const nand_rw_response_t      err               = _read_next(mtd_nand, lun_no, fill, last);
+
+        if(err != NAND_RW_OK) {
+            mtd_nand_onfi_cache_drop(mtd_nand, page_no + pos);
+        }
+
+        if(pos == 0) {
+            if(err == NAND_RW_OK) {
+                memcpy(read_buffer, &(fill[offset]), size);
+                res = size;
+            } else if(err == NAND_RW_ECC_MISMATCH) {
+                DEBUG("mtd_nand_onfi_readahead: uncorrectable page %" PRIu32 "\n", page_no);
+                res = -EBADMSG;
+            }
+        }
+
+        /** Uncorrectable pages are left to a read of their own, the run goes on */
+        if(err != NAND_RW_OK && err != NAND_RW_ECC_MISMATCH) {
+            DEBUG("mtd_nand_onfi_readahead: run stopped at page %" PRIu32 "\n", page_no + pos);
+
+            /** The part is still in the cache read, it has to leave it before the next command */
+            if(! last) {
+                nand_onfi_read_cache_end(nand_onfi, lun_no);
+            }
+
+            /** The pages read ahead are a bonus, the page asked for is what counts */
+            return (pos > 0) ? res : -EIO;
+        }
+
+        ra->end = page_no + pos + 1;
+    }
+
+    return res;
+}
@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_mtd_nand_wb
+ * @{
+ *
+ * @file
+ * @brief       mtd write-back page buffer for NANDs
+ *
+ * Bytes of a slot outside of its dirty range are kept erased (0xFF), so a
+ * program of the whole range leaves the rest of the page as it is.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "mtd_nand_wb.h"
+#include "mtd.h"
+#include "ztimer.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+static inline uint8_t* _slot_data(const mtd_nand_wb_t* const wb, const mtd_nand_wb_slot_t* const slot) {
+    return &(wb->buffer[(slot - wb->slots) * wb->base.page_size]);
+}
+
+static inline bool _slot_dirty(const mtd_nand_wb_slot_t* const slot) {
+    return slot->dirty_end > slot->dirty_start;
+}
+
+static mtd_nand_wb_slot_t* _find_slot(mtd_nand_wb_t* const wb, const uint32_t page_no) {
+    for(unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; ++pos) {
+        if(wb->slots[pos].page_no == page_no) {
+            return &(wb->slots[pos]);
+        }
+    }
+
+    return NULL;
+}
+
+static void _release(const mtd_nand_wb_t* const wb, mtd_nand_wb_slot_t* const slot) {
+    memset(_slot_data(wb, slot), 0xFF, wb->base.page_size);
+    slot->page_no       = MTD_NAND_WB_NO_PAGE;
+    slot->dirty_start   = 0;
+    slot->dirty_end     = 0;
+}
+
+/** Programs the dirty range of a slot and frees it, the slot is freed on a failed program as well */
+static int _flush(mtd_nand_wb_t* const wb, mtd_nand_wb_slot_t* const slot) {
+    int res = 0;
+
+    if(_slot_dirty(slot)) {
+        DEBUG("mtd_nand_wb: programming page %" PRIu32 " [%" PRIu32 ", %" PRIu32 ")\n", slot->page_no, slot->dirty_start, slot->dirty_end);
+
+        res = mtd_write_page_raw(wb->parent, &(_slot_data(wb, slot)[slot->dirty_start]), slot->page_no, slot->dirty_start, slot->dirty_end - slot->dirty_start);
+        wb->programs += 1;
+    }
+
+    _release(wb, slot);
+
+    return res;
+}
+
+/** Programs the slots whose oldest write timed out */
+static int _flush_expired(mtd_nand_wb_t* const wb) {
+    if(CONFIG_MTD_NAND_WB_TIMEOUT_MS == 0) {
+        return 0;
+    }
+
+    const uint32_t            now       = ztimer_now(ZTIMER_MSEC);
+          int                 res       = 0;
+
+    for(unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; ++pos) {
+        mtd_nand_wb_slot_t* const slot = &(wb->slots[pos]);
+
+        if(_slot_dirty(slot) && now - slot->since >= CONFIG_MTD_NAND_WB_TIMEOUT_MS) {
+            const int flush_res = _flush(wb, slot);
+            if(res == 0) {
+                res = flush_res;
+            }
+        }
+    }
+
+    return res;
+}
+
+/** Slot of @p page_no, taking a free or the least recently written one, NULL if that one fails to program */
+static mtd_nand_wb_slot_t* _claim(mtd_nand_wb_t* const wb, const uint32_t page_no, int* const res) {
+    mtd_nand_wb_slot_t*       victim    = _find_slot(wb, page_no);
+
+    *res = 0;
+    if(victim != NULL) {
+        return victim;
+    }
+
+    for(unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; ++pos) {
+        mtd_nand_wb_slot_t* const slot = &(wb->slots[pos]);
+
+        if(slot->page_no == MTD_NAND_WB_NO_PAGE) {
+            victim = slot;
+            break;
+        }
+        if(victim == NULL || wb->used - slot->used > wb->used - victim->used) {
+            victim = slot;
+        }
+    }
+
+    /** The victim only changes its page once its data is out */
+    if(victim->page_no != MTD_NAND_WB_NO_PAGE) {
+        *res = _flush(wb, victim);
+        if(*res < 0) {
+            return NULL;
+        }
+    }
+
+    victim->page_no = page_no;
+
+    return victim;
+}
+
+int mtd_nand_wb_sync(mtd_nand_wb_t* const wb) {
+    int res = 0;
+
+    if(wb->buffer == NULL) {
+        return 0;
+    }
+
+    for(unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; ++pos) {
+        if(wb->slots[pos].page_no == MTD_NAND_WB_NO_PAGE) {
+            continue;
+        }
+
+        const int flush_res = _flush(wb, &(wb->slots[pos]));
+        if(res == 0) {
+            res = flush_res;
+        }
+    }
+
+    return res;
+}
+
+static int mtd_nand_wb_init(mtd_dev_t* const dev)
+{
+    if(dev == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_nand_wb_t*      const wb        = (mtd_nand_wb_t*)dev;
+    if(wb->parent == NULL) {
+        return -ENODEV;
+    }
+
+    mtd_dev_t*          const parent    = wb->parent;
+    if(parent->sector_count == 0) {
+        const int res = mtd_init(parent);
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    /** Data still buffered for the old geometry goes out first */
+    mtd_nand_wb_sync(wb);
+
+    dev->sector_count           = parent->sector_count;
+    dev->pages_per_sector       = parent->pages_per_sector;
+    dev->page_size              = parent->page_size;
+
+    free(wb->buffer);
+    wb->buffer                  = (uint8_t*)malloc(sizeof(uint8_t) * dev->page_size * CONFIG_MTD_NAND_WB_SLOTS);
+    if(wb->buffer == NULL) {
+        return -ENOMEM;
+    }
+
+    for(unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; ++pos) {
+        _release(wb, &(wb->slots[pos]));
+    }
+
+    wb->used                    = 0;
+    wb->writes                  = 0;
+    wb->programs                = 0;
+
+    return 0;
+}
+
+static int mtd_nand_wb_read_page(mtd_dev_t* const dev, void* const read_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_wb_t*      const wb        = (mtd_nand_wb_t*)dev;
+    mtd_dev_t*          const parent    = wb->parent;
+
+    if(page_no >= dev->sector_count * dev->pages_per_sector || offset >= dev->page_size) {
+        return -EOVERFLOW;
+    }
+
+    const int                 flush_res = _flush_expired(wb);
+    if(flush_res < 0) {
+        return flush_res;
+    }
+
+    const int                 res       = parent->driver->read_page(parent, read_buffer, page_no, offset, size);
+    if(res <= 0) {
+        return res;
+    }
+
+    /** Buffered bytes are newer than the NAND, they read back as the flush would leave them. Programs
+     *  only clear bits, so the 0xFF gaps between writes keep what is already on the NAND */
+    const mtd_nand_wb_slot_t* const slot = _find_slot(wb, page_no);
+    if(slot != NULL && _slot_dirty(slot)) {
+        const uint32_t start    = (offset > slot->dirty_start) ? offset : slot->dirty_start;
+        const uint32_t end      = (offset + res < slot->dirty_end) ? offset + res : slot->dirty_end;
+        uint8_t*       const out    = (uint8_t*)read_buffer;
+        const uint8_t* const data   = _slot_data(wb, slot);
+
+        for(uint32_t pos = start; pos < end; ++pos) {
+            out[pos - offset] &= data[pos];
+        }
+    }
+
+    return res;
+}
+
+static int mtd_nand_wb_write_page(mtd_dev_t* const dev, const void* const write_buffer, const uint32_t page_no, const uint32_t offset, const uint32_t size)
+{
+    mtd_nand_wb_t*      const wb        = (mtd_nand_wb_t*)dev;
+    mtd_dev_t*          const parent    = wb->parent;
+
+    if(page_no >= dev->sector_count * dev->pages_per_sector || offset >= dev->page_size) {
+        return -EOVERFLOW;
+    }
+
+    const uint32_t            raw_size  = (size < dev->page_size - offset) ? size : dev->page_size - offset;
+
+    wb->writes += 1;
+
+    int                       res       = _flush_expired(wb);
+    if(res < 0) {
+        return res;
+    }
+
+    /** Nothing to coalesce with */
+    if(raw_size == dev->page_size && _find_slot(wb, page_no) == NULL) {
+        wb->programs += 1;
+        return parent->driver->write_page(parent, write_buffer, page_no, 0, raw_size);
+    }
+
+    mtd_nand_wb_slot_t* const slot      = _claim(wb, page_no, &res);
+    if(res < 0) {
+        return res;
+    }
+
+    if(! _slot_dirty(slot)) {
+        slot->dirty_start   = offset;
+        slot->dirty_end     = offset + raw_size;
+        slot->since         = ztimer_now(ZTIMER_MSEC);
+    } else {
+        slot->dirty_start   = (offset < slot->dirty_start) ? offset : slot->dirty_start;
+        slot->dirty_end     = (offset + raw_size > slot->dirty_end) ? offset + raw_size : slot->dirty_end;
+    }
+
+    memcpy(&(_slot_data(wb, slot)[offset]), write_buffer, raw_size);
+    slot->used = ++wb->used;
+
+    if(slot->dirty_start == 0 && slot->dirty_end == dev->page_size) {
+        res = _flush(wb, slot);
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    return raw_size;
+}
+
+static int mtd_nand_wb_erase_sector(mtd_dev_t* const dev, const uint32_t sector, const uint32_t count)
+{
+    mtd_nand_wb_t*      const wb        = (mtd_nand_wb_t*)dev;
+    mtd_dev_t*          const parent    = wb->parent;
+
+    if(sector + count > dev->sector_count) {
+        return -EOVERFLOW;
+    }
+
+    /** Whatever was buffered for the erased pages is gone with them */
+    for(unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; ++pos) {
+        mtd_nand_wb_slot_t* const slot = &(wb->slots[pos]);
+
+        if(slot->page_no != MTD_NAND_WB_NO_PAGE && slot->page_no / dev->pages_per_sector - sector < count) {
+            _release(wb, slot);
+        }
+    }
+
+    return parent->driver->erase_sector(parent, sector, count);
+}
+
+static int mtd_nand_wb_power(mtd_dev_t *dev, enum mtd_power_state power)
+{
+    mtd_nand_wb_t*      const wb        = (mtd_nand_wb_t*)dev;
+
+    /** Still powered up on an error, the caller may retry */
+    if(power == MTD_POWER_DOWN) {
+        const int res = mtd_nand_wb_sync(wb);
+        if(res < 0) {
+            return res;
+        }
+    }
+
+    return mtd_power(wb->parent, power);
+}
+
+const mtd_desc_t mtd_nand_wb_driver = {
+    .init           = mtd_nand_wb_init,
+    .read_page      = mtd_nand_wb_read_page,
+    .write_page     = mtd_nand_wb_write_page,
+    .erase_sector   = mtd_nand_wb_erase_sector,
+    .power          = mtd_nand_wb_power,
+};
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand
+ * @{
+ *
+ * @file
+ * @brief       Default pin configuration for a single 8-bit NAND
+ *
+ * Boards wiring a NAND override the NAND_PARAM_* pins they use.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+
+#ifndef NAND_PARAMS_H
+#define NAND_PARAMS_H
+
+#include "board.h"
+#include "nand.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name    Set default configuration parameters for the nand driver
+ * @{
+ */
+#ifndef NAND_PARAM_CE0
+#define NAND_PARAM_CE0              GPIO_PIN(0, 0)
+#endif
+#ifndef NAND_PARAM_CE1
+#define NAND_PARAM_CE1              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_CE2
+#define NAND_PARAM_CE2              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_CE3
+#define NAND_PARAM_CE3              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_CE4
+#define NAND_PARAM_CE4              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_CE5
+#define NAND_PARAM_CE5              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_CE6
+#define NAND_PARAM_CE6              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_CE7
+#define NAND_PARAM_CE7              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB0
+#define NAND_PARAM_RB0              GPIO_PIN(0, 1)
+#endif
+#ifndef NAND_PARAM_RB1
+#define NAND_PARAM_RB1              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB2
+#define NAND_PARAM_RB2              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB3
+#define NAND_PARAM_RB3              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB4
+#define NAND_PARAM_RB4              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB5
+#define NAND_PARAM_RB5              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB6
+#define NAND_PARAM_RB6              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RB7
+#define NAND_PARAM_RB7              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_RE
+#define NAND_PARAM_RE               GPIO_PIN(0, 2)
+#endif
+#ifndef NAND_PARAM_WE
+#define NAND_PARAM_WE               GPIO_PIN(0, 3)
+#endif
+#ifndef NAND_PARAM_WP
+#define NAND_PARAM_WP               GPIO_PIN(0, 4)
+#endif
+#ifndef NAND_PARAM_CLE
+#define NAND_PARAM_CLE              GPIO_PIN(0, 5)
+#endif
+#ifndef NAND_PARAM_ALE
+#define NAND_PARAM_ALE              GPIO_PIN(0, 6)
+#endif
+#ifndef NAND_PARAM_IO0
+#define NAND_PARAM_IO0              GPIO_PIN(1, 0)
+#endif
+#ifndef NAND_PARAM_IO1
+#define NAND_PARAM_IO1              GPIO_PIN(1, 1)
+#endif
+#ifndef NAND_PARAM_IO2
+#define NAND_PARAM_IO2              GPIO_PIN(1, 2)
+#endif
+#ifndef NAND_PARAM_IO3
+#define NAND_PARAM_IO3              GPIO_PIN(1, 3)
+#endif
+#ifndef NAND_PARAM_IO4
+#define NAND_PARAM_IO4              GPIO_PIN(1, 4)
+#endif
+#ifndef NAND_PARAM_IO5
+#define NAND_PARAM_IO5              GPIO_PIN(1, 5)
+#endif
+#ifndef NAND_PARAM_IO6
+#define NAND_PARAM_IO6              GPIO_PIN(1, 6)
+#endif
+#ifndef NAND_PARAM_IO7
+#define NAND_PARAM_IO7              GPIO_PIN(1, 7)
+#endif
+#ifndef NAND_PARAM_IO8
+#define NAND_PARAM_IO8              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO9
+#define NAND_PARAM_IO9              (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO10
+#define NAND_PARAM_IO10             (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO11
+#define NAND_PARAM_IO11             (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO12
+#define NAND_PARAM_IO12             (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO13
+#define NAND_PARAM_IO13             (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO14
+#define NAND_PARAM_IO14             (GPIO_UNDEF)
+#endif
+#ifndef NAND_PARAM_IO15
+#define NAND_PARAM_IO15             (GPIO_UNDEF)
+#endif
+
+#ifndef NAND_PARAMS
+#define NAND_PARAMS                 { .ce   = { NAND_PARAM_CE0, NAND_PARAM_CE1,     \
+                                                NAND_PARAM_CE2, NAND_PARAM_CE3,     \
+                                                NAND_PARAM_CE4, NAND_PARAM_CE5,     \
+                                                NAND_PARAM_CE6, NAND_PARAM_CE7 },   \
+                                      .rb   = { NAND_PARAM_RB0, NAND_PARAM_RB1,     \
+                                                NAND_PARAM_RB2, NAND_PARAM_RB3,     \
+                                                NAND_PARAM_RB4, NAND_PARAM_RB5,     \
+                                                NAND_PARAM_RB6, NAND_PARAM_RB7 },   \
+                                      .re   = NAND_PARAM_RE,                        \
+                                      .we   = NAND_PARAM_WE,                        \
+                                      .wp   = NAND_PARAM_WP,                        \
+                                      .cle  = NAND_PARAM_CLE,                       \
+                                      .ale  = NAND_PARAM_ALE,                       \
+                                      .io   = { NAND_PARAM_IO0, NAND_PARAM_IO1,     \
+                                                NAND_PARAM_IO2, NAND_PARAM_IO3,     \
+                                                NAND_PARAM_IO4, NAND_PARAM_IO5,     \
+                                                NAND_PARAM_IO6, NAND_PARAM_IO7,     \
+                                                NAND_PARAM_IO8, NAND_PARAM_IO9,     \
+                                                NAND_PARAM_IO10, NAND_PARAM_IO11,   \
+                                                NAND_PARAM_IO12, NAND_PARAM_IO13,   \
+                                                NAND_PARAM_IO14, NAND_PARAM_IO15 } }
+#endif
+/** @} */
+
+/**
+ * @brief   nand configuration
+ */
+static const nand_params_t nand_params[] = {
+    NAND_PARAMS
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NAND_PARAMS_H */
+/** @} */
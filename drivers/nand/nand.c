@@ -23,13 +23,316 @@
 #include "debug.h"
 
 #include "nand.h"
+#include "nand/stats.h"
+#include "nand/trace.h"
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
-int nand_init(nand_t* const nand, nand_params_t* const params) {
+/** READ STATUS for a LUN without R/B#, the same on ONFI and on older parts */
+#define NAND_STATUS_CMD_READ_STATUS         (0x70)
+#define NAND_STATUS_CMD_READ_MODE           (0x00)  /**< back to data output after a status read */
+#define NAND_STATUS_RDY                     (0x40)
+
+/** Its delays, the slowest SDR timing mode */
+#define NAND_STATUS_TIMING_SETUP_NS         (50)    /**< tCLS, tWP */
+#define NAND_STATUS_TIMING_HOLD_NS          (30)    /**< tCLH, tWH, tREH */
+#define NAND_STATUS_TIMING_WHR_NS           (120)
+#define NAND_STATUS_TIMING_REA_NS           (40)
+
+/** One byte lane of the data bus, pin by pin */
+static inline void _write_lane_pins(const nand_t* const nand, const unsigned lane_no, const uint8_t data) {
+    const gpio_t* const io = &(nand->params->io[lane_no * NAND_IO_LANE_BITS]);
+
+    for(unsigned bit = 0; bit < NAND_IO_LANE_BITS; ++bit) {
+        gpio_write(io[bit], (data >> bit) & 1);
+    }
+}
+
+static inline uint8_t _read_lane_pins(const nand_t* const nand, const unsigned lane_no) {
+    const gpio_t* const io   = &(nand->params->io[lane_no * NAND_IO_LANE_BITS]);
+    uint8_t             data = 0;
+
+    for(unsigned bit = 0; bit < NAND_IO_LANE_BITS; ++bit) {
+        data |= (gpio_read(io[bit]) != 0) << bit;
+    }
+
+    return data;
+}
+
+#if IS_USED(MODULE_PERIPH_GPIO_LL)
+/** Port access for each byte lane on consecutive pins of one port */
+static void _io_lanes_init(nand_t* const nand) {
+    for(unsigned lane_no = 0; lane_no < ARRAY_SIZE(nand->io_lane); ++lane_no) {
+        nand_io_lane_t* const lane  = &(nand->io_lane[lane_no]);
+        const gpio_t* const   io    = &(nand->params->io[lane_no * NAND_IO_LANE_BITS]);
+
+        lane->port  = GPIO_PORT_UNDEF;
+        lane->shift = 0;
+        lane->mask  = 0;
+
+        if(! gpio_is_valid(io[0])) {
+            continue;
+        }
+
+        const unsigned first    = gpio_get_pin_num(io[0]);
+        bool           in_order = (first + NAND_IO_LANE_BITS <= sizeof(uword_t) * 8);
+
+        for(unsigned bit = 1; in_order && bit < NAND_IO_LANE_BITS; ++bit) {
+            if(! gpio_is_valid(io[bit]) || gpio_get_port(io[bit]) != gpio_get_port(io[0]) || (unsigned)gpio_get_pin_num(io[bit]) != first + bit) {
+                in_order = false;
+            }
+        }
+
+        if(! in_order) {
+            DEBUG("nand_init: I/O lane %u not on consecutive pins of a port, pin by pin\n", lane_no);
+            continue;
+        }
+
+        lane->port  = gpio_get_port(io[0]);
+        lane->shift = first;
+        lane->mask  = (uword_t)0xFF << lane->shift;
+    }
+}
+
+/** Port bits that put @p data on @p lane */
+static inline uword_t _lane_bits(const nand_io_lane_t* const lane, const uint8_t data) {
+    return (uword_t)data << lane->shift;
+}
+
+/** Byte on @p lane in the port @p levels */
+static inline uint8_t _lane_byte(const nand_io_lane_t* const lane, const uword_t levels) {
+    return (uint8_t)(levels >> lane->shift);
+}
+
+static inline void _write_lane(const nand_t* const nand, const unsigned lane_no, const uint8_t data) {
+    const nand_io_lane_t* const lane = &(nand->io_lane[lane_no]);
+
+    if(lane->port == GPIO_PORT_UNDEF) {
+        _write_lane_pins(nand, lane_no, data);
+        return;
+    }
+
+    const uword_t set = _lane_bits(lane, data);
+
+    gpio_ll_set(lane->port, set);
+    gpio_ll_clear(lane->port, lane->mask & ~set);
+}
+
+static inline uint8_t _read_lane(const nand_t* const nand, const unsigned lane_no) {
+    const nand_io_lane_t* const lane = &(nand->io_lane[lane_no]);
+
+    if(lane->port == GPIO_PORT_UNDEF) {
+        return _read_lane_pins(nand, lane_no);
+    }
+
+    return _lane_byte(lane, gpio_ll_read(lane->port));
+}
+
+/** Both lanes with one port access when they share the port */
+static inline void _write_word(const nand_t* const nand, const uint16_t word) {
+    const nand_io_lane_t* const lo = &(nand->io_lane[0]);
+    const nand_io_lane_t* const hi = &(nand->io_lane[1]);
+
+    if(lo->port == GPIO_PORT_UNDEF || lo->port != hi->port) {
+        _write_lane(nand, 1, word >> 8);
+        _write_lane(nand, 0, word & 0xFF);
+        return;
+    }
+
+    const uword_t set = _lane_bits(lo, word & 0xFF) | _lane_bits(hi, word >> 8);
+
+    gpio_ll_set(lo->port, set);
+    gpio_ll_clear(lo->port, (lo->mask | hi->mask) & ~set);
+}
+
+static inline uint16_t _read_word(const nand_t* const nand) {
+    const nand_io_lane_t* const lo = &(nand->io_lane[0]);
+    const nand_io_lane_t* const hi = &(nand->io_lane[1]);
+
+    if(lo->port == GPIO_PORT_UNDEF || lo->port != hi->port) {
+        const uint8_t high = _read_lane(nand, 1);
+        return ((uint16_t)high << 8) | _read_lane(nand, 0);
+    }
+
+    const uword_t levels = gpio_ll_read(lo->port);
+
+    return ((uint16_t)_lane_byte(hi, levels) << 8) | _lane_byte(lo, levels);
+}
+#else
+static void _io_lanes_init(nand_t* const nand) {
+    (void)nand;
+}
+
+static inline void _write_lane(const nand_t* const nand, const unsigned lane_no, const uint8_t data) {
+    _write_lane_pins(nand, lane_no, data);
+}
+
+static inline uint8_t _read_lane(const nand_t* const nand, const unsigned lane_no) {
+    return _read_lane_pins(nand, lane_no);
+}
+
+static inline void _write_word(const nand_t* const nand, const uint16_t word) {
+    _write_lane_pins(nand, 1, word >> 8);
+    _write_lane_pins(nand, 0, word & 0xFF);
+}
+
+static inline uint16_t _read_word(const nand_t* const nand) {
+    const uint8_t high = _read_lane_pins(nand, 1);
+    return ((uint16_t)high << 8) | _read_lane_pins(nand, 0);
+}
+#endif
+
+/** One WE# cycle of an 8-bit bus */
+static inline void _write_cycle_x8(const nand_t* const nand, const uint8_t data, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns) {
+    nand_set_write_enable(nand);
+
+    if(cycle_write_enable_post_delay_ns > 0) {
+        nand_wait(cycle_write_enable_post_delay_ns);
+    }
+
+    _write_lane(nand, 0, data);
+
+    nand_set_write_disable(nand);
+
+    if(cycle_write_disable_post_delay_ns > 0) {
+        nand_wait(cycle_write_disable_post_delay_ns);
+    }
+}
+
+/** One WE# cycle of a 16-bit bus, the low byte on I/O 0 to 7 */
+static inline void _write_cycle_x16(const nand_t* const nand, const uint16_t word, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns) {
+    nand_set_write_enable(nand);
+
+    if(cycle_write_enable_post_delay_ns > 0) {
+        nand_wait(cycle_write_enable_post_delay_ns);
+    }
+
+    _write_word(nand, word);
+
+    nand_set_write_disable(nand);
+
+    if(cycle_write_disable_post_delay_ns > 0) {
+        nand_wait(cycle_write_disable_post_delay_ns);
+    }
+}
+
+static inline uint8_t _read_cycle_x8(const nand_t* const nand, const uint32_t cycle_read_enable_post_delay_ns, const uint32_t cycle_read_disable_post_delay_ns) {
+    nand_set_read_enable(nand);
+
+    if(cycle_read_enable_post_delay_ns > 0) {
+        nand_wait(cycle_read_enable_post_delay_ns);
+    }
+
+    const uint8_t data = _read_lane(nand, 0);
+
+    nand_set_read_disable(nand);
+
+    if(cycle_read_disable_post_delay_ns > 0) {
+        nand_wait(cycle_read_disable_post_delay_ns);
+    }
+
+    return data;
+}
+
+static inline uint16_t _read_cycle_x16(const nand_t* const nand, const uint32_t cycle_read_enable_post_delay_ns, const uint32_t cycle_read_disable_post_delay_ns) {
+    nand_set_read_enable(nand);
+
+    if(cycle_read_enable_post_delay_ns > 0) {
+        nand_wait(cycle_read_enable_post_delay_ns);
+    }
+
+    const uint16_t word = _read_word(nand);
+
+    nand_set_read_disable(nand);
+
+    if(cycle_read_disable_post_delay_ns > 0) {
+        nand_wait(cycle_read_disable_post_delay_ns);
+    }
+
+    return word;
+}
+
+static size_t _write_raw_x8(const nand_t* const nand, const uint8_t* const data, const size_t data_size, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns) {
+    for(size_t pos = 0; pos < data_size; ++pos) {
+        _write_cycle_x8(nand, data[pos], cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+    }
+
+    return data_size;
+}
+
+/** Two words per round, an odd last byte goes out with a zero high byte */
+static size_t _write_raw_x16(const nand_t* const nand, const uint8_t* const data, const size_t data_size, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns) {
+    size_t pos = 0;
+
+    for(; pos + 4 <= data_size; pos += 4) {
+        _write_cycle_x16(nand, data[pos] | ((uint16_t)data[pos + 1] << 8), cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+        _write_cycle_x16(nand, data[pos + 2] | ((uint16_t)data[pos + 3] << 8), cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+    }
+
+    if(pos + 2 <= data_size) {
+        _write_cycle_x16(nand, data[pos] | ((uint16_t)data[pos + 1] << 8), cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+        pos += 2;
+    }
+
+    if(pos < data_size) {
+        _write_cycle_x16(nand, data[pos], cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+        pos += 2;
+    }
+
+    return pos;
+}
+
+static size_t _read_raw_x8(const nand_t* const nand, uint8_t* const out_buffer, const size_t buffer_size, const uint32_t cycle_read_enable_post_delay_ns, const uint32_t cycle_read_disable_post_delay_ns) {
+    for(size_t pos = 0; pos < buffer_size; ++pos) {
+        out_buffer[pos] = _read_cycle_x8(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
+    }
+
+    return buffer_size;
+}
+
+/** Two words per round, the high byte of an odd last word is dropped */
+static size_t _read_raw_x16(const nand_t* const nand, uint8_t* const out_buffer, const size_t buffer_size, const uint32_t cycle_read_enable_post_delay_ns, const uint32_t cycle_read_disable_post_delay_ns) {
+    size_t pos = 0;
+
+    for(; pos + 4 <= buffer_size; pos += 4) {
+        const uint16_t word0 = _read_cycle_x16(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
+        const uint16_t word1 = _read_cycle_x16(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
+
+        out_buffer[pos]     = word0 & 0xFF;
+        out_buffer[pos + 1] = word0 >> 8;
+        out_buffer[pos + 2] = word1 & 0xFF;
+        out_buffer[pos + 3] = word1 >> 8;
+    }
+
+    if(pos + 2 <= buffer_size) {
+        const uint16_t word = _read_cycle_x16(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
+
+        out_buffer[pos]     = word & 0xFF;
+        out_buffer[pos + 1] = word >> 8;
+        pos += 2;
+    }
+
+    if(pos < buffer_size) {
+        out_buffer[pos] = _read_cycle_x16(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns) & 0xFF;
+        pos += 2;
+    }
+
+    return pos;
+}
+
+static void _set_io_pin_mode(const nand_t* const nand, const gpio_mode_t mode) {
+    const unsigned io_bits = (nand->addr_bus_width == 16 || nand_data_bus_width(nand) == 16) ? NAND_MAX_IO_BITS : NAND_IO_LANE_BITS;
+
+    for(unsigned bit = 0; bit < io_bits; ++bit) {
+        gpio_init(nand->params->io[bit], mode);
+    }
+}
+
+int nand_init(nand_t* const nand, const nand_params_t* const params) {
     if(nand == NULL) {
         return NAND_INIT_ERROR;
     }
@@ -41,9 +344,15 @@ int nand_init(nand_t* const nand, nand_params_t* const params) {
     }
 
     nand->standard_type = NAND_STD_UNKNWOWN;
-    nand->params = *params;
+    nand->params = params;
+    mutex_init(&(nand->lock));
+    _io_lanes_init(nand);
+    nand->timing_scale_cycle = NAND_TIMING_SCALE_NOMINAL;
+    nand->timing_scale_latch = NAND_TIMING_SCALE_NOMINAL;
     nand_set_pin_default(nand);
 
+    nand_stats_register(nand);
+
     return NAND_INIT_PARTIAL;
 }
 
@@ -55,26 +364,22 @@ size_t nand_write_addr_column(const nand_t* const nand, const uint64_t* const ad
     switch(bus_width) {
     case 8:
         {
-            uint64_t mask = 0xFF;
             for(size_t seq = 0; seq < column_addr_cycles; ++seq) {
                 uint8_t* const cycle_data = (uint8_t *)malloc(sizeof(uint8_t));
-                *cycle_data = *addr_column & mask;
+                *cycle_data = (*addr_column >> (8 * seq)) & 0xFF;
                 ret_size += nand_write_cycle(nand, cycle_data, bus_width, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
                 free(cycle_data);
-                mask <<= 8;
             }
         }
         break;
     case 16:
         {
-            uint64_t mask = 0xFF;
             for(size_t seq = 0; seq < column_addr_cycles; ++seq) {
                 uint8_t* const cycle_data = (uint8_t *)malloc(sizeof(uint8_t) * 2);
-                cycle_data[0] = *addr_column & mask;
-                cycle_data[1] = *addr_column & (mask << 8);
+                cycle_data[0] = (*addr_column >> (16 * seq)) & 0xFF;
+                cycle_data[1] = (*addr_column >> (16 * seq + 8)) & 0xFF;
                 ret_size += nand_write_cycle(nand, cycle_data, bus_width, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
                 free(cycle_data);
-                mask <<= 16;
             }
         }
         break;
@@ -91,26 +396,22 @@ size_t nand_write_addr_row(const nand_t* const nand, const uint64_t* const addr_
     switch(bus_width) {
     case 8:
         {
-            uint64_t mask = 0xFF;
             for(size_t seq = 0; seq < row_addr_cycles; ++seq) {
                 uint8_t* const cycle_data = (uint8_t *)malloc(sizeof(uint8_t));
-                *cycle_data = *addr_row & mask;
+                *cycle_data = (*addr_row >> (8 * seq)) & 0xFF;
                 ret_size += nand_write_cycle(nand, cycle_data, bus_width, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
                 free(cycle_data);
-                mask <<= 8;
             }
         }
         break;
     case 16:
         {
-            uint64_t mask = 0xFF;
             for(size_t seq = 0; seq < row_addr_cycles; ++seq) {
                 uint8_t* const cycle_data = (uint8_t *)malloc(sizeof(uint8_t) * 2);
-                cycle_data[1] = *addr_row & (mask << 8);
-                cycle_data[0] = *addr_row & mask;
+                cycle_data[1] = (*addr_row >> (16 * seq + 8)) & 0xFF;
+                cycle_data[0] = (*addr_row >> (16 * seq)) & 0xFF;
                 ret_size += nand_write_cycle(nand, cycle_data, bus_width, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
                 free(cycle_data);
-                mask <<= 16;
             }
         }
         break;
@@ -144,225 +445,75 @@ size_t nand_write_addr_single(const nand_t* const nand, const uint16_t* const ad
 }
 
 size_t nand_write_raw(const nand_t* const nand, const uint8_t* const data, const size_t data_size, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns) {
-          size_t  ret_size  = 0;
-    const uint8_t bus_width = nand->data_bus_width;
-
-    size_t seq = 0;
-    while(seq + 1 < data_size) {
-        ret_size += nand_write_cycle(nand, &(data[seq]), bus_width, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
-
-        ++seq;
-        if(bus_width == 16) {
-            ++seq;
-        }
-    }
-    if(seq + 1 == data_size) {
-        uint8_t* const cycle_data = (uint8_t*)malloc(sizeof(uint8_t) * 2);
-        cycle_data[1] = 0x00;
-        cycle_data[0] = data[seq];
-        ret_size += nand_write_cycle(nand, cycle_data, bus_width, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
-        free(cycle_data);
+    if(nand_data_bus_width(nand) == 16) {
+        return _write_raw_x16(nand, data, data_size, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
     }
 
-    return ret_size;
+    return _write_raw_x8(nand, data, data_size, cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
 }
 
 size_t nand_write_io(const nand_t* const nand, const uint8_t data[2], const uint8_t bus_width, const uint32_t cycle_write_enable_post_delay_ns, const uint32_t cycle_write_disable_post_delay_ns) {
-    size_t ret_len = 0;
-
-    nand_set_write_enable(nand);
-
-    if(cycle_write_enable_post_delay_ns > 0) {
-        nand_wait(cycle_write_enable_post_delay_ns);
-    }
-
     if(bus_width == 16) {
-        gpio_write(nand->params.io15, (data[1] & NAND_MSB7) ? 1 : 0);
-        gpio_write(nand->params.io14, (data[1] & NAND_MSB6) ? 1 : 0);
-        gpio_write(nand->params.io13, (data[1] & NAND_MSB5) ? 1 : 0);
-        gpio_write(nand->params.io12, (data[1] & NAND_MSB4) ? 1 : 0);
-        gpio_write(nand->params.io11, (data[1] & NAND_MSB3) ? 1 : 0);
-        gpio_write(nand->params.io10, (data[1] & NAND_MSB2) ? 1 : 0);
-        gpio_write(nand->params.io9, (data[1] & NAND_MSB1) ? 1 : 0);
-        gpio_write(nand->params.io8, (data[1] & NAND_MSB0) ? 1 : 0);
-        ++ret_len;
-    }
-
-    gpio_write(nand->params.io7, (data[0] & NAND_MSB7) ? 1 : 0);
-    gpio_write(nand->params.io6, (data[0] & NAND_MSB6) ? 1 : 0);
-    gpio_write(nand->params.io5, (data[0] & NAND_MSB5) ? 1 : 0);
-    gpio_write(nand->params.io4, (data[0] & NAND_MSB4) ? 1 : 0);
-    gpio_write(nand->params.io3, (data[0] & NAND_MSB3) ? 1 : 0);
-    gpio_write(nand->params.io2, (data[0] & NAND_MSB2) ? 1 : 0);
-    gpio_write(nand->params.io1, (data[0] & NAND_MSB1) ? 1 : 0);
-    gpio_write(nand->params.io0, (data[0] & NAND_MSB0) ? 1 : 0);
-    ++ret_len;
-
-    nand_set_write_disable(nand);
-
-    if(cycle_write_disable_post_delay_ns > 0) {
-        nand_wait(cycle_write_disable_post_delay_ns);
+        _write_cycle_x16(nand, data[0] | ((uint16_t)data[1] << 8), cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+        return 2;
     }
 
-    return ret_len;
+    _write_cycle_x8(nand, data[0], cycle_write_enable_post_delay_ns, cycle_write_disable_post_delay_ns);
+    return 1;
 }
 
 size_t nand_read_raw(const nand_t* const nand, uint8_t* const out_buffer, const size_t buffer_size, const uint32_t cycle_read_enable_post_delay_ns, const uint32_t cycle_read_disable_post_delay_ns) {
-          size_t  ret_size  = 0;
-    const uint8_t bus_width = nand->data_bus_width;
-
-    size_t seq = 0;
-    while(seq + 1 < buffer_size) {
-        ret_size += nand_read_cycle(nand, &(out_buffer[seq]), bus_width, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
-
-        ++seq;
-        if(bus_width == 16) {
-            ++seq;
-        }
-    }
-    if(seq + 1 == buffer_size) {
-        uint8_t* const cycle_data = (uint8_t*)malloc(sizeof(uint8_t) * 2);
-        ret_size += nand_read_cycle(nand, cycle_data, bus_width, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
-        out_buffer[seq] = cycle_data[0];
-        free(cycle_data);
+    if(nand_data_bus_width(nand) == 16) {
+        return _read_raw_x16(nand, out_buffer, buffer_size, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
     }
 
-    return ret_size;
+    return _read_raw_x8(nand, out_buffer, buffer_size, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
 }
 
 size_t nand_read_io(const nand_t* const nand, uint8_t out_data[2], const uint8_t bus_width, const uint32_t cycle_read_enable_post_delay_ns, const uint32_t cycle_read_disable_post_delay_ns) {
-    size_t ret_len = 0;
-
-    nand_set_read_enable(nand);
-
-    if(cycle_read_enable_post_delay_ns > 0) {
-        nand_wait(cycle_read_enable_post_delay_ns);
-    }
-
     if(bus_width == 16) {
-        out_data[1] = 0;
-        const bool io15 = gpio_read(nand->params.io15) != 0;
-        const bool io14 = gpio_read(nand->params.io14) != 0;
-        const bool io13 = gpio_read(nand->params.io13) != 0;
-        const bool io12 = gpio_read(nand->params.io12) != 0;
-        const bool io11 = gpio_read(nand->params.io11) != 0;
-        const bool io10 = gpio_read(nand->params.io10) != 0;
-        const bool io9 = gpio_read(nand->params.io9) != 0;
-        const bool io8 = gpio_read(nand->params.io8) != 0;
-        out_data[1] = (io15 << 7) | (io14 << 6) | (io13 << 5) | (io12 << 4) | (io11 << 3) | (io10 << 2) | (io9 << 1) | io8;
-        ++ret_len;
-    }
-
-    out_data[0] = 0;
-    const bool io7 = gpio_read(nand->params.io7) != 0;
-    const bool io6 = gpio_read(nand->params.io6) != 0;
-    const bool io5 = gpio_read(nand->params.io5) != 0;
-    const bool io4 = gpio_read(nand->params.io4) != 0;
-    const bool io3 = gpio_read(nand->params.io3) != 0;
-    const bool io2 = gpio_read(nand->params.io2) != 0;
-    const bool io1 = gpio_read(nand->params.io1) != 0;
-    const bool io0 = gpio_read(nand->params.io0) != 0;
-    out_data[0] = (io7 << 7) | (io6 << 6) | (io5 << 5) | (io4 << 4) | (io3 << 3) | (io2 << 2) | (io1 << 1) | io0;
-    ++ret_len;
-
-    nand_set_read_disable(nand);
+        const uint16_t word = _read_cycle_x16(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
 
-    if(cycle_read_disable_post_delay_ns > 0) {
-        nand_wait(cycle_read_disable_post_delay_ns);
+        out_data[0] = word & 0xFF;
+        out_data[1] = word >> 8;
+        return 2;
     }
 
-    return ret_len;
+    out_data[0] = _read_cycle_x8(nand, cycle_read_enable_post_delay_ns, cycle_read_disable_post_delay_ns);
+    return 1;
 }
 
 void nand_set_ctrl_pin(const nand_t* const nand) {
-    gpio_init(nand->params.ce0, GPIO_OUT);
-    gpio_init(nand->params.rb0, GPIO_IN);
-    /** TODO: Verify rb pin related with param lun_count */
-
-    if(nand->lun_count > 0) {
-        gpio_init(nand->params.ce1, GPIO_OUT);
-        gpio_init(nand->params.rb1, GPIO_IN);
-    }
-
-    if(nand->lun_count > 1) {
-        gpio_init(nand->params.ce2, GPIO_OUT);
-        gpio_init(nand->params.rb2, GPIO_IN);
-    }
-
-    if(nand->lun_count > 2) {
-        gpio_init(nand->params.ce3, GPIO_OUT);
-        gpio_init(nand->params.rb3, GPIO_IN);
-    }
-
-    if(nand->lun_count > 3) {
-        gpio_init(nand->params.ce4, GPIO_OUT);
-    }
-
-    if(nand->lun_count > 4) {
-        gpio_init(nand->params.ce5, GPIO_OUT);
-    }
-
-    if(nand->lun_count > 5) {
-        gpio_init(nand->params.ce6, GPIO_OUT);
-    }
+    /** Every LUN the board wires, lun_count is not known before the ID is read */
+    for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+        if(gpio_is_valid(nand->params->ce[lun_no])) {
+            gpio_init(nand->params->ce[lun_no], GPIO_OUT);
+        }
 
-    if(nand->lun_count > 6) {
-        gpio_init(nand->params.ce7, GPIO_OUT);
+        if(gpio_is_valid(nand->params->rb[lun_no])) {
+            gpio_init(nand->params->rb[lun_no], GPIO_IN);
+        }
     }
 
-    gpio_init(nand->params.re, GPIO_OUT);
-    gpio_init(nand->params.we, GPIO_OUT);
-    gpio_init(nand->params.wp, GPIO_OUT);
-    gpio_init(nand->params.cle, GPIO_OUT);
-    gpio_init(nand->params.ale, GPIO_OUT);
+    gpio_init(nand->params->re, GPIO_OUT);
+    gpio_init(nand->params->we, GPIO_OUT);
+    gpio_init(nand->params->wp, GPIO_OUT);
+    gpio_init(nand->params->cle, GPIO_OUT);
+    gpio_init(nand->params->ale, GPIO_OUT);
 }
 
 void nand_set_io_pin_write(const nand_t* const nand) {
-    if(nand->addr_bus_width == 16 || nand->data_bus_width == 16) {
-        gpio_init(nand->params.io15, GPIO_OUT);
-        gpio_init(nand->params.io14, GPIO_OUT);
-        gpio_init(nand->params.io13, GPIO_OUT);
-        gpio_init(nand->params.io12, GPIO_OUT);
-        gpio_init(nand->params.io11, GPIO_OUT);
-        gpio_init(nand->params.io10, GPIO_OUT);
-        gpio_init(nand->params.io9, GPIO_OUT);
-        gpio_init(nand->params.io8, GPIO_OUT);
-    }
-
-    gpio_init(nand->params.io7, GPIO_OUT);
-    gpio_init(nand->params.io6, GPIO_OUT);
-    gpio_init(nand->params.io5, GPIO_OUT);
-    gpio_init(nand->params.io4, GPIO_OUT);
-    gpio_init(nand->params.io3, GPIO_OUT);
-    gpio_init(nand->params.io2, GPIO_OUT);
-    gpio_init(nand->params.io1, GPIO_OUT);
-    gpio_init(nand->params.io0, GPIO_OUT);
+    _set_io_pin_mode(nand, GPIO_OUT);
 }
 
 void nand_set_io_pin_read(const nand_t* const nand) {
-    if(nand->addr_bus_width == 16 || nand->data_bus_width == 16) {
-        gpio_init(nand->params.io15, GPIO_IN);
-        gpio_init(nand->params.io14, GPIO_IN);
-        gpio_init(nand->params.io13, GPIO_IN);
-        gpio_init(nand->params.io12, GPIO_IN);
-        gpio_init(nand->params.io11, GPIO_IN);
-        gpio_init(nand->params.io10, GPIO_IN);
-        gpio_init(nand->params.io9, GPIO_IN);
-        gpio_init(nand->params.io8, GPIO_IN);
-    }
-
-    gpio_init(nand->params.io7, GPIO_IN);
-    gpio_init(nand->params.io6, GPIO_IN);
-    gpio_init(nand->params.io5, GPIO_IN);
-    gpio_init(nand->params.io4, GPIO_IN);
-    gpio_init(nand->params.io3, GPIO_IN);
-    gpio_init(nand->params.io2, GPIO_IN);
-    gpio_init(nand->params.io1, GPIO_IN);
-    gpio_init(nand->params.io0, GPIO_IN);
+    _set_io_pin_mode(nand, GPIO_IN);
 }
 
 void nand_wait(const uint32_t delay_ns) {
     if(delay_ns != 0) {
+        nand_stats_wait(delay_ns);
+
         /* TODO: ztimer_sleep not working */
         //ztimer_sleep(ZTIMER_USEC, delay_ns / NAND_TIMING_MICROSEC(1));
 
@@ -375,7 +526,7 @@ void nand_wait(const uint32_t delay_ns) {
     }
 }
 
-bool nand_wait_until_ready(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t ready_this_lun_timeout_ns, const uint32_t ready_other_luns_timeout_ns) {
+static bool _wait_until_ready(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t ready_this_lun_timeout_ns, const uint32_t ready_other_luns_timeout_ns) {
     const uint8_t lun_count = nand->lun_count;
 
     if(ready_other_luns_timeout_ns > 0) {
@@ -384,7 +535,20 @@ bool nand_wait_until_ready(const nand_t* const nand, const uint8_t this_lun_no,
                 continue;
             }
 
-            if(! nand_wait_until_lun_ready(nand, lun_pos, ready_other_luns_timeout_ns)) {
+            /** The status of another LUN is read with only its CE# low */
+            const bool by_status = ! gpio_is_valid(nand->params->rb[lun_pos]);
+            if(by_status) {
+                nand_set_chip_disable(nand, this_lun_no);
+            }
+
+            const bool ready     = nand_wait_until_lun_ready(nand, lun_pos, ready_other_luns_timeout_ns);
+
+            if(by_status) {
+                nand_set_chip_disable(nand, lun_pos);
+                nand_set_chip_enable(nand, this_lun_no);
+            }
+
+            if(! ready) {
                 return false; /**< Other LUNs not ready but timeout */
             }
         }
@@ -399,44 +563,64 @@ bool nand_wait_until_ready(const nand_t* const nand, const uint8_t this_lun_no,
     return true; /**< All LUNs ready */
 }
 
+bool nand_wait_until_ready(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t ready_this_lun_timeout_ns, const uint32_t ready_other_luns_timeout_ns) {
+    if(ready_this_lun_timeout_ns == 0 && ready_other_luns_timeout_ns == 0) {
+        return true; /**< Nothing to wait for */
+    }
+
+    const uint32_t start = IS_USED(MODULE_NAND_STATS) ? nand_stats_now() : nand_trace_now();
+    const bool     ready = _wait_until_ready(nand, this_lun_no, ready_this_lun_timeout_ns, ready_other_luns_timeout_ns);
+
+    nand_stats_ready(start, ready);
+    nand_trace_step(nand, NAND_TRACE_READY, ready, start);
+
+    return ready;
+}
+
+static void _write_status_cmd(const nand_t* const nand, const uint8_t cmd) {
+    nand_set_io_pin_write(nand);
+    nand_set_latch_command(nand);
+    nand_wait(NAND_STATUS_TIMING_SETUP_NS);
+    nand_write_cmd(nand, &cmd, NAND_STATUS_TIMING_SETUP_NS, NAND_STATUS_TIMING_HOLD_NS);
+    nand_set_latch_raw(nand);
+}
+
+/** READ STATUS until RDY is set, then READ MODE, so a page read goes on with its data afterwards */
+static bool _poll_status(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t timeout_ns, const uint32_t timeout_deadline) {
+    bool ready = false;
+
+    nand_set_chip_enable(nand, this_lun_no);
+
+    do {
+        uint8_t status[2] = { 0 };
+
+        _write_status_cmd(nand, NAND_STATUS_CMD_READ_STATUS);
+        nand_wait(NAND_STATUS_TIMING_WHR_NS);
+        nand_set_io_pin_read(nand);
+        nand_read_io(nand, status, 8, NAND_STATUS_TIMING_REA_NS, NAND_STATUS_TIMING_HOLD_NS);
+
+        ready = (status[0] & NAND_STATUS_RDY) != 0;
+    } while(! ready && (timeout_ns == 0 || nand_deadline_left(timeout_deadline) > 0));
+
+    _write_status_cmd(nand, NAND_STATUS_CMD_READ_MODE);
+
+    return ready;
+}
+
 bool nand_wait_until_lun_ready(const nand_t* const nand, const uint8_t this_lun_no, const uint32_t timeout_ns) {
+    assert(this_lun_no < NAND_MAX_CHIPS);
+
+    const gpio_t   rb               = nand->params->rb[this_lun_no];
     const uint32_t timeout_deadline = nand_deadline_from_interval(timeout_ns);
     uint32_t timeout_left = timeout_deadline;
 
+    if(! gpio_is_valid(rb)) {
+        return _poll_status(nand, this_lun_no, timeout_ns, timeout_deadline);
+    }
+
     do {
-        switch(this_lun_no) {
-        case 0:
-            {
-                if(gpio_read(nand->params.rb0))
-                {
-                    return true;
-                }
-            }
-            break;
-        case 1:
-            {
-                if(gpio_read(nand->params.rb1))
-                {
-                    return true;
-                }
-            }
-            break;
-        case 2:
-            {
-                if(gpio_read(nand->params.rb2))
-                {
-                    return true;
-                }
-            }
-            break;
-        case 3:
-            {
-                if(gpio_read(nand->params.rb3))
-                {
-                    return true;
-                }
-            }
-            break;
+        if(gpio_read(rb)) {
+            return true;
         }
 
         timeout_left = nand_deadline_left(timeout_deadline);
@@ -445,6 +629,41 @@ bool nand_wait_until_lun_ready(const nand_t* const nand, const uint8_t this_lun_
     return false; /**< Not ready but timeout */
 }
 
+uint8_t nand_wait_until_luns_ready(const nand_t* const nand, const uint8_t lun_mask, const uint32_t timeout_ns) {
+    static_assert(NAND_MAX_CHIPS <= 8, "one bit per LUN in a uint8_t");
+
+    const uint32_t start            = IS_USED(MODULE_NAND_STATS) ? nand_stats_now() : nand_trace_now();
+    const uint32_t timeout_deadline = nand_deadline_from_interval(timeout_ns);
+    uint8_t        busy             = lun_mask;
+    uint8_t        no_rb            = 0;
+
+    for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+        if((lun_mask & (1 << lun_no)) && ! gpio_is_valid(nand->params->rb[lun_no])) {
+            no_rb |= 1 << lun_no;
+        }
+    }
+
+    while(busy != 0) {
+        for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+            if((busy & ~no_rb & (1 << lun_no)) && gpio_read(nand->params->rb[lun_no])) {
+                busy &= ~(1 << lun_no);
+            }
+        }
+
+        if(nand_deadline_left(timeout_deadline) == 0) {
+            break;
+        }
+    }
+
+    /** LUNs without R/B# are ready once the deadline passed */
+    busy &= ~no_rb;
+
+    nand_stats_ready(start, busy == 0);
+    nand_trace_step(nand, NAND_TRACE_READY, busy == 0, start);
+
+    return busy;
+}
+
 bool nand_check_DDR(const uint8_t * const bytes, const size_t bytes_size)
 {
     if(bytes_size < 1)
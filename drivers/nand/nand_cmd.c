@@ -24,6 +24,8 @@
 
 #include "nand_cmd.h"
 #include "nand.h"
+#include "nand/stats.h"
+#include "nand/trace.h"
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -31,6 +33,53 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** First command cycle of the chains, tells the statistics and the trace what kind of command runs */
+static uint8_t _first_cmd(const nand_cmd_chain_t* const chains, const size_t chains_length) {
+    for(size_t seq = 0; seq < chains_length; ++seq) {
+        if(chains[seq].cycles_defined && chains[seq].cycles_type == NAND_CMD_TYPE_CMD_WRITE) {
+            return chains[seq].cycles.cmd;
+        }
+    }
+
+    return 0xFF;
+}
+
+static nand_trace_phase_t _trace_phase(const nand_cmd_type_t cycles_type) {
+    switch(cycles_type) {
+    case NAND_CMD_TYPE_CMD_WRITE:
+        return NAND_TRACE_CMD;
+
+    case NAND_CMD_TYPE_RAW_WRITE:
+        return NAND_TRACE_DATA_IN;
+
+    case NAND_CMD_TYPE_RAW_READ:
+        return NAND_TRACE_DATA_OUT;
+
+    default:
+        return NAND_TRACE_ADDR;
+    }
+}
+
+/** Timings of a chain with the calibrated scale of the NAND, the chain itself when there is none */
+static const nand_cmd_timings_t* _scale_timings(const nand_t* const nand, const nand_cmd_timings_t* const timings, nand_cmd_timings_t* const scaled) {
+    const uint16_t cycle = nand->timing_scale_cycle;
+    const uint16_t latch = nand->timing_scale_latch;
+
+    if(cycle == NAND_TIMING_SCALE_NOMINAL && latch == NAND_TIMING_SCALE_NOMINAL) {
+        return timings;
+    }
+
+    *scaled = *timings;
+    scaled->cycle_rw_enable_post_delay_ns   = nand_timing_scaled(timings->cycle_rw_enable_post_delay_ns, cycle);
+    scaled->cycle_rw_disable_post_delay_ns  = nand_timing_scaled(timings->cycle_rw_disable_post_delay_ns, cycle);
+    scaled->latch_enable_pre_delay_ns       = nand_timing_scaled(timings->latch_enable_pre_delay_ns, latch);
+    scaled->latch_enable_post_delay_ns      = nand_timing_scaled(timings->latch_enable_post_delay_ns, latch);
+    scaled->latch_disable_pre_delay_ns      = nand_timing_scaled(timings->latch_disable_pre_delay_ns, latch);
+    scaled->latch_disable_post_delay_ns     = nand_timing_scaled(timings->latch_disable_post_delay_ns, latch);
+
+    return scaled;
+}
+
 size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand_cmd_params_t* const cmd_params, nand_rw_response_t* const err) {
     if(nand == NULL || cmd == NULL) {
         if(err != NULL) {
@@ -54,7 +103,7 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
         return 0;
     } else {
         if(cmd_override == NULL) {
-            memcpy(&chains, &(cmd->chains), sizeof(nand_cmd_chain_t) * cmd->chains_length);
+            memcpy(chains, cmd->chains, sizeof(nand_cmd_chain_t) * cmd->chains_length);
         } else {
             for(size_t pos = 0; pos < chains_length; ++pos) {
                 if(cmd_override->chains[pos].cycles_defined || pos >= cmd->chains_length) {
@@ -66,7 +115,10 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
         }
     }
 
-    size_t rw_size = 0;
+    size_t         rw_size      = 0;
+    size_t         raw_bytes    = 0;
+    const uint32_t stats_start  = nand_stats_now();
+          uint32_t trace_start  = nand_trace_begin(nand, _first_cmd(chains, chains_length), lun_no);
 
     nand_set_chip_enable(nand, lun_no);
     nand_set_write_protect_disable(nand);
@@ -76,7 +128,8 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
     for(size_t seq = 0; seq < chains_length; ++seq) {
               nand_cmd_chain_t*    const current_chain  = &(chains[seq]);
         const bool                       cycles_defined =   current_chain->cycles_defined;
-        const nand_cmd_timings_t*  const timings        = &(current_chain->timings);
+              nand_cmd_timings_t         timings_scaled;
+        const nand_cmd_timings_t*  const timings        = _scale_timings(nand, &(current_chain->timings), &timings_scaled);
         const nand_cmd_type_t            cycles_type    =   current_chain->cycles_type;
         const nand_cmd_cycles_t*   const cycles         = &(current_chain->cycles);
 
@@ -95,6 +148,19 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
             {
                 nand_wait(timings->latch_enable_pre_delay_ns);
 
+                /** Before the latch, a LUN without R/B# is polled with status cycles of its own */
+                if(! nand_wait_until_ready(nand, lun_no, timings->ready_this_lun_timeout_ns, timings->ready_other_luns_timeout_ns)) {
+                    if(err != NULL) {
+                        *err = NAND_RW_TIMEOUT;
+                    }
+                    nand_stats_cmd(_first_cmd(chains, chains_length), stats_start, raw_bytes, false);
+                    nand_trace_end(nand, false);
+                    free(chains);
+                    return rw_size;
+                } else {
+                    nand_wait(timings->ready_post_delay_ns);
+                }
+
                 switch(cycles_type) {
                 case NAND_CMD_TYPE_CMD_WRITE:
                     {
@@ -110,20 +176,6 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
 
                 nand_wait(timings->latch_enable_post_delay_ns);
 
-                if(! nand_wait_until_ready(nand, lun_no, timings->ready_this_lun_timeout_ns, timings->ready_other_luns_timeout_ns)) {
-                    nand_wait(timings->latch_disable_pre_delay_ns);
-                    nand_set_latch_raw(nand);
-                    nand_wait(timings->latch_disable_post_delay_ns);
-
-                    if(err != NULL) {
-                        *err = NAND_RW_TIMEOUT;
-                    }
-                    free(chains);
-                    return rw_size;
-                } else {
-                    nand_wait(timings->ready_post_delay_ns);
-                }
-
                 if(pre_hook_cb != NULL) {
                     pre_hook_cb(nand, cmd, cmd_params, seq, current_chain);
                 }
@@ -139,6 +191,7 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
 
                 case NAND_CMD_TYPE_ADDR_WRITE:
                     {
+                        nand_trace_row(nand, cycles->addr[NAND_ADDR_INDEX_ROW]);
                         rw_size += nand_write_addr(nand, cycles->addr, timings->cycle_rw_enable_post_delay_ns, timings->cycle_rw_disable_post_delay_ns);
                     }
                     break;
@@ -151,6 +204,7 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
 
                 case NAND_CMD_TYPE_ADDR_ROW_WRITE:
                     {
+                        nand_trace_row(nand, cycles->addr_row);
                         rw_size += nand_write_addr_row(nand, &(cycles->addr_row), timings->cycle_rw_enable_post_delay_ns, timings->cycle_rw_disable_post_delay_ns);
                     }
                     break;
@@ -180,17 +234,11 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
             {
                 nand_raw_t* const raw                   =   cycles->raw;
                 size_t*     const raw_size              = &(raw->raw_size);
-                uint8_t*    const buffer                =   raw->buffer;
-                size_t            buffer_size           =   raw->buffer_size;
                 size_t*     const current_buffer_seq    = &(raw->current_buffer_seq);
                 size_t*     const current_raw_offset    = &(raw->current_raw_offset);
 
                 if(*raw_size == 0) {
-                    if(err != NULL) {
-                        *err = NAND_RW_OK;
-                    }
-                    free(chains);
-                    return rw_size;
+                    break; /**< Nothing to transfer, go on with the next chain */
                 }
 
                 *current_raw_offset = 0;
@@ -201,16 +249,20 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
                 nand_wait(timings->latch_enable_post_delay_ns);
 
                 if(! nand_wait_until_ready(nand, lun_no, timings->ready_this_lun_timeout_ns, timings->ready_other_luns_timeout_ns)) {
+                    nand_set_chip_disable(nand, lun_no);
+
                     if(err != NULL) {
                         *err = NAND_RW_TIMEOUT;
                     }
+                    nand_stats_cmd(_first_cmd(chains, chains_length), stats_start, raw_bytes, false);
+                    nand_trace_end(nand, false);
                     free(chains);
                     return rw_size;
                 } else {
                     nand_wait(timings->ready_post_delay_ns);
                 }
 
-                while(buffer_size > 0 && *current_raw_offset < *raw_size) {
+                while(*current_raw_offset < *raw_size) {
                     if(pre_hook_cb != NULL) {
                         pre_hook_cb(nand, cmd, cmd_params, seq, current_chain);
 
@@ -219,6 +271,14 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
                         }
                     }
 
+                    /** Hooks may swap the buffer between chunks, so pick it up again every time */
+                    uint8_t* const buffer       = raw->buffer;
+                    size_t         buffer_size  = raw->buffer_size;
+
+                    if(buffer_size == 0) {
+                        break;
+                    }
+
                     if(buffer != NULL) {
                         const size_t raw_remaining_size = *raw_size - *current_raw_offset;
                         buffer_size = (raw_remaining_size > buffer_size) ? buffer_size : raw_remaining_size; /**< Only touch locally, instead of touch the passed param */
@@ -253,13 +313,21 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
                         post_hook_cb(nand, cmd, cmd_params, seq, current_chain);
                     }
 
+                    if(raw->buffer_advance && raw->buffer == buffer && buffer != NULL) {
+                        raw->buffer = &(buffer[buffer_size]);
+                    }
+
                     ++(*current_buffer_seq);
                 }
+
+                raw_bytes += *current_raw_offset;
             }
             break;
         }
 
         nand_wait(timings->post_delay_ns);
+
+        trace_start = nand_trace_step(nand, _trace_phase(cycles_type), (cycles_type == NAND_CMD_TYPE_CMD_WRITE) ? cycles->cmd : 0, trace_start);
     }
 
     nand_set_chip_disable(nand, lun_no);
@@ -268,6 +336,8 @@ size_t nand_run_cmd_chains(nand_t* const nand, const nand_cmd_t* const cmd, nand
         *err = NAND_RW_OK;
     }
 
+    nand_stats_cmd(_first_cmd(chains, chains_length), stats_start, raw_bytes, true);
+    nand_trace_end(nand, true);
     free(chains);
     return rw_size;
 }
@@ -281,6 +351,7 @@ size_t nand_cmd_base_cmdw_addrsgw_rawsgr(nand_t* const nand, const uint8_t this_
                 raw_store->buffer_size                  = buffer_size;
                 raw_store->current_buffer_seq           = 0;
                 raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
 
           nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
                 memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
@@ -290,6 +361,7 @@ size_t nand_cmd_base_cmdw_addrsgw_rawsgr(nand_t* const nand, const uint8_t this_
           nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
                 cmd_params->lun_no                      = this_lun_no;
                 cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
 
     const size_t                      raw_read_size     = nand_run_cmd_chains(nand, cmd, cmd_params, err) - 2;
 
@@ -306,6 +378,341 @@ size_t nand_cmd_base_cmdw_addrsgw_rawsgr(nand_t* const nand, const uint8_t this_
     return raw_read_size;
 }
 
+size_t nand_cmd_base_cmdw_addrw_cmdw_rawr_hooked(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg, nand_rw_response_t* const err) {
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = buffer;
+                raw_store->buffer_size                  = chunk_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = true;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->pre_hook_cb                = pre_hook_cb;
+                cmd_mutable->post_hook_cb               = post_hook_cb;
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_COLUMN] = addr_column;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_ROW]    = addr_row;
+                cmd_mutable->chains[3].cycles_defined   = true;
+                cmd_mutable->chains[3].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = hook_arg;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_read_size     = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+
+    return raw_read_size;
+}
+
+size_t nand_cmd_base_cmdw_addrw_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+    return nand_cmd_base_cmdw_addrw_cmdw_rawr_hooked(nand, this_lun_no, cmd, addr_column, addr_row, buffer, buffer_size, buffer_size, NULL, NULL, NULL, err);
+}
+
+size_t nand_cmd_base_cmdw_addrw_raww_cmdw_hooked(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, const uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg, nand_rw_response_t* const err) {
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = (uint8_t*)buffer; /**< Only read on NAND_CMD_TYPE_RAW_WRITE */
+                raw_store->buffer_size                  = chunk_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = true;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->pre_hook_cb                = pre_hook_cb;
+                cmd_mutable->post_hook_cb               = post_hook_cb;
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_COLUMN] = addr_column;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_ROW]    = addr_row;
+                cmd_mutable->chains[2].cycles_defined   = true;
+                cmd_mutable->chains[2].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = hook_arg;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_write_size    = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+
+    return raw_write_size;
+}
+
+size_t nand_cmd_base_cmdw_addrw_raww_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, const uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+    return nand_cmd_base_cmdw_addrw_raww_cmdw_hooked(nand, this_lun_no, cmd, addr_column, addr_row, buffer, buffer_size, buffer_size, NULL, NULL, NULL, err);
+}
+
+size_t nand_cmd_base_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = buffer;
+                raw_store->buffer_size                  = buffer_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_read_size     = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+
+    return raw_read_size;
+}
+
+size_t nand_cmd_base_cmdw_addrrw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_row, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = buffer;
+                raw_store->buffer_size                  = buffer_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr_row  = addr_row;
+                cmd_mutable->chains[2].cycles_defined   = true;
+                cmd_mutable->chains[2].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_read_size     = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+
+    return raw_read_size;
+}
+
+size_t nand_cmd_base_cmdw_addrsgw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint16_t addr_single, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = buffer;
+                raw_store->buffer_size                  = buffer_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr_single = addr_single;
+                cmd_mutable->chains[2].cycles_defined   = true;
+                cmd_mutable->chains[2].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_read_size     = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+
+    return raw_read_size;
+}
+
+size_t nand_cmd_base_cmdw_addrsgw_raww(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint16_t addr_single, const uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = (uint8_t*)buffer; /**< Only read on NAND_CMD_TYPE_RAW_WRITE */
+                raw_store->buffer_size                  = buffer_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr_single = addr_single;
+                cmd_mutable->chains[2].cycles_defined   = true;
+                cmd_mutable->chains[2].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_write_size    = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+
+    return raw_write_size;
+}
+
+size_t nand_cmd_base_cmdw_addrw_cmdw_cmdw_rawr_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, uint8_t* const status, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+          nand_raw_t*           const status_store      = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                status_store->raw_size                  = 1;
+                status_store->buffer                    = status;
+                status_store->buffer_size               = 1;
+                status_store->current_buffer_seq        = 0;
+                status_store->current_raw_offset        = 0;
+                status_store->buffer_advance            = false;
+
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = buffer;
+                raw_store->buffer_size                  = buffer_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_COLUMN] = addr_column;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_ROW]    = addr_row;
+                cmd_mutable->chains[4].cycles_defined   = true;
+                cmd_mutable->chains[4].cycles.raw       = status_store;
+                cmd_mutable->chains[6].cycles_defined   = true;
+                cmd_mutable->chains[6].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_read_size     = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+    free(status_store);
+
+    return raw_read_size;
+}
+
+size_t nand_cmd_base_cmdw_cmdw_rawr_cmdw_rawr(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, uint8_t* const status, uint8_t* const buffer, const size_t buffer_size, nand_rw_response_t* const err) {
+          nand_raw_t*           const status_store      = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                status_store->raw_size                  = 1;
+                status_store->buffer                    = status;
+                status_store->buffer_size               = 1;
+                status_store->current_buffer_seq        = 0;
+                status_store->current_raw_offset        = 0;
+                status_store->buffer_advance            = false;
+
+          nand_raw_t*           const raw_store         = (nand_raw_t*)malloc(sizeof(nand_raw_t));
+                raw_store->raw_size                     = buffer_size;
+                raw_store->buffer                       = buffer;
+                raw_store->buffer_size                  = buffer_size;
+                raw_store->current_buffer_seq           = 0;
+                raw_store->current_raw_offset           = 0;
+                raw_store->buffer_advance               = false;
+
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[2].cycles_defined   = true;
+                cmd_mutable->chains[2].cycles.raw       = status_store;
+                cmd_mutable->chains[4].cycles_defined   = true;
+                cmd_mutable->chains[4].cycles.raw       = raw_store;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    const size_t                      raw_read_size     = raw_store->current_raw_offset;
+
+    free(cmd_params);
+    free(cmd_mutable);
+    free(raw_store);
+    free(status_store);
+
+    return raw_read_size;
+}
+
+void nand_cmd_base_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, nand_rw_response_t* const err) {
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = NULL;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    free(cmd_params);
+}
+
+void nand_cmd_base_cmdw_addrrw_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_row, nand_rw_response_t* const err) {
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr_row  = addr_row;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    free(cmd_params);
+    free(cmd_mutable);
+}
+
+void nand_cmd_base_cmdw_addrw_cmdw(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const cmd, const uint64_t addr_column, const uint64_t addr_row, nand_rw_response_t* const err) {
+          nand_cmd_t*           const cmd_mutable       = (nand_cmd_t*)malloc(sizeof(nand_cmd_t));
+                memcpy(cmd_mutable, cmd, sizeof(nand_cmd_t));
+                cmd_mutable->chains[1].cycles_defined   = true;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_COLUMN] = addr_column;
+                cmd_mutable->chains[1].cycles.addr[NAND_ADDR_INDEX_ROW]    = addr_row;
+
+          nand_cmd_params_t*    const cmd_params        = (nand_cmd_params_t*)malloc(sizeof(nand_cmd_params_t));
+                cmd_params->lun_no                      = this_lun_no;
+                cmd_params->cmd_override                = cmd_mutable;
+                cmd_params->hook_arg                    = NULL;
+
+    nand_run_cmd_chains(nand, cmd, cmd_params, err);
+
+    free(cmd_params);
+    free(cmd_mutable);
+}
+
 size_t nand_cmd_read_id(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const id_cmd, uint8_t* const bytes_id, const size_t bytes_id_max_size) {
     const size_t raw_read_size  = nand_cmd_base_cmdw_addrsgw_rawsgr(nand, this_lun_no, id_cmd, bytes_id, bytes_id_max_size);
 
@@ -316,6 +723,16 @@ size_t nand_cmd_read_id(nand_t* const nand, const uint8_t this_lun_no, const nan
     return nand_extract_id(bytes_id, raw_read_size);
 }
 
+size_t nand_cmd_read_nand_id(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const id_cmd) {
+    uint8_t      bytes_id[NAND_MAX_ID_SIZE];
+    const size_t id_size    = nand_cmd_read_id(nand, this_lun_no, id_cmd, bytes_id, NAND_MAX_ID_SIZE);
+
+    nand->nand_id_size = (id_size > NAND_ID_KEEP_SIZE) ? NAND_ID_KEEP_SIZE : id_size;
+    memcpy(nand->nand_id, bytes_id, NAND_ID_KEEP_SIZE);
+
+    return id_size;
+}
+
 size_t nand_cmd_read_parameter_page(nand_t* const nand, const uint8_t this_lun_no, const nand_cmd_t* const pp_cmd, uint8_t* const bytes_pp, const size_t bytes_pp_max_size) {
     const size_t raw_read_size  = nand_cmd_base_cmdw_addrsgw_rawsgr(nand, this_lun_no, pp_cmd, bytes_pp, bytes_pp_max_size);
     const bool   is_DDR         = nand_check_DDR(bytes_pp, raw_read_size);
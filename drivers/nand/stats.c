@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_stats
+ * @{
+ *
+ * @file
+ * @brief       Counters and latency histograms of the NAND stack
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#include "bitarithm.h"
+#include "nand.h"
+#include "nand/stats.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+nand_stats_t nand_stats;
+
+void nand_stats_reset(void) {
+    const nand_t* const nand = nand_stats.nand;
+
+    memset(&nand_stats, 0, sizeof(nand_stats));
+    nand_stats.nand = nand;
+}
+
+void nand_stats_op(nand_stats_ops_t* const ops, const uint32_t start, const size_t bytes, const bool ok) {
+    const uint32_t       usec   = nand_stats_now() - start;
+    const unsigned       bucket = (usec < 2) ? 0 : bitarithm_msb(usec);
+
+    ops->count  += 1;
+    ops->bytes  += bytes;
+    ops->usec   += usec;
+
+    if(! ok) {
+        ops->failed += 1;
+    }
+
+    if(usec > ops->usec_max) {
+        ops->usec_max = usec;
+    }
+
+    ops->buckets[(bucket < CONFIG_NAND_STATS_BUCKETS) ? bucket : CONFIG_NAND_STATS_BUCKETS - 1] += 1;
+}
+
+nand_stats_op_t nand_stats_cmd_op(const uint8_t first_cmd) {
+    /** The opcodes ONFI and the older Samsung parts share */
+    switch(first_cmd) {
+    case 0x00:
+    case 0x31:
+    case 0x3F:
+        return NAND_STATS_OP_READ;
+
+    case 0x80:
+    case 0x85:
+        return NAND_STATS_OP_PROGRAM;
+
+    case 0x60:
+        return NAND_STATS_OP_ERASE;
+
+    default:
+        return NAND_STATS_OP_OTHER;
+    }
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_trace
+ * @{
+ *
+ * @file
+ * @brief       Ring buffer of the steps of the last NAND commands
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#include "atomic_utils.h"
+#include "nand.h"
+#include "nand/trace.h"
+
+#if IS_USED(MODULE_TRACE)
+#include "trace.h"
+#endif
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+static_assert((CONFIG_NAND_TRACE_EVENTS & (CONFIG_NAND_TRACE_EVENTS - 1)) == 0,
+              "CONFIG_NAND_TRACE_EVENTS must be a power of two");
+
+static nand_trace_event_t _events[CONFIG_NAND_TRACE_EVENTS];
+static uint32_t           _head;   /**< events recorded since the last reset, the next slot masked */
+
+static const char* const _phase_names[NAND_TRACE_PHASE_NUMOF] = {
+    [NAND_TRACE_CMD]        = "cmd",
+    [NAND_TRACE_ADDR]       = "addr",
+    [NAND_TRACE_DATA_IN]    = "data-in",
+    [NAND_TRACE_DATA_OUT]   = "data-out",
+    [NAND_TRACE_READY]      = "ready",
+    [NAND_TRACE_TIMEOUT]    = "TIMEOUT",
+    [NAND_TRACE_END]        = "end",
+};
+
+static uint32_t _record(const nand_trace_ctx_t* const ctx, const nand_trace_phase_t phase, const uint8_t cycle, const uint32_t start) {
+    const uint32_t              now     = nand_trace_now();
+    nand_trace_event_t* const   event   = &(_events[atomic_fetch_add_u32(&_head, 1) & (CONFIG_NAND_TRACE_EVENTS - 1)]);
+
+    event->time     = start;
+    event->duration = now - start;
+    event->row      = ctx->row;
+    event->cmd      = ctx->cmd;
+    event->cycle    = cycle;
+    event->lun      = ctx->lun;
+    event->phase    = phase;
+
+#if IS_USED(MODULE_TRACE)
+    trace(((uint32_t)phase << 24) | ((uint32_t)ctx->cmd << 16) | ((uint32_t)cycle << 8) | ctx->lun);
+#endif
+
+    return now;
+}
+
+uint32_t nand_trace_begin(nand_t* const nand, const uint8_t cmd, const uint8_t lun_no) {
+    nand->trace.cmd     = cmd;
+    nand->trace.lun     = lun_no;
+    nand->trace.row     = UINT32_MAX;
+    nand->trace.start   = nand_trace_now();
+
+    return nand->trace.start;
+}
+
+void nand_trace_row(nand_t* const nand, const uint64_t row) {
+    nand->trace.row = (uint32_t)row;
+}
+
+uint32_t nand_trace_step(const nand_t* const nand, const nand_trace_phase_t phase, const uint8_t cycle, const uint32_t start) {
+    return _record(&(nand->trace), phase, cycle, start);
+}
+
+void nand_trace_end(const nand_t* const nand, const bool ok) {
+    _record(&(nand->trace), ok ? NAND_TRACE_END : NAND_TRACE_TIMEOUT, 0, nand->trace.start);
+}
+
+void nand_trace_dump(void) {
+    const uint32_t head     = atomic_load_u32(&_head);
+    const uint32_t count    = (head > CONFIG_NAND_TRACE_EVENTS) ? CONFIG_NAND_TRACE_EVENTS : head;
+
+    printf("%" PRIu32 " events, last %" PRIu32 ":\n", head, count);
+    puts("      time us  duration us  lun  cmd  phase     cycle  row");
+
+    for(uint32_t pos = head - count; pos != head; ++pos) {
+        const nand_trace_event_t* const event = &(_events[pos & (CONFIG_NAND_TRACE_EVENTS - 1)]);
+
+        printf("%13" PRIu32 "  %11" PRIu32 "  %3u   %02x  %-8s    %02x  ",
+               event->time, event->duration, event->lun, event->cmd,
+               (event->phase < NAND_TRACE_PHASE_NUMOF) ? _phase_names[event->phase] : "?",
+               event->cycle);
+
+        if(event->row == UINT32_MAX) {
+            puts("-");
+        } else {
+            printf("%" PRIu32 "\n", event->row);
+        }
+    }
+}
+
+void nand_trace_reset(void) {
+    atomic_store_u32(&_head, 0);
+    memset(_events, 0, sizeof(_events));
+}
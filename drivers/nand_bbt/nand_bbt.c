@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_bbt
+ * @{
+ *
+ * @file
+ * @brief       bad block table for ONFI NANDs
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "nand/bbt.h"
+#include "nand/onfi.h"
+#include "nand.h"
+#include "checksum/crc16_ccitt.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint64_t _addr_row(const nand_t* const nand, const uint32_t block_no, const uint32_t page_in_block) {
+    return nand_page_no_to_addr_row((uint64_t)block_no * nand->pages_per_block + page_in_block);
+}
+
+static inline size_t _table_size(const nand_bbt_t* const bbt) {
+    return sizeof(nand_bbt_header_t) + nand_bbt_bitmap_size(bbt->blocks) + sizeof(nand_bbt_remap_t) * bbt->remaps_max;
+}
+
+static inline uint32_t _table_pages(const nand_bbt_t* const bbt) {
+    const nand_t* const nand = (nand_t*)bbt->nand_onfi;
+
+    return (_table_size(bbt) + nand->data_bytes_per_page - 1) / nand->data_bytes_per_page;
+}
+
+static uint16_t _table_crc(const uint8_t* const table, const size_t table_size) {
+    const uint16_t crc = crc16_ccitt_calc(table, offsetof(nand_bbt_header_t, crc));
+
+    return crc16_ccitt_update(crc, &(table[sizeof(nand_bbt_header_t)]), table_size - sizeof(nand_bbt_header_t));
+}
+
+static bool _read_copy(nand_bbt_t* const bbt, const uint32_t block_no, uint8_t* const table, uint32_t* const version) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+    const size_t             table_size = _table_size(bbt);
+    nand_bbt_header_t        header;
+
+    for(uint32_t page = 0; page < _table_pages(bbt); ++page) {
+        if(nand_onfi_read_page(bbt->nand_onfi, _addr_row(nand, block_no, page), nand_offset_to_addr_column(0), &(table[page * nand->data_bytes_per_page]), nand->data_bytes_per_page) != NAND_RW_OK) {
+            return false;
+        }
+
+        /** Erased or foreign blocks are recognised on the first page */
+        if(page == 0 && memcmp(table, NAND_BBT_MAGIC, NAND_BBT_MAGIC_SIZE) != 0) {
+            return false;
+        }
+    }
+
+    memcpy(&header, table, sizeof(header));
+    if(header.blocks != bbt->blocks || header.remaps_max != bbt->remaps_max || header.remaps_count > header.remaps_max || header.crc != _table_crc(table, table_size)) {
+        DEBUG("nand_bbt: copy in block %" PRIu32 " is corrupt\n", block_no);
+        return false;
+    }
+
+    *version = header.version;
+    return true;
+}
+
+static nand_rw_response_t _write_copy(nand_bbt_t* const bbt, const uint32_t block_no, uint8_t* const table, const uint32_t version) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+    const size_t             table_size = _table_size(bbt);
+    nand_bbt_header_t        header;
+    nand_rw_response_t       err;
+
+    /** Serialised per copy, a failing copy changes the bitmap */
+    memset(table, 0xFF, _table_pages(bbt) * nand->data_bytes_per_page);
+    memcpy(header.magic, NAND_BBT_MAGIC, NAND_BBT_MAGIC_SIZE);
+    header.version  = version;
+    header.blocks   = bbt->blocks;
+    header.remaps_max   = bbt->remaps_max;
+    header.remaps_count = bbt->remaps_count;
+    memcpy(table, &header, sizeof(header));
+    memcpy(&(table[sizeof(header)]), bbt->bitmap, nand_bbt_bitmap_size(bbt->blocks));
+    memcpy(&(table[sizeof(header) + nand_bbt_bitmap_size(bbt->blocks)]), bbt->remaps, sizeof(nand_bbt_remap_t) * bbt->remaps_max);
+    header.crc      = _table_crc(table, table_size);
+    memcpy(table, &header, sizeof(header));
+
+    if((err = nand_onfi_erase_block(bbt->nand_onfi, _addr_row(nand, block_no, 0))) != NAND_RW_OK) {
+        return err;
+    }
+
+    for(uint32_t page = 0; page < _table_pages(bbt); ++page) {
+        if((err = nand_onfi_program_page(bbt->nand_onfi, _addr_row(nand, block_no, page), nand_offset_to_addr_column(0), &(table[page * nand->data_bytes_per_page]), nand->data_bytes_per_page)) != NAND_RW_OK) {
+            return err;
+        }
+    }
+
+    return NAND_RW_OK;
+}
+
+static bool _marker_bad(nand_bbt_t* const bbt, const uint32_t block_no, const uint32_t page_in_block) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+    const size_t             size       = (nand->data_bus_width == 16) ? 2 : 1;
+    uint8_t                  marker[2]  = { NAND_BBT_MARKER_GOOD, NAND_BBT_MARKER_GOOD };
+
+    if(nand_onfi_read_page(bbt->nand_onfi, _addr_row(nand, block_no, page_in_block), nand_offset_to_addr_column(nand->data_bytes_per_page), marker, size) != NAND_RW_OK) {
+        return true;
+    }
+
+    return marker[0] != NAND_BBT_MARKER_GOOD || marker[1] != NAND_BBT_MARKER_GOOD;
+}
+
+int nand_bbt_init(nand_bbt_t* const bbt, nand_onfi_t* const nand_onfi) {
+    if(bbt == NULL || nand_onfi == NULL) {
+        return NAND_INIT_ERROR;
+    }
+
+    nand_t*            const nand       = (nand_t*)nand_onfi;
+
+    memset(bbt, 0, sizeof(nand_bbt_t));
+    bbt->nand_onfi      = nand_onfi;
+    bbt->blocks         = nand_all_blocks_count(nand);
+    bbt->remaps_max     = (nand->bb_per_lun > 0) ? nand->bb_per_lun * nand->lun_count : CONFIG_NAND_BBT_REMAPS;
+
+    if(bbt->blocks <= CONFIG_NAND_BBT_BLOCKS || nand->pages_per_block < _table_pages(bbt)) {
+        return NAND_INIT_ERROR;
+    }
+
+    bbt->first_reserved = bbt->blocks - CONFIG_NAND_BBT_BLOCKS;
+    bbt->bitmap         = (uint8_t*)malloc(sizeof(uint8_t) * nand_bbt_bitmap_size(bbt->blocks));
+    bbt->remaps         = (nand_bbt_remap_t*)calloc(bbt->remaps_max, sizeof(nand_bbt_remap_t));
+    if(bbt->bitmap == NULL || bbt->remaps == NULL) {
+        nand_bbt_deinit(bbt);
+        return NAND_INIT_ERROR;
+    }
+
+    if(nand_bbt_load(bbt) == NAND_RW_OK) {
+        return NAND_INIT_OK;
+    }
+
+    DEBUG("nand_bbt_init: no table found, scanning %" PRIu32 " blocks\n", bbt->blocks);
+
+    if(nand_bbt_scan(bbt) != NAND_RW_OK) {
+        nand_bbt_deinit(bbt);
+        return NAND_INIT_ERROR;
+    }
+
+    if(nand_bbt_store(bbt) != NAND_RW_OK) {
+        return NAND_INIT_PARTIAL;
+    }
+
+    return NAND_INIT_OK;
+}
+
+void nand_bbt_deinit(nand_bbt_t* const bbt) {
+    free(bbt->bitmap);
+    free(bbt->remaps);
+    bbt->bitmap = NULL;
+    bbt->remaps = NULL;
+}
+
+nand_rw_response_t nand_bbt_scan(nand_bbt_t* const bbt) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+
+    for(uint32_t block_no = 0; block_no < bbt->blocks; ++block_no) {
+        nand_bbt_state_t state = (block_no < bbt->first_reserved) ? NAND_BBT_GOOD : NAND_BBT_RESERVED;
+
+        /** ONFI places the marker in the first or the last page of a block */
+        if(_marker_bad(bbt, block_no, 0) || _marker_bad(bbt, block_no, nand->pages_per_block - 1)) {
+            DEBUG("nand_bbt_scan: block %" PRIu32 " is factory bad\n", block_no);
+            state = NAND_BBT_FACTORY_BAD;
+        }
+
+        nand_bbt_set(bbt, block_no, state);
+    }
+
+    bbt->version        = 0;
+    bbt->current_copies = 0;
+    bbt->remaps_count   = 0;
+
+    return NAND_RW_OK;
+}
+
+nand_rw_response_t nand_bbt_load(nand_bbt_t* const bbt) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+    uint8_t*           const table      = (uint8_t*)malloc(sizeof(uint8_t) * _table_pages(bbt) * nand->data_bytes_per_page);
+    bool                     found      = false;
+
+    if(table == NULL) {
+        return NAND_RW_NOT_SUPPORTED;
+    }
+
+    for(uint8_t slot = 0; slot < CONFIG_NAND_BBT_BLOCKS; ++slot) {
+        uint32_t version = 0;
+
+        if(! _read_copy(bbt, bbt->first_reserved + slot, table, &version)) {
+            continue;
+        }
+
+        if(! found || version > bbt->version) {
+            const nand_bbt_header_t* const header = (const nand_bbt_header_t*)table;
+
+            memcpy(bbt->bitmap, &(table[sizeof(nand_bbt_header_t)]), nand_bbt_bitmap_size(bbt->blocks));
+            memcpy(bbt->remaps, &(table[sizeof(nand_bbt_header_t) + nand_bbt_bitmap_size(bbt->blocks)]), sizeof(nand_bbt_remap_t) * bbt->remaps_max);
+            bbt->remaps_count   = header->remaps_count;
+            bbt->version        = version;
+            bbt->current_copies = 0;
+            found               = true;
+        }
+
+        if(version == bbt->version) {
+            bbt->current_copies |= (1 << slot);
+        }
+    }
+
+    free(table);
+
+    return found ? NAND_RW_OK : NAND_RW_NOT_FOUND;
+}
+
+nand_rw_response_t nand_bbt_store(nand_bbt_t* const bbt) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+    uint8_t*           const table      = (uint8_t*)malloc(sizeof(uint8_t) * _table_pages(bbt) * nand->data_bytes_per_page);
+    const uint32_t           version    = bbt->version + 1;
+    uint8_t                  copies     = 0;
+    uint8_t                  written    = 0;
+    bool                     retired    = false;
+
+    if(table == NULL) {
+        return NAND_RW_NOT_SUPPORTED;
+    }
+
+    /** Blocks holding the current table are only overwritten if no others are left */
+    for(uint8_t pass = 0; pass < 2; ++pass) {
+        for(uint8_t slot = 0; slot < CONFIG_NAND_BBT_BLOCKS && written < NAND_BBT_COPIES; ++slot) {
+            const uint32_t  block_no    = bbt->first_reserved + slot;
+            const bool      current     = bbt->current_copies & (1 << slot);
+
+            if(current != (pass == 1) || nand_bbt_get(bbt, block_no) != NAND_BBT_RESERVED) {
+                continue;
+            }
+
+            if(_write_copy(bbt, block_no, table, version) != NAND_RW_OK) {
+                DEBUG("nand_bbt_store: block %" PRIu32 " failed, retiring it\n", block_no);
+                nand_bbt_set(bbt, block_no, NAND_BBT_WORN);
+                retired = true;
+                continue;
+            }
+
+            copies |= (1 << slot);
+            ++written;
+        }
+    }
+
+    free(table);
+
+    if(written == 0) {
+        return NAND_RW_WRITE_ERROR;
+    }
+
+    bbt->version        = version;
+    bbt->current_copies = copies;
+
+    /** Copies written before the failure miss the retired block, supersede them */
+    if(retired) {
+        return nand_bbt_store(bbt);
+    }
+
+    return NAND_RW_OK;
+}
+
+nand_rw_response_t nand_bbt_mark_bad(nand_bbt_t* const bbt, const uint32_t block_no) {
+    nand_t*            const nand       = (nand_t*)bbt->nand_onfi;
+    const uint8_t            marker[2]  = { 0x00, 0x00 };
+
+    if(block_no >= bbt->blocks) {
+        return NAND_RW_CMD_INVALID;
+    }
+
+    if(nand_bbt_get(bbt, block_no) == NAND_BBT_WORN || nand_bbt_get(bbt, block_no) == NAND_BBT_FACTORY_BAD) {
+        return NAND_RW_OK;
+    }
+
+    nand_bbt_set(bbt, block_no, NAND_BBT_WORN);
+
+    /** Also marked on flash, in case the table is ever lost and rescanned */
+    nand_onfi_program_page(bbt->nand_onfi, _addr_row(nand, block_no, 0), nand_offset_to_addr_column(nand->data_bytes_per_page), marker, (nand->data_bus_width == 16) ? 2 : 1);
+
+    return nand_bbt_store(bbt);
+}
+
+nand_rw_response_t nand_bbt_remap(nand_bbt_t* const bbt, const uint32_t block_no, const uint32_t replacement) {
+    nand_bbt_remap_t*        entry      = NULL;
+
+    if(block_no >= bbt->blocks || replacement >= bbt->blocks) {
+        return NAND_RW_CMD_INVALID;
+    }
+
+    for(uint16_t pos = 0; pos < bbt->remaps_count; ++pos) {
+        if(bbt->remaps[pos].block == block_no) {
+            entry = &(bbt->remaps[pos]);
+            break;
+        }
+    }
+
+    if(entry == NULL) {
+        if(bbt->remaps_count >= bbt->remaps_max) {
+            return NAND_RW_NOT_SUPPORTED;
+        }
+
+        entry = &(bbt->remaps[bbt->remaps_count++]);
+        entry->block        = block_no;
+        entry->replacement  = block_no;
+    }
+
+    if(nand_bbt_get(bbt, entry->replacement) == NAND_BBT_GOOD) {
+        nand_bbt_set(bbt, entry->replacement, NAND_BBT_WORN);
+    }
+    entry->replacement = replacement;
+
+    return nand_bbt_store(bbt);
+}
+
+uint32_t nand_bbt_replacement(const nand_bbt_t* const bbt, const uint32_t block_no) {
+    for(uint16_t pos = 0; pos < bbt->remaps_count; ++pos) {
+        if(bbt->remaps[pos].block == block_no) {
+            return bbt->remaps[pos].replacement;
+        }
+    }
+
+    return block_no;
+}
+
+bool nand_bbt_is_replacement(const nand_bbt_t* const bbt, const uint32_t block_no) {
+    for(uint16_t pos = 0; pos < bbt->remaps_count; ++pos) {
+        if(bbt->remaps[pos].replacement == block_no) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_ecc
+ * @{
+ *
+ * @file
+ * @brief       page level ECC for NANDs
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "nand/ecc.h"
+#include "nand/ecc/bch.h"
+#include "nand.h"
+#include "nand_cmd.h"
+#include "ecc/hamming256.h"
+#include "bitarithm.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+int nand_ecc_init(nand_ecc_t* const ecc, const nand_t* const nand, const nand_ecc_mode_t mode) {
+    if(ecc == NULL || nand == NULL) {
+        return NAND_INIT_ERROR;
+    }
+
+    /** Re-init releases what the previous init allocated */
+    nand_ecc_deinit(ecc);
+    memset(ecc, 0, sizeof(nand_ecc_t));
+
+    switch(mode) {
+    case NAND_ECC_MODE_NONE:
+        return NAND_INIT_OK;
+
+    case NAND_ECC_MODE_BCH:
+        {
+            if(nand->ecc_codeword_size == 0 || nand->data_bytes_per_page % nand->ecc_codeword_size != 0) {
+                return NAND_INIT_ERROR;
+            }
+
+            if(nand_ecc_bch_init(&(ecc->bch), nand->ecc_codeword_size, nand->ecc_bits) != NAND_INIT_OK) {
+                return NAND_INIT_ERROR;
+            }
+
+            ecc->step_size      = nand->ecc_codeword_size;
+            ecc->strength       = nand->ecc_bits;
+            ecc->bytes_per_step = ecc->bch.ecc_bytes;
+        }
+        break;
+
+    case NAND_ECC_MODE_HAMMING:
+        {
+            if(nand->data_bytes_per_page % NAND_ECC_HAMMING_STEP_SIZE != 0) {
+                return NAND_INIT_ERROR;
+            }
+
+            ecc->step_size      = NAND_ECC_HAMMING_STEP_SIZE;
+            ecc->strength       = 1;
+            ecc->bytes_per_step = NAND_ECC_HAMMING_BYTES;
+        }
+        break;
+
+    case NAND_ECC_MODE_ON_DIE:
+        {
+            if(! nand->ecc_on_die) {
+                return NAND_INIT_ERROR;
+            }
+
+            ecc->step_size      = nand->data_bytes_per_page;
+            ecc->strength       = nand->ecc_bits;
+            ecc->bytes_per_step = 0;
+        }
+        break;
+
+    default:
+        return NAND_INIT_ERROR;
+    }
+
+    ecc->steps = nand->data_bytes_per_page / ecc->step_size;
+
+    const size_t ecc_size = (size_t)ecc->steps * ecc->bytes_per_step;
+    if(ecc_size + NAND_ECC_SPARE_RESERVED_SIZE > nand->spare_bytes_per_page) {
+        DEBUG("nand_ecc_init: %u parity bytes do not fit the spare area\n", (unsigned)ecc_size);
+        nand_ecc_deinit(ecc);
+        return NAND_INIT_ERROR;
+    }
+
+    ecc->spare_offset   = nand->spare_bytes_per_page - ecc_size;
+    ecc->mode           = mode;
+
+    if(ecc_size > 0) {
+        ecc->calculated = (uint8_t*)malloc(sizeof(uint8_t) * ecc_size);
+        if(ecc->calculated == NULL) {
+            nand_ecc_deinit(ecc);
+            return NAND_INIT_ERROR;
+        }
+    }
+
+    return NAND_INIT_OK;
+}
+
+void nand_ecc_deinit(nand_ecc_t* const ecc) {
+    nand_ecc_bch_deinit(&(ecc->bch));
+    free(ecc->calculated);
+    ecc->calculated = NULL;
+    ecc->mode = NAND_ECC_MODE_NONE;
+}
+
+void nand_ecc_calculate_step(const nand_ecc_t* const ecc, const uint8_t* const data, uint8_t* const code) {
+    switch(ecc->mode) {
+    case NAND_ECC_MODE_BCH:
+        nand_ecc_bch_encode(&(ecc->bch), data, code);
+        break;
+
+    case NAND_ECC_MODE_HAMMING:
+        hamming_compute256x(data, ecc->step_size, code);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void nand_ecc_calculate(const nand_ecc_t* const ecc, const uint8_t* const data, uint8_t* const spare) {
+    uint8_t* const parity = &(spare[ecc->spare_offset]);
+
+    for(uint16_t step = 0; step < ecc->steps && ecc->bytes_per_step > 0; ++step) {
+        nand_ecc_calculate_step(ecc, &(data[step * ecc->step_size]), &(parity[step * ecc->bytes_per_step]));
+    }
+}
+
+static int _correct_step(nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const code) {
+    switch(ecc->mode) {
+    case NAND_ECC_MODE_BCH:
+        return nand_ecc_bch_decode(&(ecc->bch), data, code);
+
+    case NAND_ECC_MODE_HAMMING:
+        switch(hamming_verify256x(data, ecc->step_size, code)) {
+        case Hamming_ERROR_NONE:
+        case Hamming_ERROR_ECC:     /**< flip in the code itself, data is intact */
+            return 0;
+
+        case Hamming_ERROR_SINGLEBIT:
+            return 1;
+
+        default:
+            return -1;
+        }
+
+    default:
+        return 0;
+    }
+}
+
+/** Zero bits of @p buf, counting stops once @p limit is exceeded */
+static size_t _count_zeros(const uint8_t* const buf, const size_t size, const size_t limit) {
+    size_t          zeros   = 0;
+    size_t          pos     = 0;
+
+    /** Leading bytes up to the first word boundary */
+    for(; pos < size && ((uintptr_t)&(buf[pos]) % sizeof(uint32_t)) != 0; ++pos) {
+        zeros += bitarithm_bits_set_u32((uint8_t)~buf[pos]);
+    }
+
+    /** Programmed codewords almost always fail within the first words */
+    for(; pos + sizeof(uint32_t) <= size && zeros <= limit; pos += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, &(buf[pos]), sizeof(word));
+
+        if(word != UINT32_MAX) {
+            zeros += bitarithm_bits_set_u32(~word);
+        }
+    }
+
+    for(; pos < size && zeros <= limit; ++pos) {
+        zeros += bitarithm_bits_set_u32((uint8_t)~buf[pos]);
+    }
+
+    return zeros;
+}
+
+nand_rw_response_t nand_ecc_correct_calculated(nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const spare, const uint8_t* const calculated, size_t* const corrected_bits) {
+    const uint8_t* const      parity    = &(spare[ecc->spare_offset]);
+          nand_rw_response_t  res       = NAND_RW_OK;
+          size_t              corrected = 0;
+
+    for(uint16_t step = 0; step < ecc->steps && ecc->bytes_per_step > 0; ++step) {
+        const uint8_t* const code = &(parity[step * ecc->bytes_per_step]);
+
+        /** Codes computed during the transfer only need a compare while the codeword is clean */
+        if(calculated != NULL && memcmp(&(calculated[step * ecc->bytes_per_step]), code, ecc->bytes_per_step) == 0) {
+            continue;
+        }
+
+        /**
+         * Erased codewords, e.g. during a mount scan, carry no valid parity and must not reach the decoder,
+         * which could pull one with a few flips onto a valid codeword. Programmed parity is almost never
+         * within strength bits of all 0xFF, so the popcount of the data rarely runs.
+         */
+        size_t erased_flips;
+        if(_count_zeros(code, ecc->bytes_per_step, ecc->strength) <= ecc->strength
+           && nand_ecc_check_erased(ecc, &(data[step * ecc->step_size]), code, &erased_flips)) {
+            corrected += erased_flips;
+            continue;
+        }
+
+        const int flips = _correct_step(ecc, &(data[step * ecc->step_size]), code);
+
+        if(flips < 0) {
+            ++(ecc->failed_steps);
+            res = NAND_RW_ECC_MISMATCH;
+        } else {
+            corrected += flips;
+        }
+    }
+
+    ecc->corrected_bits += corrected;
+    if(corrected_bits != NULL) {
+        *corrected_bits = corrected;
+    }
+
+    return res;
+}
+
+nand_rw_response_t nand_ecc_correct(nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const spare, size_t* const corrected_bits) {
+    return nand_ecc_correct_calculated(ecc, data, spare, NULL, corrected_bits);
+}
+
+bool nand_ecc_check_erased(const nand_ecc_t* const ecc, uint8_t* const data, const uint8_t* const code, size_t* const flipped_bits) {
+    const size_t    limit   = ecc->strength;
+          size_t    zeros   = _count_zeros(data, ecc->step_size, limit);
+
+    if(zeros <= limit) {
+        zeros += _count_zeros(code, ecc->bytes_per_step, limit - zeros);
+    }
+
+    if(zeros > limit) {
+        return false;
+    }
+
+    memset(data, 0xFF, ecc->step_size);
+    if(flipped_bits != NULL) {
+        *flipped_bits = zeros;
+    }
+
+    return true;
+}
+
+void nand_ecc_stream_program_cb(nand_t* const nand, const nand_cmd_t* const cmd, nand_cmd_params_t* const cmd_params, const size_t current_chain_seq, nand_cmd_chain_t* current_chain) {
+    (void)nand;
+    (void)cmd;
+    (void)current_chain_seq;
+
+    if(current_chain->cycles_type != NAND_CMD_TYPE_RAW_WRITE) {
+        return;
+    }
+
+    const nand_ecc_t* const ecc         = (const nand_ecc_t*)cmd_params->hook_arg;
+          nand_raw_t* const raw         =   current_chain->cycles.raw;
+    const size_t            offset      =   raw->current_raw_offset;
+    const size_t            data_size   =   (size_t)ecc->steps * ecc->step_size;
+
+    if(offset >= data_size || offset % ecc->step_size != 0) {
+        return;
+    }
+
+    /** Called before the chunk goes out, parity lands in the spare area which is sent last */
+    uint8_t* const page = raw->buffer - offset;
+    nand_ecc_calculate_step(ecc, raw->buffer, &(page[data_size + ecc->spare_offset + (offset / ecc->step_size) * ecc->bytes_per_step]));
+}
+
+void nand_ecc_stream_read_cb(nand_t* const nand, const nand_cmd_t* const cmd, nand_cmd_params_t* const cmd_params, const size_t current_chain_seq, nand_cmd_chain_t* current_chain) {
+    (void)nand;
+    (void)cmd;
+    (void)current_chain_seq;
+
+    if(current_chain->cycles_type != NAND_CMD_TYPE_RAW_READ) {
+        return;
+    }
+
+    const nand_ecc_t* const ecc         = (const nand_ecc_t*)cmd_params->hook_arg;
+    const nand_raw_t* const raw         =   current_chain->cycles.raw;
+    const size_t            offset      =   raw->current_raw_offset - raw->buffer_size;
+    const size_t            data_size   =   (size_t)ecc->steps * ecc->step_size;
+
+    if(offset >= data_size || offset % ecc->step_size != 0 || raw->buffer_size != ecc->step_size) {
+        return;
+    }
+
+    /** Called right after the chunk arrived, while it is still in cache */
+    nand_ecc_calculate_step(ecc, raw->buffer, &(ecc->calculated[(offset / ecc->step_size) * ecc->bytes_per_step]));
+}
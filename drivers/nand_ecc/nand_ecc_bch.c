@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_ecc
+ * @{
+ *
+ * @file
+ * @brief       binary BCH codec for NAND codewords
+ *
+ * The codeword polynomial is laid out as data bits (byte 0 MSB first) at the
+ * highest powers followed by ecc_bits parity bits. The LFSR is kept left
+ * aligned in ecc_words 32-bit words, so the parity bytes are the leading
+ * bytes of the register in big endian order.
+ *
+ * GF(2^m) arithmetic goes through log/antilog tables built on init, 4 bytes
+ * per field element: 32 KiB for 512-byte codewords, 64 KiB for 1 KiB ones.
+ * They are only read on the error path and while building the generator.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+
+#include "nand/ecc/bch.h"
+#include "nand/ecc.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Primitive polynomials of GF(2^m), m = NAND_ECC_BCH_MIN_M .. NAND_ECC_BCH_MAX_M */
+static const uint16_t nand_ecc_bch_prim_poly[] = {
+    0x0025, 0x0043, 0x0083, 0x011D, 0x0211, 0x0409, 0x0805, 0x1053, 0x201B, 0x402B, 0x8003
+};
+
+static inline uint16_t _gf_mul(const nand_ecc_bch_t* const bch, const uint16_t a, const uint16_t b) {
+    if(a == 0 || b == 0) {
+        return 0;
+    }
+
+    return bch->gf_exp[((uint32_t)bch->gf_log[a] + bch->gf_log[b]) % bch->n];
+}
+
+static inline uint16_t _gf_alpha_pow(const nand_ecc_bch_t* const bch, const uint32_t exp) {
+    return bch->gf_exp[exp % bch->n];
+}
+
+/** @p a must not be 0 */
+static inline uint16_t _gf_inv(const nand_ecc_bch_t* const bch, const uint16_t a) {
+    return bch->gf_exp[(bch->n - bch->gf_log[a]) % bch->n];
+}
+
+static bool _gf_tables_init(nand_ecc_bch_t* const bch) {
+    bch->gf_exp = (uint16_t*)malloc(sizeof(uint16_t) * bch->n);
+    bch->gf_log = (uint16_t*)malloc(sizeof(uint16_t) * (bch->n + 1));
+    if(bch->gf_exp == NULL || bch->gf_log == NULL) {
+        return false;
+    }
+
+    uint32_t x = 1;
+    for(uint16_t exp = 0; exp < bch->n; ++exp) {
+        bch->gf_exp[exp]    = x;
+        bch->gf_log[x]      = exp;
+
+        x <<= 1;
+        if(x & (1UL << bch->m)) {
+            x ^= bch->poly;
+        }
+    }
+    bch->gf_log[0] = 0; /**< log(0) is undefined, _gf_mul() never looks it up */
+
+    return true;
+}
+
+static inline void _reg_shift_left(uint32_t* const reg, const uint8_t words, const uint8_t bits) {
+    for(uint8_t pos = 0; pos + 1 < words; ++pos) {
+        reg[pos] = (reg[pos] << bits) | (reg[pos + 1] >> (32 - bits));
+    }
+    reg[words - 1] <<= bits;
+}
+
+static inline bool _reg_get_bit(const uint32_t* const reg, const uint8_t words, const uint32_t bit_from_lsb) {
+    return (reg[words - 1 - (bit_from_lsb / 32)] >> (bit_from_lsb % 32)) & 1;
+}
+
+static void _remainder(const nand_ecc_bch_t* const bch, uint32_t* const reg, const uint8_t* const data, const size_t size) {
+    const uint8_t         words = bch->ecc_words;
+    const uint32_t* const table = bch->remainder_table;
+
+    if(words == 1) {
+        uint32_t r = reg[0];
+        for(size_t pos = 0; pos < size; ++pos) {
+            r = (r << 8) ^ table[(r >> 24) ^ data[pos]];
+        }
+        reg[0] = r;
+        return;
+    }
+
+    for(size_t pos = 0; pos < size; ++pos) {
+        const uint32_t* const entry = &(table[((reg[0] >> 24) ^ data[pos]) * words]);
+
+        _reg_shift_left(reg, words, 8);
+        for(uint8_t word = 0; word < words; ++word) {
+            reg[word] ^= entry[word];
+        }
+    }
+}
+
+static void _reg_to_bytes(const nand_ecc_bch_t* const bch, const uint32_t* const reg, uint8_t* const ecc) {
+    for(uint8_t pos = 0; pos < bch->ecc_bytes; ++pos) {
+        ecc[pos] = reg[pos / 4] >> (24 - (pos % 4) * 8);
+    }
+}
+
+static void _bytes_to_reg(const nand_ecc_bch_t* const bch, const uint8_t* const ecc, uint32_t* const reg) {
+    memset(reg, 0, sizeof(uint32_t) * bch->ecc_words);
+    for(uint8_t pos = 0; pos < bch->ecc_bytes; ++pos) {
+        reg[pos / 4] |= (uint32_t)ecc[pos] << (24 - (pos % 4) * 8);
+    }
+
+    /** Clear the pad bits behind the last parity bit */
+    const uint32_t pad_bits = bch->ecc_words * 32 - bch->ecc_bits;
+    for(uint32_t bit = 0; bit < pad_bits; ++bit) {
+        reg[bch->ecc_words - 1 - (bit / 32)] &= ~(1UL << (bit % 32));
+    }
+}
+
+int nand_ecc_bch_init(nand_ecc_bch_t* const bch, const uint16_t data_size, const uint8_t strength) {
+    if(bch == NULL || data_size == 0 || strength == 0 || strength > CONFIG_NAND_ECC_BCH_MAX_STRENGTH) {
+        return NAND_INIT_ERROR;
+    }
+
+    memset(bch, 0, sizeof(nand_ecc_bch_t));
+
+    /** Smallest field holding the shortened codeword */
+    const uint32_t data_bits = data_size * 8UL;
+    uint8_t        m         = NAND_ECC_BCH_MIN_M;
+    while(m <= NAND_ECC_BCH_MAX_M && ((1UL << m) - 1) < data_bits + (uint32_t)m * strength) {
+        ++m;
+    }
+    if(m > NAND_ECC_BCH_MAX_M) {
+        return NAND_INIT_ERROR;
+    }
+
+    bch->m          = m;
+    bch->t          = strength;
+    bch->n          = (1UL << m) - 1;
+    bch->poly       = nand_ecc_bch_prim_poly[m - NAND_ECC_BCH_MIN_M];
+    bch->data_size  = data_size;
+
+    if(! _gf_tables_init(bch)) {
+        nand_ecc_bch_deinit(bch);
+        return NAND_INIT_ERROR;
+    }
+
+    /**
+     * Generator polynomial: product of (x - a^j) over the cyclotomic cosets of
+     * a^1, a^3, ..., a^(2t-1). Coefficients end up in GF(2).
+     */
+    const size_t    max_degree  = (size_t)m * strength;
+          uint16_t* gen         = (uint16_t*)calloc(max_degree + 1, sizeof(uint16_t));
+          uint8_t*  roots       = (uint8_t*)calloc((bch->n + 8) / 8, sizeof(uint8_t));
+          size_t    degree      = 0;
+
+    if(gen == NULL || roots == NULL) {
+        free(gen);
+        free(roots);
+        nand_ecc_bch_deinit(bch);
+        return NAND_INIT_ERROR;
+    }
+
+    gen[0] = 1;
+    for(uint32_t odd = 1; odd < 2UL * strength; odd += 2) {
+        uint32_t root = odd;
+        do {
+            if(! (roots[root / 8] & (1 << (root % 8)))) {
+                roots[root / 8] |= (1 << (root % 8));
+
+                const uint16_t alpha_root = _gf_alpha_pow(bch, root);
+                ++degree;
+                for(size_t pos = degree; pos > 0; --pos) {
+                    gen[pos] = gen[pos - 1] ^ _gf_mul(bch, gen[pos], alpha_root);
+                }
+                gen[0] = _gf_mul(bch, gen[0], alpha_root);
+            }
+            root = (root * 2) % bch->n;
+        } while(root != odd);
+    }
+    free(roots);
+
+    bch->ecc_bits   = degree;
+    bch->ecc_bytes  = (degree + 7) / 8;
+    bch->ecc_words  = (degree + 31) / 32;
+
+    /** g(x) without its leading term, left aligned in the register */
+    uint32_t* const gen_reg = (uint32_t*)calloc(bch->ecc_words, sizeof(uint32_t));
+    bch->remainder_table    = (uint32_t*)calloc(256 * bch->ecc_words, sizeof(uint32_t));
+    if(gen_reg == NULL || bch->remainder_table == NULL) {
+        free(gen);
+        free(gen_reg);
+        nand_ecc_bch_deinit(bch);
+        return NAND_INIT_ERROR;
+    }
+
+    const uint32_t reg_bits = bch->ecc_words * 32;
+    for(size_t pos = 0; pos < degree; ++pos) {
+        if(gen[pos] & 1) {
+            const uint32_t bit = reg_bits - degree + pos;
+            gen_reg[bch->ecc_words - 1 - (bit / 32)] |= 1UL << (bit % 32);
+        }
+    }
+    free(gen);
+
+    for(uint32_t byte = 0; byte < 256; ++byte) {
+        uint32_t* const entry = &(bch->remainder_table[byte * bch->ecc_words]);
+
+        entry[0] = byte << 24;
+        for(uint8_t bit = 0; bit < 8; ++bit) {
+            const bool msb = entry[0] >> 31;
+            _reg_shift_left(entry, bch->ecc_words, 1);
+            if(msb) {
+                for(uint8_t word = 0; word < bch->ecc_words; ++word) {
+                    entry[word] ^= gen_reg[word];
+                }
+            }
+        }
+    }
+    free(gen_reg);
+
+    DEBUG("nand_ecc_bch_init: m=%u t=%u ecc_bits=%u\n", bch->m, bch->t, bch->ecc_bits);
+
+    return NAND_INIT_OK;
+}
+
+void nand_ecc_bch_deinit(nand_ecc_bch_t* const bch) {
+    free(bch->remainder_table);
+    free(bch->gf_exp);
+    free(bch->gf_log);
+    bch->remainder_table    = NULL;
+    bch->gf_exp             = NULL;
+    bch->gf_log             = NULL;
+}
+
+void nand_ecc_bch_encode(const nand_ecc_bch_t* const bch, const uint8_t* const data, uint8_t* const ecc) {
+    uint32_t reg[(CONFIG_NAND_ECC_BCH_MAX_STRENGTH * NAND_ECC_BCH_MAX_M + 31) / 32] = { 0 };
+
+    _remainder(bch, reg, data, bch->data_size);
+    _reg_to_bytes(bch, reg, ecc);
+}
+
+static uint8_t _berlekamp_massey(const nand_ecc_bch_t* const bch, const uint16_t* const syndromes, uint16_t* const locator) {
+    const uint8_t  t2               = bch->t * 2;
+          uint16_t prev[CONFIG_NAND_ECC_BCH_MAX_STRENGTH * 2 + 1] = { 1 };
+          uint16_t temp[CONFIG_NAND_ECC_BCH_MAX_STRENGTH * 2 + 1];
+          uint8_t  degree           = 0;
+          uint8_t  shift            = 1;
+          uint16_t prev_discrepancy = 1;
+
+    memset(locator, 0, sizeof(uint16_t) * (t2 + 1));
+    locator[0] = 1;
+
+    for(uint8_t step = 0; step < t2; ++step) {
+        uint16_t discrepancy = syndromes[step + 1];
+        for(uint8_t pos = 1; pos <= degree; ++pos) {
+            discrepancy ^= _gf_mul(bch, locator[pos], syndromes[step + 1 - pos]);
+        }
+
+        if(discrepancy == 0) {
+            ++shift;
+            continue;
+        }
+
+        const uint16_t coef = _gf_mul(bch, discrepancy, _gf_inv(bch, prev_discrepancy));
+        memcpy(temp, locator, sizeof(uint16_t) * (t2 + 1));
+
+        for(uint8_t pos = 0; pos + shift <= t2; ++pos) {
+            locator[pos + shift] ^= _gf_mul(bch, coef, prev[pos]);
+        }
+
+        if(2 * degree <= step) {
+            degree              = step + 1 - degree;
+            memcpy(prev, temp, sizeof(uint16_t) * (t2 + 1));
+            prev_discrepancy    = discrepancy;
+            shift               = 1;
+        } else {
+            ++shift;
+        }
+    }
+
+    return degree;
+}
+
+int nand_ecc_bch_decode(const nand_ecc_bch_t* const bch, uint8_t* const data, const uint8_t* const ecc) {
+    uint32_t reg[(CONFIG_NAND_ECC_BCH_MAX_STRENGTH * NAND_ECC_BCH_MAX_M + 31) / 32] = { 0 };
+    uint32_t stored[(CONFIG_NAND_ECC_BCH_MAX_STRENGTH * NAND_ECC_BCH_MAX_M + 31) / 32];
+    bool     clean = true;
+
+    _remainder(bch, reg, data, bch->data_size);
+    _bytes_to_reg(bch, ecc, stored);
+    for(uint8_t word = 0; word < bch->ecc_words; ++word) {
+        reg[word] ^= stored[word];
+        clean = clean && reg[word] == 0;
+    }
+
+    if(clean) {
+        return 0; /**< Fast path, no GF arithmetic at all */
+    }
+
+    /**
+     * reg now holds R(x) mod g(x). As g(a^j) = 0 for j = 1 .. 2t, the
+     * syndromes of the received word are this remainder evaluated at a^j.
+     */
+    const uint32_t reg_bits     = bch->ecc_words * 32;
+    const uint32_t low_bit      = reg_bits - bch->ecc_bits;
+          uint16_t syndromes[CONFIG_NAND_ECC_BCH_MAX_STRENGTH * 2 + 1];
+          uint16_t locator[CONFIG_NAND_ECC_BCH_MAX_STRENGTH * 2 + 1];
+
+    memset(syndromes, 0, sizeof(syndromes));
+    for(uint32_t k = 0; k < bch->ecc_bits; ++k) {
+        if(! _reg_get_bit(reg, bch->ecc_words, low_bit + k)) {
+            continue;
+        }
+
+        /** Bit k adds a^(j * k) to S(j), the exponent is kept mod n as it grows */
+        const uint32_t step = k % bch->n;
+              uint32_t exp  = step;
+        for(uint8_t j = 1; j < 2 * bch->t; j += 2) {
+            syndromes[j] ^= bch->gf_exp[exp];
+            exp = (exp + 2 * step) % bch->n;
+        }
+    }
+
+    for(uint8_t j = 1; j < 2 * bch->t; j += 2) {
+        syndromes[j + 1] = _gf_mul(bch, syndromes[(j + 1) / 2], syndromes[(j + 1) / 2]); /**< S(2i) = S(i)^2 */
+    }
+
+    const uint8_t degree = _berlekamp_massey(bch, syndromes, locator);
+    if(degree == 0 || degree > bch->t) {
+        return -1;
+    }
+
+    /**
+     * Chien search over the bit positions of the shortened codeword only, the
+     * n - codeword_bits leading positions are not sent and cannot flip.
+     * Position p is a root when locator(a^-p) == 0, the term of locator[i]
+     * is kept as its log, which drops by i from one position to the next.
+     * Zero coefficients are left out.
+     */
+    uint16_t       logs[CONFIG_NAND_ECC_BCH_MAX_STRENGTH + 1];
+    uint16_t       steps[CONFIG_NAND_ECC_BCH_MAX_STRENGTH + 1];
+    uint8_t        terms            = 0;
+    const uint32_t codeword_bits    = bch->ecc_bits + bch->data_size * 8UL;
+    const uint32_t data_last_bit    = codeword_bits - 1;
+          uint8_t  found            = 0;
+          uint32_t flip_pos[CONFIG_NAND_ECC_BCH_MAX_STRENGTH];
+
+    for(uint8_t pos = 1; pos <= degree; ++pos) {
+        if(locator[pos] != 0) {
+            logs[terms]     = bch->gf_log[locator[pos]];
+            steps[terms]    = bch->n - pos;
+            ++terms;
+        }
+    }
+
+    for(uint32_t p = 0; p < codeword_bits && found < degree; ++p) {
+        uint16_t sum = 1;
+        for(uint8_t term = 0; term < terms; ++term) {
+            sum ^= bch->gf_exp[logs[term]];
+            logs[term] += steps[term];
+            if(logs[term] >= bch->n) {
+                logs[term] -= bch->n;
+            }
+        }
+
+        if(sum == 0) {
+            flip_pos[found] = p;
+            ++found;
+        }
+    }
+
+    if(found != degree) {
+        return -1;
+    }
+
+    for(uint8_t pos = 0; pos < found; ++pos) {
+        if(flip_pos[pos] >= bch->ecc_bits) {
+            const uint32_t bit = data_last_bit - flip_pos[pos];
+            data[bit / 8] ^= 0x80 >> (bit % 8);
+        }
+    }
+
+    return found;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Parameter page of the last ONFI NAND, kept across boots
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+#include "eepreg.h"
+#include "periph/eeprom.h"
+
+#include "nand/onfi.h"
+#include "nand/onfi/geometry_cache.h"
+#include "nand.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** eepreg keeps the size of an entry, the name changes with the record */
+#define GEOMETRY_CACHE_EEPREG_NAME      "nand_onfi_geometry_v2"
+#define GEOMETRY_CACHE_EEPREG_NAME_V1   "nand_onfi_geometry"    /**< with the full NAND ID, dropped on store */
+
+/** What is kept in the EEPROM, only valid for the NAND with the same ID */
+typedef struct {
+    uint8_t             nand_id[NAND_ID_KEEP_SIZE];
+    uint8_t             nand_id_size;
+    uint8_t             ecc_bits;
+    uint16_t            ecc_codeword_size;
+    uint8_t             parameter_page[NAND_ONFI_PARAMETER_PAGE_COPY_SIZE];
+} _geometry_record_t;
+
+bool nand_onfi_geometry_cache_load(nand_onfi_t* const nand_onfi, nand_onfi_chip_t* const chip) {
+    nand_t* const       nand    = (nand_t*)nand_onfi;
+    _geometry_record_t  record;
+    uint32_t            pos;
+
+    if(eepreg_read(&pos, GEOMETRY_CACHE_EEPREG_NAME) != 0 || eeprom_read(pos, &record, sizeof(record)) != sizeof(record)) {
+        return false;
+    }
+
+    if(record.nand_id_size != nand->nand_id_size || memcmp(record.nand_id, nand->nand_id, nand->nand_id_size) != 0) {
+        return false;
+    }
+
+    if(! nand_onfi_check_parameter_page(record.parameter_page)) {
+        DEBUG("nand_onfi_geometry_cache_load: cached parameter page damaged\n");
+        return false;
+    }
+
+    memcpy(chip, record.parameter_page, sizeof(record.parameter_page));
+    nand->ecc_bits          = record.ecc_bits;
+    nand->ecc_codeword_size = record.ecc_codeword_size;
+
+    return true;
+}
+
+void nand_onfi_geometry_cache_store(const nand_onfi_t* const nand_onfi, const nand_onfi_chip_t* const chip) {
+    const nand_t* const nand    = (const nand_t*)nand_onfi;
+    _geometry_record_t  record  = {
+        .nand_id_size       = nand->nand_id_size,
+        .ecc_bits           = nand->ecc_bits,
+        .ecc_codeword_size  = nand->ecc_codeword_size,
+    };
+    uint32_t            pos;
+
+    memcpy(record.nand_id, nand->nand_id, sizeof(record.nand_id));
+    memcpy(record.parameter_page, chip, sizeof(record.parameter_page));
+
+    eepreg_rm(GEOMETRY_CACHE_EEPREG_NAME_V1);
+
+    if(eepreg_add(&pos, GEOMETRY_CACHE_EEPREG_NAME, sizeof(record)) != 0) {
+        DEBUG("nand_onfi_geometry_cache_store: no room in the EEPROM registry\n");
+        return;
+    }
+
+    eeprom_write(pos, &record, sizeof(record));
+}
@@ -21,19 +21,129 @@
 
 #define ENABLE_DEBUG 0
 #include "debug.h"
+#include "checksum/ucrc16.h"
 #include "fmt.h"
+#include "kernel_defines.h"
 
 #include "nand/onfi.h"
+#include "nand/onfi/geometry_cache.h"
+#include "nand/onfi/tune.h"
+#include "nand/stats.h"
 #include "nand_cmd.h"
 #include "nand.h"
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-int nand_onfi_init(nand_onfi_t* const nand_onfi, nand_params_t* const params) {
+static_assert(sizeof(nand_onfi_chip_t) == NAND_ONFI_PARAMETER_PAGE_COPY_SIZE, "nand_onfi_chip_t must map one parameter page copy");
+
+/**
+ * Takes what is needed at runtime out of the parameter page, which is dropped
+ * afterwards. False when the ECC requirement is in the extended parameter
+ * page and that cannot be read, guessing it would leave the part without the
+ * correction it needs.
+ */
+static bool _parse_chip(nand_onfi_t* const nand_onfi, const nand_onfi_chip_t* const chip, const bool cached) {
+    nand_t* const nand = (nand_t*)nand_onfi;
+
+    nand->maker_code            = nand->nand_id[0];
+    nand->device_code           = nand->nand_id[1];
+
+    nand->data_bus_width        = (chip->features & NAND_ONFI_FEATURE_16BIT_DATA_BUS) ? 16 : 8;
+    nand->addr_bus_width        = 8;
+
+    nand->data_bytes_per_page   = chip->byte_per_page;
+    nand->spare_bytes_per_page  = chip->spare_bytes_per_page;
+    nand->pages_per_block       = chip->pages_per_block;
+    nand->blocks_per_lun        = chip->blocks_per_lun;
+    nand->lun_count             = chip->lun_count;
+    nand->bb_per_lun            = chip->bb_per_lun;
+
+    nand->column_addr_cycles    = (chip->addr_cycles & 0xF0) >> 4;
+    nand->row_addr_cycles       = (chip->addr_cycles & 0x0F);
+
+    nand->bits_per_cell         = chip->bits_per_cell;
+    nand->programs_per_page     = chip->programs_per_page;
+
+    nand_onfi->opt_cmd          = chip->opt_cmd;
+    nand_onfi->plane_addr_bits  = chip->interleaved_bits & NAND_ONFI_PLANE_ADDR_BITS_MASK;
+
+    if(! cached) {
+        nand->ecc_bits          = chip->ecc_bits;
+        nand->ecc_codeword_size = NAND_ONFI_ECC_CODEWORD_SIZE_DEFAULT;
+        if(nand->ecc_bits == NAND_ONFI_ECC_BITS_SEE_EXT_PARAMETER_PAGE) {
+            if(! nand_onfi_read_ext_ecc(nand_onfi, 0, chip, &(nand->ecc_bits), &(nand->ecc_codeword_size))) {
+                DEBUG("nand_onfi_init: extended parameter page unreadable, ECC requirement unknown\n");
+                return false;
+            }
+        }
+
+        if(IS_USED(MODULE_NAND_ONFI_GEOMETRY_CACHE)) {
+            nand_onfi_geometry_cache_store(nand_onfi, chip);
+        }
+    }
+
+    return true;
+}
+
+/** READ ID on each target that came out of the reset, compared against the ID of CE0# in nand_t */
+static void _probe_targets(nand_onfi_t* const nand_onfi, const uint8_t ready) {
+    nand_t* const nand = (nand_t*)nand_onfi;
+
+    for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+        if(! (ready & (1 << lun_no))) {
+            continue;
+        }
+
+        uint8_t      id[NAND_MAX_ID_SIZE];
+        const size_t id_size = nand_cmd_read_id(nand, lun_no, &NAND_ONFI_CMD_READ_ID, id, NAND_MAX_ID_SIZE);
+
+        /** An empty site on a wired CE# floats or reads back the pull-ups */
+        if(id_size < NAND_MIN_ID_SIZE || id[0] == 0x00 || id[0] == 0xFF) {
+            DEBUG("nand_onfi_init: CE%u# ready but no ID\n", lun_no);
+            continue;
+        }
+
+        nand_onfi->targets[lun_no] |= NAND_ONFI_TARGET_PRESENT;
+
+        const size_t kept_size = (id_size > NAND_ID_KEEP_SIZE) ? NAND_ID_KEEP_SIZE : id_size;
+        if(kept_size == nand->nand_id_size && memcmp(id, nand->nand_id, kept_size) == 0) {
+            nand_onfi->targets[lun_no] |= NAND_ONFI_TARGET_SAME_ID;
+        } else {
+            DEBUG("nand_onfi_init: CE%u# holds another part, maker %02x device %02x\n", lun_no, id[0], id[1]);
+        }
+
+        uint8_t sig[NAND_MAX_SIG_SIZE];
+        if(nand_cmd_read_id(nand, lun_no, &NAND_ONFI_CMD_READ_ID_ONFI_SIG, sig, NAND_MAX_SIG_SIZE) >= 4 && memcmp(sig, "ONFI", 4) == 0) {
+            nand_onfi->targets[lun_no] |= NAND_ONFI_TARGET_ONFI;
+        }
+    }
+}
+
+/**
+ * A LUN is one target on its own CE# here, so only the run of targets alike
+ * to CE0# is addressed, whatever the parameter page of CE0# counts.
+ */
+static void _count_luns(nand_onfi_t* const nand_onfi) {
+    nand_t* const nand  = (nand_t*)nand_onfi;
+    uint8_t       alike = 1;
+
+    while(alike < NAND_MAX_CHIPS && (nand_onfi->targets[alike] & NAND_ONFI_TARGET_SAME_ID)) {
+        ++alike;
+    }
+
+    /** With CE0# alone the parameter page is all there is to go by */
+    if(alike > 1 && alike != nand->lun_count) {
+        DEBUG("nand_onfi_init: %u targets alike, the parameter page counts %u LUNs\n", alike, nand->lun_count);
+        nand->lun_count = alike;
+    }
+}
+
+int nand_onfi_init(nand_onfi_t* const nand_onfi, const nand_params_t* const params) {
     if(nand_onfi == NULL) {
         return NAND_INIT_ERROR;
     }
@@ -53,37 +163,52 @@ int nand_onfi_init(nand_onfi_t* const nand_onfi, nand_params_t* const params) {
     nand->data_bus_width        = 8;
     nand->addr_bus_width        = 8;
 
-    nand->nand_id_size          = nand_cmd_read_id(nand, 0, &NAND_ONFI_CMD_READ_ID, nand->nand_id, NAND_MAX_ID_SIZE);
-    if(nand->nand_id_size < NAND_MIN_ID_SIZE) {
+    const uint8_t ready = nand_onfi_reset(nand_onfi);
+    if(! (ready & 0x01)) {
+        return NAND_INIT_RESET_TIMEOUT;
+    }
+
+    if(nand_cmd_read_nand_id(nand, 0, &NAND_ONFI_CMD_READ_ID) < NAND_MIN_ID_SIZE) {
         return NAND_INIT_ID_TOO_SHORT;
     }
 
-    nand->sig_size              = nand_cmd_read_id(nand, 0, &NAND_ONFI_CMD_READ_ID_ONFI_SIG, nand->sig, NAND_MAX_SIG_SIZE);
+    _probe_targets(nand_onfi, ready);
+    if(! (nand_onfi->targets[0] & NAND_ONFI_TARGET_ONFI)) {
+        DEBUG("nand_onfi_init: no ONFI signature\n");
+    }
 
-    const size_t pp_size        = nand_onfi_read_chip(nand_onfi, 0, &(nand_onfi->onfi_chip));
-    if(pp_size < (NAND_ONFI_PARAMETER_PAGE_SIZE / 8)) {
-        /** TODO: Parameter page too short */
-        return NAND_INIT_PARAMETER_PAGE_TOO_SHORT;
+    if(IS_USED(MODULE_NAND_ONFI_TUNE) && nand_onfi_tune_init(nand_onfi) != NAND_RW_OK) {
+        DEBUG("nand_onfi_init: timing calibration failed, nominal timing kept\n");
     }
 
-    nand->maker_code            = nand->nand_id[0];
-    nand->device_code           = nand->nand_id[1];
+    nand_onfi_chip_t* const chip = (nand_onfi_chip_t*)malloc(sizeof(nand_onfi_chip_t));
+    if(chip == NULL) {
+        return NAND_INIT_ERROR;
+    }
 
-    nand->data_bus_width        = (nand_onfi->onfi_chip.features & 0x1) ? 16 : 8;
-    nand->addr_bus_width        = 8;
+    /** A part seen before brings its parameter page and ECC requirement from the cache */
+    const bool cached           = IS_USED(MODULE_NAND_ONFI_GEOMETRY_CACHE) && nand_onfi_geometry_cache_load(nand_onfi, chip);
 
-    nand->data_bytes_per_page   = nand_onfi->onfi_chip.byte_per_page;
-    nand->spare_bytes_per_page  = nand_onfi->onfi_chip.spare_bytes_per_page;
-    nand->pages_per_block       = nand_onfi->onfi_chip.pages_per_block;
-    nand->blocks_per_lun        = nand_onfi->onfi_chip.blocks_per_lun;
-    nand->lun_count             = nand_onfi->onfi_chip.lun_count;
-    nand->bb_per_lun            = nand_onfi->onfi_chip.bb_per_lun;
+    if(! cached && nand_onfi_read_chip(nand_onfi, 0, chip) == 0) {
+        free(chip);
+        return NAND_INIT_PARAMETER_PAGE_CRC_MISMATCH;
+    }
 
-    nand->column_addr_cycles    = (nand_onfi->onfi_chip.addr_cycles & 0xF0) >> 4;
-    nand->row_addr_cycles       = (nand_onfi->onfi_chip.addr_cycles & 0x0F);
+    const bool parsed           = _parse_chip(nand_onfi, chip, cached);
+    free(chip);
+    if(! parsed) {
+        return NAND_INIT_ECC_UNKNOWN;
+    }
+    _count_luns(nand_onfi);
 
-    nand->bits_per_cell         = nand_onfi->onfi_chip.bits_per_cell;
-    nand->programs_per_page     = nand_onfi->onfi_chip.programs_per_page;
+    nand->ecc_on_die                        = false;
+    nand_onfi->ecc_on_die_corrected_bits    = 0;
+    nand_onfi->ecc_on_die_failed_reads      = 0;
+    if(! IS_ACTIVE(CONFIG_NAND_ONFI_NO_ON_DIE_ECC) && nand_onfi_has_on_die_ecc(nand_onfi)) {
+        if(! nand_onfi_set_on_die_ecc(nand_onfi, true)) {
+            DEBUG("nand_onfi_init: on-die ECC advertised but could not be enabled\n");
+        }
+    }
 
     nand->standard_type         = NAND_STD_ONFI;
 
@@ -92,17 +217,393 @@ int nand_onfi_init(nand_onfi_t* const nand_onfi, nand_params_t* const params) {
     return NAND_INIT_OK;
 }
 
+/** READ STATUS until RDY is set, for a target without R/B#; ONFI allows it while the target is busy */
+static bool _poll_ready(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const uint32_t deadline) {
+    uint8_t status;
+
+    do {
+        if(nand_onfi_read_status(nand_onfi, this_lun_no, &status) == NAND_RW_OK && (status & NAND_ONFI_STATUS_RDY)) {
+            return true;
+        }
+    } while(nand_deadline_left(deadline) > 0);
+
+    return false;
+}
+
+uint8_t nand_onfi_reset(nand_onfi_t* const nand_onfi) {
+    nand_t* const nand   = (nand_t*)nand_onfi;
+    uint8_t       issued = 0;
+    uint8_t       no_rb  = 0;
+
+    for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+        nand_onfi->targets[lun_no] = 0;
+
+        if(! gpio_is_valid(nand->params->ce[lun_no])) {
+            continue;
+        }
+
+        nand_rw_response_t err = NAND_RW_OK;
+        nand_cmd_base_cmdw(nand, lun_no, &NAND_ONFI_CMD_RESET, &err);
+        if(err == NAND_RW_OK) {
+            issued |= 1 << lun_no;
+
+            if(! gpio_is_valid(nand->params->rb[lun_no])) {
+                no_rb |= 1 << lun_no;
+            }
+        }
+    }
+
+    /** The targets reset side by side, so this is one tRST however many there are */
+    const uint32_t deadline = nand_deadline_from_interval(NAND_ONFI_TIMING_RST);
+    const uint8_t  rb       = issued & ~no_rb;
+          uint8_t  ready    = rb & ~nand_wait_until_luns_ready(nand, rb, NAND_ONFI_TIMING_RST);
+
+    for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+        if((no_rb & (1 << lun_no)) && _poll_ready(nand_onfi, lun_no, deadline)) {
+            ready |= 1 << lun_no;
+        }
+    }
+
+    for(uint8_t lun_no = 0; lun_no < NAND_MAX_CHIPS; ++lun_no) {
+        if(ready & (1 << lun_no)) {
+            nand_onfi->targets[lun_no] = NAND_ONFI_TARGET_READY;
+        }
+    }
+
+    return ready;
+}
+
 size_t nand_onfi_read_chip(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, nand_onfi_chip_t* const chip) {
-    const size_t          buffer_size   = sizeof(nand_onfi_chip_t);
+          uint8_t*  const copy          = (uint8_t*)chip;
+    const size_t          copy_size     = nand_cmd_read_parameter_page((nand_t*)nand_onfi, this_lun_no, &NAND_ONFI_CMD_READ_PARAMETER_PAGE, copy, NAND_ONFI_PARAMETER_PAGE_COPY_SIZE);
+
+    /** The redundant copies are only clocked over the bus when the first one is damaged */
+    if(copy_size == NAND_ONFI_PARAMETER_PAGE_COPY_SIZE && nand_onfi_check_parameter_page(copy)) {
+        return copy_size;
+    }
+
+    DEBUG("nand_onfi_read_chip: parameter page CRC mismatch, trying the redundant copies\n");
+
+          uint8_t*  const buffer        = (uint8_t*)malloc(sizeof(uint8_t) * NAND_ONFI_PARAMETER_PAGE_SIZE);
+    if(buffer == NULL) {
+        return 0;
+    }
+
+    const size_t          pp_size       = nand_cmd_read_parameter_page((nand_t*)nand_onfi, this_lun_no, &NAND_ONFI_CMD_READ_PARAMETER_PAGE, buffer, NAND_ONFI_PARAMETER_PAGE_SIZE);
+
+    for(size_t offset = 0; offset + NAND_ONFI_PARAMETER_PAGE_COPY_SIZE <= pp_size; offset += NAND_ONFI_PARAMETER_PAGE_COPY_SIZE) {
+        if(nand_onfi_check_parameter_page(&(buffer[offset]))) {
+            memcpy(copy, &(buffer[offset]), NAND_ONFI_PARAMETER_PAGE_COPY_SIZE);
+            free(buffer);
+            return NAND_ONFI_PARAMETER_PAGE_COPY_SIZE;
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
+
+bool nand_onfi_check_parameter_page(const uint8_t* const copy) {
+    const uint16_t crc = copy[NAND_ONFI_PARAMETER_PAGE_CRC_POS] | (copy[NAND_ONFI_PARAMETER_PAGE_CRC_POS + 1] << 8);
+
+    return ucrc16_calc_be(copy, NAND_ONFI_PARAMETER_PAGE_CRC_POS, NAND_ONFI_PARAMETER_PAGE_CRC_POLY, NAND_ONFI_PARAMETER_PAGE_CRC_SEED) == crc;
+}
+
+bool nand_onfi_read_ext_ecc(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const nand_onfi_chip_t* const chip, uint8_t* const ecc_bits, uint16_t* const ecc_codeword_size) {
+    if(! (chip->features & NAND_ONFI_FEATURE_EXT_PARAMETER_PAGE) || chip->ext_param_page_length == 0) {
+        return false;
+    }
+
+    /** The extended parameter page follows all copies of the parameter page */
+    const uint8_t         pp_count      = (chip->num_of_param_pages > 0) ? chip->num_of_param_pages : 3;
+    const size_t          ext_offset    = pp_count * NAND_ONFI_PARAMETER_PAGE_COPY_SIZE;
+    const size_t          ext_size      = chip->ext_param_page_length * NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_UNIT;
+    const size_t          buffer_size   = ext_offset + ext_size;
           uint8_t*  const buffer        = (uint8_t*)malloc(sizeof(uint8_t) * buffer_size);
     const size_t          pp_size       = nand_cmd_read_parameter_page((nand_t*)nand_onfi, this_lun_no, &NAND_ONFI_CMD_READ_PARAMETER_PAGE, buffer, buffer_size);
-    if(pp_size == 0) {
+
+    if(pp_size < buffer_size || memcmp(&(buffer[ext_offset + 2]), "EPPS", 4) != 0) {
         free(buffer);
-        return 0;
+        return false;
     }
 
-    memcpy(chip, buffer, sizeof(uint8_t) * pp_size);
+    const uint8_t* const  ext           = &(buffer[ext_offset]);
+          size_t          section_pos   = NAND_ONFI_EXT_PARAMETER_PAGE_HEADER_SIZE;
+
+    for(size_t seq = 0; seq < NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_COUNT; ++seq) {
+        const uint8_t section_type  = ext[16 + seq * 2];
+        const size_t  section_size  = ext[16 + seq * 2 + 1] * NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_UNIT;
+
+        if(section_pos + section_size > ext_size) {
+            break;
+        }
+
+        if(section_type == NAND_ONFI_EXT_PARAMETER_PAGE_SECTION_ECC && section_size > 0) {
+            /** First ECC information block: correctability bits, codeword size as power of two */
+            *ecc_bits           = ext[section_pos];
+            *ecc_codeword_size  = (ext[section_pos + 1] < 16) ? (1U << ext[section_pos + 1]) : 0;
+
+            free(buffer);
+            return *ecc_codeword_size > 0;
+        }
+
+        section_pos += section_size;
+    }
 
     free(buffer);
-    return pp_size;
-}
\ No newline at end of file
+    return false;
+}
+
+nand_rw_response_t nand_onfi_read_status(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, uint8_t* const status) {
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    if(nand_cmd_base_cmdw_rawr((nand_t*)nand_onfi, this_lun_no, &NAND_ONFI_CMD_READ_STATUS, status, 1, &err) != 1 && err == NAND_RW_OK) {
+        err = NAND_RW_TIMEOUT;
+    }
+
+    return err;
+}
+
+nand_rw_response_t nand_onfi_read_status_enhanced(nand_onfi_t* const nand_onfi, const uint64_t addr_row, uint8_t* const status) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    if((nand_onfi->opt_cmd & NAND_ONFI_OPT_CMD_READ_STATUS_ENHANCED) == 0) {
+        return nand_onfi_read_status(nand_onfi, nand_addr_row_to_lun_no(nand, addr_row), status);
+    }
+
+    if(nand_cmd_base_cmdw_addrrw_rawr(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_READ_STATUS_ENHANCED, addr_row, status, 1, &err) != 1 && err == NAND_RW_OK) {
+        err = NAND_RW_TIMEOUT;
+    }
+
+    return err;
+}
+
+nand_rw_response_t nand_onfi_get_features(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const uint8_t feature_addr, uint8_t* const parameters) {
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    if(nand_cmd_base_cmdw_addrsgw_rawr((nand_t*)nand_onfi, this_lun_no, &NAND_ONFI_CMD_GET_FEATURES, feature_addr, parameters, NAND_ONFI_FEATURE_PARAMETERS_SIZE, &err) != NAND_ONFI_FEATURE_PARAMETERS_SIZE && err == NAND_RW_OK) {
+        err = NAND_RW_TIMEOUT;
+    }
+
+    return err;
+}
+
+nand_rw_response_t nand_onfi_set_features(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, const uint8_t feature_addr, const uint8_t* const parameters) {
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    if(nand_cmd_base_cmdw_addrsgw_raww((nand_t*)nand_onfi, this_lun_no, &NAND_ONFI_CMD_SET_FEATURES, feature_addr, parameters, NAND_ONFI_FEATURE_PARAMETERS_SIZE, &err) != NAND_ONFI_FEATURE_PARAMETERS_SIZE && err == NAND_RW_OK) {
+        err = NAND_RW_WRITE_ERROR;
+    }
+
+    return err;
+}
+
+/** Program and erase report their outcome only through the status register */
+static nand_rw_response_t _check_status(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const nand_rw_response_t err) {
+    const uint32_t           deadline   = nand_deadline_from_interval(NAND_ONFI_TIMING_INFINITY);
+          uint8_t            status     = 0;
+
+    if(err != NAND_RW_OK) {
+        return err;
+    }
+
+    /** FAIL is only valid once the LUN is ready again, the command returns right after tWB */
+    do {
+        if(nand_onfi_read_status_enhanced(nand_onfi, addr_row, &status) != NAND_RW_OK) {
+            return NAND_RW_TIMEOUT;
+        }
+
+        if(status & NAND_ONFI_STATUS_RDY) {
+            return (status & NAND_ONFI_STATUS_FAIL) ? NAND_RW_WRITE_ERROR : NAND_RW_OK;
+        }
+    } while(nand_deadline_left(deadline) > 0);
+
+    return NAND_RW_TIMEOUT;
+}
+
+bool nand_onfi_has_on_die_ecc(const nand_onfi_t* const nand_onfi) {
+    const nand_t* const nand = (const nand_t*)nand_onfi;
+
+    /** The parameter page does not advertise an internal ECC, Micron reports its level in bits 1:0 of ID byte 4 instead */
+    if(nand->maker_code != NAND_ONFI_MAKER_MICRON || nand->nand_id_size <= NAND_ONFI_MICRON_ID_INTERNAL_ECC_POS) {
+        return false;
+    }
+
+    return (nand->nand_id[NAND_ONFI_MICRON_ID_INTERNAL_ECC_POS] & NAND_ONFI_MICRON_ID_INTERNAL_ECC_MASK) != 0;
+}
+
+bool nand_onfi_set_on_die_ecc(nand_onfi_t* const nand_onfi, const bool enable) {
+    nand_t* const nand = (nand_t*)nand_onfi;
+
+    nand->ecc_on_die = false;
+
+    for(uint8_t this_lun_no = 0; this_lun_no < nand->lun_count; ++this_lun_no) {
+        uint8_t parameters[NAND_ONFI_FEATURE_PARAMETERS_SIZE];
+
+        if(nand_onfi_get_features(nand_onfi, this_lun_no, NAND_ONFI_FEATURE_ADDR_ARRAY_OPERATION_MODE, parameters) != NAND_RW_OK) {
+            return false;
+        }
+
+        if(enable) {
+            parameters[0] |= NAND_ONFI_ARRAY_OPERATION_MODE_ECC_ENABLE;
+        } else {
+            parameters[0] &= ~NAND_ONFI_ARRAY_OPERATION_MODE_ECC_ENABLE;
+        }
+
+        if(nand_onfi_set_features(nand_onfi, this_lun_no, NAND_ONFI_FEATURE_ADDR_ARRAY_OPERATION_MODE, parameters) != NAND_RW_OK) {
+            return false;
+        }
+
+        /** Read back, parts without internal ECC ignore the write */
+        if(nand_onfi_get_features(nand_onfi, this_lun_no, NAND_ONFI_FEATURE_ADDR_ARRAY_OPERATION_MODE, parameters) != NAND_RW_OK) {
+            return false;
+        }
+
+        if(((parameters[0] & NAND_ONFI_ARRAY_OPERATION_MODE_ECC_ENABLE) != 0) != enable) {
+            return false;
+        }
+    }
+
+    nand->ecc_on_die = enable;
+
+    return true;
+}
+
+/** Result of a page read by the status the on-die ECC left for it */
+static nand_rw_response_t _check_on_die_ecc(nand_onfi_t* const nand_onfi, const uint8_t status, const nand_rw_response_t err) {
+    const nand_t*      const nand   = (const nand_t*)nand_onfi;
+
+    if(err != NAND_RW_OK) {
+        return err;
+    }
+
+    if(status & NAND_ONFI_STATUS_FAIL) {
+        ++(nand_onfi->ecc_on_die_failed_reads);
+        return NAND_RW_ECC_MISMATCH;
+    }
+
+    if(status & NAND_ONFI_STATUS_REWRITE_RECOMMENDED) {
+        /** No exact count is reported, the part only flags flips close to its strength.
+         *  Parts without a requirement in the parameter page still corrected one at least */
+        const size_t corrected_bits = (nand->ecc_bits != 0) ? nand->ecc_bits : 1;
+
+        nand_onfi->ecc_on_die_corrected_bits += corrected_bits;
+        nand_stats_ecc(corrected_bits);
+    }
+
+    return NAND_RW_OK;
+}
+
+nand_rw_response_t nand_onfi_read_page(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, uint8_t* const buffer, const size_t buffer_size) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    if(! nand->ecc_on_die) {
+        nand_cmd_base_cmdw_addrw_cmdw_rawr(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_READ, addr_column, addr_row, buffer, buffer_size, &err);
+
+        return err;
+    }
+
+    uint8_t                  status = 0;
+
+    nand_cmd_base_cmdw_addrw_cmdw_cmdw_rawr_cmdw_rawr(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_READ_WITH_STATUS, addr_column, addr_row, &status, buffer, buffer_size, &err);
+
+    return _check_on_die_ecc(nand_onfi, status, err);
+}
+
+nand_rw_response_t nand_onfi_read_page_hooked(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    nand_cmd_base_cmdw_addrw_cmdw_rawr_hooked(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_READ, addr_column, addr_row, buffer, buffer_size, chunk_size, pre_hook_cb, post_hook_cb, hook_arg, &err);
+
+    return err;
+}
+
+bool nand_onfi_has_read_cache(const nand_onfi_t* const nand_onfi) {
+    return (nand_onfi->opt_cmd & NAND_ONFI_OPT_CMD_READ_CACHE) != 0;
+}
+
+nand_rw_response_t nand_onfi_read_cache_start(nand_onfi_t* const nand_onfi, const uint64_t addr_row) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    nand_cmd_base_cmdw_addrw_cmdw(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_READ_CACHE_START, nand_offset_to_addr_column(0), addr_row, &err);
+
+    return err;
+}
+
+nand_rw_response_t nand_onfi_read_cache_next(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no, uint8_t* const buffer, const size_t buffer_size, const bool last) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    if(! nand->ecc_on_die) {
+        nand_cmd_base_cmdw_rawr(nand, this_lun_no, last ? &NAND_ONFI_CMD_READ_CACHE_END : &NAND_ONFI_CMD_READ_CACHE_SEQUENTIAL, buffer, buffer_size, &err);
+
+        return err;
+    }
+
+    uint8_t                  status = 0;
+
+    nand_cmd_base_cmdw_cmdw_rawr_cmdw_rawr(nand, this_lun_no, last ? &NAND_ONFI_CMD_READ_CACHE_END_WITH_STATUS : &NAND_ONFI_CMD_READ_CACHE_SEQUENTIAL_WITH_STATUS, &status, buffer, buffer_size, &err);
+
+    return _check_on_die_ecc(nand_onfi, status, err);
+}
+
+nand_rw_response_t nand_onfi_read_cache_end(nand_onfi_t* const nand_onfi, const uint8_t this_lun_no) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    nand_cmd_base_cmdw(nand, this_lun_no, &NAND_ONFI_CMD_READ_CACHE_ABORT, &err);
+
+    return err;
+}
+
+nand_rw_response_t nand_onfi_program_page(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, const uint8_t* const buffer, const size_t buffer_size) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    nand_cmd_base_cmdw_addrw_raww_cmdw(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_PAGE_PROGRAM, addr_column, addr_row, buffer, buffer_size, &err);
+
+    return _check_status(nand_onfi, addr_row, err);
+}
+
+nand_rw_response_t nand_onfi_program_page_hooked(nand_onfi_t* const nand_onfi, const uint64_t addr_row, const uint64_t addr_column, const uint8_t* const buffer, const size_t buffer_size, const size_t chunk_size, const nand_hook_cb_t pre_hook_cb, const nand_hook_cb_t post_hook_cb, void* const hook_arg) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    nand_cmd_base_cmdw_addrw_raww_cmdw_hooked(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_PAGE_PROGRAM, addr_column, addr_row, buffer, buffer_size, chunk_size, pre_hook_cb, post_hook_cb, hook_arg, &err);
+
+    return _check_status(nand_onfi, addr_row, err);
+}
+
+nand_rw_response_t nand_onfi_erase_block(nand_onfi_t* const nand_onfi, const uint64_t addr_row) {
+    nand_t*            const nand   = (nand_t*)nand_onfi;
+    nand_rw_response_t       err    = NAND_RW_OK;
+
+    nand_cmd_base_cmdw_addrrw_cmdw(nand, nand_addr_row_to_lun_no(nand, addr_row), &NAND_ONFI_CMD_BLOCK_ERASE, addr_row, &err);
+
+    return _check_status(nand_onfi, addr_row, err);
+}
+
+nand_rw_response_t nand_onfi_copyback(nand_onfi_t* const nand_onfi, const uint64_t src_addr_row, const uint64_t dst_addr_row) {
+    nand_t*            const nand       = (nand_t*)nand_onfi;
+    const uint8_t            lun_no     = nand_addr_row_to_lun_no(nand, src_addr_row);
+    const uint64_t           plane_mask = ((uint64_t)1 << nand_onfi->plane_addr_bits) - 1;
+    nand_rw_response_t       err        = NAND_RW_OK;
+
+    /** The page register is per plane, data cannot move across planes or LUNs */
+    if(lun_no != nand_addr_row_to_lun_no(nand, dst_addr_row) || ((src_addr_row / nand->pages_per_block) & plane_mask) != ((dst_addr_row / nand->pages_per_block) & plane_mask)) {
+        return NAND_RW_NOT_SUPPORTED;
+    }
+
+    nand_cmd_base_cmdw_addrw_cmdw(nand, lun_no, &NAND_ONFI_CMD_COPYBACK_READ, nand_offset_to_addr_column(0), src_addr_row, &err);
+    if(err != NAND_RW_OK) {
+        return err;
+    }
+
+    nand_cmd_base_cmdw_addrw_cmdw(nand, lun_no, &NAND_ONFI_CMD_COPYBACK_PROGRAM, nand_offset_to_addr_column(0), dst_addr_row, &err);
+
+    return _check_status(nand_onfi, dst_addr_row, err);
+}
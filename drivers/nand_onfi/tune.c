@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     drivers_nand_onfi
+ * @{
+ *
+ * @file
+ * @brief       Calibration of the bus timing of ONFI NANDs
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#define ENABLE_DEBUG 0
+#include "debug.h"
+#include "kernel_defines.h"
+
+#include "nand/onfi.h"
+#include "nand/onfi/tune.h"
+#include "nand_cmd.h"
+#include "nand.h"
+
+#if IS_USED(MODULE_EEPREG)
+#include "eepreg.h"
+#include "periph/eeprom.h"
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/** eepreg keeps the size of an entry, the name changes with the record */
+#define TUNE_EEPREG_NAME    "nand_onfi_tune_v2"
+#define TUNE_EEPREG_NAME_V1 "nand_onfi_tune"    /**< with the full NAND ID, dropped on store */
+
+/** What is kept in the EEPROM, only valid for the NAND with the same ID */
+typedef struct {
+    uint8_t             nand_id[NAND_ID_KEEP_SIZE];
+    uint8_t             nand_id_size;
+    uint16_t            timing_scale_cycle;
+    uint16_t            timing_scale_latch;
+} _tune_record_t;
+
+static nand_onfi_t* _dev;
+
+/** The first parameter page copy must read back @p reads times as @p ref */
+static bool _passes(nand_onfi_t* const nand_onfi, const uint8_t* const ref, uint8_t* const copy, const unsigned reads) {
+    for(unsigned run = 0; run < reads; ++run) {
+        const size_t pp_size = nand_cmd_read_parameter_page((nand_t*)nand_onfi, 0, &NAND_ONFI_CMD_READ_PARAMETER_PAGE, copy, NAND_ONFI_PARAMETER_PAGE_COPY_SIZE);
+
+        if(pp_size < NAND_ONFI_PARAMETER_PAGE_COPY_SIZE || ! nand_onfi_check_parameter_page(copy)) {
+            return false;
+        }
+
+        if(ref != NULL && memcmp(copy, ref, NAND_ONFI_PARAMETER_PAGE_COPY_SIZE) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Bisects @p scale down from its current, passing value, then adds the margin */
+static void _search(nand_onfi_t* const nand_onfi, uint16_t* const scale, const uint8_t* const ref, uint8_t* const copy) {
+    uint16_t pass = *scale;
+    uint16_t fail = 0;
+
+    while(pass - fail > CONFIG_NAND_ONFI_TUNE_STEP) {
+        *scale = fail + (pass - fail) / 2;
+
+        if(_passes(nand_onfi, ref, copy, CONFIG_NAND_ONFI_TUNE_READS)) {
+            pass = *scale;
+        } else {
+            fail = *scale;
+        }
+    }
+
+    const uint32_t margined = pass + (uint32_t)NAND_TIMING_SCALE_NOMINAL * CONFIG_NAND_ONFI_TUNE_MARGIN / 100;
+    *scale = (margined > NAND_TIMING_SCALE_NOMINAL) ? NAND_TIMING_SCALE_NOMINAL : margined;
+}
+
+#if IS_USED(MODULE_EEPREG)
+static bool _load(nand_onfi_t* const nand_onfi) {
+    nand_t* const   nand    = (nand_t*)nand_onfi;
+    _tune_record_t  record;
+    uint32_t        pos;
+
+    if(eepreg_read(&pos, TUNE_EEPREG_NAME) != 0 || eeprom_read(pos, &record, sizeof(record)) != sizeof(record)) {
+        return false;
+    }
+
+    if(record.nand_id_size != nand->nand_id_size || memcmp(record.nand_id, nand->nand_id, nand->nand_id_size) != 0) {
+        return false;
+    }
+
+    if(record.timing_scale_cycle > NAND_TIMING_SCALE_NOMINAL || record.timing_scale_latch > NAND_TIMING_SCALE_NOMINAL) {
+        return false;
+    }
+
+    nand->timing_scale_cycle = record.timing_scale_cycle;
+    nand->timing_scale_latch = record.timing_scale_latch;
+
+    return true;
+}
+
+static void _store(const nand_onfi_t* const nand_onfi) {
+    const nand_t* const nand   = (const nand_t*)nand_onfi;
+    _tune_record_t      record = {
+        .nand_id_size       = nand->nand_id_size,
+        .timing_scale_cycle = nand->timing_scale_cycle,
+        .timing_scale_latch = nand->timing_scale_latch,
+    };
+    uint32_t            pos;
+
+    memcpy(record.nand_id, nand->nand_id, sizeof(record.nand_id));
+
+    eepreg_rm(TUNE_EEPREG_NAME_V1);
+
+    if(eepreg_add(&pos, TUNE_EEPREG_NAME, sizeof(record)) != 0) {
+        DEBUG("nand_onfi_tune: no room in the EEPROM registry\n");
+        return;
+    }
+
+    eeprom_write(pos, &record, sizeof(record));
+}
+#else
+static bool _load(nand_onfi_t* const nand_onfi) {
+    (void)nand_onfi;
+
+    return false;
+}
+
+static void _store(const nand_onfi_t* const nand_onfi) {
+    (void)nand_onfi;
+}
+#endif
+
+nand_rw_response_t nand_onfi_tune(nand_onfi_t* const nand_onfi) {
+    nand_t* const nand = (nand_t*)nand_onfi;
+    uint8_t       ref[NAND_ONFI_PARAMETER_PAGE_COPY_SIZE];
+    uint8_t       copy[NAND_ONFI_PARAMETER_PAGE_COPY_SIZE];
+
+    nand->timing_scale_cycle = NAND_TIMING_SCALE_NOMINAL;
+    nand->timing_scale_latch = NAND_TIMING_SCALE_NOMINAL;
+
+    if(! _passes(nand_onfi, NULL, ref, CONFIG_NAND_ONFI_TUNE_READS)) {
+        return NAND_RW_UNRELIABLE;
+    }
+
+    /** The cycle delays add up over every byte, so they go first */
+    _search(nand_onfi, &(nand->timing_scale_cycle), ref, copy);
+    _search(nand_onfi, &(nand->timing_scale_latch), ref, copy);
+
+    /** The cycle search ran with the nominal latch delays, check both together */
+    if(! _passes(nand_onfi, ref, copy, CONFIG_NAND_ONFI_TUNE_READS)) {
+        DEBUG("nand_onfi_tune: tuned timing fails, back to nominal\n");
+        nand->timing_scale_cycle = NAND_TIMING_SCALE_NOMINAL;
+        nand->timing_scale_latch = NAND_TIMING_SCALE_NOMINAL;
+        return NAND_RW_UNRELIABLE;
+    }
+
+    DEBUG("nand_onfi_tune: cycle %u/256, latch %u/256\n", nand->timing_scale_cycle, nand->timing_scale_latch);
+
+    _store(nand_onfi);
+
+    return NAND_RW_OK;
+}
+
+nand_rw_response_t nand_onfi_tune_init(nand_onfi_t* const nand_onfi) {
+    uint8_t copy[NAND_ONFI_PARAMETER_PAGE_COPY_SIZE];
+
+    _dev = nand_onfi;
+
+    /** A stored timing passed all reads when it was found, one read at boot is enough to catch a changed board */
+    if(_load(nand_onfi) && _passes(nand_onfi, NULL, copy, 1)) {
+        return NAND_RW_OK;
+    }
+
+    return nand_onfi_tune(nand_onfi);
+}
+
+nand_onfi_t* nand_onfi_tune_dev(void) {
+    return _dev;
+}
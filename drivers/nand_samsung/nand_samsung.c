@@ -33,7 +33,7 @@
 #include <stdlib.h>
 #include <string.h>
 
-int nand_samsung_init(nand_samsung_t* const nand_samsung, nand_params_t* const params) {
+int nand_samsung_init(nand_samsung_t* const nand_samsung, const nand_params_t* const params) {
     if(nand_samsung == NULL) {
         return NAND_INIT_ERROR;
     }
@@ -53,8 +53,7 @@ int nand_samsung_init(nand_samsung_t* const nand_samsung, nand_params_t* const p
     nand->data_bus_width        = 8;
     nand->addr_bus_width        = 8;
 
-    nand->nand_id_size          = nand_cmd_read_id(nand, 0, &NAND_SAMSUNG_CMD_READ_ID, nand->nand_id, NAND_MAX_ID_SIZE);
-    if(nand->nand_id_size < NAND_MIN_ID_SIZE) {
+    if(nand_cmd_read_nand_id(nand, 0, &NAND_SAMSUNG_CMD_READ_ID) < NAND_MIN_ID_SIZE) {
         return NAND_INIT_ID_TOO_SHORT;
     }
 
@@ -79,6 +78,10 @@ int nand_samsung_init(nand_samsung_t* const nand_samsung, nand_params_t* const p
     nand->bits_per_cell         = 0; /** TODO: bits per cell support */
     nand->programs_per_page     = 0; /** TODO: programs_per_page support */
 
+    nand->ecc_bits              = 0; /** TODO: ECC requirement support */
+    nand->ecc_codeword_size     = 0;
+    nand->ecc_on_die            = false;
+
     nand->standard_type         = NAND_STD_SAMSUNG;
 
     nand->init_done             = true;
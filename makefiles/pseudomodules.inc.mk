@@ -140,7 +140,13 @@ PSEUDOMODULES += mpu_stack_guard
 ## This is a protection mechanism which makes exploitation of buffer overflows significantly harder.
 PSEUDOMODULES += mpu_noexec_ram
 
+PSEUDOMODULES += mtd_nand_onfi_cache
+PSEUDOMODULES += mtd_nand_onfi_readahead
 PSEUDOMODULES += mtd_write_page
+PSEUDOMODULES += nand_onfi_geometry_cache
+PSEUDOMODULES += nand_onfi_tune
+PSEUDOMODULES += nand_stats
+PSEUDOMODULES += nand_trace
 PSEUDOMODULES += nanocoap_%
 PSEUDOMODULES += netdev_default
 PSEUDOMODULES += netdev_ieee802154_%
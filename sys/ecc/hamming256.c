@@ -38,6 +38,7 @@
  *----------------------------------------------------------------------------*/
 
 #include <stdint.h>
+#include <string.h>
 
 #define ENABLE_DEBUG 0
 #include "debug.h"
@@ -57,6 +58,18 @@ static uint8_t count_bits_in_code256(uint8_t *code)
     return bitarithm_bits_set(code[0]) +  bitarithm_bits_set(code[1]) +  bitarithm_bits_set(code[2]);
 }
 
+/**
+ *  @brief Returns the parity of a 32-bit word.
+ *  @param value  Word to fold.
+ */
+static inline uint8_t parity32(uint32_t value)
+{
+    value ^= value >> 16;
+    value ^= value >> 8;
+    value ^= value >> 4;
+    return (0x6996 >> (value & 0x0F)) & 1;
+}
+
 /**
  *  @brief Calculates the 22-bit hamming code for a 256-bytes block of data.
  *  @param data  Data buffer to calculate code for.
@@ -67,64 +80,71 @@ static uint8_t count_bits_in_code256(uint8_t *code)
 static void compute256(const uint8_t *data, uint8_t *code, uint8_t padding)
 {
     uint32_t i;
-    uint8_t columnSum = 0;
-    uint8_t evenLineCode = 0;
-    uint8_t oddLineCode = 0;
+    uint32_t size = 256 - padding;
+    uint32_t words = size / sizeof(uint32_t);
+    uint32_t columnWord = 0;
+    uint32_t indexWords[6] = { 0 };
+    uint8_t columnBytes[sizeof(uint32_t)];
+    uint8_t columnSum;
+    uint8_t evenLineCode;
+    uint8_t oddLineCode;
     uint8_t evenColumnCode = 0;
     uint8_t oddColumnCode = 0;
 
     /*
-     * Xor all bytes together to get the column sum;
-     * At the same time, calculate the even and odd line codes
+     * The line code of the byte-wise algorithm is the xor of the indexes of
+     * all bytes with odd parity, so bit b of oddLineCode is the parity of all
+     * bytes whose index has bit b set. Bits 2 to 7 of a byte index are bits 0
+     * to 5 of the word index: xor every word into the accumulator of each of
+     * its set index bits and take the parity at the end. Bits 0 and 1 select
+     * a byte within the word, they come from the xor of all words.
+     * Zero padding does not change any xor, so the data is read up to its end
+     * only.
      */
-    for (i = 0; i < 256; i++) {
-        /* Allow non-multiples of 256 to be calculated by padding the data with zeroes */
-        uint8_t current = 0;
-        if (i < ((uint16_t)(256 - padding))) {
-            current = data[i];
-        }
+    for (i = 0; i < words; i++) {
+        uint32_t current;
+        memcpy(&current, &data[i * sizeof(uint32_t)], sizeof(uint32_t));
+
+        columnWord ^= current;
+        indexWords[0] ^= current & -(uint32_t)(i & 1);
+        indexWords[1] ^= current & -(uint32_t)((i >> 1) & 1);
+        indexWords[2] ^= current & -(uint32_t)((i >> 2) & 1);
+        indexWords[3] ^= current & -(uint32_t)((i >> 3) & 1);
+        indexWords[4] ^= current & -(uint32_t)((i >> 4) & 1);
+        indexWords[5] ^= current & -(uint32_t)((i >> 5) & 1);
+    }
+
+    if (words * sizeof(uint32_t) < size) {
+        uint32_t current = 0;
+        memcpy(&current, &data[words * sizeof(uint32_t)], size - words * sizeof(uint32_t));
 
-        columnSum ^= current;
-
-        /*
-         * If the xor sum of the byte is 0, then this byte has no incidence on
-         * the computed code; so check if the sum is 1.
-         */
-        if ((bitarithm_bits_set(current) & 1) == 1) {
-            /*
-             * Parity groups are formed by forcing a particular index bit to 0
-             * (even) or 1 (odd).
-             * Example on one byte:
-             *
-             * bits (dec)  7   6   5   4   3   2   1   0
-             *      (bin) 111 110 101 100 011 010 001 000
-             *                            '---'---'---'----------.
-             *                                                   |
-             * groups P4' ooooooooooooooo eeeeeeeeeeeeeee P4     |
-             *        P2' ooooooo eeeeeee ooooooo eeeeeee P2     |
-             *        P1' ooo eee ooo eee ooo eee ooo eee P1     |
-             *                                                   |
-             * We can see that:                                  |
-             *  - P4  -> bit 2 of index is 0 --------------------'
-             *  - P4' -> bit 2 of index is 1.
-             *  - P2  -> bit 1 of index if 0.
-             *  - etc...
-             * We deduce that a bit position has an impact on all even Px if
-             * the log2(x)nth bit of its index is 0
-             *     ex: log2(4) = 2, bit2 of the index must be 0 (-> 0 1 2 3)
-             * and on all odd Px' if the log2(x)nth bit of its index is 1
-             *     ex: log2(2) = 1, bit1 of the index must be 1 (-> 0 1 4 5)
-             *
-             * As such, we calculate all the possible Px and Px' values at the
-             * same time in two variables, evenLineCode and oddLineCode, such as
-             *     evenLineCode bits: P128  P64  P32  P16  P8  P4  P2  P1
-             *     oddLineCode  bits: P128' P64' P32' P16' P8' P4' P2' P1'
-             */
-            evenLineCode ^= (255 - i);
-            oddLineCode ^= i;
+        columnWord ^= current;
+        for (i = 0; i < 6; i++) {
+            if ((words >> i) & 1) {
+                indexWords[i] ^= current;
+            }
         }
     }
 
+    /* Same byte order as in memory, regardless of the CPU endianness */
+    memcpy(columnBytes, &columnWord, sizeof(uint32_t));
+    columnSum = columnBytes[0] ^ columnBytes[1] ^ columnBytes[2] ^ columnBytes[3];
+
+    oddLineCode = (bitarithm_bits_set(columnBytes[1] ^ columnBytes[3]) & 1)
+                | ((bitarithm_bits_set(columnBytes[2] ^ columnBytes[3]) & 1) << 1);
+    for (i = 0; i < 6; i++) {
+        oddLineCode |= parity32(indexWords[i]) << (i + 2);
+    }
+
+    /*
+     * evenLineCode is the xor of the complemented indexes, which only
+     * differs from oddLineCode if an odd count of bytes had odd parity.
+     */
+    evenLineCode = oddLineCode;
+    if (bitarithm_bits_set(columnSum) & 1) {
+        evenLineCode ^= 0xFF;
+    }
+
     /*
      * At this point, we have the line parities, and the column sum. First, We
      * must calculate the parity group values on the column sum.
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     sys_shell_commands
+ * @{
+ *
+ * @file
+ * @brief       Shell command showing the statistics and the command trace of
+ *              the NAND stack, and calibrating its bus timing
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mutex.h"
+#include "nand.h"
+#include "nand/onfi/tune.h"
+#include "nand/stats.h"
+#include "nand/trace.h"
+
+#if IS_USED(MODULE_NAND_STATS)
+
+static const char *_op_names[NAND_STATS_OP_NUMOF] = {
+    [NAND_STATS_OP_READ]    = "read",
+    [NAND_STATS_OP_PROGRAM] = "program",
+    [NAND_STATS_OP_ERASE]   = "erase",
+    [NAND_STATS_OP_OTHER]   = "other",
+};
+
+static void _print_ops(const char *layer, const nand_stats_ops_t *ops, nand_stats_op_t op)
+{
+    uint32_t kb_per_sec = ops->usec ? ops->bytes * 1000 / ops->usec : 0;
+
+    printf("%s %s: %" PRIu32 " ops, %" PRIu32 " failed, %" PRIu64 " bytes, "
+           "%" PRIu64 " us, max %" PRIu32 " us, %" PRIu32 ".%03" PRIu32 " MB/s\n",
+           layer, _op_names[op], ops->count, ops->failed, ops->bytes,
+           ops->usec, ops->usec_max, kb_per_sec / 1000, kb_per_sec % 1000);
+
+    if (ops->count == 0) {
+        return;
+    }
+
+    /* bucket n counts [2^n, 2^(n+1)) us, the first one everything below 2 us */
+    printf("  us:");
+    for (unsigned bucket = 0; bucket < CONFIG_NAND_STATS_BUCKETS; bucket++) {
+        if (ops->buckets[bucket] == 0) {
+            continue;
+        }
+        printf(" %s%" PRIu32 ":%" PRIu32,
+               (bucket + 1 == CONFIG_NAND_STATS_BUCKETS) ? ">=" : "",
+               (bucket == 0) ? 0 : (uint32_t)1 << bucket, ops->buckets[bucket]);
+    }
+    puts("");
+}
+
+static int _cmd_stats(void)
+{
+    uint64_t cmd_usec = 0;
+
+    for (unsigned op = 0; op < NAND_STATS_OP_NUMOF; op++) {
+        _print_ops("cmd", &nand_stats.cmd[op], op);
+        cmd_usec += nand_stats.cmd[op].usec;
+    }
+    for (unsigned op = 0; op < NAND_STATS_OP_OTHER; op++) {
+        _print_ops("mtd", &nand_stats.mtd[op], op);
+    }
+
+    /* the bus cycles are what is left of the commands after the waits */
+    uint64_t wait_usec = nand_stats.wait_ns / 1000;
+    uint64_t waits = wait_usec + nand_stats.ready_usec;
+
+    printf("time: bus %" PRIu64 " us, nand_wait %" PRIu64 " us, R/B# %" PRIu64 " us\n",
+           (cmd_usec > waits) ? cmd_usec - waits : 0,
+           wait_usec, nand_stats.ready_usec);
+    printf("timeouts: %" PRIu32 "\n", nand_stats.timeouts);
+    printf("ecc: %" PRIu32 " bits corrected, %" PRIu32 " pages uncorrectable\n",
+           nand_stats.ecc_corrected_bits, nand_stats.ecc_failed);
+
+    return 0;
+}
+
+static int _cmd_info(void)
+{
+    const nand_t *nand = nand_stats.nand;
+
+    if (nand == NULL) {
+        puts("no NAND initialized");
+        return 1;
+    }
+
+    printf("id:");
+    for (unsigned pos = 0; pos < nand->nand_id_size; pos++) {
+        printf(" %02x", nand->nand_id[pos]);
+    }
+    puts("");
+
+    printf("standard: %s%s\n",
+           (nand->standard_type == NAND_STD_ONFI) ? "ONFI" :
+           (nand->standard_type == NAND_STD_SAMSUNG) ? "Samsung" : "unknown",
+           nand->init_done ? "" : ", init not done");
+    printf("bus: %u bit data, %u bit address, %u column and %u row cycles\n",
+           nand->data_bus_width, nand->addr_bus_width,
+           nand->column_addr_cycles, nand->row_addr_cycles);
+    printf("page: %" PRIu32 "+%u bytes, %" PRIu32 " pages per block, "
+           "%" PRIu32 " blocks per LUN, %u LUNs\n",
+           nand->data_bytes_per_page, nand->spare_bytes_per_page,
+           nand->pages_per_block, nand->blocks_per_lun, nand->lun_count);
+    printf("ecc: %u bits per %u bytes%s\n", nand->ecc_bits, nand->ecc_codeword_size,
+           nand->ecc_on_die ? ", on-die" : "");
+
+    return 0;
+}
+#endif
+
+#if IS_USED(MODULE_NAND_ONFI_TUNE)
+static int _cmd_tune(void)
+{
+    nand_onfi_t *nand_onfi = nand_onfi_tune_dev();
+
+    if (nand_onfi == NULL) {
+        puts("no ONFI NAND initialized");
+        return 1;
+    }
+
+    /* the search runs the bus too fast on purpose, nothing else may use it meanwhile */
+    mutex_lock(&nand_onfi->nand.lock);
+    nand_rw_response_t res = nand_onfi_tune(nand_onfi);
+    mutex_unlock(&nand_onfi->nand.lock);
+
+    printf("%s: cycle delays %u/%u, latch delays %u/%u of nominal\n",
+           (res == NAND_RW_OK) ? "tuned" : "failed, nominal kept",
+           nand_onfi->nand.timing_scale_cycle, NAND_TIMING_SCALE_NOMINAL,
+           nand_onfi->nand.timing_scale_latch, NAND_TIMING_SCALE_NOMINAL);
+
+    return (res == NAND_RW_OK) ? 0 : 1;
+}
+#endif
+
+static void _print_usage(void)
+{
+    puts("Usage:");
+    if (IS_USED(MODULE_NAND_STATS)) {
+        puts("\tnand stats: operations, time split and latency histograms");
+        puts("\tnand info: ID and geometry of the NAND");
+    }
+    if (IS_USED(MODULE_NAND_TRACE)) {
+        puts("\tnand trace: steps of the last commands, oldest first");
+    }
+    if (IS_USED(MODULE_NAND_ONFI_TUNE)) {
+        puts("\tnand tune: search the shortest bus timing again and store it");
+    }
+    puts("\tnand reset: set all counters to zero and drop the trace");
+}
+
+int _nand_handler(int argc, char **argv)
+{
+    if (argc != 2) {
+        _print_usage();
+        return 1;
+    }
+
+#if IS_USED(MODULE_NAND_STATS)
+    if (!strcmp(argv[1], "stats")) {
+        return _cmd_stats();
+    }
+
+    if (!strcmp(argv[1], "info")) {
+        return _cmd_info();
+    }
+#endif
+
+#if IS_USED(MODULE_NAND_TRACE)
+    if (!strcmp(argv[1], "trace")) {
+        nand_trace_dump();
+        return 0;
+    }
+#endif
+
+#if IS_USED(MODULE_NAND_ONFI_TUNE)
+    if (!strcmp(argv[1], "tune")) {
+        return _cmd_tune();
+    }
+#endif
+
+    if (!strcmp(argv[1], "reset")) {
+#if IS_USED(MODULE_NAND_STATS)
+        nand_stats_reset();
+#endif
+#if IS_USED(MODULE_NAND_TRACE)
+        nand_trace_reset();
+#endif
+        return 0;
+    }
+
+    _print_usage();
+    return 1;
+}
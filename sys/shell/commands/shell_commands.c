@@ -80,6 +80,10 @@ extern int _read_sector(int argc, char **argv);
 extern int _read_bytes(int argc, char **argv);
 #endif
 
+#if defined(MODULE_NAND_STATS) || defined(MODULE_NAND_TRACE) || defined(MODULE_NAND_ONFI_TUNE)
+extern int _nand_handler(int argc, char **argv);
+#endif
+
 #ifdef MODULE_GNRC_ICMPV6_ECHO
 #ifdef MODULE_XTIMER
 extern int _gnrc_icmpv6_ping(int argc, char **argv);
@@ -252,6 +256,9 @@ const shell_command_t _shell_command_list[] = {
     {DISK_GET_SECTOR_COUNT, "Get the sector count of inserted memory card", _get_sectorcount},
     {DISK_GET_BLOCK_SIZE, "Get the block size of inserted memory card", _get_blocksize},
 #endif
+#if defined(MODULE_NAND_STATS) || defined(MODULE_NAND_TRACE) || defined(MODULE_NAND_ONFI_TUNE)
+    {"nand", "NAND statistics, command trace and bus timing", _nand_handler},
+#endif
 #ifdef MODULE_GNRC_ICMPV6_ECHO
 #ifdef MODULE_XTIMER
     { "ping6", "Ping via ICMPv6", _gnrc_icmpv6_ping },
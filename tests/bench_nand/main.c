@@ -0,0 +1,348 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Throughput of the NAND stack, from bus cycles up to littlefs2
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "fs/littlefs2_fs.h"
+#include "mtd.h"
+#include "mtd_nand_onfi.h"
+#include "nand.h"
+#include "nand/onfi.h"
+#include "nand_params.h"
+#include "random.h"
+#include "vfs.h"
+#include "ztimer.h"
+
+#ifndef BENCH_KIB
+#define BENCH_KIB           (256UL)
+#endif
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS          (64UL)
+#endif
+
+#ifndef BENCH_CYCLES
+#define BENCH_CYCLES        (4096UL)
+#endif
+
+#ifndef BENCH_FIRST_BLOCK
+#define BENCH_FIRST_BLOCK   (0)
+#endif
+
+#ifndef BENCH_BLOCKS
+#define BENCH_BLOCKS        (16)
+#endif
+
+#ifndef BENCH_SEED
+#define BENCH_SEED          (0x4E414E44UL)
+#endif
+
+#define MOUNT_POINT         "/nand"
+#define FILE_NAME           MOUNT_POINT "/bench"
+
+static nand_onfi_t _nand_onfi;
+static mtd_nand_onfi_t _mtd_nand = {
+    .base = {
+        .driver = &mtd_nand_driver,
+    },
+    .nand_onfi = &_nand_onfi,
+    .params = &nand_params[0],
+};
+static littlefs2_desc_t _littlefs2 = {
+    .dev = &_mtd_nand.base,
+    .base_addr = BENCH_FIRST_BLOCK,
+    .config = {
+        .block_count = BENCH_BLOCKS,
+    },
+};
+static vfs_mount_t _mount = {
+    .fs = &littlefs2_file_system,
+    .mount_point = MOUNT_POINT,
+    .private_data = &_littlefs2,
+};
+static uint8_t *_page;
+
+/**
+ * Prints the benchmark_print_time() line and the throughput of @p bytes,
+ * one byte per us being one MB/s
+ */
+static void _report(const char *name, uint32_t usec, unsigned long ops, uint32_t bytes)
+{
+    uint32_t kb_per_sec = (uint64_t)bytes * 1000 / (usec ? usec : 1);
+
+    benchmark_print_time(usec ? usec : 1, ops, name);
+    printf("%25s: %9" PRIu32 " bytes  ---  %4" PRIu32 ".%03" PRIu32 " MB/s\n",
+           name, bytes, kb_per_sec / 1000, kb_per_sec % 1000);
+}
+
+/** Pages the mtd benchmarks move, BENCH_KIB as far as BENCH_BLOCKS hold it */
+static uint32_t _pages(void)
+{
+    mtd_dev_t *dev = &_mtd_nand.base;
+    uint32_t pages = BENCH_KIB * 1024 / dev->page_size;
+
+    if (pages > BENCH_BLOCKS * dev->pages_per_sector) {
+        pages = BENCH_BLOCKS * dev->pages_per_sector;
+    }
+
+    return pages ? pages : 1;
+}
+
+/** Cycles with CE# high, the target ignores them and only the bus is timed */
+static void _bench_bus(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+    uint8_t cycle[2] = { 0xA5, 0x5A };
+    uint32_t start;
+
+    nand_set_io_pin_write(nand);
+    start = ztimer_now(ZTIMER_USEC);
+    for (unsigned long pos = 0; pos < BENCH_CYCLES; pos++) {
+        nand_write_io(nand, cycle, nand->data_bus_width, NAND_ONFI_TIMING_IGNORE, NAND_ONFI_TIMING_WH);
+    }
+    _report("bus write cycle", ztimer_now(ZTIMER_USEC) - start, BENCH_CYCLES,
+            BENCH_CYCLES * nand->data_bus_width / 8);
+
+    nand_set_io_pin_read(nand);
+    start = ztimer_now(ZTIMER_USEC);
+    for (unsigned long pos = 0; pos < BENCH_CYCLES; pos++) {
+        nand_read_io(nand, cycle, nand->data_bus_width, NAND_ONFI_TIMING_REA, NAND_ONFI_TIMING_REH);
+    }
+    _report("bus read cycle", ztimer_now(ZTIMER_USEC) - start, BENCH_CYCLES,
+            BENCH_CYCLES * nand->data_bus_width / 8);
+
+    nand_set_pin_default(nand);
+}
+
+/** Whole pages straight through nand_onfi, no ECC and no page cache */
+static int _bench_page(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+    uint64_t row = nand_page_no_to_addr_row((uint64_t)BENCH_FIRST_BLOCK * nand->pages_per_block);
+    uint32_t start;
+
+    start = ztimer_now(ZTIMER_USEC);
+    for (unsigned long pos = 0; pos < BENCH_RUNS; pos++) {
+        if (nand_onfi_erase_block(&_nand_onfi, row) != NAND_RW_OK) {
+            return -1;
+        }
+    }
+    _report("block erase", ztimer_now(ZTIMER_USEC) - start, BENCH_RUNS,
+            BENCH_RUNS * nand->pages_per_block * nand->data_bytes_per_page);
+
+    /* one erased block takes pages_per_block programs */
+    start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t pos = 0; pos < nand->pages_per_block; pos++) {
+        if (nand_onfi_program_page(&_nand_onfi, row + pos, 0, _page, nand->data_bytes_per_page) != NAND_RW_OK) {
+            return -1;
+        }
+    }
+    _report("page program", ztimer_now(ZTIMER_USEC) - start, nand->pages_per_block,
+            nand->pages_per_block * nand->data_bytes_per_page);
+
+    start = ztimer_now(ZTIMER_USEC);
+    for (unsigned long pos = 0; pos < BENCH_RUNS; pos++) {
+        if (nand_onfi_read_page(&_nand_onfi, row + pos % nand->pages_per_block, 0, _page,
+                                nand->data_bytes_per_page) != NAND_RW_OK) {
+            return -1;
+        }
+    }
+    _report("page read", ztimer_now(ZTIMER_USEC) - start, BENCH_RUNS,
+            BENCH_RUNS * nand->data_bytes_per_page);
+
+    return 0;
+}
+
+static int _bench_mtd(void)
+{
+    mtd_dev_t *dev = &_mtd_nand.base;
+    uint32_t first_page = BENCH_FIRST_BLOCK * dev->pages_per_sector;
+    uint32_t pages = _pages();
+    uint32_t start;
+
+    if (mtd_erase_sector(dev, BENCH_FIRST_BLOCK, BENCH_BLOCKS) < 0) {
+        return -1;
+    }
+
+    start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t pos = 0; pos < pages; pos++) {
+        if (mtd_write_page_raw(dev, _page, first_page + pos, 0, dev->page_size) < 0) {
+            return -1;
+        }
+    }
+    _report("mtd sequential write", ztimer_now(ZTIMER_USEC) - start, pages, pages * dev->page_size);
+
+    start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t pos = 0; pos < pages; pos++) {
+        if (mtd_read_page(dev, _page, first_page + pos, 0, dev->page_size) < 0) {
+            return -1;
+        }
+    }
+    _report("mtd sequential read", ztimer_now(ZTIMER_USEC) - start, pages, pages * dev->page_size);
+
+    if (mtd_erase_sector(dev, BENCH_FIRST_BLOCK, BENCH_BLOCKS) < 0) {
+        return -1;
+    }
+
+    /*
+     * Blocks are written in random order, the pages of each block in order
+     * as NAND requires. The same sequence on every run, so runs compare.
+     */
+    uint32_t blocks = (pages + dev->pages_per_sector - 1) / dev->pages_per_sector;
+    uint32_t written = 0;
+    uint32_t *next = calloc(blocks, sizeof(uint32_t));
+    if (next == NULL) {
+        return -1;
+    }
+
+    random_init(BENCH_SEED);
+    start = ztimer_now(ZTIMER_USEC);
+    while (written < pages) {
+        uint32_t block = random_uint32_range(0, blocks);
+
+        /* a block already full is passed over for the next draw */
+        if (next[block] >= dev->pages_per_sector) {
+            continue;
+        }
+        if (mtd_write_page_raw(dev, _page, first_page + block * dev->pages_per_sector + next[block],
+                               0, dev->page_size) < 0) {
+            free(next);
+            return -1;
+        }
+        next[block] += 1;
+        written += 1;
+    }
+    _report("mtd random write", ztimer_now(ZTIMER_USEC) - start, pages, pages * dev->page_size);
+    free(next);
+
+    random_init(BENCH_SEED);
+    start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t pos = 0; pos < pages; pos++) {
+        if (mtd_read_page(dev, _page, first_page + random_uint32_range(0, pages), 0,
+                          dev->page_size) < 0) {
+            return -1;
+        }
+    }
+    _report("mtd random read", ztimer_now(ZTIMER_USEC) - start, pages, pages * dev->page_size);
+
+    return 0;
+}
+
+static int _bench_littlefs2(void)
+{
+    mtd_dev_t *dev = &_mtd_nand.base;
+    uint32_t pages = _pages();
+    uint32_t start;
+    int fd;
+
+    if (vfs_format(&_mount) < 0 || vfs_mount(&_mount) < 0) {
+        return -1;
+    }
+
+    start = ztimer_now(ZTIMER_USEC);
+    fd = vfs_open(FILE_NAME, O_CREAT | O_TRUNC | O_WRONLY, 0);
+    if (fd < 0) {
+        vfs_umount(&_mount);
+        return -1;
+    }
+    for (uint32_t pos = 0; pos < pages; pos++) {
+        if (vfs_write(fd, _page, dev->page_size) != (ssize_t)dev->page_size) {
+            vfs_close(fd);
+            vfs_umount(&_mount);
+            return -1;
+        }
+    }
+    vfs_close(fd);
+    _report("littlefs2 file write", ztimer_now(ZTIMER_USEC) - start, pages, pages * dev->page_size);
+
+    start = ztimer_now(ZTIMER_USEC);
+    fd = vfs_open(FILE_NAME, O_RDONLY, 0);
+    if (fd < 0) {
+        vfs_umount(&_mount);
+        return -1;
+    }
+    for (uint32_t pos = 0; pos < pages; pos++) {
+        if (vfs_read(fd, _page, dev->page_size) != (ssize_t)dev->page_size) {
+            vfs_close(fd);
+            vfs_umount(&_mount);
+            return -1;
+        }
+    }
+    vfs_close(fd);
+    _report("littlefs2 file read", ztimer_now(ZTIMER_USEC) - start, pages, pages * dev->page_size);
+
+    vfs_unlink(FILE_NAME);
+
+    return vfs_umount(&_mount);
+}
+
+int main(void)
+{
+    puts("NAND throughput benchmark");
+
+    if (mtd_init(&_mtd_nand.base) < 0) {
+        puts("[FAILED] no ONFI NAND found");
+        return 1;
+    }
+
+    if (BENCH_FIRST_BLOCK + BENCH_BLOCKS > _mtd_nand.base.sector_count) {
+        puts("[FAILED] BENCH_BLOCKS exceed the NAND");
+        return 1;
+    }
+
+    _page = malloc(nand_one_page_size((nand_t *)&_nand_onfi));
+    if (_page == NULL) {
+        puts("[FAILED] page buffer");
+        return 1;
+    }
+
+    for (size_t pos = 0; pos < _mtd_nand.base.page_size; pos++) {
+        _page[pos] = pos * 7 + 3;
+    }
+
+    _bench_bus();
+
+    if (_bench_page() < 0) {
+        puts("[FAILED] nand_onfi page");
+        return 1;
+    }
+
+    if (_bench_mtd() < 0) {
+        puts("[FAILED] mtd");
+        return 1;
+    }
+
+    if (_bench_littlefs2() < 0) {
+        puts("[FAILED] littlefs2");
+        return 1;
+    }
+
+    free(_page);
+
+    puts("[SUCCESS]");
+
+    return 0;
+}
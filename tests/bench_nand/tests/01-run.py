@@ -0,0 +1,42 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+#               2022-2023 double O Co., Ltd.
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+TIMEOUT = 600
+BENCHMARK_REGEXP = r"\s+{func}:\s+\d+us\s+---\s+\d*\.*\d+us per call\s+---\s+\d+ calls per sec"
+THROUGHPUT_REGEXP = r"\s+{func}:\s+\d+ bytes\s+---\s+\d+\.\d+ MB/s"
+
+BENCHMARKS = (
+    "bus write cycle",
+    "bus read cycle",
+    "block erase",
+    "page program",
+    "page read",
+    "mtd sequential write",
+    "mtd sequential read",
+    "mtd random write",
+    "mtd random read",
+    "littlefs2 file write",
+    "littlefs2 file read",
+)
+
+
+def testfunc(child):
+    child.expect_exact('NAND throughput benchmark')
+    for func in BENCHMARKS:
+        child.expect(BENCHMARK_REGEXP.format(func=func), timeout=TIMEOUT)
+        child.expect(THROUGHPUT_REGEXP.format(func=func), timeout=TIMEOUT)
+    child.expect_exact('[SUCCESS]')
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
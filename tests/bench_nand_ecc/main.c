@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compare ECC computed after the transfer with ECC streamed
+ *              through the raw chunk hooks
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+#include "bitarithm.h"
+#include "ecc/hamming256.h"
+#include "nand.h"
+#include "nand/ecc.h"
+#include "nand/onfi.h"
+#include "nand_params.h"
+
+#ifndef BENCH_RUNS
+#define BENCH_RUNS          (100UL)
+#endif
+
+#ifndef BENCH_BLOCK
+#define BENCH_BLOCK         (0)
+#endif
+
+static nand_onfi_t _nand_onfi;
+static nand_ecc_t _ecc;
+static uint8_t *_page;
+static uint64_t _row;
+static bool _nand_found;
+
+static void _calculate_only(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    nand_ecc_calculate(&_ecc, _page, &_page[nand->data_bytes_per_page]);
+}
+
+static void _correct_only(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    nand_ecc_correct(&_ecc, _page, &_page[nand->data_bytes_per_page], NULL);
+}
+
+static void _program_after(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    nand_onfi_erase_block(&_nand_onfi, _row);
+    nand_ecc_calculate(&_ecc, _page, &_page[nand->data_bytes_per_page]);
+    nand_onfi_program_page(&_nand_onfi, _row, 0, _page, nand_one_page_size(nand));
+}
+
+static void _program_streamed(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    nand_onfi_erase_block(&_nand_onfi, _row);
+    nand_onfi_program_page_hooked(&_nand_onfi, _row, 0, _page, nand_one_page_size(nand),
+                                  _ecc.step_size, nand_ecc_stream_program_cb, NULL, &_ecc);
+}
+
+static void _read_after(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    nand_onfi_read_page(&_nand_onfi, _row, 0, _page, nand_one_page_size(nand));
+    nand_ecc_correct(&_ecc, _page, &_page[nand->data_bytes_per_page], NULL);
+}
+
+static void _read_streamed(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    nand_onfi_read_page_hooked(&_nand_onfi, _row, 0, _page, nand_one_page_size(nand),
+                               _ecc.step_size, NULL, nand_ecc_stream_read_cb, &_ecc);
+    nand_ecc_correct_calculated(&_ecc, _page, &_page[nand->data_bytes_per_page],
+                                _ecc.calculated, NULL);
+}
+
+/**
+ * @brief   Hamming code of one 256 byte block, computed byte by byte as
+ *          ecc_hamming256 did before it went word-wise
+ */
+static void _hamming256_bytewise(const uint8_t *data, uint8_t *code)
+{
+    uint8_t column_sum = 0;
+    uint8_t even_line_code = 0;
+    uint8_t odd_line_code = 0;
+    uint8_t even_column_code = 0;
+    uint8_t odd_column_code = 0;
+
+    for (unsigned i = 0; i < 256; i++) {
+        column_sum ^= data[i];
+        if ((bitarithm_bits_set(data[i]) & 1) == 1) {
+            even_line_code ^= (255 - i);
+            odd_line_code ^= i;
+        }
+    }
+
+    for (unsigned i = 0; i < 8; i++) {
+        if (column_sum & 1) {
+            even_column_code ^= (7 - i);
+            odd_column_code ^= i;
+        }
+        column_sum >>= 1;
+    }
+
+    memset(code, 0, 3);
+    for (unsigned i = 0; i < 4; i++) {
+        code[0] <<= 2;
+        code[1] <<= 2;
+        code[2] <<= 2;
+        code[0] |= ((odd_line_code & 0x80) ? 2 : 0) | ((even_line_code & 0x80) ? 1 : 0);
+        code[1] |= ((odd_line_code & 0x08) ? 2 : 0) | ((even_line_code & 0x08) ? 1 : 0);
+        code[2] |= ((odd_column_code & 0x04) ? 2 : 0) | ((even_column_code & 0x04) ? 1 : 0);
+        odd_line_code <<= 1;
+        even_line_code <<= 1;
+        odd_column_code <<= 1;
+        even_column_code <<= 1;
+    }
+
+    code[0] = ~code[0];
+    code[1] = ~code[1];
+    code[2] = ~code[2];
+}
+
+static void _hamming_bytewise_page(uint8_t *code)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    for (size_t pos = 0; pos < nand->data_bytes_per_page; pos += 256) {
+        _hamming256_bytewise(&_page[pos], &code[pos / 256 * 3]);
+    }
+}
+
+static void _hamming_wordwise_page(uint8_t *code)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    hamming_compute256x(_page, nand->data_bytes_per_page, code);
+}
+
+static void _fill_page(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    for (size_t pos = 0; pos < nand->data_bytes_per_page; pos++) {
+        _page[pos] = pos * 7 + 3;
+    }
+    memset(&_page[nand->data_bytes_per_page], 0xFF, nand->spare_bytes_per_page);
+}
+
+static void _bench_hamming256(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+    uint8_t *code_bytewise = malloc(nand->data_bytes_per_page / 256 * 3);
+    uint8_t *code_wordwise = malloc(nand->data_bytes_per_page / 256 * 3);
+    uint32_t time_bytewise;
+    uint32_t time_wordwise;
+
+    if (code_bytewise == NULL || code_wordwise == NULL) {
+        puts("Hamming code buffers do not fit, skipped");
+        free(code_bytewise);
+        free(code_wordwise);
+        return;
+    }
+
+    _fill_page();
+
+    time_bytewise = ztimer_now(ZTIMER_USEC);
+    for (unsigned long i = 0; i < BENCH_RUNS; i++) {
+        _hamming_bytewise_page(code_bytewise);
+    }
+    time_bytewise = ztimer_now(ZTIMER_USEC) - time_bytewise;
+    benchmark_print_time(time_bytewise, BENCH_RUNS, "Hamming page codes, bytewise");
+
+    time_wordwise = ztimer_now(ZTIMER_USEC);
+    for (unsigned long i = 0; i < BENCH_RUNS; i++) {
+        _hamming_wordwise_page(code_wordwise);
+    }
+    time_wordwise = ztimer_now(ZTIMER_USEC) - time_wordwise;
+    benchmark_print_time(time_wordwise, BENCH_RUNS, "Hamming page codes, word-wise");
+
+    if (memcmp(code_bytewise, code_wordwise, nand->data_bytes_per_page / 256 * 3) != 0) {
+        puts("Hamming codes of the bytewise and word-wise routines differ");
+    }
+    else if (time_wordwise > 0) {
+        printf("Hamming word-wise speedup: %" PRIu32 ".%02" PRIu32 "x\n",
+               time_bytewise / time_wordwise,
+               (time_bytewise % time_wordwise) * 100 / time_wordwise);
+    }
+
+    free(code_bytewise);
+    free(code_wordwise);
+}
+
+static void _bench(const char *name, nand_ecc_mode_t mode)
+{
+    char label[48];
+
+    if (nand_ecc_init(&_ecc, (nand_t *)&_nand_onfi, mode) != NAND_INIT_OK) {
+        printf("%s ECC does not fit this NAND, skipped\n", name);
+        return;
+    }
+
+    printf("%s: %u codewords of %u bytes, %u parity bytes each\n", name,
+           _ecc.steps, _ecc.step_size, _ecc.bytes_per_step);
+
+    _fill_page();
+    snprintf(label, sizeof(label), "%s calculate, CPU only", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _calculate_only());
+    snprintf(label, sizeof(label), "%s correct, CPU only", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _correct_only());
+
+    if (!_nand_found) {
+        nand_ecc_deinit(&_ecc);
+        return;
+    }
+
+    snprintf(label, sizeof(label), "%s program, after transfer", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _program_after());
+    snprintf(label, sizeof(label), "%s program, streamed", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _program_streamed());
+
+    snprintf(label, sizeof(label), "%s read, after transfer", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _read_after());
+    snprintf(label, sizeof(label), "%s read, streamed", name);
+    BENCHMARK_FUNC(label, BENCH_RUNS, _read_streamed());
+
+    nand_ecc_deinit(&_ecc);
+}
+
+int main(void)
+{
+    nand_t *nand = (nand_t *)&_nand_onfi;
+
+    puts("NAND ECC streaming benchmark");
+
+    _nand_found = (nand_onfi_init(&_nand_onfi, &nand_params[0]) == NAND_INIT_OK);
+    if (!_nand_found) {
+        puts("No ONFI NAND found, assuming 2048+64 byte pages with 8 bits per 512 bytes");
+
+        nand->data_bus_width        = 8;
+        nand->addr_bus_width        = 8;
+        nand->data_bytes_per_page   = 2048;
+        nand->spare_bytes_per_page  = 64;
+        nand->pages_per_block       = 64;
+        nand->blocks_per_lun        = 1024;
+        nand->lun_count             = 1;
+        nand->column_addr_cycles    = 2;
+        nand->row_addr_cycles       = 3;
+        nand->ecc_bits              = 8;
+        nand->ecc_codeword_size     = 512;
+        nand->ecc_on_die            = false;
+    }
+
+    /* benchmark the host ECC, also on parts that do not ask for any */
+    if (nand->ecc_on_die) {
+        nand_onfi_set_on_die_ecc(&_nand_onfi, false);
+    }
+    if (nand->ecc_bits == 0 || nand->ecc_codeword_size == 0) {
+        nand->ecc_bits = 4;
+        nand->ecc_codeword_size = 512;
+    }
+
+    _page = malloc(nand_one_page_size(nand));
+    if (_page == NULL) {
+        puts("[FAILED] page buffer");
+        return 1;
+    }
+
+    _row = nand_page_no_to_addr_row((uint64_t)BENCH_BLOCK * nand->pages_per_block);
+
+    _bench("BCH", NAND_ECC_MODE_BCH);
+    _bench("Hamming", NAND_ECC_MODE_HAMMING);
+    _bench_hamming256();
+
+    free(_page);
+
+    puts("[SUCCESS]");
+
+    return 0;
+}
@@ -0,0 +1,31 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+#               2022-2023 double O Co., Ltd.
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+TIMEOUT = 120
+BENCHMARK_REGEXP = r"\s+{func}:\s+\d+us\s+---\s+\d*\.*\d+us per call\s+---\s+\d+ calls per sec"
+
+
+def testfunc(child):
+    child.expect_exact('NAND ECC streaming benchmark')
+    for mode in ("BCH", "Hamming"):
+        for op in ("program", "read"):
+            for way in ("after transfer", "streamed"):
+                child.expect(BENCHMARK_REGEXP.format(func=f"{mode} {op}, {way}"), timeout=TIMEOUT)
+    for way in ("bytewise", "word-wise"):
+        child.expect(BENCHMARK_REGEXP.format(func=f"Hamming page codes, {way}"), timeout=TIMEOUT)
+    child.expect(r"Hamming word-wise speedup: \d+\.\d+x")
+    child.expect_exact('[SUCCESS]')
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
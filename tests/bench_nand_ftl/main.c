@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @ingroup     tests
+ * @{
+ *
+ * @file
+ * @brief       Compare 512 byte sector writes through the FTL with raw page
+ *              programs
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ *
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mtd.h"
+#include "mtd_nand_onfi.h"
+#include "mtd_nand_ftl.h"
+#include "nand.h"
+#include "nand/bbt.h"
+#include "nand_params.h"
+#include "thread.h"
+#include "ztimer.h"
+
+#ifndef BENCH_KIB
+#define BENCH_KIB           (256UL)
+#endif
+
+#ifndef BENCH_FIRST_BLOCK
+#define BENCH_FIRST_BLOCK   (0)
+#endif
+
+#ifndef BENCH_BLOCKS
+#define BENCH_BLOCKS        (64)
+#endif
+
+#ifndef BENCH_MOUNT_BLOCKS
+#define BENCH_MOUNT_BLOCKS  (256)   /**< behind the benchmarked blocks, 0 for the rest of the NAND */
+#endif
+
+#ifndef BENCH_IDLE_USEC
+#define BENCH_IDLE_USEC     (10000UL)
+#endif
+
+#define SECTOR_SIZE         (MTD_NAND_FTL_SECTOR_SIZE)
+#define CLUSTER_SECTORS     (8)
+#define FAT_SECTOR          (1)
+#define DIR_SECTOR          (64)
+#define DATA_SECTOR         (128)
+
+static nand_onfi_t _nand_onfi;
+static mtd_nand_onfi_t _mtd_nand = {
+    .base = {
+        .driver = &mtd_nand_driver,
+    },
+    .nand_onfi = &_nand_onfi,
+    .params = &nand_params[0],
+};
+static mtd_nand_ftl_t _ftl = {
+    .base = {
+        .driver = &mtd_nand_ftl_driver,
+    },
+    .parent = &_mtd_nand,
+    .first_block = BENCH_FIRST_BLOCK,
+    .block_count = BENCH_BLOCKS,
+};
+static mtd_nand_ftl_t _ftl_mount = {
+    .base = {
+        .driver = &mtd_nand_ftl_driver,
+    },
+    .parent = &_mtd_nand,
+    .first_block = BENCH_FIRST_BLOCK + BENCH_BLOCKS,
+    .block_count = BENCH_MOUNT_BLOCKS,
+};
+static uint8_t _cluster[CLUSTER_SECTORS * SECTOR_SIZE];
+static char _eraser_stack[THREAD_STACKSIZE_DEFAULT];
+static uint32_t _raw_kib_per_sec;
+
+static uint32_t _kib_per_sec(uint32_t bytes, uint32_t usec)
+{
+    return ((uint64_t)bytes * 1000000UL / 1024) / (usec ? usec : 1);
+}
+
+static void _report(const char *name, uint32_t bytes, uint32_t usec)
+{
+    uint32_t kib_per_sec = _kib_per_sec(bytes, usec);
+
+    printf("%s: %lu KiB/s, %lu%% of raw\n", name, (unsigned long)kib_per_sec,
+           (unsigned long)(_raw_kib_per_sec ? kib_per_sec * 100 / _raw_kib_per_sec : 0));
+}
+
+/* factory bad blocks fail every erase, they are left to the FTL */
+static int _erase_good_blocks(void)
+{
+    mtd_dev_t *dev = &_mtd_nand.base;
+
+    for (uint32_t block = BENCH_FIRST_BLOCK; block < BENCH_FIRST_BLOCK + BENCH_BLOCKS; block++) {
+        if (!nand_bbt_is_bad(&_mtd_nand.bbt, block) && mtd_erase_sector(dev, block, 1) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int _bench_raw(uint8_t *page)
+{
+    mtd_dev_t *dev = &_mtd_nand.base;
+    uint32_t pages = BENCH_KIB * 1024 / dev->page_size;
+    uint32_t written = 0;
+
+    if (_erase_good_blocks() < 0) {
+        return -1;
+    }
+
+    uint32_t start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t block = BENCH_FIRST_BLOCK;
+         block < BENCH_FIRST_BLOCK + BENCH_BLOCKS && written < pages; block++) {
+        if (nand_bbt_is_bad(&_mtd_nand.bbt, block)) {
+            continue;
+        }
+
+        for (uint32_t pos = 0; pos < dev->pages_per_sector && written < pages; pos++, written++) {
+            if (mtd_write_page_raw(dev, page, block * dev->pages_per_sector + pos, 0,
+                                   dev->page_size) < 0) {
+                return -1;
+            }
+        }
+    }
+    uint32_t usec = ztimer_now(ZTIMER_USEC) - start;
+
+    _raw_kib_per_sec = _kib_per_sec(written * dev->page_size, usec);
+    printf("raw page program: %lu KiB/s\n", (unsigned long)_raw_kib_per_sec);
+
+    /* the FTL starts out on erased blocks */
+    return _erase_good_blocks();
+}
+
+static int _bench_sectors(void)
+{
+    mtd_dev_t *dev = &_ftl.base;
+    uint32_t sectors = BENCH_KIB * 1024 / SECTOR_SIZE;
+
+    uint32_t start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t pos = 0; pos < sectors; pos++) {
+        uint32_t sector = DATA_SECTOR + pos % (dev->sector_count - DATA_SECTOR);
+
+        if (mtd_write_page_raw(dev, _cluster, sector, 0, SECTOR_SIZE) < 0) {
+            return -1;
+        }
+    }
+    _report("sector by sector", sectors * SECTOR_SIZE, ztimer_now(ZTIMER_USEC) - start);
+
+    return 0;
+}
+
+static int _bench_clusters(bool fat)
+{
+    mtd_dev_t *dev = &_ftl.base;
+    uint32_t clusters = BENCH_KIB * 1024 / sizeof(_cluster);
+    uint32_t data_clusters = (dev->sector_count - DATA_SECTOR) / CLUSTER_SECTORS;
+
+    uint32_t start = ztimer_now(ZTIMER_USEC);
+    for (uint32_t pos = 0; pos < clusters; pos++) {
+        uint32_t sector = DATA_SECTOR + (pos % data_clusters) * CLUSTER_SECTORS;
+
+        if (mtd_write_page_raw(dev, _cluster, sector, 0, sizeof(_cluster)) < 0) {
+            return -1;
+        }
+        if (!fat) {
+            continue;
+        }
+        /* cluster chain and file size get updated after every cluster */
+        if (mtd_write_page_raw(dev, _cluster, FAT_SECTOR, 0, SECTOR_SIZE) < 0 ||
+            mtd_write_page_raw(dev, _cluster, DIR_SECTOR, 0, SECTOR_SIZE) < 0) {
+            return -1;
+        }
+    }
+    _report(fat ? "FAT pattern" : "4 KiB clusters", clusters * sizeof(_cluster),
+            ztimer_now(ZTIMER_USEC) - start);
+
+    return 0;
+}
+
+static int _bench_latency(const char *name, bool idle)
+{
+    mtd_dev_t *dev = &_ftl.base;
+    uint32_t clusters = BENCH_KIB * 1024 / sizeof(_cluster);
+    uint32_t data_clusters = (dev->sector_count - DATA_SECTOR) / CLUSTER_SECTORS;
+    uint32_t max_usec = 0;
+
+    for (uint32_t pos = 0; pos < clusters; pos++) {
+        uint32_t sector = DATA_SECTOR + (pos % data_clusters) * CLUSTER_SECTORS;
+
+        uint32_t start = ztimer_now(ZTIMER_USEC);
+        if (mtd_write_page_raw(dev, _cluster, sector, 0, sizeof(_cluster)) < 0) {
+            return -1;
+        }
+        uint32_t usec = ztimer_now(ZTIMER_USEC) - start;
+
+        if (usec > max_usec) {
+            max_usec = usec;
+        }
+        /* lets the eraser run, as an application waiting for its next data */
+        if (idle) {
+            ztimer_sleep(ZTIMER_USEC, BENCH_IDLE_USEC);
+        }
+    }
+    printf("%s: max %lu us per 4 KiB cluster\n", name, (unsigned long)max_usec);
+
+    return 0;
+}
+
+static int _bench_mount(const char *name)
+{
+    uint32_t start = ztimer_now(ZTIMER_USEC);
+    if (mtd_init(&_ftl.base) < 0) {
+        return -1;
+    }
+    uint32_t usec = ztimer_now(ZTIMER_USEC) - start;
+
+    printf("%s: %lu us for %lu blocks\n", name, (unsigned long)usec, (unsigned long)_ftl.block_count);
+
+    return 0;
+}
+
+static int _timed_init(mtd_nand_ftl_t *ftl, uint32_t *usec)
+{
+    uint32_t start = ztimer_now(ZTIMER_USEC);
+    if (mtd_init(&ftl->base) < 0) {
+        return -1;
+    }
+    *usec = ztimer_now(ZTIMER_USEC) - start;
+
+    return 0;
+}
+
+/* mounting from a checkpoint against scanning every block, on a large range */
+static int _bench_mount_scaling(void)
+{
+    mtd_dev_t *parent = &_mtd_nand.base;
+    mtd_dev_t *dev = &_ftl_mount.base;
+    uint32_t checkpoint_usec;
+    uint32_t scan_usec;
+
+    /* the first init finds no checkpoint, scans and writes one */
+    if (mtd_init(dev) < 0) {
+        puts("mount scaling: FTL does not fit into RAM, skipped");
+        return 0;
+    }
+
+    uint32_t clusters = BENCH_KIB * 1024 / sizeof(_cluster);
+    uint32_t stride = (dev->sector_count / CLUSTER_SECTORS) / clusters;
+    for (uint32_t pos = 0; pos < clusters; pos++) {
+        if (mtd_write_page_raw(dev, _cluster, pos * (stride ? stride : 1) * CLUSTER_SECTORS, 0,
+                               sizeof(_cluster)) < 0) {
+            return -1;
+        }
+    }
+
+    if (mtd_nand_ftl_checkpoint(&_ftl_mount) < 0 || _timed_init(&_ftl_mount, &checkpoint_usec) < 0) {
+        return -1;
+    }
+
+    /* without a checkpoint, init reads the spare bytes of all blocks and writes a new one */
+    for (uint32_t block = _ftl_mount.first_block;
+         block < _ftl_mount.first_block + _ftl_mount.checkpoint_blocks; block++) {
+        if (!nand_bbt_is_bad(&_mtd_nand.bbt, block) && mtd_erase_sector(parent, block, 1) < 0) {
+            return -1;
+        }
+    }
+    if (_timed_init(&_ftl_mount, &scan_usec) < 0) {
+        return -1;
+    }
+
+    printf("mount scaling: %lu blocks, %lu MiB\n", (unsigned long)_ftl_mount.block_count,
+           (unsigned long)((uint64_t)_ftl_mount.block_count * parent->pages_per_sector *
+                           parent->page_size / (1024 * 1024)));
+    printf("mount from checkpoint: %lu us\n", (unsigned long)checkpoint_usec);
+    uint32_t ratio = (uint64_t)scan_usec * 100 / (checkpoint_usec ? checkpoint_usec : 1);
+    printf("mount by full scan: %lu us, %lu.%02lux the checkpoint\n", (unsigned long)scan_usec,
+           (unsigned long)(ratio / 100), (unsigned long)(ratio % 100));
+
+    return 0;
+}
+
+int main(void)
+{
+    puts("NAND FTL sector write benchmark");
+
+    if (mtd_init(&_mtd_nand.base) < 0) {
+        puts("[FAILED] no ONFI NAND found");
+        return 1;
+    }
+
+    if (BENCH_FIRST_BLOCK + BENCH_BLOCKS + BENCH_MOUNT_BLOCKS > _mtd_nand.base.sector_count) {
+        puts("[FAILED] BENCH_BLOCKS and BENCH_MOUNT_BLOCKS exceed the NAND");
+        return 1;
+    }
+
+    uint8_t *page = malloc(_mtd_nand.base.page_size);
+    if (page == NULL) {
+        puts("[FAILED] page buffer");
+        return 1;
+    }
+
+    for (size_t pos = 0; pos < _mtd_nand.base.page_size; pos++) {
+        page[pos] = pos * 7 + 3;
+    }
+    memcpy(_cluster, page, sizeof(_cluster) < _mtd_nand.base.page_size
+                           ? sizeof(_cluster) : _mtd_nand.base.page_size);
+
+    int res = _bench_raw(page);
+    free(page);
+    if (res < 0) {
+        puts("[FAILED] raw page program");
+        return 1;
+    }
+
+    if (mtd_init(&_ftl.base) < 0 || _ftl.base.sector_count <= DATA_SECTOR + CLUSTER_SECTORS) {
+        puts("[FAILED] FTL init");
+        return 1;
+    }
+
+    if (_bench_sectors() < 0 || _bench_clusters(false) < 0 || _bench_clusters(true) < 0) {
+        puts("[FAILED] FTL write");
+        return 1;
+    }
+
+    /* the same idle time without the eraser, then with blocks erased in it */
+    if (_bench_latency("write latency", true) < 0 ||
+        mtd_nand_ftl_eraser_start(&_ftl, _eraser_stack, sizeof(_eraser_stack),
+                                  THREAD_PRIORITY_MAIN + 1) < 0 ||
+        _bench_latency("write latency, erased ahead", true) < 0) {
+        puts("[FAILED] FTL write latency");
+        return 1;
+    }
+
+    /* the last checkpoint plus the pool blocks written since are read */
+    if (_bench_mount("mount") < 0 || mtd_nand_ftl_checkpoint(&_ftl) < 0 ||
+        _bench_mount("mount after checkpoint") < 0) {
+        puts("[FAILED] FTL mount");
+        return 1;
+    }
+
+    if (_bench_mount_scaling() < 0) {
+        puts("[FAILED] FTL mount scaling");
+        return 1;
+    }
+
+    puts("[SUCCESS]");
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+#               2022-2023 double O Co., Ltd.
+#
+# This file is subject to the terms and conditions of the GNU Lesser
+# General Public License v2.1. See the file LICENSE in the top level
+# directory for more details.
+
+import sys
+from testrunner import run
+
+
+TIMEOUT = 600
+THROUGHPUT_REGEXP = r"{name}:\s+\d+ KiB/s,\s+\d+% of raw"
+
+
+def testfunc(child):
+    child.expect_exact('NAND FTL sector write benchmark')
+    child.expect(r"raw page program:\s+\d+ KiB/s", timeout=TIMEOUT)
+    for name in ("sector by sector", "4 KiB clusters", "FAT pattern"):
+        child.expect(THROUGHPUT_REGEXP.format(name=name), timeout=TIMEOUT)
+    for name in ("write latency", "write latency, erased ahead"):
+        child.expect(r"{name}:\s+max \d+ us per 4 KiB cluster".format(name=name), timeout=TIMEOUT)
+    for name in ("mount", "mount after checkpoint"):
+        child.expect(r"{name}:\s+\d+ us for \d+ blocks".format(name=name), timeout=TIMEOUT)
+    if child.expect([r"mount scaling:\s+\d+ blocks,\s+\d+ MiB", r"mount scaling: .*skipped"],
+                    timeout=TIMEOUT) == 0:
+        child.expect(r"mount from checkpoint:\s+\d+ us", timeout=TIMEOUT)
+        child.expect(r"mount by full scan:\s+\d+ us,\s+\d+\.\d+x the checkpoint", timeout=TIMEOUT)
+    child.expect_exact('[SUCCESS]')
+
+
+if __name__ == "__main__":
+    sys.exit(run(testfunc))
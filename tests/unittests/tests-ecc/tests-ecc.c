@@ -19,6 +19,8 @@
 #include <string.h>
 #include "embUnit.h"
 
+#include "bitarithm.h"
+
 #include "ecc/hamming256.h"
 #include "ecc/golay2412.h"
 #include "ecc/repetition.h"
@@ -98,6 +100,90 @@ static void test_hamming256_padding(void)
     TEST_ASSERT_EQUAL_INT(Hamming_ERROR_ECC, result);
 }
 
+/* byte-at-a-time hamming code, as computed before the word-wise rewrite */
+static void hamming256_reference(const uint8_t *data, uint32_t size, uint8_t *code)
+{
+    uint8_t columnSum = 0;
+    uint8_t evenLineCode = 0;
+    uint8_t oddLineCode = 0;
+    uint8_t evenColumnCode = 0;
+    uint8_t oddColumnCode = 0;
+
+    for (uint32_t i = 0; i < 256; i++) {
+        uint8_t current = (i < size) ? data[i] : 0;
+
+        columnSum ^= current;
+        if ((bitarithm_bits_set(current) & 1) == 1) {
+            evenLineCode ^= (255 - i);
+            oddLineCode ^= i;
+        }
+    }
+
+    for (unsigned i = 0; i < 8; i++) {
+        if (columnSum & 1) {
+            evenColumnCode ^= (7 - i);
+            oddColumnCode ^= i;
+        }
+        columnSum >>= 1;
+    }
+
+    memset(code, 0, 3);
+    for (unsigned i = 0; i < 4; i++) {
+        code[0] <<= 2;
+        code[1] <<= 2;
+        code[2] <<= 2;
+        code[0] |= ((oddLineCode & 0x80) ? 2 : 0) | ((evenLineCode & 0x80) ? 1 : 0);
+        code[1] |= ((oddLineCode & 0x08) ? 2 : 0) | ((evenLineCode & 0x08) ? 1 : 0);
+        code[2] |= ((oddColumnCode & 0x04) ? 2 : 0) | ((evenColumnCode & 0x04) ? 1 : 0);
+        oddLineCode <<= 1;
+        evenLineCode <<= 1;
+        oddColumnCode <<= 1;
+        evenColumnCode <<= 1;
+    }
+
+    code[0] = ~code[0];
+    code[1] = ~code[1];
+    code[2] = ~code[2];
+}
+
+static void test_hamming256_reference(void)
+{
+    /* one spare byte in front to also cover unaligned buffers */
+    static uint8_t data[1 + 512];
+    uint8_t ecc[6];
+    uint8_t expected[6];
+    uint32_t seed = 0x2545F491;
+
+    for (unsigned round = 0; round < 8; round++) {
+        for (unsigned i = 0; i < sizeof(data); i++) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = seed >> 16;
+        }
+        if (round == 0) {
+            memset(data, 0xFF, sizeof(data));
+        }
+
+        for (unsigned offset = 0; offset < 2; offset++) {
+            static const uint32_t sizes[] = { 1, 3, 4, 5, 203, 255, 256, 257, 300, 512 };
+
+            for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+                const uint8_t *block = &data[offset];
+                uint32_t size = sizes[i];
+
+                memset(ecc, 0, sizeof(ecc));
+                memset(expected, 0, sizeof(expected));
+                hamming256_reference(block, size, expected);
+                if (size > 256) {
+                    hamming256_reference(&block[256], size - 256, &expected[3]);
+                }
+
+                hamming_compute256x(block, size, ecc);
+                TEST_ASSERT_EQUAL_INT(0, memcmp(expected, ecc, sizeof(ecc)));
+            }
+        }
+    }
+}
+
 static void test_golay2412_message_encode(void)
 {
     unsigned char encoded[2 * sizeof(data_in)];
@@ -185,6 +271,7 @@ TestRef test_all(void)
     EMB_UNIT_TESTFIXTURES(fixtures) {
         new_TestFixture(test_hamming256_single),
         new_TestFixture(test_hamming256_padding),
+        new_TestFixture(test_hamming256_reference),
         new_TestFixture(test_golay2412_message_encode),
         new_TestFixture(test_golay2412_message_noerr),
         new_TestFixture(test_golay2412_message_decode_success),
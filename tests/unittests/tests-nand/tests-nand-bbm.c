@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_BBM)
+#include "mtd_nand_bbm.h"
+#include "nand/bbt.h"
+#include "nand_sim.h"
+
+#define TEST_BLOCK      (24)    /**< logical, the one after it is used too */
+
+static mtd_nand_bbm_t _bbm = {
+    .base = {
+        .driver = &mtd_nand_bbm_driver,
+    },
+};
+static nand_bbt_t _bbt;
+static uint8_t _page[2048 + 64];
+static uint8_t _read[2048];
+
+static void set_up(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+
+    TEST_ASSERT_NOT_NULL(mtd_nand);
+    if (_bbm.parent == NULL) {
+        _bbm.parent = mtd_nand;
+        TEST_ASSERT_EQUAL_INT(0, mtd_init(&_bbm.base));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(&_bbm.base, TEST_BLOCK, 2));
+}
+
+static void tear_down(void)
+{
+    nand_bbt_deinit(&_bbt);
+}
+
+static void test_bbm_remap_worn(void)
+{
+    mtd_dev_t *dev = &_bbm.base;
+    nand_bbt_t *bbt = &_bbm.parent->bbt;
+    const uint32_t page = TEST_BLOCK * dev->pages_per_sector;
+    const uint32_t physical = _bbm.map[TEST_BLOCK];
+
+    memset(_page, 0x11, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _page, page, 0, dev->page_size));
+
+    /* the program of the next page fails, the first one moves along */
+    nand_sim_set_worn_block(0, physical);
+    memset(_page, 0x22, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _page, page + 1, 0, dev->page_size));
+
+    TEST_ASSERT(_bbm.map[TEST_BLOCK] != physical);
+    TEST_ASSERT(nand_bbt_is_bad(bbt, physical));
+    TEST_ASSERT_EQUAL_INT(_bbm.map[TEST_BLOCK], nand_bbt_replacement(bbt, TEST_BLOCK));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, page, 0, dev->page_size));
+    memset(_page, 0x11, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _read, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, page + 1, 0, dev->page_size));
+    memset(_page, 0x22, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _read, dev->page_size));
+
+    /* the replacement survives a reload of the table */
+    TEST_ASSERT_EQUAL_INT(NAND_INIT_OK, nand_bbt_init(&_bbt, _bbm.parent->nand_onfi));
+    TEST_ASSERT_EQUAL_INT(_bbm.map[TEST_BLOCK], nand_bbt_replacement(&_bbt, TEST_BLOCK));
+}
+
+static void test_bbm_remap_unreadable(void)
+{
+    mtd_dev_t *dev = &_bbm.base;
+    nand_t *nand = (nand_t *)_bbm.parent->nand_onfi;
+    const uint32_t page = (TEST_BLOCK + 1) * dev->pages_per_sector;
+    const uint32_t physical = _bbm.map[TEST_BLOCK + 1];
+
+    /* data under a parity of zeros does not decode */
+    memset(_page, 0x5A, nand->data_bytes_per_page);
+    memset(&_page[nand->data_bytes_per_page], 0x00, nand->spare_bytes_per_page);
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_onfi_program_page(_bbm.parent->nand_onfi,
+                          nand_page_no_to_addr_row((uint64_t)physical * dev->pages_per_sector),
+                          nand_offset_to_addr_column(0), _page, nand_one_page_size(nand)));
+
+    nand_sim_set_worn_block(0, physical);
+    memset(_page, 0x33, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(-EBADMSG, mtd_write_page_raw(dev, _page, page + 1, 0, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(physical, _bbm.map[TEST_BLOCK + 1]);
+}
+
+Test *tests_nand_bbm_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_bbm_remap_worn),
+        new_TestFixture(test_bbm_remap_unreadable),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_bbm_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&nand_bbm_tests;
+}
+#endif
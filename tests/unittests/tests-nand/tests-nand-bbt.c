@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM)
+#include "bitarithm.h"
+#include "checksum/crc16_ccitt.h"
+#include "nand/bbt.h"
+
+#define TEST_BLOCK      (16)
+
+static nand_bbt_t _bbt;
+static uint8_t _page[2048];
+
+static void set_up(void)
+{
+    TEST_ASSERT_NOT_NULL(tests_nand_dev());
+}
+
+static void tear_down(void)
+{
+    nand_bbt_deinit(&_bbt);
+}
+
+static void test_bbt_store_load(void)
+{
+    nand_bbt_t *bbt = &tests_nand_dev()->bbt;
+
+    nand_bbt_set(bbt, TEST_BLOCK, NAND_BBT_WORN);
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_bbt_store(bbt));
+    TEST_ASSERT_EQUAL_INT(NAND_BBT_COPIES, bitarithm_bits_set(bbt->current_copies));
+
+    /* a second table on the same NAND loads what the first one stored */
+    TEST_ASSERT_EQUAL_INT(NAND_INIT_OK, nand_bbt_init(&_bbt, bbt->nand_onfi));
+    TEST_ASSERT_EQUAL_INT(bbt->version, _bbt.version);
+    TEST_ASSERT_EQUAL_INT(bbt->current_copies, _bbt.current_copies);
+    TEST_ASSERT_EQUAL_INT(NAND_BBT_WORN, nand_bbt_get(&_bbt, TEST_BLOCK));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(bbt->bitmap, _bbt.bitmap, nand_bbt_bitmap_size(bbt->blocks)));
+
+    nand_bbt_set(bbt, TEST_BLOCK, NAND_BBT_GOOD);
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_bbt_store(bbt));
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_bbt_load(&_bbt));
+    TEST_ASSERT_EQUAL_INT(bbt->version, _bbt.version);
+    TEST_ASSERT_EQUAL_INT(NAND_BBT_GOOD, nand_bbt_get(&_bbt, TEST_BLOCK));
+}
+
+static void test_bbt_old_layout(void)
+{
+    nand_bbt_t *bbt = &tests_nand_dev()->bbt;
+    nand_t *nand = (nand_t *)bbt->nand_onfi;
+    const size_t bitmap_size = nand_bbt_bitmap_size(bbt->blocks);
+    const uint32_t version = bbt->version + 1;
+    uint16_t crc;
+
+    TEST_ASSERT_EQUAL_INT(NAND_INIT_OK, nand_bbt_init(&_bbt, bbt->nand_onfi));
+
+    for (uint8_t slot = 0; slot < CONFIG_NAND_BBT_BLOCKS; slot++) {
+        const uint64_t block_no = bbt->first_reserved + slot;
+
+        TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_onfi_erase_block(bbt->nand_onfi,
+                              nand_page_no_to_addr_row(block_no * nand->pages_per_block)));
+    }
+
+    /* a valid table of the layout before the replacements: magic, version,
+     * blocks and CRC, followed by the bitmap */
+    memset(_page, 0xFF, sizeof(_page));
+    memcpy(&_page[0], "NBBT", 4);
+    memcpy(&_page[4], &version, sizeof(version));
+    memcpy(&_page[8], &bbt->blocks, sizeof(bbt->blocks));
+    memcpy(&_page[14], bbt->bitmap, bitmap_size);
+    crc = crc16_ccitt_update(crc16_ccitt_calc(_page, 12), &_page[14], bitmap_size);
+    memcpy(&_page[12], &crc, sizeof(crc));
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_onfi_program_page(bbt->nand_onfi,
+                          nand_page_no_to_addr_row((uint64_t)bbt->first_reserved * nand->pages_per_block),
+                          nand_offset_to_addr_column(0), _page, nand->data_bytes_per_page));
+
+    TEST_ASSERT_EQUAL_INT(NAND_RW_NOT_FOUND, nand_bbt_load(&_bbt));
+
+    /* put the table of the device back */
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_bbt_store(bbt));
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_bbt_load(&_bbt));
+    TEST_ASSERT_EQUAL_INT(bbt->version, _bbt.version);
+}
+
+Test *tests_nand_bbt_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_bbt_store_load),
+        new_TestFixture(test_bbt_old_layout),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_bbt_tests, set_up, tear_down, fixtures);
+
+    return (Test *)&nand_bbt_tests;
+}
+#endif
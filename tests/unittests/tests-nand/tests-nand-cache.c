@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_ONFI_CACHE)
+#include "nand_sim.h"
+
+#define TEST_BLOCK      (32)
+#define TEST_STRIDE     (2)     /**< apart by more than one page, nothing is read ahead */
+
+static uint8_t _page[2048];
+static uint8_t _read[2048];
+
+static uint32_t _page_no(unsigned pos)
+{
+    return TEST_BLOCK * tests_nand_dev()->base.pages_per_sector + pos * TEST_STRIDE;
+}
+
+static void set_up(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+
+    TEST_ASSERT_NOT_NULL(mtd_nand);
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(&mtd_nand->base, TEST_BLOCK, 1));
+    /* a block still erased is not erased again, pages of the last test stay cached */
+    mtd_nand_onfi_cache_invalidate(mtd_nand, TEST_BLOCK);
+    nand_sim_stats_reset();
+}
+
+static void test_cache_hit(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+    mtd_dev_t *dev = &mtd_nand->base;
+    const uint32_t hits = mtd_nand->cache.hits;
+
+    memset(_page, 0x5A, dev->page_size);
+    _page[100] = 0x11;
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _page, _page_no(0), 0, dev->page_size));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, 16));
+    TEST_ASSERT_EQUAL_INT(1, nand_sim_stats()->page_reads);
+
+    /* another part of the page comes from the cache */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 100, 16));
+    TEST_ASSERT_EQUAL_INT(1, nand_sim_stats()->page_reads);
+    TEST_ASSERT_EQUAL_INT(hits + 1, mtd_nand->cache.hits);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&_page[100], _read, 16));
+}
+
+static void test_cache_miss(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+    mtd_dev_t *dev = &mtd_nand->base;
+    const uint32_t misses = mtd_nand->cache.misses;
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(1), 0, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(misses + 2, mtd_nand->cache.misses);
+    TEST_ASSERT_EQUAL_INT(2, nand_sim_stats()->page_reads);
+}
+
+static void test_cache_eviction(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+
+    /* one more page than the cache holds, the first one is replaced */
+    for (unsigned pos = 0; pos <= CONFIG_MTD_NAND_ONFI_CACHE_PAGES; pos++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(pos), 0, 16));
+    }
+    TEST_ASSERT_EQUAL_INT(CONFIG_MTD_NAND_ONFI_CACHE_PAGES + 1, nand_sim_stats()->page_reads);
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(CONFIG_MTD_NAND_ONFI_CACHE_PAGES),
+                                           0, 16));
+    TEST_ASSERT_EQUAL_INT(CONFIG_MTD_NAND_ONFI_CACHE_PAGES + 1, nand_sim_stats()->page_reads);
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, 16));
+    TEST_ASSERT_EQUAL_INT(CONFIG_MTD_NAND_ONFI_CACHE_PAGES + 2, nand_sim_stats()->page_reads);
+}
+
+static void test_cache_invalidate_write(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+
+    /* the erased page is cached, the program has to drop it */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, dev->page_size));
+    memset(_page, 0x3C, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _page, _page_no(0), 0, dev->page_size));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _read, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(2, nand_sim_stats()->page_reads);
+}
+
+static void test_cache_invalidate_erase(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+
+    memset(_page, 0x3C, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _page, _page_no(0), 0, dev->page_size));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, dev->page_size));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(dev, TEST_BLOCK, 1));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, _page_no(0), 0, dev->page_size));
+    memset(_page, 0xFF, dev->page_size);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _read, dev->page_size));
+}
+
+Test *tests_nand_cache_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_cache_hit),
+        new_TestFixture(test_cache_miss),
+        new_TestFixture(test_cache_eviction),
+        new_TestFixture(test_cache_invalidate_write),
+        new_TestFixture(test_cache_invalidate_erase),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_cache_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nand_cache_tests;
+}
+#endif
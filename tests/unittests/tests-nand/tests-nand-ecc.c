@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_ECC)
+#include "nand/ecc.h"
+#include "nand/ecc/bch.h"
+
+static void _bch_fill(uint8_t *data, size_t size, uint32_t seed)
+{
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed >> 16;
+    }
+}
+
+/* flips `count` bits spread over data and parity, the last one in the parity */
+static void _bch_flip(const nand_ecc_bch_t *bch, uint8_t *data, uint8_t *ecc,
+                      unsigned count)
+{
+    const uint32_t data_bits = bch->data_size * 8UL;
+
+    for (unsigned i = 0; i + 1 < count; i++) {
+        const uint32_t bit = (i * 1031UL + 7) % data_bits;
+        data[bit / 8] ^= 0x80 >> (bit % 8);
+    }
+    ecc[0] ^= 0x01;
+}
+
+static void _bch_roundtrip(uint16_t data_size, uint8_t strength)
+{
+    static uint8_t data[1024];
+    static uint8_t ref[1024];
+    uint8_t ecc[(CONFIG_NAND_ECC_BCH_MAX_STRENGTH * NAND_ECC_BCH_MAX_M + 7) / 8];
+    nand_ecc_bch_t bch;
+
+    TEST_ASSERT_EQUAL_INT(0, nand_ecc_bch_init(&bch, data_size, strength));
+
+    _bch_fill(ref, data_size, 0x2545F491 + strength);
+    nand_ecc_bch_encode(&bch, ref, ecc);
+
+    /* clean codeword */
+    memcpy(data, ref, data_size);
+    TEST_ASSERT_EQUAL_INT(0, nand_ecc_bch_decode(&bch, data, ecc));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(ref, data, data_size));
+
+    /* exactly t bitflips are corrected, parity flips are counted but
+     * leave the data alone */
+    memcpy(data, ref, data_size);
+    _bch_flip(&bch, data, ecc, strength);
+    TEST_ASSERT_EQUAL_INT(strength, nand_ecc_bch_decode(&bch, data, ecc));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(ref, data, data_size));
+    ecc[0] ^= 0x01;
+
+    /* beyond t a BCH code may miscorrect, but it never restores the data */
+    memcpy(data, ref, data_size);
+    _bch_flip(&bch, data, ecc, strength + 1);
+    const int res = nand_ecc_bch_decode(&bch, data, ecc);
+    TEST_ASSERT(res < 0 || memcmp(ref, data, data_size) != 0);
+
+    nand_ecc_bch_deinit(&bch);
+}
+
+static void test_bch_t1(void)
+{
+    _bch_roundtrip(512, 1);
+}
+
+static void test_bch_t4(void)
+{
+    _bch_roundtrip(512, 4);
+}
+
+static void test_bch_t8(void)
+{
+    _bch_roundtrip(512, 8);
+}
+
+static void test_bch_t24_1k(void)
+{
+    _bch_roundtrip(1024, 24);
+}
+
+static void _ecc_erased_page(nand_ecc_t *ecc, uint8_t *page)
+{
+    static nand_t nand;
+
+    nand.data_bytes_per_page    = 2048;
+    nand.spare_bytes_per_page   = 64;
+    nand.ecc_bits               = 4;
+    nand.ecc_codeword_size      = 512;
+
+    TEST_ASSERT_EQUAL_INT(NAND_INIT_OK, nand_ecc_init(ecc, &nand, NAND_ECC_MODE_BCH));
+    memset(page, 0xFF, 2048 + 64);
+}
+
+static void test_nand_ecc_erased(void)
+{
+    static uint8_t page[2048 + 64];
+    static uint8_t ref[2048];
+    static nand_ecc_t ecc;
+    uint8_t *parity;
+    size_t corrected;
+
+    _ecc_erased_page(&ecc, page);
+    memset(ref, 0xFF, sizeof(ref));
+    parity = &page[2048 + ecc.spare_offset];
+
+    /* up to `strength` zero bits per codeword, data and parity together */
+    page[3] = 0xFE;
+    page[512 + 100] = 0xF3;
+    parity[ecc.bytes_per_step] = 0xFD;
+    page[1536] = 0x7E;
+    page[2047] = 0xEF;
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_ecc_correct(&ecc, page, &page[2048], &corrected));
+    TEST_ASSERT_EQUAL_INT(7, corrected);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(ref, page, 2048));
+
+    /* the limit holds per codeword, not per page */
+    memset(page, 0xFF, sizeof(page));
+    page[0] = 0x07;
+    page[600] = 0xFE;
+    TEST_ASSERT_EQUAL_INT(NAND_RW_ECC_MISMATCH, nand_ecc_correct(&ecc, page, &page[2048], NULL));
+    TEST_ASSERT_EQUAL_INT(0x07, page[0]);
+    TEST_ASSERT_EQUAL_INT(0xFF, page[600]);
+
+    nand_ecc_deinit(&ecc);
+}
+
+Test *tests_nand_ecc_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_bch_t1),
+        new_TestFixture(test_bch_t4),
+        new_TestFixture(test_bch_t8),
+        new_TestFixture(test_bch_t24_1k),
+        new_TestFixture(test_nand_ecc_erased),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_ecc_tests, NULL, NULL, fixtures);
+
+    return (Test *)&nand_ecc_tests;
+}
+#endif
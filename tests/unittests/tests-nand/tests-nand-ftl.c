@@ -0,0 +1,297 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_FTL)
+#include "mtd_nand_ftl.h"
+#include "nand/bbt.h"
+
+#define TEST_FIRST_BLOCK        (100)
+#define TEST_SCAN_FIRST_BLOCK   (200)   /**< its checkpoint area gets retired */
+#define TEST_BLOCKS             (24)
+#define TEST_PAGE_SIZE          (2048)
+#define TEST_SECTORS            (TEST_PAGE_SIZE / MTD_NAND_FTL_SECTOR_SIZE)
+
+static mtd_nand_ftl_t _ftl = {
+    .base = {
+        .driver = &mtd_nand_ftl_driver,
+    },
+    .first_block = TEST_FIRST_BLOCK,
+    .block_count = TEST_BLOCKS,
+};
+static uint8_t _page[TEST_PAGE_SIZE];
+static uint8_t _read[TEST_PAGE_SIZE];
+
+static void _fill(uint8_t *buf, uint32_t logical, unsigned gen)
+{
+    for (unsigned i = 0; i < TEST_PAGE_SIZE; i++) {
+        buf[i] = logical * 31 + gen * 17 + i;
+    }
+}
+
+static void _write(uint32_t logical, unsigned gen)
+{
+    _fill(_page, logical, gen);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(&_ftl.base, _page, logical * TEST_SECTORS, 0,
+                                                TEST_PAGE_SIZE));
+}
+
+static bool _holds(uint32_t logical, unsigned gen)
+{
+    _fill(_page, logical, gen);
+    return mtd_read_page(&_ftl.base, _read, logical * TEST_SECTORS, 0, TEST_PAGE_SIZE) == 0 &&
+           memcmp(_page, _read, TEST_PAGE_SIZE) == 0;
+}
+
+static bool _erased(uint32_t logical)
+{
+    memset(_page, 0xFF, TEST_PAGE_SIZE);
+    return mtd_read_page(&_ftl.base, _read, logical * TEST_SECTORS, 0, TEST_PAGE_SIZE) == 0 &&
+           memcmp(_page, _read, TEST_PAGE_SIZE) == 0;
+}
+
+static void _trim(uint32_t first_logical, uint32_t end_logical)
+{
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(&_ftl.base, first_logical * TEST_SECTORS,
+                                              (end_logical - first_logical) * TEST_SECTORS));
+}
+
+/* the next init finds no checkpoint and scans all blocks */
+static void _drop_checkpoints(void)
+{
+    mtd_dev_t *parent = &_ftl.parent->base;
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(parent, TEST_FIRST_BLOCK, _ftl.checkpoint_blocks));
+}
+
+static void set_up(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+
+    TEST_ASSERT_NOT_NULL(mtd_nand);
+    TEST_ASSERT_EQUAL_INT(TEST_PAGE_SIZE, ((nand_t *)mtd_nand->nand_onfi)->data_bytes_per_page);
+    _ftl.parent = mtd_nand;
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(&mtd_nand->base, TEST_FIRST_BLOCK, TEST_BLOCKS));
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+}
+
+static void test_ftl_overwrite(void)
+{
+    for (uint32_t logical = 0; logical < 16; logical++) {
+        _write(logical, 1);
+    }
+    _write(5, 2);
+
+    /* one sector of a NAND page, the others keep their content */
+    memset(_page, 0xAB, MTD_NAND_FTL_SECTOR_SIZE);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(&_ftl.base, _page, 3 * TEST_SECTORS + 1, 0,
+                                                MTD_NAND_FTL_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(&_ftl.base, _read, 3 * TEST_SECTORS, 0,
+                                           TEST_PAGE_SIZE));
+    _fill(_page, 3, 1);
+    memset(&_page[MTD_NAND_FTL_SECTOR_SIZE], 0xAB, MTD_NAND_FTL_SECTOR_SIZE);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _read, TEST_PAGE_SIZE));
+
+    TEST_ASSERT(_holds(5, 2));
+    TEST_ASSERT(_holds(15, 1));
+    TEST_ASSERT(_erased(16));
+}
+
+static void test_ftl_remount_checkpoint(void)
+{
+    for (uint32_t logical = 0; logical < 32; logical++) {
+        _write(logical, 1);
+    }
+    for (uint32_t logical = 0; logical < 8; logical++) {
+        _write(logical, 2);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_power(&_ftl.base, MTD_POWER_DOWN));
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    TEST_ASSERT(_ftl.checkpointed);
+
+    for (uint32_t logical = 0; logical < 32; logical++) {
+        TEST_ASSERT(_holds(logical, (logical < 8) ? 2 : 1));
+    }
+    TEST_ASSERT(_erased(32));
+}
+
+static void test_ftl_remount_scan(void)
+{
+    for (uint32_t logical = 0; logical < 32; logical++) {
+        _write(logical, 1);
+    }
+    for (uint32_t logical = 8; logical < 16; logical++) {
+        _write(logical, 2);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_power(&_ftl.base, MTD_POWER_DOWN));
+    _drop_checkpoints();
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+
+    for (uint32_t logical = 0; logical < 32; logical++) {
+        TEST_ASSERT(_holds(logical, (logical >= 8 && logical < 16) ? 2 : 1));
+    }
+    TEST_ASSERT(_erased(32));
+}
+
+static void test_ftl_power_loss(void)
+{
+    for (uint32_t logical = 0; logical < 32; logical++) {
+        _write(logical, 1);
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_nand_ftl_checkpoint(&_ftl));
+
+    /* written after the checkpoint, init replays them without a power down */
+    for (uint32_t logical = 0; logical < 16; logical++) {
+        _write(logical, 2);
+    }
+    _write(40, 3);
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+
+    for (uint32_t logical = 0; logical < 32; logical++) {
+        TEST_ASSERT(_holds(logical, (logical < 16) ? 2 : 1));
+    }
+    TEST_ASSERT(_holds(40, 3));
+}
+
+static void test_ftl_gc_full(void)
+{
+    /* every logical page is valid, only the spare blocks take the rewrites */
+    for (unsigned gen = 1; gen <= 3; gen++) {
+        for (uint32_t logical = 0; logical < _ftl.logical_pages; logical++) {
+            _write(logical, gen);
+        }
+    }
+
+    for (uint32_t logical = 0; logical < _ftl.logical_pages; logical++) {
+        TEST_ASSERT(_holds(logical, 3));
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    for (uint32_t logical = 0; logical < _ftl.logical_pages; logical++) {
+        TEST_ASSERT(_holds(logical, 3));
+    }
+}
+
+static void test_ftl_trim(void)
+{
+    for (uint32_t logical = 0; logical < 64; logical++) {
+        _write(logical, 1);
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_nand_ftl_checkpoint(&_ftl));
+
+    /* replayed after the checkpoint */
+    _trim(8, 16);
+    TEST_ASSERT(_erased(8));
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    TEST_ASSERT(_erased(8));
+    TEST_ASSERT(_erased(15));
+    TEST_ASSERT(_holds(16, 1));
+
+    /* found by a full scan, the copies it unmaps are still programmed */
+    _drop_checkpoints();
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    TEST_ASSERT(_erased(8));
+    TEST_ASSERT(_erased(15));
+    TEST_ASSERT(_holds(7, 1));
+    TEST_ASSERT(_holds(16, 1));
+}
+
+/* rewrites until the block of the trim got collected and erased */
+static void _collect_trim(void)
+{
+    const uint32_t trim_block = _ftl.open_block;
+
+    for (unsigned round = 0; round < 64; round++) {
+        for (uint32_t logical = 100; logical < 132; logical++) {
+            _write(logical, round);
+            while (mtd_nand_ftl_erase_ahead(&_ftl) > 0) {}
+        }
+
+        if (mtd_nand_onfi_block_erased(_ftl.parent, _ftl.first_block + trim_block)) {
+            return;
+        }
+    }
+    TEST_FAIL("block of the trim not collected");
+}
+
+static void test_ftl_trim_collected(void)
+{
+    /* a full device, so the rewrites need the garbage collector */
+    for (uint32_t logical = 0; logical < _ftl.logical_pages; logical++) {
+        _write(logical, 1);
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_nand_ftl_checkpoint(&_ftl));
+
+    _trim(16, 24);
+    _collect_trim();
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    TEST_ASSERT(_erased(16));
+    TEST_ASSERT(_erased(23));
+    TEST_ASSERT(_holds(15, 1));
+    TEST_ASSERT(_holds(24, 1));
+}
+
+static void test_ftl_trim_collected_scan(void)
+{
+    mtd_nand_onfi_t *mtd_nand = _ftl.parent;
+
+    /* blocks of their own, as their checkpoint area is retired for good */
+    _ftl.first_block = TEST_SCAN_FIRST_BLOCK;
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(&mtd_nand->base, TEST_SCAN_FIRST_BLOCK, TEST_BLOCKS));
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    for (uint32_t block = 0; block < _ftl.checkpoint_blocks; block++) {
+        TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_bbt_mark_bad(&mtd_nand->bbt,
+                                                            TEST_SCAN_FIRST_BLOCK + block));
+    }
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    TEST_ASSERT(!_ftl.checkpointed);
+
+    /* without a checkpoint, only the trim page keeps the older copies unmapped */
+    for (uint32_t logical = 0; logical < _ftl.logical_pages; logical++) {
+        _write(logical, 1);
+    }
+    _trim(16, 24);
+    _write(20, 2);
+    _collect_trim();
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_ftl.base));
+    TEST_ASSERT(_erased(16));
+    TEST_ASSERT(_erased(23));
+    TEST_ASSERT(_holds(20, 2));
+    TEST_ASSERT(_holds(15, 1));
+    TEST_ASSERT(_holds(24, 1));
+
+    _ftl.first_block = TEST_FIRST_BLOCK;
+}
+
+Test *tests_nand_ftl_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_ftl_overwrite),
+        new_TestFixture(test_ftl_remount_checkpoint),
+        new_TestFixture(test_ftl_remount_scan),
+        new_TestFixture(test_ftl_power_loss),
+        new_TestFixture(test_ftl_gc_full),
+        new_TestFixture(test_ftl_trim),
+        new_TestFixture(test_ftl_trim_collected),
+        new_TestFixture(test_ftl_trim_collected_scan),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_ftl_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nand_ftl_tests;
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM)
+#include "nand_sim.h"
+#include "ztimer.h"
+
+#define TEST_BLOCK          (8)
+#define TEST_UNUSED_BLOCK   (900)   /**< never programmed by any test */
+
+static uint8_t _buf[512];
+static uint8_t _page[2048];
+
+static void set_up(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+
+    TEST_ASSERT_NOT_NULL(mtd_nand);
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(&mtd_nand->base, TEST_BLOCK, 1));
+}
+
+static void test_onfi_host_ecc(void)
+{
+    TEST_ASSERT(nand_ecc_on_host(&tests_nand_dev()->ecc));
+}
+
+static void test_onfi_partial_program_once(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+    const uint32_t page = TEST_BLOCK * dev->pages_per_sector;
+
+    memset(_buf, 0x5A, sizeof(_buf));
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _buf, page, 0, sizeof(_buf)));
+
+    /* the parity of the first program covers the whole page */
+    memset(_buf, 0xA5, sizeof(_buf));
+    TEST_ASSERT_EQUAL_INT(-EINVAL, mtd_write_page_raw(dev, _buf, page, sizeof(_buf), sizeof(_buf)));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _page, page, 0, dev->page_size));
+    memset(_buf, 0x5A, sizeof(_buf));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0xFF, _page[sizeof(_buf)]);
+}
+
+static void test_onfi_partial_program_erased(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+    const uint32_t page = TEST_BLOCK * dev->pages_per_sector + 1;
+
+    memset(_buf, 0x3C, sizeof(_buf));
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _buf, page, sizeof(_buf), sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _page, page, sizeof(_buf), sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _buf, sizeof(_buf)));
+}
+
+static void test_onfi_erase_wears_unused(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+    const nand_t *nand = (nand_t *)mtd_nand->nand_onfi;
+    const uint32_t erases = nand_sim_block_erases(0, TEST_UNUSED_BLOCK);
+
+    /* never programmed, the erase still counts */
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_onfi_erase_block(mtd_nand->nand_onfi,
+                          nand_page_no_to_addr_row((uint64_t)TEST_UNUSED_BLOCK * nand->pages_per_block)));
+    TEST_ASSERT_EQUAL_INT(erases + 1, nand_sim_block_erases(0, TEST_UNUSED_BLOCK));
+}
+
+static void test_onfi_reset_without_rb(void)
+{
+    static nand_params_t no_rb;
+    nand_onfi_t *nand_onfi = tests_nand_dev()->nand_onfi;
+    const nand_params_t *params = nand_onfi->nand.params;
+    uint8_t targets[NAND_MAX_CHIPS];
+    uint8_t status;
+
+    memcpy(targets, nand_onfi->targets, sizeof(targets));
+    no_rb = *params;
+    no_rb.rb[0] = GPIO_UNDEF;
+
+    /* RESET is still sent, READ STATUS tells when it is done */
+    nand_onfi->nand.params = &no_rb;
+    const uint8_t ready = nand_onfi_reset(nand_onfi);
+    nand_onfi->nand.params = params;
+    memcpy(nand_onfi->targets, targets, sizeof(targets));
+
+    TEST_ASSERT_EQUAL_INT(1, ready & 1);
+    TEST_ASSERT_EQUAL_INT(NAND_RW_OK, nand_onfi_read_status(nand_onfi, 0, &status));
+    TEST_ASSERT(status & NAND_ONFI_STATUS_RDY);
+}
+
+static void test_onfi_rw_without_rb(void)
+{
+    static nand_params_t no_rb;
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+    mtd_dev_t *dev = &mtd_nand->base;
+    const nand_params_t *params = mtd_nand->nand_onfi->nand.params;
+    const uint32_t page = TEST_BLOCK * dev->pages_per_sector + 2;
+
+    no_rb = *params;
+    no_rb.rb[0] = GPIO_UNDEF;
+
+    /* READ STATUS ends every wait once the LUN is done, well before the 10 ms timeout */
+    mtd_nand->nand_onfi->nand.params = &no_rb;
+    const uint32_t start = ztimer_now(ZTIMER_USEC);
+    memset(_buf, 0x96, sizeof(_buf));
+    const int write_res = mtd_write_page_raw(dev, _buf, page, 0, sizeof(_buf));
+    const int read_res = mtd_read_page(dev, _page, page, 0, dev->page_size);
+    const uint32_t usec = ztimer_now(ZTIMER_USEC) - start;
+    mtd_nand->nand_onfi->nand.params = params;
+
+    TEST_ASSERT_EQUAL_INT(0, write_res);
+    TEST_ASSERT_EQUAL_INT(0, read_res);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _buf, sizeof(_buf)));
+    TEST_ASSERT_EQUAL_INT(0xFF, _page[sizeof(_buf)]);
+    TEST_ASSERT(usec < 10000);
+}
+
+Test *tests_nand_onfi_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_onfi_host_ecc),
+        new_TestFixture(test_onfi_partial_program_once),
+        new_TestFixture(test_onfi_partial_program_erased),
+        new_TestFixture(test_onfi_erase_wears_unused),
+        new_TestFixture(test_onfi_reset_without_rb),
+        new_TestFixture(test_onfi_rw_without_rb),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_onfi_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nand_onfi_tests;
+}
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_ONFI_READAHEAD)
+#include "nand_sim.h"
+
+#define TEST_BLOCK      (40)    /**< the one after it is used too */
+#define TEST_BLOCKS     (2)
+#define TEST_CHUNK      (512)
+
+static uint8_t _page[2048];
+static uint8_t _read[TEST_CHUNK];
+
+static void _fill(uint32_t page_no, uint32_t offset, uint8_t *buf, size_t size)
+{
+    for (size_t pos = 0; pos < size; pos++) {
+        buf[pos] = (uint8_t)(page_no * 7 + (offset + pos) / TEST_CHUNK);
+    }
+}
+
+static void set_up(void)
+{
+    mtd_nand_onfi_t *mtd_nand = tests_nand_dev();
+    mtd_dev_t *dev;
+
+    TEST_ASSERT_NOT_NULL(mtd_nand);
+    dev = &mtd_nand->base;
+    TEST_ASSERT_EQUAL_INT(0, mtd_erase_sector(dev, TEST_BLOCK, TEST_BLOCKS));
+
+    for (uint32_t page = 0; page < TEST_BLOCKS * dev->pages_per_sector; page++) {
+        const uint32_t page_no = TEST_BLOCK * dev->pages_per_sector + page;
+
+        _fill(page_no, 0, _page, dev->page_size);
+        TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _page, page_no, 0, dev->page_size));
+    }
+
+    /* a read elsewhere, the stream starts anew */
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, 0, 0, sizeof(_read)));
+    nand_sim_stats_reset();
+}
+
+static void test_readahead_tr(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+    const uint32_t pages = TEST_BLOCKS * dev->pages_per_sector;
+    const uint32_t window = (CONFIG_MTD_NAND_ONFI_READAHEAD_MAX < CONFIG_MTD_NAND_ONFI_CACHE_PAGES)
+                          ? CONFIG_MTD_NAND_ONFI_READAHEAD_MAX : CONFIG_MTD_NAND_ONFI_CACHE_PAGES;
+
+    for (uint32_t page = 0; page < pages; page++) {
+        const uint32_t page_no = TEST_BLOCK * dev->pages_per_sector + page;
+
+        for (uint32_t offset = 0; offset < dev->page_size; offset += TEST_CHUNK) {
+            TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, page_no, offset, sizeof(_read)));
+            _fill(page_no, offset, _page, sizeof(_read));
+            TEST_ASSERT_EQUAL_INT(0, memcmp(_page, _read, sizeof(_read)));
+        }
+    }
+
+    /* every page is loaded once, tR is waited for once per window after it grew */
+    TEST_ASSERT_EQUAL_INT(pages, nand_sim_stats()->page_reads);
+    TEST_ASSERT(nand_sim_stats()->read_waits <= pages / window + 2 * TEST_BLOCKS);
+}
+
+static void test_readahead_random(void)
+{
+    mtd_dev_t *dev = &tests_nand_dev()->base;
+    const uint32_t first = TEST_BLOCK * dev->pages_per_sector;
+
+    /* pages apart are not a stream, nothing is read ahead */
+    for (uint32_t page = 0; page < dev->pages_per_sector; page += 2) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, first + page, 0, sizeof(_read)));
+    }
+
+    TEST_ASSERT_EQUAL_INT(dev->pages_per_sector / 2, nand_sim_stats()->page_reads);
+    TEST_ASSERT_EQUAL_INT(dev->pages_per_sector / 2, nand_sim_stats()->read_waits);
+}
+
+Test *tests_nand_readahead_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_readahead_tr),
+        new_TestFixture(test_readahead_random),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_readahead_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nand_readahead_tests;
+}
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_STATS)
+#include "nand/stats.h"
+
+static void set_up(void)
+{
+    nand_stats_reset();
+}
+
+static void test_stats_wait_below_usec(void)
+{
+    /* tWHR, tADL and the like are some ten ns each, they add up all the same */
+    for (unsigned pos = 0; pos < 1000; pos++) {
+        nand_stats_wait(80);
+    }
+    nand_stats_wait(500);
+
+    TEST_ASSERT(nand_stats.wait_ns == 80500);
+}
+
+static void test_stats_ecc(void)
+{
+    nand_stats_ecc(3);
+    nand_stats_ecc(1);
+    TEST_ASSERT_EQUAL_INT(4, nand_stats.ecc_corrected_bits);
+
+    nand_stats_mtd(NAND_STATS_OP_READ, nand_stats_now(), -EBADMSG);
+    TEST_ASSERT_EQUAL_INT(1, nand_stats.ecc_failed);
+    TEST_ASSERT_EQUAL_INT(1, nand_stats.mtd[NAND_STATS_OP_READ].failed);
+}
+
+static void test_stats_op(void)
+{
+    nand_stats_cmd(0x00, nand_stats_now(), 2048, true);
+    nand_stats_cmd(0x80, nand_stats_now(), 2048, false);
+    nand_stats_cmd(0x60, nand_stats_now(), 0, true);
+    nand_stats_cmd(0x70, nand_stats_now(), 1, true);
+
+    for (unsigned op = 0; op < NAND_STATS_OP_NUMOF; op++) {
+        TEST_ASSERT_EQUAL_INT(1, nand_stats.cmd[op].count);
+    }
+    TEST_ASSERT(nand_stats.cmd[NAND_STATS_OP_READ].bytes == 2048);
+    TEST_ASSERT_EQUAL_INT(1, nand_stats.cmd[NAND_STATS_OP_PROGRAM].failed);
+    TEST_ASSERT_EQUAL_INT(0, nand_stats.cmd[NAND_STATS_OP_ERASE].failed);
+}
+
+Test *tests_nand_stats_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_stats_wait_below_usec),
+        new_TestFixture(test_stats_ecc),
+        new_TestFixture(test_stats_op),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_stats_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nand_stats_tests;
+}
+#endif
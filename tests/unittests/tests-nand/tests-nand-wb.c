@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_MTD_NAND_WB)
+#include "mtd_nand_wb.h"
+
+#define MOCK_PAGE_SIZE          (2048)
+#define MOCK_PAGES_PER_SECTOR   (4)
+#define MOCK_SECTOR_COUNT       (2)
+#define MOCK_CHUNK              (MOCK_PAGE_SIZE / 8)
+
+/* counts the programs the buffer issues, a program can be made to fail */
+static uint8_t _memory[MOCK_SECTOR_COUNT * MOCK_PAGES_PER_SECTOR * MOCK_PAGE_SIZE];
+static unsigned _programs;
+static int _program_res;
+
+static int _mock_init(mtd_dev_t *dev)
+{
+    (void)dev;
+    return 0;
+}
+
+static int _mock_read_page(mtd_dev_t *dev, void *buf, uint32_t page, uint32_t offset,
+                           uint32_t size)
+{
+    (void)dev;
+
+    if (size > MOCK_PAGE_SIZE - offset) {
+        size = MOCK_PAGE_SIZE - offset;
+    }
+    memcpy(buf, &_memory[page * MOCK_PAGE_SIZE + offset], size);
+
+    return size;
+}
+
+static int _mock_write_page(mtd_dev_t *dev, const void *buf, uint32_t page, uint32_t offset,
+                            uint32_t size)
+{
+    (void)dev;
+
+    _programs++;
+    if (_program_res < 0) {
+        return _program_res;
+    }
+    if (size > MOCK_PAGE_SIZE - offset) {
+        size = MOCK_PAGE_SIZE - offset;
+    }
+    /* bits only go from 1 to 0 until the next erase */
+    for (uint32_t pos = 0; pos < size; pos++) {
+        _memory[page * MOCK_PAGE_SIZE + offset + pos] &= ((const uint8_t *)buf)[pos];
+    }
+
+    return size;
+}
+
+static int _mock_erase_sector(mtd_dev_t *dev, uint32_t sector, uint32_t count)
+{
+    (void)dev;
+
+    memset(&_memory[sector * MOCK_PAGES_PER_SECTOR * MOCK_PAGE_SIZE], 0xFF,
+           count * MOCK_PAGES_PER_SECTOR * MOCK_PAGE_SIZE);
+
+    return 0;
+}
+
+static const mtd_desc_t _mock_driver = {
+    .init           = _mock_init,
+    .read_page      = _mock_read_page,
+    .write_page     = _mock_write_page,
+    .erase_sector   = _mock_erase_sector,
+};
+
+static mtd_dev_t _mock = {
+    .driver             = &_mock_driver,
+    .sector_count       = MOCK_SECTOR_COUNT,
+    .pages_per_sector   = MOCK_PAGES_PER_SECTOR,
+    .page_size          = MOCK_PAGE_SIZE,
+};
+
+static mtd_nand_wb_t _wb = {
+    .base = {
+        .driver = &mtd_nand_wb_driver,
+    },
+    .parent = &_mock,
+};
+static uint8_t _chunk[MOCK_CHUNK];
+static uint8_t _read[MOCK_CHUNK];
+
+static void set_up(void)
+{
+    memset(_memory, 0xFF, sizeof(_memory));
+    _program_res = 0;
+    TEST_ASSERT_EQUAL_INT(0, mtd_init(&_wb.base));
+    _programs = 0;
+}
+
+static void test_wb_one_program_per_page(void)
+{
+    mtd_dev_t *dev = &_wb.base;
+
+    for (unsigned pos = 0; pos < MOCK_PAGE_SIZE / MOCK_CHUNK; pos++) {
+        memset(_chunk, pos, sizeof(_chunk));
+        TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _chunk, 1, pos * MOCK_CHUNK,
+                                                    sizeof(_chunk)));
+    }
+
+    /* the last write completed the page, it went out in one program */
+    TEST_ASSERT_EQUAL_INT(1, _programs);
+    TEST_ASSERT_EQUAL_INT(8, _wb.writes);
+    TEST_ASSERT_EQUAL_INT(1, _wb.programs);
+    TEST_ASSERT_EQUAL_INT(0, mtd_nand_wb_sync(&_wb));
+    TEST_ASSERT_EQUAL_INT(1, _programs);
+
+    TEST_ASSERT_EQUAL_INT(sizeof(_read), _mock_read_page(&_mock, _read, 1, 7 * MOCK_CHUNK,
+                                                          sizeof(_read)));
+    memset(_chunk, 7, sizeof(_chunk));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_chunk, _read, sizeof(_read)));
+}
+
+static void test_wb_read_buffered(void)
+{
+    mtd_dev_t *dev = &_wb.base;
+
+    memset(_chunk, 0x42, sizeof(_chunk));
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _chunk, 2, MOCK_CHUNK, sizeof(_chunk)));
+    TEST_ASSERT_EQUAL_INT(0, _programs);
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, _read, 2, MOCK_CHUNK, sizeof(_read)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(_chunk, _read, sizeof(_read)));
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_nand_wb_sync(&_wb));
+    TEST_ASSERT_EQUAL_INT(1, _programs);
+}
+
+static void test_wb_read_gap(void)
+{
+    mtd_dev_t *dev = &_wb.base;
+    uint8_t page[120];
+
+    /* bytes 50..60 are programmed already, the buffered writes leave a gap over them */
+    memset(_chunk, 0x5A, 10);
+    TEST_ASSERT_EQUAL_INT(10, _mock_write_page(&_mock, _chunk, 3, 50, 10));
+    _programs = 0;
+
+    memset(_chunk, 0x11, 10);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _chunk, 3, 0, 10));
+    memset(_chunk, 0x22, 10);
+    TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _chunk, 3, 100, 10));
+    TEST_ASSERT_EQUAL_INT(0, _programs);
+
+    TEST_ASSERT_EQUAL_INT(0, mtd_read_page(dev, page, 3, 0, sizeof(page)));
+    TEST_ASSERT_EQUAL_INT(0x11, page[0]);
+    TEST_ASSERT_EQUAL_INT(0xFF, page[10]);
+    TEST_ASSERT_EQUAL_INT(0x5A, page[50]);
+    TEST_ASSERT_EQUAL_INT(0x5A, page[59]);
+    TEST_ASSERT_EQUAL_INT(0xFF, page[60]);
+    TEST_ASSERT_EQUAL_INT(0x22, page[109]);
+    TEST_ASSERT_EQUAL_INT(0xFF, page[110]);
+
+    /* the NAND reads the same after the flush */
+    TEST_ASSERT_EQUAL_INT(0, mtd_nand_wb_sync(&_wb));
+    TEST_ASSERT_EQUAL_INT(1, _programs);
+    TEST_ASSERT_EQUAL_INT(sizeof(_read), _mock_read_page(&_mock, _read, 3, 0, sizeof(_read)));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(page, _read, sizeof(page)));
+}
+
+static void test_wb_evict_failed(void)
+{
+    mtd_dev_t *dev = &_wb.base;
+
+    memset(_chunk, 0x11, sizeof(_chunk));
+    for (uint32_t page = 0; page < CONFIG_MTD_NAND_WB_SLOTS; page++) {
+        TEST_ASSERT_EQUAL_INT(0, mtd_write_page_raw(dev, _chunk, page, 0, sizeof(_chunk)));
+    }
+
+    /* the least recently written slot fails to go out, the new page does not take it */
+    _program_res = -EIO;
+    TEST_ASSERT_EQUAL_INT(-EIO, mtd_write_page_raw(dev, _chunk, CONFIG_MTD_NAND_WB_SLOTS, 0,
+                                                   sizeof(_chunk)));
+    for (unsigned pos = 0; pos < CONFIG_MTD_NAND_WB_SLOTS; pos++) {
+        TEST_ASSERT(_wb.slots[pos].page_no != CONFIG_MTD_NAND_WB_SLOTS);
+    }
+
+    /* nor does a power down go on with data left behind */
+    TEST_ASSERT_EQUAL_INT(-EIO, mtd_power(dev, MTD_POWER_DOWN));
+}
+
+Test *tests_nand_wb_tests(void)
+{
+    EMB_UNIT_TESTFIXTURES(fixtures) {
+        new_TestFixture(test_wb_one_program_per_page),
+        new_TestFixture(test_wb_read_buffered),
+        new_TestFixture(test_wb_read_gap),
+        new_TestFixture(test_wb_evict_failed),
+    };
+
+    EMB_UNIT_TESTCALLER(nand_wb_tests, set_up, NULL, fixtures);
+
+    return (Test *)&nand_wb_tests;
+}
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+#include <stdbool.h>
+
+#include "tests-nand.h"
+
+#if IS_USED(MODULE_NAND_SIM)
+#include "nand_params.h"
+
+static nand_onfi_t _nand_onfi;
+static mtd_nand_onfi_t _mtd_nand = {
+    .base = {
+        .driver = &mtd_nand_driver,
+    },
+    .nand_onfi = &_nand_onfi,
+    .params = &nand_params[0],
+};
+
+mtd_nand_onfi_t *tests_nand_dev(void)
+{
+    static bool init_done;
+
+    if (!init_done) {
+        init_done = (mtd_init(&_mtd_nand.base) == 0);
+    }
+
+    return init_done ? &_mtd_nand : NULL;
+}
+#endif
+
+void tests_nand(void)
+{
+#if IS_USED(MODULE_NAND_SIM)
+    TESTS_RUN(tests_nand_onfi_tests());
+    TESTS_RUN(tests_nand_bbt_tests());
+#endif
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_BBM)
+    TESTS_RUN(tests_nand_bbm_tests());
+#endif
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_FTL)
+    TESTS_RUN(tests_nand_ftl_tests());
+#endif
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_ONFI_CACHE)
+    TESTS_RUN(tests_nand_cache_tests());
+#endif
+#if IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_ONFI_READAHEAD)
+    TESTS_RUN(tests_nand_readahead_tests());
+#endif
+#if IS_USED(MODULE_MTD_NAND_WB)
+    TESTS_RUN(tests_nand_wb_tests());
+#endif
+#if IS_USED(MODULE_NAND_ECC)
+    TESTS_RUN(tests_nand_ecc_tests());
+#endif
+#if IS_USED(MODULE_NAND_STATS)
+    TESTS_RUN(tests_nand_stats_tests());
+#endif
+}
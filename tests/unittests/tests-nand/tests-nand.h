@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2022-2023 Jongmin Kim <jmkim@pukyong.ac.kr>
+ *               2022-2023 double O Co., Ltd.
+ *
+ * This file is subject to the terms and conditions of the GNU Lesser
+ * General Public License v2.1. See the file LICENSE in the top level
+ * directory for more details.
+ */
+
+/**
+ * @addtogroup  unittests
+ * @{
+ *
+ * @file
+ * @brief       Unittests for the NAND stack
+ *
+ * The tests run against the simulated part of native (`nand_sim`) and are
+ * empty on other boards. All of them share one mtd_nand_onfi device, each
+ * test file works on blocks of its own.
+ *
+ * @author      Jongmin Kim <jmkim@pukyong.ac.kr>
+ */
+#ifndef TESTS_NAND_H
+#define TESTS_NAND_H
+
+#include "embUnit.h"
+#include "kernel_defines.h"
+
+#if IS_USED(MODULE_NAND_SIM)
+#include "mtd_nand_onfi.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief   The entry point of this test suite.
+ */
+void tests_nand(void);
+
+#if IS_USED(MODULE_NAND_SIM) || defined(DOXYGEN)
+/**
+ * @brief   The mtd_nand_onfi device on the simulated part, initialised on
+ *          first use
+ *
+ * @return  NULL if its init failed
+ */
+mtd_nand_onfi_t *tests_nand_dev(void);
+
+/**
+ * @brief   Generates tests for mtd_nand_onfi
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_onfi_tests(void);
+
+/**
+ * @brief   Generates tests for nand_bbt
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_bbt_tests(void);
+#endif
+
+#if (IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_BBM)) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for mtd_nand_bbm
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_bbm_tests(void);
+#endif
+
+#if (IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_FTL)) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for mtd_nand_ftl
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_ftl_tests(void);
+#endif
+
+#if (IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_ONFI_CACHE)) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for the page cache of mtd_nand_onfi
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_cache_tests(void);
+#endif
+
+#if (IS_USED(MODULE_NAND_SIM) && IS_USED(MODULE_MTD_NAND_ONFI_READAHEAD)) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for the read-ahead of mtd_nand_onfi
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_readahead_tests(void);
+#endif
+
+#if IS_USED(MODULE_MTD_NAND_WB) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for mtd_nand_wb
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_wb_tests(void);
+#endif
+
+#if IS_USED(MODULE_NAND_ECC) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for the BCH codec and nand_ecc
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_ecc_tests(void);
+#endif
+
+#if IS_USED(MODULE_NAND_STATS) || defined(DOXYGEN)
+/**
+ * @brief   Generates tests for nand_stats
+ *
+ * @return  embUnit tests if successful, NULL if not.
+ */
+Test *tests_nand_stats_tests(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TESTS_NAND_H */
+/** @} */